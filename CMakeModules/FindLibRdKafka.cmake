@@ -0,0 +1,55 @@
+#  RDKAFKA_FOUND - System has librdkafka
+#  RDKAFKA_INCLUDE_DIRS - The librdkafka include directories
+#  RDKAFKA_LIBRARIES - The libraries needed to use librdkafka
+#  RDKAFKA_DEFINITIONS - Compiler switches required for using librdkafka
+
+# use pkg-config to get the directories and then use these values
+# in the find_path() and find_library() calls
+find_package(PkgConfig)
+pkg_check_modules(PC_RDKAFKA QUIET rdkafka)
+set(RDKAFKA_DEFINITIONS ${PC_RDKAFKA_CFLAGS_OTHER})
+
+find_path(
+	RDKAFKA_INCLUDE_DIR librdkafka/rdkafka.h
+	HINTS ${PC_RDKAFKA_INCLUDEDIR} ${PC_RDKAFKA_INCLUDE_DIRS}
+	PATH_SUFFIXES include
+)
+
+find_library(
+	RDKAFKA_LIBRARY NAMES rdkafka librdkafka
+	HINTS ${PC_RDKAFKA_LIBDIR} ${PC_RDKAFKA_LIBRARY_DIRS}
+	PATH_SUFFIXES lib lib64
+)
+
+if (PC_RDKAFKA_VERSION)
+    # Version extracted from pkg-config
+    set(RDKAFKA_VERSION_STRING ${PC_RDKAFKA_VERSION})
+elseif(RDKAFKA_INCLUDE_DIR AND EXISTS "${RDKAFKA_INCLUDE_DIR}/librdkafka/rdkafka.h")
+    # Try to extract library version from a header file (format 0xMMmmrrxx)
+    file(STRINGS "${RDKAFKA_INCLUDE_DIR}/librdkafka/rdkafka.h" rdkafka_version_str
+         REGEX "^#define[\t ]+RD_KAFKA_VERSION[\t ]+0x[0-9a-fA-F]+")
+
+    string(REGEX REPLACE "^#define[\t ]+RD_KAFKA_VERSION[\t ]+0x([0-9a-fA-F]+).*" "\\1"
+           rdkafka_version_hex "${rdkafka_version_str}")
+    string(SUBSTRING "${rdkafka_version_hex}" 0 2 rdkafka_major)
+    string(SUBSTRING "${rdkafka_version_hex}" 2 2 rdkafka_minor)
+    string(SUBSTRING "${rdkafka_version_hex}" 4 2 rdkafka_patch)
+    math(EXPR rdkafka_major "0x${rdkafka_major}")
+    math(EXPR rdkafka_minor "0x${rdkafka_minor}")
+    math(EXPR rdkafka_patch "0x${rdkafka_patch}")
+    set(RDKAFKA_VERSION_STRING "${rdkafka_major}.${rdkafka_minor}.${rdkafka_patch}")
+    unset(rdkafka_version_str)
+    unset(rdkafka_version_hex)
+endif()
+
+# handle the QUIETLY and REQUIRED arguments and set RDKAFKA_FOUND to TRUE
+# if all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LibRdKafka
+	REQUIRED_VARS RDKAFKA_LIBRARY RDKAFKA_INCLUDE_DIR
+	VERSION_VAR RDKAFKA_VERSION_STRING
+)
+
+set(RDKAFKA_LIBRARIES ${RDKAFKA_LIBRARY})
+set(RDKAFKA_INCLUDE_DIRS ${RDKAFKA_INCLUDE_DIR})
+mark_as_advanced(RDKAFKA_INCLUDE_DIR RDKAFKA_LIBRARY)
@@ -0,0 +1,75 @@
+/**
+ * \file extra_plugins/output/arrow/src/Config.hpp
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_ARROW_CONFIG_HPP
+#define IPFIXCOL2_ARROW_CONFIG_HPP
+
+#include <string>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    enum class format {
+        ARROW,  ///< Apache Arrow IPC (streaming format)
+        PARQUET ///< Apache Parquet
+    };
+
+    enum class calg {
+        NONE,   ///< Do not use compression
+        LZ4,    ///< LZ4 compression
+        ZSTD,   ///< ZSTD compression
+        SNAPPY  ///< Snappy compression (Parquet only)
+    };
+
+    /// Storage path
+    std::string m_path;
+    /// Output file format
+    format m_format;
+    /// Compression algorithm
+    calg m_calg;
+    /// Maximum number of records in a record batch (Arrow) or a row group (Parquet)
+    uint32_t m_batch_size;
+    /// Dictionary encoding of string fields
+    bool m_dictionary;
+
+    struct {
+        bool     align;   ///< Enable/disable window alignment
+        uint32_t size;    ///< Time window size
+    } m_window;   ///< Window alignment
+
+private:
+    /// Default window size
+    static const uint32_t WINDOW_SIZE = 300U;
+    /// Default size of record batches
+    static const uint32_t BATCH_SIZE = 65536U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+    void
+    parse_dump(fds_xml_ctx_t *ctx);
+};
+
+
+#endif // IPFIXCOL2_ARROW_CONFIG_HPP
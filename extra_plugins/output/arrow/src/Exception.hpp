@@ -0,0 +1,33 @@
+/**
+ * \file extra_plugins/output/arrow/src/Exception.hpp
+ * \brief Plugin specific exception (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_ARROW_EXCEPTION_HPP
+#define IPFIXCOL2_ARROW_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+/// Plugin specific exception
+class Arrow_exception : public std::runtime_error {
+public:
+    /**
+     * @brief Constructor
+     * @param[in] str Error message
+     */
+    Arrow_exception(const std::string &str) : std::runtime_error(str) {};
+    /**
+     * @brief Constructor
+     * @param[in] str Error message
+     */
+    Arrow_exception(const char *str) : std::runtime_error(str) {};
+    // Default destructor
+    ~Arrow_exception() = default;
+};
+
+#endif // IPFIXCOL2_ARROW_EXCEPTION_HPP
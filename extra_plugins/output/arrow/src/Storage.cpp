@@ -0,0 +1,192 @@
+/**
+ * \file extra_plugins/output/arrow/src/Storage.cpp
+ * \brief Columnar flow storage (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <libgen.h>
+
+#include "Storage.hpp"
+
+Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) : m_ctx(ctx), m_cfg(cfg)
+{
+    // Nothing to do
+}
+
+Storage::~Storage()
+{
+    window_close();
+}
+
+void
+Storage::window_new(time_t ts)
+{
+    // Close the current window if exists
+    window_close();
+
+    m_window_ts = ts;
+    m_window_valid = true;
+    m_file_idx = 0;
+}
+
+void
+Storage::window_close()
+{
+    if (!m_window_valid) {
+        return;
+    }
+
+    // Write remaining records and finalize all files
+    for (auto &it : m_tables) {
+        struct table_ctx &ctx = *it.second;
+        try {
+            table_flush(ctx);
+            if (ctx.writer) {
+                ctx.writer->close();
+            }
+        } catch (std::exception &ex) {
+            IPX_CTX_ERROR(m_ctx, "Failed to close a file: %s", ex.what());
+        }
+    }
+
+    m_tables.clear();
+    m_window_valid = false;
+}
+
+void
+Storage::process_msg(ipx_msg_ipfix_t *msg)
+{
+    if (!m_window_valid) {
+        IPX_CTX_DEBUG(m_ctx, "Ignoring IPFIX Message due to undefined output window!", '\0');
+        return;
+    }
+
+    /*
+     * Records of a message are typically based on only a few Templates, therefore, remember
+     * the last one. Pointers to Templates are valid only during processing of the message.
+     */
+    const struct fds_template *tmplt_last = nullptr;
+    struct table_ctx *table_last = nullptr;
+
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+        const struct fds_template *tmplt = rec_ptr->rec.tmplt;
+
+        if (tmplt->type == FDS_TYPE_TEMPLATE_OPTS) {
+            // Skip records based on Options Template
+            continue;
+        }
+
+        if (tmplt != tmplt_last) {
+            table_last = &table_get(tmplt);
+            tmplt_last = tmplt;
+        }
+
+        table_last->table->append(rec_ptr->rec);
+        if (table_last->table->rows() >= m_cfg.m_batch_size) {
+            table_flush(*table_last);
+        }
+    }
+}
+
+/**
+ * @brief Write buffered records of a table to its file (if any)
+ * @param[in] ctx Table
+ * @throw Arrow_exception if the records cannot be written
+ */
+void
+Storage::table_flush(struct table_ctx &ctx)
+{
+    if (ctx.table->rows() == 0) {
+        return;
+    }
+
+    assert(ctx.writer != nullptr && "Writer must be opened!");
+    ctx.writer->write(ctx.table->flush());
+}
+
+/**
+ * @brief Get a table for records based on a Template
+ *
+ * If the table with the corresponding schema doesn't exist, a new table is created together
+ * with a new file in the current window.
+ * @param[in] tmplt IPFIX Template
+ * @return Table
+ * @throw Arrow_exception if the table or the file cannot be created
+ */
+struct Storage::table_ctx &
+Storage::table_get(const struct fds_template *tmplt)
+{
+    std::string sig = Table::signature(tmplt);
+    auto res_it = m_tables.find(sig);
+    if (res_it != m_tables.end()) {
+        // Found
+        return *res_it->second;
+    }
+
+    // Not found -> create a new table and a new file
+    std::unique_ptr<struct table_ctx> ctx(new struct table_ctx);
+    ctx->table.reset(new Table(tmplt, m_cfg.m_dictionary));
+
+    const std::string new_file = filename_gen(m_window_ts, m_file_idx);
+    std::unique_ptr<char, decltype(&free)> new_file_cpy(strdup(new_file.c_str()), &free);
+
+    char *dir2create;
+    if (!new_file_cpy || (dir2create = dirname(new_file_cpy.get())) == nullptr) {
+        throw Arrow_exception("Failed to generate name of an output directory!");
+    }
+
+    if (ipx_utils_mkdir(dir2create, IPX_UTILS_MKDIR_DEF) != FDS_OK) {
+        throw Arrow_exception("Failed to create directory '" + std::string(dir2create) + "'");
+    }
+
+    ctx->writer = Writer::create(m_cfg, new_file, ctx->table->schema());
+    m_file_idx++;
+
+    IPX_CTX_DEBUG(m_ctx, "New schema (Template ID %" PRIu16 ") stored to '%s'", tmplt->id,
+        new_file.c_str());
+
+    struct table_ctx &result = *ctx;
+    m_tables.emplace(std::move(sig), std::move(ctx));
+    return result;
+}
+
+/**
+ * @brief Create a filename (without extension) based for a user defined timestamp
+ * @note The timestamp will be expressed in Coordinated Universal Time (UTC)
+ *
+ * @param[in] ts  Timestamp of the file
+ * @param[in] idx Index of the file in the window
+ * @return New filename
+ * @throw Arrow_exception if formatting functions fail.
+ */
+std::string
+Storage::filename_gen(const time_t &ts, unsigned int idx)
+{
+    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S";
+    constexpr size_t buffer_size = 64;
+    char buffer_data[buffer_size];
+
+    struct tm utc_time;
+    if (!gmtime_r(&ts, &utc_time)) {
+        throw Arrow_exception("gmtime_r() failed");
+    }
+
+    if (strftime(buffer_data, buffer_size, pattern, &utc_time) == 0) {
+        throw Arrow_exception("strftime() failed");
+    }
+
+    std::string new_path = m_cfg.m_path;
+    if (new_path.back() != '/') {
+        new_path += '/';
+    }
+
+    return new_path + buffer_data + "." + std::to_string(idx);
+}
@@ -0,0 +1,113 @@
+/**
+ * \file extra_plugins/output/arrow/src/Storage.hpp
+ * \brief Columnar flow storage (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_ARROW_STORAGE_HPP
+#define IPFIXCOL2_ARROW_STORAGE_HPP
+
+#include <ipfixcol2.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <libfds.h>
+
+#include "Config.hpp"
+#include "Exception.hpp"
+#include "Table.hpp"
+#include "Writer.hpp"
+
+/// Columnar flow storage
+class Storage {
+public:
+    /**
+     * @brief Create a columnar flow storage
+     *
+     * @note
+     *   Output files for the current window MUST be specified using new_window() function.
+     *   Otherwise, no flow records are stored.
+     *
+     * @param[in] ctx  Plugin context (only for log)
+     * @param[in] cfg  Configuration
+     */
+    Storage(ipx_ctx_t *ctx, const Config &cfg);
+    virtual ~Storage();
+
+    // Disable copy constructors
+    Storage(const Storage &other) = delete;
+    Storage &operator=(const Storage &other) = delete;
+
+    /**
+     * @brief Create a new time window
+     *
+     * @note Previous window is automatically closed, if exists.
+     * @note Files of the window are created on demand, i.e. a separate file is created for
+     *   each schema when the first record with the schema is processed.
+     * @param[in] ts Timestamp of the window
+     * @throw Arrow_exception if the new window cannot be created
+     */
+    void
+    window_new(time_t ts);
+
+    /**
+     * @brief Close the current time window
+     *
+     * All buffered records are written and all files of the window are finalized.
+     * @note
+     *   This can be also useful if a fatal error has occurred and we should not add more flow
+     *   records to the files.
+     * @note
+     *   No more Data Records will be added until a new window is created!
+     */
+    void
+    window_close();
+
+    /**
+     * @brief Process IPFIX message
+     *
+     * Append all IPFIX Data Records in the message to column buffers of corresponding tables.
+     * Full buffers are written to files as record batches.
+     * @note If a time window is not opened, no Data Records are stored and no exception is thrown.
+     * @note Records based on Options Templates are ignored.
+     * @param[in] msg Message to process
+     * @throw Arrow_exception if processing fails
+     */
+    void
+    process_msg(ipx_msg_ipfix_t *msg);
+
+private:
+    /// Table with a file writer
+    struct table_ctx {
+        /// Column buffers
+        std::unique_ptr<Table> table;
+        /// Output file of the table in the current window
+        std::unique_ptr<Writer> writer;
+    };
+
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Plugin configuration
+    Config m_cfg;
+
+    /// Window status
+    bool m_window_valid = false;
+    /// Timestamp of the current window
+    time_t m_window_ts = 0;
+    /// Index of the next file in the current window
+    unsigned int m_file_idx = 0;
+    /// Tables of the current window (schema signature -> table)
+    std::unordered_map<std::string, std::unique_ptr<struct table_ctx>> m_tables;
+
+    std::string
+    filename_gen(const time_t &ts, unsigned int idx);
+    struct table_ctx &
+    table_get(const struct fds_template *tmplt);
+    static void
+    table_flush(struct table_ctx &ctx);
+};
+
+#endif // IPFIXCOL2_ARROW_STORAGE_HPP
@@ -0,0 +1,408 @@
+/**
+ * \file extra_plugins/output/arrow/src/Table.cpp
+ * \brief Columnar buffer of Data Records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cassert>
+#include <cinttypes>
+#include <limits>
+#include <set>
+
+#include "Table.hpp"
+
+/// Private Enterprise Number of the paddingOctets Information Element
+static const uint32_t PADDING_EN = 0;
+/// Identification of the paddingOctets Information Element
+static const uint16_t PADDING_ID = 210;
+
+Table::Table(const struct fds_template *tmplt, bool dictionary)
+{
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::set<std::string> names;
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (is_padding(field)) {
+            continue;
+        }
+
+        column_add(field, dictionary, fields);
+
+        // Make sure that column names are unique (the same IE can be used multiple times)
+        std::string name = fields.back()->name();
+        for (unsigned int idx = 2; names.find(name) != names.end(); ++idx) {
+            name = fields.back()->name() + "#" + std::to_string(idx);
+        }
+
+        names.insert(name);
+        fields.back() = fields.back()->WithName(name);
+    }
+
+    m_schema = arrow::schema(fields);
+}
+
+std::string
+Table::signature(const struct fds_template *tmplt)
+{
+    std::string result;
+    result.reserve(tmplt->fields_cnt_total * 8U);
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (is_padding(field)) {
+            continue;
+        }
+
+        const uint8_t type = static_cast<uint8_t>(field_type(field));
+        result.append(reinterpret_cast<const char *>(&field->en), sizeof(field->en));
+        result.append(reinterpret_cast<const char *>(&field->id), sizeof(field->id));
+        result.append(reinterpret_cast<const char *>(&type), sizeof(type));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Check if a Template field represents padding
+ * @param[in] field Template field
+ */
+bool
+Table::is_padding(const struct fds_tfield *field)
+{
+    return field->en == PADDING_EN && field->id == PADDING_ID;
+}
+
+/**
+ * @brief Get a data type of a Template field
+ * @note Fields without known definition are considered as octetArray
+ * @param[in] field Template field
+ */
+enum fds_iemgr_element_type
+Table::field_type(const struct fds_tfield *field)
+{
+    return (field->def != nullptr) ? field->def->data_type : FDS_ET_OCTET_ARRAY;
+}
+
+/**
+ * @brief Add a new column for a Template field
+ *
+ * @param[in]  field      Template field
+ * @param[in]  dictionary Use dictionary encoding for strings
+ * @param[out] fields     Vector of Arrow schema fields where a new field will be added
+ * @throw Arrow_exception if a column buffer cannot be created
+ */
+void
+Table::column_add(const struct fds_tfield *field, bool dictionary,
+    std::vector<std::shared_ptr<arrow::Field>> &fields)
+{
+    column col;
+    col.ie_type = field_type(field);
+    col.size = 0;
+
+    std::shared_ptr<arrow::DataType> type;
+    switch (col.ie_type) {
+    case FDS_ET_UNSIGNED_8:
+        col.type = ctype::UINT8;
+        type = arrow::uint8();
+        break;
+    case FDS_ET_UNSIGNED_16:
+        col.type = ctype::UINT16;
+        type = arrow::uint16();
+        break;
+    case FDS_ET_UNSIGNED_32:
+        col.type = ctype::UINT32;
+        type = arrow::uint32();
+        break;
+    case FDS_ET_UNSIGNED_64:
+        col.type = ctype::UINT64;
+        type = arrow::uint64();
+        break;
+    case FDS_ET_SIGNED_8:
+        col.type = ctype::INT8;
+        type = arrow::int8();
+        break;
+    case FDS_ET_SIGNED_16:
+        col.type = ctype::INT16;
+        type = arrow::int16();
+        break;
+    case FDS_ET_SIGNED_32:
+        col.type = ctype::INT32;
+        type = arrow::int32();
+        break;
+    case FDS_ET_SIGNED_64:
+        col.type = ctype::INT64;
+        type = arrow::int64();
+        break;
+    case FDS_ET_FLOAT_32:
+        col.type = ctype::FLOAT32;
+        type = arrow::float32();
+        break;
+    case FDS_ET_FLOAT_64:
+        col.type = ctype::FLOAT64;
+        type = arrow::float64();
+        break;
+    case FDS_ET_BOOLEAN:
+        col.type = ctype::BOOL;
+        type = arrow::boolean();
+        break;
+    case FDS_ET_DATE_TIME_SECONDS:
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+        col.type = ctype::TS_MILLI;
+        type = arrow::timestamp(arrow::TimeUnit::MILLI, "UTC");
+        break;
+    case FDS_ET_DATE_TIME_MICROSECONDS:
+        col.type = ctype::TS_MICRO;
+        type = arrow::timestamp(arrow::TimeUnit::MICRO, "UTC");
+        break;
+    case FDS_ET_DATE_TIME_NANOSECONDS:
+        col.type = ctype::TS_NANO;
+        type = arrow::timestamp(arrow::TimeUnit::NANO, "UTC");
+        break;
+    case FDS_ET_MAC_ADDRESS:
+        col.type = ctype::FIXED;
+        col.size = 6U;
+        type = arrow::fixed_size_binary(col.size);
+        break;
+    case FDS_ET_IPV4_ADDRESS:
+        col.type = ctype::FIXED;
+        col.size = 4U;
+        type = arrow::fixed_size_binary(col.size);
+        break;
+    case FDS_ET_IPV6_ADDRESS:
+        col.type = ctype::FIXED;
+        col.size = 16U;
+        type = arrow::fixed_size_binary(col.size);
+        break;
+    case FDS_ET_STRING:
+        col.type = dictionary ? ctype::STRING_DICT : ctype::STRING;
+        type = dictionary ? arrow::dictionary(arrow::int32(), arrow::utf8()) : arrow::utf8();
+        break;
+    default:
+        // octetArray, structured data types, etc.
+        col.type = ctype::BINARY;
+        type = arrow::binary();
+        break;
+    }
+
+    if (col.type == ctype::STRING_DICT) {
+        // Dictionary with exact index type (MakeBuilder() would create an adaptive one)
+        col.builder.reset(new arrow::StringDictionary32Builder());
+    } else {
+        auto builder = arrow::MakeBuilder(type);
+        if (!builder.ok()) {
+            throw Arrow_exception("Failed to create a column buffer: "
+                + builder.status().ToString());
+        }
+        col.builder = std::move(builder).ValueUnsafe();
+    }
+
+    // Column name and metadata
+    std::string name;
+    if (field->def != nullptr && field->def->scope != nullptr) {
+        name = std::string(field->def->scope->name) + ":" + field->def->name;
+    } else {
+        name = "en" + std::to_string(field->en) + ":id" + std::to_string(field->id);
+    }
+
+    auto metadata = arrow::key_value_metadata(
+        {"ipfix:enterpriseId", "ipfix:elementId"},
+        {std::to_string(field->en), std::to_string(field->id)});
+    fields.push_back(arrow::field(name, type, true, metadata));
+    m_columns.push_back(std::move(col));
+}
+
+/**
+ * @brief Append unsigned integer value to a column buffer
+ * @tparam Builder Arrow builder of the column
+ */
+template <typename Builder>
+static arrow::Status
+append_uint(arrow::ArrayBuilder *builder, const uint8_t *data, uint16_t size)
+{
+    using value_type = typename Builder::value_type;
+    auto ptr = static_cast<Builder *>(builder);
+    uint64_t value;
+
+    if (fds_get_uint_be(data, size, &value) != FDS_OK
+            || value > std::numeric_limits<value_type>::max()) {
+        return ptr->AppendNull();
+    }
+
+    return ptr->Append(static_cast<value_type>(value));
+}
+
+/**
+ * @brief Append signed integer value to a column buffer
+ * @tparam Builder Arrow builder of the column
+ */
+template <typename Builder>
+static arrow::Status
+append_int(arrow::ArrayBuilder *builder, const uint8_t *data, uint16_t size)
+{
+    using value_type = typename Builder::value_type;
+    auto ptr = static_cast<Builder *>(builder);
+    int64_t value;
+
+    if (fds_get_int_be(data, size, &value) != FDS_OK
+            || value > std::numeric_limits<value_type>::max()
+            || value < std::numeric_limits<value_type>::min()) {
+        return ptr->AppendNull();
+    }
+
+    return ptr->Append(static_cast<value_type>(value));
+}
+
+/**
+ * @brief Append floating point value to a column buffer
+ * @tparam Builder Arrow builder of the column
+ */
+template <typename Builder>
+static arrow::Status
+append_float(arrow::ArrayBuilder *builder, const uint8_t *data, uint16_t size)
+{
+    using value_type = typename Builder::value_type;
+    auto ptr = static_cast<Builder *>(builder);
+    double value;
+
+    if (fds_get_float_be(data, size, &value) != FDS_OK) {
+        return ptr->AppendNull();
+    }
+
+    return ptr->Append(static_cast<value_type>(value));
+}
+
+/**
+ * @brief Convert a field value and append it to a column buffer
+ *
+ * @param[in] col  Column
+ * @param[in] data Field value
+ * @param[in] size Field size
+ * @return Status of the column builder
+ */
+arrow::Status
+Table::column_append(column &col, const uint8_t *data, uint16_t size)
+{
+    arrow::ArrayBuilder *builder = col.builder.get();
+
+    switch (col.type) {
+    case ctype::UINT8:
+        return append_uint<arrow::UInt8Builder>(builder, data, size);
+    case ctype::UINT16:
+        return append_uint<arrow::UInt16Builder>(builder, data, size);
+    case ctype::UINT32:
+        return append_uint<arrow::UInt32Builder>(builder, data, size);
+    case ctype::UINT64:
+        return append_uint<arrow::UInt64Builder>(builder, data, size);
+    case ctype::INT8:
+        return append_int<arrow::Int8Builder>(builder, data, size);
+    case ctype::INT16:
+        return append_int<arrow::Int16Builder>(builder, data, size);
+    case ctype::INT32:
+        return append_int<arrow::Int32Builder>(builder, data, size);
+    case ctype::INT64:
+        return append_int<arrow::Int64Builder>(builder, data, size);
+    case ctype::FLOAT32:
+        return append_float<arrow::FloatBuilder>(builder, data, size);
+    case ctype::FLOAT64:
+        return append_float<arrow::DoubleBuilder>(builder, data, size);
+    case ctype::BOOL: {
+        auto ptr = static_cast<arrow::BooleanBuilder *>(builder);
+        bool value;
+        if (fds_get_bool(data, size, &value) != FDS_OK) {
+            return ptr->AppendNull();
+        }
+        return ptr->Append(value);
+        }
+    case ctype::TS_MILLI: {
+        auto ptr = static_cast<arrow::TimestampBuilder *>(builder);
+        uint64_t value;
+        if (fds_get_datetime_lp_be(data, size, col.ie_type, &value) != FDS_OK) {
+            return ptr->AppendNull();
+        }
+        return ptr->Append(static_cast<int64_t>(value));
+        }
+    case ctype::TS_MICRO:
+    case ctype::TS_NANO: {
+        auto ptr = static_cast<arrow::TimestampBuilder *>(builder);
+        struct timespec ts;
+        if (fds_get_datetime_hp_be(data, size, col.ie_type, &ts) != FDS_OK) {
+            return ptr->AppendNull();
+        }
+
+        int64_t value = static_cast<int64_t>(ts.tv_sec);
+        if (col.type == ctype::TS_MICRO) {
+            value = value * INT64_C(1000000) + ts.tv_nsec / 1000;
+        } else {
+            value = value * INT64_C(1000000000) + ts.tv_nsec;
+        }
+        return ptr->Append(value);
+        }
+    case ctype::FIXED: {
+        auto ptr = static_cast<arrow::FixedSizeBinaryBuilder *>(builder);
+        if (size != col.size) {
+            return ptr->AppendNull();
+        }
+        return ptr->Append(data);
+        }
+    case ctype::STRING:
+        return static_cast<arrow::StringBuilder *>(builder)->Append(
+            reinterpret_cast<const char *>(data), size);
+    case ctype::STRING_DICT:
+        return static_cast<arrow::StringDictionary32Builder *>(builder)->Append(
+            reinterpret_cast<const char *>(data), size);
+    case ctype::BINARY:
+        return static_cast<arrow::BinaryBuilder *>(builder)->Append(data, size);
+    }
+
+    return arrow::Status::NotImplemented("Unknown column type");
+}
+
+void
+Table::append(const struct fds_drec &rec)
+{
+    struct fds_drec_iter it;
+    size_t idx = 0;
+
+    fds_drec_iter_init(&it, const_cast<struct fds_drec *>(&rec), FDS_DREC_PADDING_SHOW);
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        if (is_padding(it.field.info)) {
+            continue;
+        }
+
+        assert(idx < m_columns.size() && "Template doesn't match the table!");
+        arrow::Status status = column_append(m_columns[idx++], it.field.data, it.field.size);
+        if (!status.ok()) {
+            throw Arrow_exception("Failed to append a record: " + status.ToString());
+        }
+    }
+
+    m_rows++;
+}
+
+std::shared_ptr<arrow::RecordBatch>
+Table::flush()
+{
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    arrays.reserve(m_columns.size());
+
+    for (column &col : m_columns) {
+        std::shared_ptr<arrow::Array> array;
+        arrow::Status status = col.builder->Finish(&array);
+        if (!status.ok()) {
+            throw Arrow_exception("Failed to finish a column buffer: " + status.ToString());
+        }
+        if (array->length() != m_rows) {
+            // Probably a previous failure during appending a record
+            throw Arrow_exception("Column buffers are inconsistent!");
+        }
+        arrays.push_back(std::move(array));
+    }
+
+    auto batch = arrow::RecordBatch::Make(m_schema, m_rows, std::move(arrays));
+    m_rows = 0;
+    return batch;
+}
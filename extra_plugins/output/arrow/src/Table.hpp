@@ -0,0 +1,132 @@
+/**
+ * \file extra_plugins/output/arrow/src/Table.hpp
+ * \brief Columnar buffer of Data Records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_ARROW_TABLE_HPP
+#define IPFIXCOL2_ARROW_TABLE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include <libfds.h>
+
+#include "Exception.hpp"
+
+/**
+ * @brief Columnar buffer of Data Records with the same schema
+ *
+ * The schema is derived from an IPFIX (Options) Template i.e. each Template field (except
+ * padding) is mapped to a column of the corresponding Arrow data type. Different Templates
+ * (e.g. from different exporters) that consist of the same Information Elements in the same
+ * order share the same schema and, therefore, can be stored into the same table.
+ */
+class Table {
+public:
+    /**
+     * @brief Create a table for records based on a Template
+     * @param[in] tmplt      IPFIX (Options) Template
+     * @param[in] dictionary Use dictionary encoding of string fields
+     * @throw Arrow_exception if the table cannot be created
+     */
+    Table(const struct fds_template *tmplt, bool dictionary);
+    ~Table() = default;
+
+    // Disable copy constructors
+    Table(const Table &other) = delete;
+    Table &operator=(const Table &other) = delete;
+
+    /**
+     * @brief Get a signature of the schema that corresponds to a Template
+     *
+     * Templates with the same signature are mapped to the same schema. The signature consists
+     * of Information Element identifiers and data types of all non-padding fields.
+     * @param[in] tmplt IPFIX (Options) Template
+     * @return Binary signature
+     */
+    static std::string
+    signature(const struct fds_template *tmplt);
+
+    /**
+     * @brief Get the schema of the table
+     */
+    const std::shared_ptr<arrow::Schema> &
+    schema() const {return m_schema;};
+
+    /**
+     * @brief Get the number of buffered records
+     */
+    int64_t
+    rows() const {return m_rows;};
+
+    /**
+     * @brief Append a Data Record to column buffers
+     *
+     * Fields that cannot be converted (e.g. invalid size) are stored as null values.
+     * @warning Template of the record MUST have the same signature as the table!
+     * @param[in] rec Data Record to append
+     * @throw Arrow_exception if the record cannot be appended
+     */
+    void
+    append(const struct fds_drec &rec);
+
+    /**
+     * @brief Move buffered records to a record batch
+     *
+     * Column buffers are empty after the call.
+     * @return Record batch
+     * @throw Arrow_exception if the batch cannot be created
+     */
+    std::shared_ptr<arrow::RecordBatch>
+    flush();
+
+private:
+    /// Internal type of a column (determines conversion function)
+    enum class ctype {
+        UINT8, UINT16, UINT32, UINT64,
+        INT8, INT16, INT32, INT64,
+        FLOAT32, FLOAT64,
+        BOOL,
+        TS_MILLI, TS_MICRO, TS_NANO,
+        FIXED,
+        STRING,
+        STRING_DICT,
+        BINARY
+    };
+
+    /// Description of a column
+    struct column {
+        /// Conversion type
+        ctype type;
+        /// Data type of the Information Element
+        enum fds_iemgr_element_type ie_type;
+        /// Expected field size (only for fixed size binary types)
+        uint16_t size;
+        /// Column buffer
+        std::unique_ptr<arrow::ArrayBuilder> builder;
+    };
+
+    /// Schema of the table
+    std::shared_ptr<arrow::Schema> m_schema;
+    /// Columns
+    std::vector<column> m_columns;
+    /// Number of buffered records
+    int64_t m_rows = 0;
+
+    static bool
+    is_padding(const struct fds_tfield *field);
+    static enum fds_iemgr_element_type
+    field_type(const struct fds_tfield *field);
+    void
+    column_add(const struct fds_tfield *field, bool dictionary, std::vector<std::shared_ptr<arrow::Field>> &fields);
+    static arrow::Status
+    column_append(column &col, const uint8_t *data, uint16_t size);
+};
+
+#endif // IPFIXCOL2_ARROW_TABLE_HPP
@@ -0,0 +1,199 @@
+/**
+ * \file extra_plugins/output/arrow/src/Writer.cpp
+ * \brief Writers of Arrow IPC and Parquet files (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+
+#include "Writer.hpp"
+
+/**
+ * @brief Throw an exception if a status represents a failure
+ * @param[in] status Status of an Arrow operation
+ * @param[in] what   Description of the operation
+ */
+static void
+status_check(const arrow::Status &status, const std::string &what)
+{
+    if (!status.ok()) {
+        throw Arrow_exception(what + ": " + status.ToString());
+    }
+}
+
+/**
+ * @brief Open an output file
+ * @param[in] path Path of the file
+ * @return Output stream
+ */
+static std::shared_ptr<arrow::io::FileOutputStream>
+file_open(const std::string &path)
+{
+    auto file = arrow::io::FileOutputStream::Open(path);
+    status_check(file.status(), "Failed to create file '" + path + "'");
+    return file.ValueUnsafe();
+}
+
+/// Writer of Arrow IPC files (streaming format)
+class IPC_writer : public Writer {
+private:
+    /// Output file
+    std::shared_ptr<arrow::io::FileOutputStream> m_file;
+    /// IPC writer
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> m_writer;
+
+public:
+    /**
+     * @brief Create a new writer
+     *
+     * The streaming format is used because dictionaries of string columns are different
+     * in each record batch (i.e. dictionary replacement is required).
+     * @param[in] cfg    Plugin configuration
+     * @param[in] path   Path of the new file
+     * @param[in] schema Schema of records
+     */
+    IPC_writer(const Config &cfg, const std::string &path,
+        const std::shared_ptr<arrow::Schema> &schema)
+    {
+        arrow::ipc::IpcWriteOptions opts = arrow::ipc::IpcWriteOptions::Defaults();
+        if (cfg.m_calg != Config::calg::NONE) {
+            arrow::Compression::type type = (cfg.m_calg == Config::calg::LZ4)
+                ? arrow::Compression::LZ4_FRAME : arrow::Compression::ZSTD;
+            auto codec = arrow::util::Codec::Create(type);
+            status_check(codec.status(), "Failed to create a compression codec");
+            opts.codec = std::move(codec).ValueUnsafe();
+        }
+
+        m_file = file_open(path);
+        auto writer = arrow::ipc::MakeStreamWriter(m_file, schema, opts);
+        status_check(writer.status(), "Failed to create an IPC writer of '" + path + "'");
+        m_writer = writer.ValueUnsafe();
+    }
+
+    ~IPC_writer()
+    {
+        if (!m_writer) {
+            return;
+        }
+
+        // Exceptions cannot be thrown here
+        (void) m_writer->Close();
+        (void) m_file->Close();
+    }
+
+    void
+    write(const std::shared_ptr<arrow::RecordBatch> &batch) override
+    {
+        status_check(m_writer->WriteRecordBatch(*batch), "Failed to write a record batch");
+    }
+
+    void
+    close() override
+    {
+        status_check(m_writer->Close(), "Failed to finalize an IPC file");
+        m_writer.reset();
+        status_check(m_file->Close(), "Failed to close an IPC file");
+    }
+};
+
+/// Writer of Parquet files
+class Parquet_writer : public Writer {
+private:
+    /// Output file
+    std::shared_ptr<arrow::io::FileOutputStream> m_file;
+    /// Parquet writer
+    std::unique_ptr<parquet::arrow::FileWriter> m_writer;
+
+public:
+    /**
+     * @brief Create a new writer
+     *
+     * Each record batch is stored as a separate row group. Dictionary encoding of Parquet
+     * is enabled for all columns.
+     * @param[in] cfg    Plugin configuration
+     * @param[in] path   Path of the new file
+     * @param[in] schema Schema of records
+     */
+    Parquet_writer(const Config &cfg, const std::string &path,
+        const std::shared_ptr<arrow::Schema> &schema)
+    {
+        arrow::Compression::type type;
+        switch (cfg.m_calg) {
+        case Config::calg::LZ4:
+            type = arrow::Compression::LZ4;
+            break;
+        case Config::calg::ZSTD:
+            type = arrow::Compression::ZSTD;
+            break;
+        case Config::calg::SNAPPY:
+            type = arrow::Compression::SNAPPY;
+            break;
+        default:
+            type = arrow::Compression::UNCOMPRESSED;
+            break;
+        }
+
+        parquet::WriterProperties::Builder props_builder;
+        props_builder.compression(type);
+        props_builder.enable_dictionary();
+        props_builder.max_row_group_length(cfg.m_batch_size);
+        std::shared_ptr<parquet::WriterProperties> props = props_builder.build();
+
+        // Store the Arrow schema (i.e. types and metadata) for readers
+        parquet::ArrowWriterProperties::Builder arrow_builder;
+        arrow_builder.store_schema();
+        std::shared_ptr<parquet::ArrowWriterProperties> arrow_props = arrow_builder.build();
+
+        m_file = file_open(path);
+        auto writer = parquet::arrow::FileWriter::Open(*schema, arrow::default_memory_pool(),
+            m_file, props, arrow_props);
+        status_check(writer.status(), "Failed to create a Parquet writer of '" + path + "'");
+        m_writer = std::move(writer).ValueUnsafe();
+    }
+
+    ~Parquet_writer()
+    {
+        if (!m_writer) {
+            return;
+        }
+
+        // Exceptions cannot be thrown here
+        (void) m_writer->Close();
+        (void) m_file->Close();
+    }
+
+    void
+    write(const std::shared_ptr<arrow::RecordBatch> &batch) override
+    {
+        status_check(m_writer->WriteRecordBatch(*batch), "Failed to write a record batch");
+    }
+
+    void
+    close() override
+    {
+        status_check(m_writer->Close(), "Failed to finalize a Parquet file");
+        m_writer.reset();
+        status_check(m_file->Close(), "Failed to close a Parquet file");
+    }
+};
+
+std::unique_ptr<Writer>
+Writer::create(const Config &cfg, const std::string &path,
+    const std::shared_ptr<arrow::Schema> &schema)
+{
+    switch (cfg.m_format) {
+    case Config::format::ARROW:
+        return std::unique_ptr<Writer>(new IPC_writer(cfg, path + ".arrows", schema));
+    case Config::format::PARQUET:
+        return std::unique_ptr<Writer>(new Parquet_writer(cfg, path + ".parquet", schema));
+    }
+
+    throw Arrow_exception("Unsupported file format!");
+}
@@ -0,0 +1,55 @@
+/**
+ * \file extra_plugins/output/arrow/src/Writer.hpp
+ * \brief Writers of Arrow IPC and Parquet files (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_ARROW_WRITER_HPP
+#define IPFIXCOL2_ARROW_WRITER_HPP
+
+#include <memory>
+#include <string>
+#include <arrow/api.h>
+
+#include "Config.hpp"
+#include "Exception.hpp"
+
+/// Base class of a file writer
+class Writer {
+public:
+    virtual ~Writer() = default;
+
+    /**
+     * @brief Write a record batch to the file
+     * @param[in] batch Record batch (MUST match the schema of the file)
+     * @throw Arrow_exception on failure
+     */
+    virtual void
+    write(const std::shared_ptr<arrow::RecordBatch> &batch) = 0;
+
+    /**
+     * @brief Finalize and close the file
+     * @note No more record batches can be written after the call.
+     * @throw Arrow_exception on failure
+     */
+    virtual void
+    close() = 0;
+
+    /**
+     * @brief Create a new file writer
+     *
+     * Type of the writer and compression depends on the configuration.
+     * @param[in] cfg    Plugin configuration
+     * @param[in] path   Path of the new file (without extension)
+     * @param[in] schema Schema of records
+     * @return New writer
+     * @throw Arrow_exception if the file cannot be created
+     */
+    static std::unique_ptr<Writer>
+    create(const Config &cfg, const std::string &path, const std::shared_ptr<arrow::Schema> &schema);
+};
+
+#endif // IPFIXCOL2_ARROW_WRITER_HPP
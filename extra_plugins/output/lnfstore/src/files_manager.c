@@ -719,6 +719,33 @@ files_mgr_add_record(files_mgr_t *mgr, lnf_rec_t *rec_ptr)
     return status;
 }
 
+int
+files_mgr_add_records(files_mgr_t *mgr, lnf_rec_t * const *recs, size_t cnt)
+{
+    int status = 0;
+
+    // LNF file
+    if (mgr->mode & FILES_M_LNF) {
+        lnf_file_t *file_ptr = mgr->outputs.file_lnf;
+        if (!file_ptr) {
+            status = 1;
+        } else {
+            for (size_t i = 0; i < cnt; ++i) {
+                status |= (lnf_write(file_ptr, recs[i]) != LNF_OK) ? 1 : 0;
+            }
+        }
+    }
+
+    // Index file
+    if (mgr->mode & FILES_M_INDEX) {
+        for (size_t i = 0; i < cnt; ++i) {
+            status |= files_mgr_add2idx(mgr, recs[i]);
+        }
+    }
+
+    return status;
+}
+
 const char *
 files_mgr_get_storage_dir(files_mgr_t *mgr)
 {
@@ -178,6 +178,20 @@ files_mgr_invalidate(files_mgr_t *mgr);
 int
 files_mgr_add_record(files_mgr_t *mgr, lnf_rec_t *rec_ptr);
 
+/**
+ * \brief Add a batch of records to output files
+ *
+ * All records are written to the LNF file first and then IP addresses of all records are
+ * added to the Bloom filter index.
+ * \param[in,out] mgr  File manager
+ * \param[in]     recs Array of pointers to the records
+ * \param[in]     cnt  Number of records
+ * \return On success returns 0. Otherwise (failed to write to any of output
+ *   files) returns a non-zero value.
+ */
+int
+files_mgr_add_records(files_mgr_t *mgr, lnf_rec_t * const *recs, size_t cnt);
+
 /**
  * \brief Get the storage directory of the manager
  * \return The directory
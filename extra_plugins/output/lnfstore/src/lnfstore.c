@@ -80,19 +80,9 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
 
     conf->params = parsed_params;
 
-    // Init a LNF record for conversion from IPFIX
-    if (lnf_rec_init(&conf->record.rec_ptr) != LNF_OK) {
-        IPX_CTX_ERROR(ctx, "Failed to initialize an internal structure for conversion of records",
-            '\0');
-        configuration_free(parsed_params);
-        free(conf);
-        return IPX_ERR_DENIED;
-    }
-
     conf->record.translator = translator_init(ctx);
     if (!conf->record.translator) {
         IPX_CTX_ERROR(ctx, "Failed to initialize a record translator.", '\0');
-        lnf_rec_free(conf->record.rec_ptr);
         configuration_free(parsed_params);
         free(conf);
         return IPX_ERR_DENIED;
@@ -108,9 +98,9 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
     if (!conf->storage.basic/* && !conf->storage.profiles*/) {
         IPX_CTX_ERROR(ctx, "Failed to initialize an internal structure for file storage(s).", '\0');
         translator_destroy(conf->record.translator);
-        lnf_rec_free(conf->record.rec_ptr);
         configuration_free(parsed_params);
         free(conf);
+        return IPX_ERR_DENIED;
     }
 
     // Save the configuration
@@ -142,6 +132,9 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         stg_basic_new_window(conf->storage.basic, new_time);
     }
 
+    // Records are translated directly into batches of the storage (stored by its writer thread)
+    stg_basic_t *storage = conf->storage.basic;
+    translator_msg_start(conf->record.translator);
     ipx_msg_ipfix_t *ipfix = ipx_msg_base2ipfix(msg);
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix);
     for (uint32_t i = 0; i < rec_cnt; i++) {
@@ -151,13 +144,13 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
         // Fill record
         uint16_t flags = biflow ? FDS_DREC_BIFLOW_FWD : 0; // In case of biflow, forward fields only
-        lnf_rec_t *lnf_rec = conf->record.rec_ptr;
+        lnf_rec_t *lnf_rec = stg_basic_rec_next(storage);
         if (translator_translate(conf->record.translator, &ipfix_rec->rec, lnf_rec, flags) <= 0) {
             // Nothing to store
             continue;
         }
 
-        stg_basic_store(conf->storage.basic, lnf_rec);
+        stg_basic_rec_commit(storage);
 
         // Is it biflow? Store the reverse direction
         if (!biflow) {
@@ -165,14 +158,16 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
 
         flags = FDS_DREC_BIFLOW_REV;
+        lnf_rec = stg_basic_rec_next(storage);
         if (translator_translate(conf->record.translator, &ipfix_rec->rec, lnf_rec, flags) <= 0) {
             // Nothing to store
             continue;
         }
 
-        stg_basic_store(conf->storage.basic, lnf_rec);
+        stg_basic_rec_commit(storage);
     }
 
+    stg_basic_flush(storage);
     return 0;
 }
 
@@ -190,9 +185,8 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
         stg_basic_destroy(conf->storage.basic);
     //}
 
-    // Destroy a translator and a record
+    // Destroy a translator
     translator_destroy(conf->record.translator);
-    lnf_rec_free(conf->record.rec_ptr);
 
     // Destroy parsed XML configuration
     configuration_free(conf->params);
@@ -68,9 +68,8 @@ struct conf_lnfstore {
     } storage; /**< Only one type of storage is initialized at the same time */
 
     struct {
-        lnf_rec_t *rec_ptr;       /**< LNF record (converted IPFIX record)   */
         translator_t *translator; /**< IPFIX to LNF translator               */
-    } record; /**< Record conversion */
+    } record; /**< Record conversion (records are provided by the storage)   */
 };
 
 
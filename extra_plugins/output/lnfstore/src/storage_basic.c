@@ -37,21 +37,76 @@
  *
  */
 
+#include <pthread.h>
+#include <string.h>
+
 #include "lnfstore.h"
 
 #include "storage_basic.h"
 #include "storage_common.h"
 #include "configuration.h"
 
+/** Number of LNF records in a batch                                         */
+#define STG_BATCH_SIZE (512U)
+/** Number of batches (i.e. maximum number of batches waiting for the writer) */
+#define STG_BATCH_CNT  (8U)
+
+/** \brief Command executed by the writer after records of a batch are stored */
+enum stg_batch_cmd {
+    STG_CMD_NONE,   /**< No command                                          */
+    STG_CMD_WINDOW, /**< Create a new time window                            */
+    STG_CMD_STOP    /**< Stop the writer thread                              */
+};
+
+/** \brief Batch of LNF records                                               */
+struct stg_batch {
+    lnf_rec_t *recs[STG_BATCH_SIZE]; /**< Preallocated LNF records           */
+    size_t cnt;                      /**< Number of filled records           */
+    enum stg_batch_cmd cmd;          /**< Command after the records          */
+    time_t window;                   /**< Timestamp of a new window          */
+};
+
 /** \brief Basic storage structure */
 struct stg_basic_s {
     /** Instance context (only for logs!)   */
     ipx_ctx_t *ctx;
     /** Pointer to the plugin configuration */
     const struct conf_params *params;
-    files_mgr_t *mgr; /**< Output files     */
+    files_mgr_t *mgr; /**< Output files (accessed only by the writer thread) */
+
+    /** Ring of batches                                                      */
+    struct stg_batch batches[STG_BATCH_CNT];
+    /** Index of the batch being filled (owned by the processing thread)     */
+    size_t batch_fill;
+    /** Index of the oldest batch waiting for the writer                     */
+    size_t batch_head;
+    /** Number of batches waiting for the writer                             */
+    size_t batch_pending;
+
+    pthread_mutex_t mutex;   /**< Mutex protecting the ring                  */
+    pthread_cond_t  cond_batch; /**< A batch has been passed to the writer   */
+    pthread_cond_t  cond_space; /**< A batch has been returned by the writer */
+    pthread_t       thread;  /**< Writer thread                              */
 };
 
+static void *
+stg_basic_writer(void *arg);
+
+/**
+ * \brief Free LNF records of all batches
+ * \param[in] storage Storage
+ */
+static void
+stg_basic_batches_free(stg_basic_t *storage)
+{
+    for (size_t i = 0; i < STG_BATCH_CNT; ++i) {
+        for (size_t j = 0; j < STG_BATCH_SIZE; ++j) {
+            if (storage->batches[i].recs[j] != NULL) {
+                lnf_rec_free(storage->batches[i].recs[j]);
+            }
+        }
+    }
+}
 
 stg_basic_t *
 stg_basic_create(ipx_ctx_t *ctx, const struct conf_params *params)
@@ -63,11 +118,28 @@ stg_basic_create(ipx_ctx_t *ctx, const struct conf_params *params)
         return NULL;
     }
 
+    // Prepare LNF records of all batches
+    for (size_t i = 0; i < STG_BATCH_CNT; ++i) {
+        for (size_t j = 0; j < STG_BATCH_SIZE; ++j) {
+            if (lnf_rec_init(&instance->batches[i].recs[j]) == LNF_OK) {
+                continue;
+            }
+
+            IPX_CTX_ERROR(ctx, "Failed to initialize an internal structure for conversion of "
+                "records", '\0');
+            instance->batches[i].recs[j] = NULL;
+            stg_basic_batches_free(instance);
+            free(instance);
+            return NULL;
+        }
+    }
+
     // Create an output file manager
     files_mgr_t * mgr;
     mgr = stg_common_files_mgr_create(ctx, params, params->files.path);
     if (!mgr) {
         IPX_CTX_ERROR(ctx, "Failed to create output manager.", '\0');
+        stg_basic_batches_free(instance);
         free(instance);
         return NULL;
     }
@@ -75,24 +147,123 @@ stg_basic_create(ipx_ctx_t *ctx, const struct conf_params *params)
     instance->params = params;
     instance->mgr = mgr;
     instance->ctx = ctx;
+
+    // Start the writer
+    pthread_mutex_init(&instance->mutex, NULL);
+    pthread_cond_init(&instance->cond_batch, NULL);
+    pthread_cond_init(&instance->cond_space, NULL);
+
+    int rc = pthread_create(&instance->thread, NULL, &stg_basic_writer, instance);
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to start a writer thread: %s", err_str);
+        pthread_cond_destroy(&instance->cond_space);
+        pthread_cond_destroy(&instance->cond_batch);
+        pthread_mutex_destroy(&instance->mutex);
+        files_mgr_destroy(mgr);
+        stg_basic_batches_free(instance);
+        free(instance);
+        return NULL;
+    }
+
     return instance;
 }
 
+/**
+ * \brief Pass the batch being filled (and its command) to the writer
+ *
+ * If all batches are waiting for the writer, the function waits until the oldest one is
+ * processed, so the next batch can be filled.
+ * \param[in,out] storage Storage
+ * \param[in]     cmd     Command to execute after records of the batch are stored
+ * \param[in]     window  Timestamp of a new window (only for ::STG_CMD_WINDOW)
+ */
+static void
+stg_basic_publish(stg_basic_t *storage, enum stg_batch_cmd cmd, time_t window)
+{
+    struct stg_batch *batch = &storage->batches[storage->batch_fill];
+    batch->cmd = cmd;
+    batch->window = window;
+
+    pthread_mutex_lock(&storage->mutex);
+    storage->batch_pending++;
+    pthread_cond_signal(&storage->cond_batch);
+    while (storage->batch_pending == STG_BATCH_CNT) {
+        pthread_cond_wait(&storage->cond_space, &storage->mutex);
+    }
+    pthread_mutex_unlock(&storage->mutex);
+
+    // Prepare the next batch
+    storage->batch_fill = (storage->batch_fill + 1) % STG_BATCH_CNT;
+    storage->batches[storage->batch_fill].cnt = 0;
+    storage->batches[storage->batch_fill].cmd = STG_CMD_NONE;
+}
+
 void
 stg_basic_destroy(stg_basic_t *storage)
 {
+    // Store remaining records and stop the writer
+    stg_basic_publish(storage, STG_CMD_STOP, 0);
+    pthread_join(storage->thread, NULL);
+
+    pthread_cond_destroy(&storage->cond_space);
+    pthread_cond_destroy(&storage->cond_batch);
+    pthread_mutex_destroy(&storage->mutex);
+
     files_mgr_destroy(storage->mgr);
+    stg_basic_batches_free(storage);
     free(storage);
 }
 
-int
-stg_basic_store(stg_basic_t *storage, lnf_rec_t *rec)
+lnf_rec_t *
+stg_basic_rec_next(stg_basic_t *storage)
+{
+    struct stg_batch *batch = &storage->batches[storage->batch_fill];
+    return batch->recs[batch->cnt];
+}
+
+void
+stg_basic_rec_commit(stg_basic_t *storage)
+{
+    struct stg_batch *batch = &storage->batches[storage->batch_fill];
+    if (++batch->cnt == STG_BATCH_SIZE) {
+        stg_basic_publish(storage, STG_CMD_NONE, 0);
+    }
+}
+
+void
+stg_basic_flush(stg_basic_t *storage)
 {
-    return files_mgr_add_record(storage->mgr, rec);
+    if (storage->batches[storage->batch_fill].cnt == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&storage->mutex);
+    bool writer_idle = (storage->batch_pending == 0);
+    pthread_mutex_unlock(&storage->mutex);
+
+    if (writer_idle) {
+        // Otherwise the batch can grow until the writer is ready
+        stg_basic_publish(storage, STG_CMD_NONE, 0);
+    }
 }
 
 int
 stg_basic_new_window(stg_basic_t *storage, time_t window)
+{
+    stg_basic_publish(storage, STG_CMD_WINDOW, window);
+    return 0;
+}
+
+/**
+ * \brief Create a new time window (called by the writer thread)
+ * \param[in,out] storage Storage
+ * \param[in]     window  Identification time of new window (UTC)
+ * \return On success returns 0. Otherwise returns a non-zero value.
+ */
+static int
+stg_basic_window_create(stg_basic_t *storage, time_t window)
 {
     // Check if the output directory already exists
     const char *dir_path = storage->params->files.path;
@@ -114,5 +285,51 @@ stg_basic_new_window(stg_basic_t *storage, time_t window)
     }
 }
 
+/**
+ * \brief Writer thread
+ *
+ * Store records of batches passed by the processing thread to the output files and execute
+ * commands of the batches (i.e. window change).
+ * \param[in] arg Storage
+ * \return NULL
+ */
+static void *
+stg_basic_writer(void *arg)
+{
+    stg_basic_t *storage = (stg_basic_t *) arg;
+    bool stop = false;
+
+    pthread_mutex_lock(&storage->mutex);
+    while (!stop) {
+        while (storage->batch_pending == 0) {
+            pthread_cond_wait(&storage->cond_batch, &storage->mutex);
+        }
+
+        struct stg_batch *batch = &storage->batches[storage->batch_head];
+        pthread_mutex_unlock(&storage->mutex);
+
+        if (batch->cnt > 0) {
+            files_mgr_add_records(storage->mgr, batch->recs, batch->cnt);
+        }
 
+        switch (batch->cmd) {
+        case STG_CMD_NONE:
+            break;
+        case STG_CMD_WINDOW:
+            stg_basic_window_create(storage, batch->window);
+            break;
+        case STG_CMD_STOP:
+            stop = true;
+            break;
+        }
 
+        // Return the batch
+        pthread_mutex_lock(&storage->mutex);
+        storage->batch_head = (storage->batch_head + 1) % STG_BATCH_CNT;
+        storage->batch_pending--;
+        pthread_cond_signal(&storage->cond_space);
+    }
+    pthread_mutex_unlock(&storage->mutex);
+
+    return NULL;
+}
@@ -61,29 +61,53 @@ stg_basic_create(ipx_ctx_t *ctx, const struct conf_params *params);
 /**
  * \brief Delete a basic storage
  *
- * Close output file(s) and delete the storage
+ * Store all remaining records, close output file(s) and delete the storage
  * \param[in,out] storage Storage
  */
 void
 stg_basic_destroy(stg_basic_t *storage);
 
 /**
- * \brief Store a LNF record to a storage
+ * \brief Get the next free LNF record of the storage
+ *
+ * The record can be filled (e.g. by a translator) and stored using stg_basic_rec_commit().
+ * If the record is not committed, the same record is returned by the next call.
  * \param[in,out] storage Storage
- * \param[in]     rec     LNF record
- * \return On success returns 0. Otherwise (failed to write to any of output
- *   files) returns a non-zero value.
+ * \return Pointer to the record
  */
-int
-stg_basic_store(stg_basic_t *storage, lnf_rec_t *rec);
+lnf_rec_t *
+stg_basic_rec_next(stg_basic_t *storage);
+
+/**
+ * \brief Store the record previously returned by stg_basic_rec_next()
+ *
+ * Records are stored in batches by a writer thread. If the current batch is full, it is passed
+ * to the writer. If all batches are waiting for the writer, the function blocks until
+ * the oldest one is processed.
+ * \param[in,out] storage Storage
+ */
+void
+stg_basic_rec_commit(stg_basic_t *storage);
+
+/**
+ * \brief Pass a partially filled batch to the writer if the writer is idle
+ *
+ * Should be called after processing of each IPFIX Message, so records do not wait for
+ * filling of the whole batch if the writer has nothing to do.
+ * \param[in,out] storage Storage
+ */
+void
+stg_basic_flush(stg_basic_t *storage);
 
 /**
  * \brief Create a new time window
  *
- * Current output file(s) will be closed and new ones will be opened
+ * Current output file(s) will be closed and new ones will be opened. The operation is performed
+ * asynchronously by the writer thread after all previously committed records are stored,
+ * therefore, errors are only reported to the log.
  * \param[in,out] storage Storage
  * \param[in]     window  Identification time of new window (UTC)
- * \return On success returns 0. Otherwise returns a non-zero value.
+ * \return Always returns 0.
  */
 int
 stg_basic_new_window(stg_basic_t *storage, time_t window);
@@ -408,6 +408,31 @@ translate_time(const struct fds_drec_field *field,
 #define TRANSLATOR_TABLE_SIZE \
     (sizeof(translator_table_global) / sizeof(translator_table_global[0]))
 
+/**
+ * \brief Selection of convertible fields (for one direction of biflow records)
+ */
+struct translator_sel {
+    /** Translator (only for the bsearch in the mapping function)             */
+    const struct translator_s *trans;
+    /** Iterator flags of the selection                                       */
+    uint16_t flags;
+    /** Field selector (private data of fields are conversion definitions)    */
+    ipx_fsel_t *fsel;
+
+    /** Template of the last processed record (reset for each IPFIX Message)  */
+    const struct fds_template *last_tmplt;
+    /** Selected fields of the last template                                  */
+    const struct ipx_fsel_result *last_res;
+};
+
+/** Selections (uniflow, forward and reverse direction of biflow records)     */
+enum translator_dir {
+    TRANSLATOR_DIR_UNI = 0,
+    TRANSLATOR_DIR_FWD,
+    TRANSLATOR_DIR_REV,
+    TRANSLATOR_DIR_CNT
+};
+
 struct translator_s {
     /** Instance context (only for log!) */
     ipx_ctx_t *ctx;
@@ -415,6 +440,9 @@ struct translator_s {
     struct translator_table_rec table[TRANSLATOR_TABLE_SIZE];
     /** Record conversion buffer         */
     uint8_t rec_buffer[REC_BUFF_SIZE];
+
+    /** Selections of convertible fields (see translator_dir)                 */
+    struct translator_sel sels[TRANSLATOR_DIR_CNT];
 };
 
 /**
@@ -442,6 +470,52 @@ transtator_cmp(const void *p1, const void *p2)
     }
 }
 
+/**
+ * \brief Get definitions of template fields as seen by a record iterator with given flags
+ *
+ * In case of the reverse direction of a biflow record, reverse fields are presented as
+ * forward fields and vice versa (the same as fds_drec_iter does).
+ * \param[in] tmplt Template
+ * \param[in] flags Iterator flags
+ * \return Array of fields
+ */
+static inline const struct fds_tfield *
+translator_fields(const struct fds_template *tmplt, uint16_t flags)
+{
+    if ((flags & FDS_DREC_BIFLOW_REV) != 0 && tmplt->fields_rev != NULL) {
+        return tmplt->fields_rev;
+    }
+
+    return tmplt->fields;
+}
+
+/**
+ * \brief Find a conversion definition of a template field (mapping function of selectors)
+ *
+ * Fields are processed in the same way as fds_drec_iter with the same flags would do,
+ * i.e. reverse fields are skipped in case of biflow records.
+ * \param[in] tmplt Template
+ * \param[in] idx   Index of the field in the template
+ * \param[in] data  Selection (struct translator_sel)
+ * \return Conversion definition or NULL (the field cannot be converted)
+ */
+static const void *
+translator_map(const struct fds_template *tmplt, uint16_t idx, void *data)
+{
+    const struct translator_sel *sel = data;
+    const struct fds_tfield *field = &translator_fields(tmplt, sel->flags)[idx];
+    if (sel->flags != 0 && (field->flags & FDS_TFIELD_REVERSE) != 0) {
+        return NULL;
+    }
+
+    struct translator_table_rec key;
+    key.ipfix.ie = field->id;
+    key.ipfix.pen = field->en;
+    // Conversion definition might not exist (padding included)
+    return bsearch(&key, sel->trans->table, TRANSLATOR_TABLE_SIZE, sizeof(sel->trans->table[0]),
+        transtator_cmp);
+}
+
 translator_t *
 translator_init(ipx_ctx_t *ctx)
 {
@@ -484,6 +558,20 @@ translator_init(ipx_ctx_t *ctx)
         return NULL;
     }
 
+    // Prepare selectors of convertible fields
+    const uint16_t sel_flags[TRANSLATOR_DIR_CNT] = {0, FDS_DREC_BIFLOW_FWD, FDS_DREC_BIFLOW_REV};
+    for (size_t i = 0; i < TRANSLATOR_DIR_CNT; ++i) {
+        struct translator_sel *sel = &instance->sels[i];
+        sel->trans = instance;
+        sel->flags = sel_flags[i];
+        sel->fsel = ipx_fsel_create_map(&translator_map, sel);
+        if (!sel->fsel) {
+            IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            translator_destroy(instance);
+            return NULL;
+        }
+    }
+
     instance->ctx = ctx;
     return instance;
 }
@@ -491,41 +579,59 @@ translator_init(ipx_ctx_t *ctx)
 void
 translator_destroy(translator_t *trans)
 {
+    for (size_t i = 0; i < TRANSLATOR_DIR_CNT; ++i) {
+        ipx_fsel_destroy(trans->sels[i].fsel);
+    }
+
     free(trans);
 }
 
+void
+translator_msg_start(translator_t *trans)
+{
+    // Templates can be freed and replaced between IPFIX Messages
+    for (size_t i = 0; i < TRANSLATOR_DIR_CNT; ++i) {
+        trans->sels[i].last_tmplt = NULL;
+    }
+}
+
 int
 translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, lnf_rec_t *lnf_rec,
     uint16_t flags)
 {
     lnf_rec_clear(lnf_rec);
 
-    // Initialize a record iterator
-    struct fds_drec_iter it;
-    fds_drec_iter_init(&it, ipfix_rec, flags);
-
-    // Try to convert all IPFIX fields
-    struct translator_table_rec key;
-    struct translator_table_rec *def;
-    int converted_fields = 0;
+    enum translator_dir dir = TRANSLATOR_DIR_UNI;
+    if ((flags & FDS_DREC_BIFLOW_REV) != 0) {
+        dir = TRANSLATOR_DIR_REV;
+    } else if ((flags & FDS_DREC_BIFLOW_FWD) != 0) {
+        dir = TRANSLATOR_DIR_FWD;
+    }
 
-    const size_t table_rec_cnt = TRANSLATOR_TABLE_SIZE;
-    const size_t table_rec_size = sizeof(trans->table[0]);
-    uint8_t * const buffer_ptr = trans->rec_buffer;
+    const struct fds_template *tmplt = ipfix_rec->tmplt;
+    struct translator_sel *sel = &trans->sels[dir];
+    if (sel->last_tmplt != tmplt) {
+        sel->last_res = ipx_fsel_get(sel->fsel, tmplt);
+        sel->last_tmplt = (sel->last_res != NULL) ? tmplt : NULL;
+    }
 
-    while (fds_drec_iter_next(&it) != FDS_EOC) {
-        // Find a conversion function
-        const struct fds_tfield *info = it.field.info;
+    if (!sel->last_res) {
+        IPX_CTX_ERROR(trans->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return 0;
+    }
 
-        key.ipfix.ie = info->id;
-        key.ipfix.pen = info->en;
+    const struct fds_tfield *fields = translator_fields(tmplt, sel->flags);
+    uint8_t * const buffer_ptr = trans->rec_buffer;
+    int converted_fields = 0;
 
-        def = bsearch(&key, trans->table, table_rec_cnt, table_rec_size, transtator_cmp);
-        if (!def) {
-            // Conversion definition not found
-            continue;
-        }
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, sel->last_res, ipfix_rec);
+    while (ipx_fsel_iter_next(&it) == IPX_OK) {
+        // Present the field as fds_drec_iter would do (i.e. reverse fields as forward ones)
+        const struct fds_tfield *info = &fields[it.field.info - tmplt->fields];
+        it.field.info = info;
 
+        const struct translator_table_rec *def = it.priv;
         if (def->func(&it.field, def, buffer_ptr) != 0) {
             // Conversion function failed
             IPX_CTX_WARNING(trans->ctx, "Failed to converter a IPFIX IE field  (ID: %" PRIu16 ", "
@@ -542,6 +648,5 @@ translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, lnf_rec_t
         converted_fields++;
     }
 
-    // Cleanup
     return converted_fields;
 }
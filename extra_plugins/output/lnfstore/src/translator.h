@@ -59,13 +59,29 @@ translator_init(ipx_ctx_t *ctx);
 void
 translator_destroy(translator_t *trans);
 
+/**
+ * \brief Start processing of a new IPFIX Message
+ *
+ * The translator caches fields of each template that can be converted (see field selector).
+ * Templates can be freed and replaced between IPFIX Messages, therefore, the function MUST be
+ * called before translation of records of each IPFIX Message, so the template of the last
+ * translated record is forgotten.
+ * \param[in] trans Translator instance
+ */
+void
+translator_msg_start(translator_t *trans);
+
 /**
  * \brief Convert a IPFIX record to a LNF record
+ *
+ * Only fields of the record that can be converted (based on the cached selection of fields of
+ * its template) are processed.
  * \warning LNF record is always automatically cleared before conversion start.
  * \param[in]     trans     Translator instance
  * \param[in]     ipfix_rec IPFIX record (read only!)
  * \param[in,out] lnf_rec   Filled LNF record
- * \param[in]     flags     Flags for iterator over the IPFIX record
+ * \param[in]     flags     Flags for iterator over the IPFIX record (only 0,
+ *   #FDS_DREC_BIFLOW_FWD or #FDS_DREC_BIFLOW_REV)
  * \return Number of converted fields
  */
 int
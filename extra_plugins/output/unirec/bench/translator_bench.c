@@ -0,0 +1,264 @@
+/**
+ * \file translator_bench.c
+ * \brief Microbenchmark of IPFIX to UniRec conversion
+ * \date 2026
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+/*
+ * The benchmark converts synthetic IPFIX records of a common flow template into UniRec records
+ * stored one after another in a batch buffer (the same way as the plugin does) and prints
+ * the number of converted records per second. TRAP interface is not involved.
+ *
+ * Usage: unirec-translator-bench [record count]
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include <ipfixcol2.h>
+#include <unirec/unirec.h>
+#include "../src/translator.h"
+#include "../src/map.h"
+
+/** Number of different IPFIX records               */
+#define BENCH_RECS (1024U)
+/** Number of records in one (simulated) IPFIX Message */
+#define BENCH_MSG_RECS (32U)
+/** Size of the batch buffer                        */
+#define BENCH_BATCH_SIZE (1024U * 1024U)
+/** Default number of converted records             */
+#define BENCH_DEFAULT_CNT (10000000ULL)
+
+/** UniRec template specification                   */
+static const char *bench_ur_spec =
+    "TIME_FIRST,TIME_LAST,SRC_IP,DST_IP,PROTOCOL,?SRC_PORT,?DST_PORT,?TCP_FLAGS,PACKETS,BYTES";
+
+/** Fields of the IPFIX template (ID, size)         */
+static const uint16_t bench_ipx_fields[][2] = {
+    {8, 4},   // sourceIPv4Address
+    {12, 4},  // destinationIPv4Address
+    {7, 2},   // sourceTransportPort
+    {11, 2},  // destinationTransportPort
+    {4, 1},   // protocolIdentifier
+    {6, 1},   // tcpControlBits
+    {1, 8},   // octetDeltaCount
+    {2, 8},   // packetDeltaCount
+    {152, 8}, // flowStartMilliseconds
+    {153, 8}  // flowEndMilliseconds
+};
+
+// Only errors are printed (the collector is not available)
+enum ipx_verb_level
+ipx_ctx_verb_get(const ipx_ctx_t *ctx)
+{
+    (void) ctx;
+    return IPX_VERB_ERROR;
+}
+
+void
+ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *fmt, ...)
+{
+    (void) level;
+    (void) ctx;
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+/**
+ * \brief Create the IPFIX template of records
+ * \param[in] iemgr Manager of Information Elements
+ * \return Template or NULL
+ */
+static struct fds_template *
+bench_template(const fds_iemgr_t *iemgr)
+{
+    const size_t fields_cnt = sizeof(bench_ipx_fields) / sizeof(bench_ipx_fields[0]);
+    uint16_t raw[2 + 2 * (sizeof(bench_ipx_fields) / sizeof(bench_ipx_fields[0]))];
+    raw[0] = htons(256);
+    raw[1] = htons((uint16_t) fields_cnt);
+    for (size_t i = 0; i < fields_cnt; ++i) {
+        raw[2 + 2 * i] = htons(bench_ipx_fields[i][0]);
+        raw[3 + 2 * i] = htons(bench_ipx_fields[i][1]);
+    }
+
+    struct fds_template *tmplt;
+    uint16_t len = sizeof(raw);
+    if (fds_template_parse(FDS_TYPE_TEMPLATE, raw, &len, &tmplt) != FDS_OK) {
+        return NULL;
+    }
+
+    if (fds_template_ies_define(tmplt, iemgr, false) != FDS_OK) {
+        fds_template_destroy(tmplt);
+        return NULL;
+    }
+
+    return tmplt;
+}
+
+/**
+ * \brief Fill IPFIX records with pseudo-random values
+ * \param[in] data      Records
+ * \param[in] rec_size  Size of a record
+ */
+static void
+bench_records(uint8_t *data, uint16_t rec_size)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < BENCH_RECS * rec_size; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        data[i] = (uint8_t) state;
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    unsigned long long cnt = BENCH_DEFAULT_CNT;
+    if (argc > 1) {
+        cnt = strtoull(argv[1], NULL, 10);
+    }
+
+    // Prepare definitions of IPFIX and UniRec fields
+    fds_iemgr_t *iemgr = fds_iemgr_create();
+    if (!iemgr || fds_iemgr_read_dir(iemgr, fds_api_cfg_dir()) != FDS_OK) {
+        fprintf(stderr, "Failed to load definitions of IPFIX Information Elements\n");
+        return EXIT_FAILURE;
+    }
+
+    map_t *map = map_init(iemgr);
+    if (!map || map_load(map, UNIREC_ELEMENTS_FILE) != IPX_OK) {
+        fprintf(stderr, "Failed to load the IPFIX-to-UniRec mapping file\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < map_size(map); ++i) {
+        const struct map_rec *rec = map_get(map, i);
+        ur_define_field(rec->unirec.name, rec->unirec.type);
+    }
+
+    // UniRec template (without question marks)
+    char *ur_fields = strdup(bench_ur_spec);
+    char *w = ur_fields;
+    for (const char *r = bench_ur_spec; *r != '\0'; ++r) {
+        if (*r != '?') {
+            *(w++) = *r;
+        }
+    }
+    *w = '\0';
+
+    ur_template_t *ur_tmplt = ur_create_template(ur_fields, NULL);
+    free(ur_fields);
+    if (!ur_tmplt) {
+        fprintf(stderr, "Failed to create a UniRec template\n");
+        return EXIT_FAILURE;
+    }
+
+    translator_t *trans = translator_init(NULL, map, ur_tmplt, bench_ur_spec);
+    struct fds_template *tmplt = bench_template(iemgr);
+    if (!trans || !tmplt) {
+        fprintf(stderr, "Failed to initialize the translator\n");
+        return EXIT_FAILURE;
+    }
+
+    // Synthetic records and buffers
+    const uint16_t rec_size = tmplt->data_length;
+    uint8_t *records = malloc(BENCH_RECS * rec_size);
+    uint8_t *batch = NULL;
+    if (!records || posix_memalign((void **) &batch, 8, BENCH_BATCH_SIZE) != 0) {
+        fprintf(stderr, "Unable to allocate memory\n");
+        return EXIT_FAILURE;
+    }
+    bench_records(records, rec_size);
+
+    struct fds_ipfix_msg_hdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+
+    struct timespec ts_start, ts_end;
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+    size_t used = 0;
+    unsigned long long converted = 0;
+    for (unsigned long long i = 0; i < cnt; ++i) {
+        if (i % BENCH_MSG_RECS == 0) {
+            translator_set_context(trans, &hdr);
+        }
+
+        struct fds_drec rec;
+        rec.data = records + (i % BENCH_RECS) * rec_size;
+        rec.size = rec_size;
+        rec.tmplt = tmplt;
+        rec.snap = NULL;
+
+        if (used + 8U + translator_size_max(trans, &rec) > BENCH_BATCH_SIZE) {
+            used = 0;
+        }
+
+        uint16_t size;
+        if (translator_translate(trans, &rec, 0, batch + used + 8U, &size) != IPX_OK) {
+            continue;
+        }
+
+        used += (8U + size + 7U) & ~((size_t) 7U);
+        converted++;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    double duration = (double) (ts_end.tv_sec - ts_start.tv_sec)
+        + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+
+    printf("Records:   %llu (converted %llu)\n", cnt, converted);
+    printf("Duration:  %.3f s\n", duration);
+    printf("Rate:      %.0f records/s\n", (duration > 0) ? (cnt / duration) : 0.0);
+
+    free(batch);
+    free(records);
+    fds_template_destroy(tmplt);
+    translator_destroy(trans);
+    ur_free_template(ur_tmplt);
+    ur_finalize();
+    map_destroy(map);
+    fds_iemgr_destroy(iemgr);
+    return EXIT_SUCCESS;
+}
@@ -43,6 +43,7 @@
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <endian.h>
 
 #include "translator.h"
 #include "fields.h"
@@ -94,6 +95,61 @@ struct translator_rec {
     translator_func func;
 };
 
+/** Type of a step of a conversion                                     */
+enum translator_op {
+    /** Call the conversion function of the translator record           */
+    TRANSLATOR_OP_FUNC,
+    /** Copy an unsigned integer of the same size (1 byte)              */
+    TRANSLATOR_OP_UINT8,
+    /** Copy an unsigned integer of the same size (2 bytes)             */
+    TRANSLATOR_OP_UINT16,
+    /** Copy an unsigned integer of the same size (4 bytes)             */
+    TRANSLATOR_OP_UINT32,
+    /** Copy an unsigned integer of the same size (8 bytes)             */
+    TRANSLATOR_OP_UINT64
+};
+
+/**
+ * \brief Conversion step (conversion of one IPFIX field)
+ *
+ * Steps are private data of fields selected by the field selector, so the type of conversion
+ * of each field is decided only once per template.
+ */
+struct translator_step {
+    /** Type of the step                                                */
+    enum translator_op op;
+    /** Translator record                                               */
+    const struct translator_rec *def;
+};
+
+/** Selections (uniflow, forward and reverse direction of biflow records) */
+enum translator_dir {
+    TRANSLATOR_DIR_UNI = 0,
+    TRANSLATOR_DIR_FWD,
+    TRANSLATOR_DIR_REV,
+    TRANSLATOR_DIR_CNT
+};
+
+/** Selection of convertible fields (for one direction of biflow records) */
+struct translator_sel {
+    /** Translator (only for the mapping function)                      */
+    const struct translator_s *trans;
+    /** Iterator flags of the selection                                 */
+    uint16_t flags;
+    /** Field selector (private data of fields are conversion steps)    */
+    ipx_fsel_t *fsel;
+
+    /** Template of the last processed record (reset for each IPFIX Message) */
+    const struct fds_template *last_tmplt;
+    /** Selected fields of the last template                            */
+    const struct ipx_fsel_result *last_res;
+    /**
+     * Index of a required UniRec field that cannot be filled from records of the last template
+     * (or -1, if all required fields can be filled)
+     */
+    int last_req_missing;
+};
+
 /** Internal structure of IPFIX to Unirec translator                    */
 struct translator_s {
     /** Instance context (only for log!)                                */
@@ -104,15 +160,23 @@ struct translator_s {
         struct translator_rec *recs;
         /** Number of records                                           */
         size_t size;
+        /**
+         * Conversion steps (two for each record, the first one calls the conversion
+         * function, the second one copies an integer of the same size, if possible)
+         */
+        struct translator_step *steps;
     } table; /**< Conversion table                                      */
 
     struct {
-        /** Record structure                                            */
+        /** Record structure (destination of the current conversion)   */
         void *data;
         /** Reference to a UniRec template                              */
         const ur_template_t *ur_tmplt;
     } record; /**< UniRec record structure                              */
 
+    /** Selections of convertible fields (see translator_dir)           */
+    struct translator_sel sels[TRANSLATOR_DIR_CNT];
+
     struct {
         /**
          * Required fields to be filled
@@ -819,8 +883,8 @@ translator_idx_by_name(const ur_template_t *tmplt, const char *name)
 /**
  * \brief Initialize components necessary for storing converted fields
  *
- * The function initialize will UniRec records and determine whether fields of the UniRec record
- * are required or optional.
+ * The function will determine whether fields of the UniRec record are required or optional.
+ * \note UniRec records are stored into buffers provided by the user of the translator.
  *
  * \warning
  *   The function expects that the \p tmplt_spec doesn't contain whitespace characters!
@@ -833,13 +897,6 @@ translator_idx_by_name(const ur_template_t *tmplt, const char *name)
 static int
 translator_init_record(translator_t *trans, const ur_template_t *tmplt, const char *tmplt_spec)
 {
-    // Prepare UniRec record
-    void *ur_record = ur_create_record(tmplt, UR_MAX_SIZE);
-    if (!ur_record) {
-        IPX_CTX_ERROR(trans->ctx, "Unable to create a UniRec record (%s:%d)", __FILE__, __LINE__);
-        return IPX_ERR_DENIED;
-    }
-
     // Prepare progress fields
     const size_t tmplt_cnt = tmplt->count;
     uint8_t *req_fields = malloc(tmplt_cnt * sizeof(*req_fields));
@@ -850,7 +907,6 @@ translator_init_record(translator_t *trans, const ur_template_t *tmplt, const ch
     if (!req_fields || !req_tmplt || !req_names || !spec_cpy) {
         IPX_CTX_ERROR(trans->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
         free(req_fields); free(req_tmplt); free(req_names); free(spec_cpy);
-        ur_free_record(ur_record);
         return IPX_ERR_NOMEM;
     }
 
@@ -895,11 +951,10 @@ translator_init_record(translator_t *trans, const ur_template_t *tmplt, const ch
             free(req_names[i]);
         }
         free(req_fields); free(req_tmplt); free(req_names);
-        ur_free_record(ur_record);
         return ret_code;
     }
 
-    trans->record.data = ur_record;
+    trans->record.data = NULL;
     trans->record.ur_tmplt = tmplt;
     trans->progress.req_fields = req_fields;
     trans->progress.req_names = req_names;
@@ -923,7 +978,6 @@ translator_destroy_record(translator_t *trans)
     free(trans->progress.req_names);
     free(trans->progress.req_tmplt);
     free(trans->progress.req_fields);
-    ur_free_record(trans->record.data);
 }
 
 /**
@@ -1083,6 +1137,57 @@ translator_table_fill_internal(translator_t *trans, const struct map_rec *map_re
     return IPX_ERR_DENIED;
 }
 
+/**
+ * \brief Select the type of a conversion step that copies an integer of the same size
+ *
+ * Unsigned integers that have the same size in the template as the destination UniRec field
+ * are just copied (with byte order conversion). Other fields use the conversion function.
+ * \param[in] def Translator record
+ * \return Type of the step (#TRANSLATOR_OP_FUNC, if the field cannot be just copied)
+ */
+static enum translator_op
+translator_copy_op(const struct translator_rec *def)
+{
+    if (def->func != translate_uint || !fds_iemgr_is_type_unsigned(def->ipfix.type)) {
+        return TRANSLATOR_OP_FUNC;
+    }
+
+    switch (def->unirec.type) {
+    case UR_TYPE_UINT8:
+        return TRANSLATOR_OP_UINT8;
+    case UR_TYPE_UINT16:
+        return TRANSLATOR_OP_UINT16;
+    case UR_TYPE_UINT32:
+        return TRANSLATOR_OP_UINT32;
+    case UR_TYPE_UINT64:
+        return TRANSLATOR_OP_UINT64;
+    default:
+        return TRANSLATOR_OP_FUNC;
+    }
+}
+
+/**
+ * \brief Get the size of an IPFIX field that can be converted by a step
+ * \param[in] op Type of the step
+ * \return Size of the field (0 = any size)
+ */
+static inline uint16_t
+translator_op_size(enum translator_op op)
+{
+    switch (op) {
+    case TRANSLATOR_OP_UINT8:
+        return 1U;
+    case TRANSLATOR_OP_UINT16:
+        return 2U;
+    case TRANSLATOR_OP_UINT32:
+        return 4U;
+    case TRANSLATOR_OP_UINT64:
+        return 8U;
+    default:
+        return 0U;
+    }
+}
+
 /**
  * \brief Initialize a conversion table
  *
@@ -1167,8 +1272,25 @@ translator_init_table(translator_t *trans, const map_t *map, const ur_template_t
     }
 
     qsort(table, rec_cnt, sizeof(*table), translator_cmp);
+
+    // Prepare conversion steps of the records
+    struct translator_step *steps = malloc(2 * rec_cnt * sizeof(*steps));
+    if (!steps && rec_cnt != 0) {
+        IPX_CTX_ERROR(trans->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        free(table);
+        return IPX_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < rec_cnt; ++i) {
+        steps[2 * i].op = TRANSLATOR_OP_FUNC;
+        steps[2 * i].def = &table[i];
+        steps[2 * i + 1].op = translator_copy_op(&table[i]);
+        steps[2 * i + 1].def = &table[i];
+    }
+
     trans->table.recs = table;
     trans->table.size = rec_cnt;
+    trans->table.steps = steps;
     return IPX_OK;
 }
 
@@ -1181,6 +1303,7 @@ translator_init_table(translator_t *trans, const map_t *map, const ur_template_t
 static void
 translator_destroy_table(translator_t *trans)
 {
+    free(trans->table.steps);
     free(trans->table.recs);
 }
 
@@ -1214,6 +1337,165 @@ translator_call_internals(translator_t *trans)
     return converted_fields;
 }
 
+/**
+ * \brief Get definitions of template fields as seen by a record iterator with given flags
+ *
+ * In case of the reverse direction of a biflow record, reverse fields are presented as
+ * forward fields and vice versa (the same as fds_drec_iter does).
+ * \param[in] tmplt Template
+ * \param[in] flags Iterator flags
+ * \return Array of fields
+ */
+static inline const struct fds_tfield *
+translator_fields(const struct fds_template *tmplt, uint16_t flags)
+{
+    if ((flags & FDS_DREC_BIFLOW_REV) != 0 && tmplt->fields_rev != NULL) {
+        return tmplt->fields_rev;
+    }
+
+    return tmplt->fields;
+}
+
+/**
+ * \brief Find a conversion step of a template field (mapping function of selectors)
+ *
+ * Fields are processed in the same way as fds_drec_iter with the same flags would do,
+ * i.e. reverse fields are skipped in case of biflow records.
+ * \param[in] tmplt IPFIX template
+ * \param[in] idx   Index of the field in the template
+ * \param[in] data  Selection (struct translator_sel)
+ * \return Conversion step or NULL (the field cannot be converted)
+ */
+static const void *
+translator_map(const struct fds_template *tmplt, uint16_t idx, void *data)
+{
+    const struct translator_sel *sel = data;
+    const struct translator_s *trans = sel->trans;
+    const struct fds_tfield *field = &translator_fields(tmplt, sel->flags)[idx];
+    if (sel->flags != 0 && (field->flags & FDS_TFIELD_REVERSE) != 0) {
+        return NULL;
+    }
+
+    struct translator_rec key;
+    key.ipfix.id = field->id;
+    key.ipfix.pen = field->en;
+    const struct translator_rec *def = bsearch(&key, trans->table.recs, trans->table.size,
+        sizeof(*trans->table.recs), translator_cmp);
+    if (!def) {
+        // Conversion definition not found
+        return NULL;
+    }
+
+    const struct translator_step *steps = &trans->table.steps[2 * (def - trans->table.recs)];
+    if (steps[1].op != TRANSLATOR_OP_FUNC && translator_op_size(steps[1].op) == field->length) {
+        return &steps[1];
+    }
+
+    return &steps[0];
+}
+
+/**
+ * \brief Find a required UniRec field that cannot be filled from records of a template
+ * \note The array of required fields to be filled is used as a temporary storage.
+ * \param[in] trans Translator internal structure
+ * \param[in] res   Selected fields of the template
+ * \return Index of the field or -1 (all required fields can be filled)
+ */
+static int
+translator_req_missing(translator_t *trans, const struct ipx_fsel_result *res)
+{
+    uint8_t *req_fields = trans->progress.req_fields;
+    memcpy(req_fields, trans->progress.req_tmplt, trans->progress.size * sizeof(*req_fields));
+
+    for (uint16_t i = 0; i < res->cnt; ++i) {
+        const struct translator_step *step = res->priv[i];
+        req_fields[step->def->unirec.req_idx] = 0U;
+    }
+
+    if (trans->extra_conv.lbf.en) {
+        req_fields[trans->extra_conv.lbf.req_idx] = 0U;
+    }
+
+    for (size_t i = 0; i < trans->progress.size; ++i) {
+        if (req_fields[i] != 0) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * \brief Convert selected fields of an IPFIX record
+ * \param[in] trans     Translator internal structure
+ * \param[in] sel       Selection of the template of the record
+ * \param[in] ipfix_rec IPFIX record
+ * \return Number of converted fields
+ */
+static int
+translator_convert(translator_t *trans, const struct translator_sel *sel,
+    const struct fds_drec *ipfix_rec)
+{
+    const struct fds_template *tmplt = ipfix_rec->tmplt;
+    const struct fds_tfield *fields = translator_fields(tmplt, sel->flags);
+    const ur_template_t *ur_tmplt = trans->record.ur_tmplt;
+    void *ur_record = trans->record.data;
+    uint8_t *req_fields = trans->progress.req_fields;
+    int converted_fields = 0;
+
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, sel->last_res, ipfix_rec);
+    while (ipx_fsel_iter_next(&it) == IPX_OK) {
+        const struct translator_step *step = it.priv;
+        const struct translator_rec *def = step->def;
+        const uint8_t *data = it.field.data;
+        void *field_ptr;
+        uint16_t u16;
+        uint32_t u32;
+        uint64_t u64;
+
+        switch (step->op) {
+        case TRANSLATOR_OP_UINT8:
+            field_ptr = ur_get_ptr_by_id(ur_tmplt, ur_record, def->unirec.id);
+            *((uint8_t *) field_ptr) = *data;
+            break;
+        case TRANSLATOR_OP_UINT16:
+            memcpy(&u16, data, sizeof(u16));
+            field_ptr = ur_get_ptr_by_id(ur_tmplt, ur_record, def->unirec.id);
+            *((uint16_t *) field_ptr) = ntohs(u16);
+            break;
+        case TRANSLATOR_OP_UINT32:
+            memcpy(&u32, data, sizeof(u32));
+            field_ptr = ur_get_ptr_by_id(ur_tmplt, ur_record, def->unirec.id);
+            *((uint32_t *) field_ptr) = ntohl(u32);
+            break;
+        case TRANSLATOR_OP_UINT64:
+            memcpy(&u64, data, sizeof(u64));
+            field_ptr = ur_get_ptr_by_id(ur_tmplt, ur_record, def->unirec.id);
+            *((uint64_t *) field_ptr) = be64toh(u64);
+            break;
+        default: {
+            // Present the field as fds_drec_iter would do (i.e. reverse fields as forward ones)
+            const struct fds_tfield *info = &fields[it.field.info - tmplt->fields];
+            it.field.info = info;
+
+            if (def->func(trans, def, &it.field) != 0) {
+                IPX_CTX_WARNING(trans->ctx, "Failed to convert an IPFIX IE (PEN: %" PRIu32 ", "
+                    "ID: %" PRIu16 ") to UniRec field '%s'",
+                    info->en, info->id, trans->progress.req_names[def->unirec.req_idx]);
+                continue;
+            }
+            break;
+        }
+        }
+
+        req_fields[def->unirec.req_idx] = 0; // Clear the "flag"
+        converted_fields++;
+    }
+
+    return converted_fields;
+}
+
 translator_t *
 translator_init(ipx_ctx_t *ctx, const map_t *map, const ur_template_t *tmplt, const char *tmplt_spec)
 {
@@ -1235,12 +1517,30 @@ translator_init(ipx_ctx_t *ctx, const map_t *map, const ur_template_t *tmplt, co
         return NULL;
     }
 
+    // Prepare selectors of convertible fields
+    const uint16_t sel_flags[TRANSLATOR_DIR_CNT] = {0, FDS_DREC_BIFLOW_FWD, FDS_DREC_BIFLOW_REV};
+    for (size_t i = 0; i < TRANSLATOR_DIR_CNT; ++i) {
+        struct translator_sel *sel = &trans->sels[i];
+        sel->trans = trans;
+        sel->flags = sel_flags[i];
+        sel->fsel = ipx_fsel_create_map(&translator_map, sel);
+        if (!sel->fsel) {
+            IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            translator_destroy(trans);
+            return NULL;
+        }
+    }
+
     return trans;
 }
 
 void
 translator_destroy(translator_t *trans)
 {
+    for (size_t i = 0; i < TRANSLATOR_DIR_CNT; ++i) {
+        ipx_fsel_destroy(trans->sels[i].fsel);
+    }
+
     translator_destroy_table(trans);
     translator_destroy_record(trans);
     free(trans);
@@ -1250,60 +1550,73 @@ void
 translator_set_context(translator_t *trans, const struct fds_ipfix_msg_hdr *hdr)
 {
     trans->msg_context.hdr = hdr;
+    // Templates can be freed and replaced between IPFIX Messages
+    for (size_t i = 0; i < TRANSLATOR_DIR_CNT; ++i) {
+        trans->sels[i].last_tmplt = NULL;
+    }
 }
 
-const void *
-translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t flags, uint16_t *size)
+size_t
+translator_size_max(const translator_t *trans, const struct fds_drec *ipfix_rec)
 {
-    // Reset UniRec record and required field "flags"
-    void *ur_record = trans->record.data;
-    const ur_template_t *ur_tmplt = trans->record.ur_tmplt;
-    memset(ur_record, 0, ur_rec_fixlen_size(ur_tmplt));
-    ur_clear_varlen(trans->record.ur_tmplt, ur_record);
+    // Variable-length UniRec fields are filled only from fields of the IPFIX record
+    return ur_rec_fixlen_size(trans->record.ur_tmplt) + ipfix_rec->size;
+}
 
-    const size_t req_fields_size = trans->progress.size * sizeof(*trans->progress.req_fields);
-    memcpy(trans->progress.req_fields, trans->progress.req_tmplt, req_fields_size);
+int
+translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t flags, void *dst,
+    uint16_t *size)
+{
+    enum translator_dir dir = TRANSLATOR_DIR_UNI;
+    if ((flags & FDS_DREC_BIFLOW_REV) != 0) {
+        dir = TRANSLATOR_DIR_REV;
+    } else if ((flags & FDS_DREC_BIFLOW_FWD) != 0) {
+        dir = TRANSLATOR_DIR_FWD;
+    }
 
-    // Initialize a record iterator
-    struct fds_drec_iter it;
-    fds_drec_iter_init(&it, ipfix_rec, flags);
+    const struct fds_template *ipfix_tmplt = ipfix_rec->tmplt;
+    struct translator_sel *sel = &trans->sels[dir];
+    if (sel->last_tmplt != ipfix_tmplt) {
+        sel->last_res = ipx_fsel_get(sel->fsel, ipfix_tmplt);
+        if (!sel->last_res) {
+            sel->last_tmplt = NULL;
+            IPX_CTX_ERROR(trans->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
 
-    struct translator_rec key;
-    const struct translator_rec *def;
-    const size_t table_rec_cnt = trans->table.size;
-    const size_t table_rec_size = sizeof(*trans->table.recs);
+        sel->last_tmplt = ipfix_tmplt;
+        sel->last_req_missing = translator_req_missing(trans, sel->last_res);
+    }
 
-    // First, call special internal conversion functions, if enabled
-    int converted_fields = translator_call_internals(trans);
+    if (sel->last_res->cnt == 0 && !trans->extra_conv.lbf.en) {
+        IPX_CTX_INFO(trans->ctx, "Record conversion failed: no fields have been converted!", '\0');
+        return IPX_ERR_NOTFOUND;
+    }
 
-    // Try to convert all IPFIX fields
-    while (fds_drec_iter_next(&it) != FDS_EOC) {
-        // Find the conversion function
-        const struct fds_tfield *info = it.field.info;
-        key.ipfix.id = info->id;
-        key.ipfix.pen = info->en;
+    if (sel->last_req_missing >= 0) {
+        // The record cannot be converted at all
+        IPX_CTX_INFO(trans->ctx, "Record conversion failed: required UniRec field '%s' was not "
+            "filled!", trans->progress.req_names[sel->last_req_missing]);
+        return IPX_ERR_NOTFOUND;
+    }
 
-        def = bsearch(&key, trans->table.recs, table_rec_cnt, table_rec_size, translator_cmp);
-        if (!def) {
-            // Conversion definition not found
-            continue;
-        }
+    // Reset UniRec record and required field "flags"
+    const ur_template_t *ur_tmplt = trans->record.ur_tmplt;
+    trans->record.data = dst;
+    memset(dst, 0, ur_rec_fixlen_size(ur_tmplt));
+    ur_clear_varlen(ur_tmplt, dst);
 
-        int field_idx = def->unirec.req_idx;
-        if (def->func(trans, def, &it.field) != 0) {
-            IPX_CTX_WARNING(trans->ctx, "Failed to convert an IPFIX IE (PEN: %" PRIu32 ", "
-                "ID: %" PRIu16 ") to UniRec field '%s'",
-                info->en, info->id, trans->progress.req_names[field_idx]);
-            continue;
-        }
+    const size_t req_fields_size = trans->progress.size * sizeof(*trans->progress.req_fields);
+    memcpy(trans->progress.req_fields, trans->progress.req_tmplt, req_fields_size);
 
-        trans->progress.req_fields[field_idx] = 0; // Clear the "flag"
-        converted_fields++;
-    }
+    // First, call special internal conversion functions, if enabled
+    int converted_fields = translator_call_internals(trans);
+    // Convert all IPFIX fields with a conversion definition
+    converted_fields += translator_convert(trans, sel, ipfix_rec);
 
     if (converted_fields == 0) {
         IPX_CTX_INFO(trans->ctx, "Record conversion failed: no fields have been converted!", '\0');
-        return NULL;
+        return IPX_ERR_NOTFOUND;
     }
 
     // Check if conversion filled are required fields
@@ -1313,12 +1626,11 @@ translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t f
         assert(trans->progress.req_fields[idx] != 0);
         IPX_CTX_INFO(trans->ctx, "Record conversion failed: required UniRec field '%s' was not "
             "filled!", trans->progress.req_names[idx]);
-        return NULL;
+        return IPX_ERR_NOTFOUND;
     }
 
     // Success
     IPX_CTX_INFO(trans->ctx, "Record conversion successful: %d fields converted", converted_fields);
-    *size = ur_rec_size(ur_tmplt, ur_record);
-    return ur_record;
+    *size = ur_rec_size(ur_tmplt, dst);
+    return IPX_OK;
 }
-
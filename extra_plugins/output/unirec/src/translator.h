@@ -77,22 +77,43 @@ translator_destroy(translator_t *trans);
  *
  * This function MUST be called before processing each IPFIX Message to set proper record
  * parameters. The message header is required for determine ODID or other parameters.
+ *
+ * \note The translator caches convertible fields of each IPFIX template (see field selector).
+ *   Because templates can be freed or replaced between IPFIX Messages, the template of the last
+ *   converted record is forgotten after calling this function.
  * \param[in] trans Translator instance
  * \param[in] hdr   IPFIX message header
  */
 void
 translator_set_context(translator_t *trans, const struct fds_ipfix_msg_hdr *hdr);
 
+/**
+ * \brief Get the maximum size of an UniRec record converted from a IPFIX record
+ * \param[in] trans     Translator instance
+ * \param[in] ipfix_rec IPFIX record
+ * \return Size in bytes
+ */
+size_t
+translator_size_max(const translator_t *trans, const struct fds_drec *ipfix_rec);
+
 /**
  * \brief Convert a IPFIX record to an UniRec message
+ *
+ * The UniRec message is stored directly to the memory \p dst, so multiple messages can be
+ * converted into a single buffer.
  * \param[in]  trans     Translator instance
  * \param[in]  ipfix_rec IPFIX record (read only!)
- * \param[in]  flags     Flags for iterator over the IPFIX record
+ * \param[in]  flags     Flags for iterator over the IPFIX record (only 0,
+ *   #FDS_DREC_BIFLOW_FWD or #FDS_DREC_BIFLOW_REV)
+ * \param[out] dst       Destination memory (at least translator_size_max() bytes, the address
+ *   should be aligned to 8 bytes)
  * \param[out] size      Size of the converted message
- * \return Number of converted fields
+ * \return #IPX_OK on success (the message is filled)
+ * \return #IPX_ERR_NOTFOUND if the record cannot be converted (no fields or missing required fields)
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
-const void *
-translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t flags,
+int
+translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t flags, void *dst,
     uint16_t *size);
 
 #endif // UR_TRANSLATOR_H
@@ -41,6 +41,8 @@
 #include <ipfixcol2.h>
 #include <libtrap/trap.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <unirec/unirec.h>
 
@@ -54,6 +56,12 @@
 #define PLUGIN_TRAP_NAME "IPFIXcol2-UniRec"
 /** Description of the TRAP context that belongs to the plugin */
 #define PLUGIN_TRAP_DSC  "UniRec output plugin for IPFIXcol2."
+/** Size of the buffer of converted UniRec records            */
+#define BATCH_SIZE (1024U * 1024U)
+/** Size of the header of a record in the batch buffer        */
+#define BATCH_HDR_SIZE (8U)
+/** Alignment of records in the batch buffer                  */
+#define BATCH_ALIGN(x) (((x) + 7U) & ~((size_t) 7U))
 
 /** GLOBAL mutex shared across all plugin instances  */
 static pthread_mutex_t urp_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -95,8 +103,76 @@ struct conf_unirec {
     ur_template_t *ur_tmplt;
     /** IPFIX to UniRec translator           */
     translator_t *trans;
+
+    struct {
+        /**
+         * Converted UniRec records
+         * \note Each record is preceded by a header with its size (uint16_t) and aligned to
+         *   #BATCH_HDR_SIZE bytes.
+         */
+        uint8_t *data;
+        /** Used part of the buffer             */
+        size_t used;
+        /** Number of records in the buffer     */
+        uint32_t cnt;
+    } batch; /**< Batch of records to send      */
 };
 
+/**
+ * \brief Send all records in the batch via TRAP interface and clear the batch
+ * \param[in] ctx  Plugin context (just for log)
+ * \param[in] conf Plugin configuration
+ */
+static void
+batch_send(ipx_ctx_t *ctx, struct conf_unirec *conf)
+{
+    if (conf->batch.cnt == 0) {
+        return;
+    }
+
+    IPX_CTX_DEBUG(ctx, "Send %" PRIu32 " records via TRAP IFC.", conf->batch.cnt);
+    const uint8_t *pos = conf->batch.data;
+    const uint8_t *end = conf->batch.data + conf->batch.used;
+
+    while (pos < end) {
+        const uint16_t size = *((const uint16_t *) pos);
+        trap_ctx_send(conf->trap_ctx, 0, pos + BATCH_HDR_SIZE, size);
+        pos += BATCH_ALIGN(BATCH_HDR_SIZE + size);
+    }
+
+    conf->batch.used = 0;
+    conf->batch.cnt = 0;
+}
+
+/**
+ * \brief Convert a IPFIX record to an UniRec record in the batch
+ *
+ * If the remaining space of the batch is not sufficient, the batch is sent first.
+ * \param[in] ctx   Plugin context (just for log)
+ * \param[in] conf  Plugin configuration
+ * \param[in] rec   IPFIX record
+ * \param[in] flags Flags for iterator over the IPFIX record
+ */
+static void
+batch_add(ipx_ctx_t *ctx, struct conf_unirec *conf, struct fds_drec *rec, uint16_t flags)
+{
+    const size_t size_max = BATCH_HDR_SIZE + translator_size_max(conf->trans, rec);
+    if (conf->batch.used + size_max > BATCH_SIZE) {
+        batch_send(ctx, conf);
+    }
+
+    uint8_t *hdr = conf->batch.data + conf->batch.used;
+    uint16_t size;
+    if (translator_translate(conf->trans, rec, flags, hdr + BATCH_HDR_SIZE, &size) != IPX_OK) {
+        // Nothing to send
+        return;
+    }
+
+    *((uint16_t *) hdr) = size;
+    conf->batch.used += BATCH_ALIGN(BATCH_HDR_SIZE + size);
+    conf->batch.cnt++;
+}
+
 /**
  * \brief Get the IPFIX-to-UniRec conversion database
  * \param ctx Plugin context
@@ -316,10 +392,19 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     }
     conf->params = parsed_params;
 
+    // Prepare a buffer for converted records (aligned for direct access to fields of records)
+    if (posix_memalign((void **) &conf->batch.data, BATCH_HDR_SIZE, BATCH_SIZE) != 0) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        configuration_free(parsed_params);
+        free(conf);
+        return IPX_ERR_DENIED;
+    }
+
     // Load IPFIX-to-UniRec conversion database
     map_t *conv_db = ipfix2unirec_db(ctx);
     if (!conv_db) {
         configuration_free(parsed_params);
+        free(conf->batch.data);
         free(conf);
         return IPX_ERR_DENIED;
     }
@@ -328,6 +413,7 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     if (core_initialize(ctx, conf, conv_db) != IPX_OK) {
         map_destroy(conv_db);
         configuration_free(parsed_params);
+        free(conf->batch.data);
         free(conf);
         return IPX_ERR_DENIED;
     }
@@ -345,6 +431,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     struct conf_unirec *conf = (struct conf_unirec *) cfg;
     core_destroy(ctx, conf);
     configuration_free(conf->params);
+    free(conf->batch.data);
     free(conf);
 }
 
@@ -356,13 +443,11 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     struct conf_unirec *conf = (struct conf_unirec *) cfg;
     IPX_CTX_DEBUG(ctx, "Received a new message to process.");
 
-    uint16_t msg_size = 0;
-    const void *msg_data = NULL;
-
     ipx_msg_ipfix_t *ipfix = ipx_msg_base2ipfix(msg);
     const uint8_t *ipfix_raw_msg = ipx_msg_ipfix_get_packet(ipfix);
     translator_set_context(conf->trans, (const struct fds_ipfix_msg_hdr *) ipfix_raw_msg);
 
+    // Convert all records into the batch first and then send them at once
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix);
     for (uint32_t i = 0; i < rec_cnt; i++) {
         // Get a pointer to the next record
@@ -371,31 +456,16 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
         // Fill record
         uint16_t flags = biflow ? FDS_DREC_BIFLOW_FWD : 0; // In case of biflow, forward fields only
-        msg_data = translator_translate(conf->trans, &ipfix_rec->rec, flags, &msg_size);
-        if (!msg_data) {
-            // Nothing to send
-            continue;
-        }
-
-        IPX_CTX_DEBUG(ctx, "Send via TRAP IFC.");
-        trap_ctx_send(conf->trap_ctx, 0, msg_data, msg_size);
+        batch_add(ctx, conf, &ipfix_rec->rec, flags);
 
         // Is it biflow? Send the reverse direction
         if (!biflow) {
             continue;
         }
 
-        flags = FDS_DREC_BIFLOW_REV;
-        msg_data = translator_translate(conf->trans, &ipfix_rec->rec, flags, &msg_size);
-        if (!msg_data) {
-            // Nothing to send
-            continue;
-        }
-
-        IPX_CTX_DEBUG(ctx, "Send via TRAP IFC.");
-        trap_ctx_send(conf->trap_ctx, 0, msg_data, msg_size);
+        batch_add(ctx, conf, &ipfix_rec->rec, FDS_DREC_BIFLOW_REV);
     }
 
+    batch_send(ctx, conf);
     return 0;
 }
-
@@ -0,0 +1,221 @@
+/**
+ * \file include/ipfixcol2/field_selector.h
+ * \brief Per-template cache of selected fields (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_FIELD_SELECTOR_H
+#define IPX_FIELD_SELECTOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <libfds.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxFieldSelector Field selector
+ * \ingroup publicAPIs
+ * \brief Cache of fields selected from IPFIX (Options) Templates
+ *
+ * Many plugins are interested only in a few fields of each Data Record (e.g. IP addresses
+ * or timestamps). Instead of iterating over all fields of every record and checking their
+ * definitions, a plugin can create a field selector with a function that decides which fields
+ * of a template are interesting. The selector evaluates the function only once per template,
+ * caches the result and the plugin can jump directly to the selected fields of each record.
+ *
+ * Typical usage:
+ * \code{.c}
+ *   const struct fds_template *last_tmplt = NULL;
+ *   const struct ipx_fsel_result *res = NULL;
+ *
+ *   for (uint32_t i = 0; i < rec_cnt; ++i) {
+ *       struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+ *       if (rec->rec.tmplt != last_tmplt) {
+ *           res = ipx_fsel_get(sel, rec->rec.tmplt);
+ *           last_tmplt = rec->rec.tmplt;
+ *       }
+ *
+ *       if (!res || res->cnt == 0) {
+ *           continue;
+ *       }
+ *
+ *       struct ipx_fsel_iter it;
+ *       ipx_fsel_iter_init(&it, res, &rec->rec);
+ *       while (ipx_fsel_iter_next(&it) == IPX_OK) {
+ *           // it.field contains the selected field...
+ *       }
+ *   }
+ * \endcode
+ *
+ * \warning
+ *   Templates are released when they are not used anymore and their memory can be reused by
+ *   another template. Therefore, a result (or template pointer) must NOT be reused across
+ *   IPFIX Messages, i.e. the \p last_tmplt in the example above must be reset for each Message.
+ * \note The selector is not thread-safe. Each plugin instance should use its own selector.
+ * @{
+ */
+
+/** Field selector (internal structure)                                       */
+typedef struct ipx_fsel ipx_fsel_t;
+
+/**
+ * \brief Field matching function
+ * \param[in] field Field of an IPFIX (Options) Template
+ * \param[in] data  User data (see ipx_fsel_create())
+ * \return True if the field should be selected. Otherwise false.
+ */
+typedef bool (*ipx_fsel_match_cb)(const struct fds_tfield *field, void *data);
+
+/**
+ * \brief Field mapping function
+ *
+ * In addition to the decision whether a field should be selected, the function assigns private
+ * data (e.g. a conversion definition) to the selected field. The data are cached together with
+ * the selection, so a plugin doesn't have to look them up for each record.
+ * \param[in] tmplt IPFIX (Options) Template
+ * \param[in] idx   Index of the field in the template
+ * \param[in] data  User data (see ipx_fsel_create_map())
+ * \return Private data of the field or NULL, if the field should not be selected.
+ */
+typedef const void *(*ipx_fsel_map_cb)(const struct fds_template *tmplt, uint16_t idx,
+    void *data);
+
+/** Result of selection for a particular template                             */
+struct ipx_fsel_result {
+    /** Number of selected fields                                             */
+    uint16_t cnt;
+    /** At least one selected field doesn't have a fixed offset in records    */
+    bool dynamic;
+    /** Indexes of selected fields in the template (in ascending order)       */
+    const uint16_t *idx;
+    /** Private data of selected fields (NULL, if not created by a mapping)   */
+    const void * const *priv;
+};
+
+/** Iterator over selected fields of a Data Record                            */
+struct ipx_fsel_iter {
+    /** Current field (the same meaning as in fds_drec_iter)                  */
+    struct fds_drec_field field;
+    /** Private data of the current field (NULL, if not created by a mapping) */
+    const void *priv;
+
+    /** Selection (internal)                                                  */
+    const struct ipx_fsel_result *_res;
+    /** Data Record (internal)                                                */
+    const struct fds_drec *_rec;
+    /** Position in the selection (internal)                                  */
+    uint16_t _pos;
+    /** Index of the first unprocessed field of the record (internal)         */
+    uint16_t _walk_idx;
+    /** Offset of the first unprocessed field of the record (internal)        */
+    uint16_t _walk_offset;
+};
+
+/**
+ * \brief Create a field selector
+ * \param[in] cb   Field matching function
+ * \param[in] data User data passed to the matching function (can be NULL)
+ * \return Pointer to the selector or NULL (memory allocation error)
+ */
+IPX_API ipx_fsel_t *
+ipx_fsel_create(ipx_fsel_match_cb cb, void *data);
+
+/**
+ * \brief Create a field selector with private data of selected fields
+ *
+ * The same as ipx_fsel_create(), but private data returned by the mapping function are
+ * available in ipx_fsel_result::priv and ipx_fsel_iter::priv.
+ * \param[in] cb   Field mapping function
+ * \param[in] data User data passed to the mapping function (can be NULL)
+ * \return Pointer to the selector or NULL (memory allocation error)
+ */
+IPX_API ipx_fsel_t *
+ipx_fsel_create_map(ipx_fsel_map_cb cb, void *data);
+
+/**
+ * \brief Destroy a field selector
+ * \note If \p sel is NULL, nothing is done.
+ * \param[in] sel Field selector
+ */
+IPX_API void
+ipx_fsel_destroy(ipx_fsel_t *sel);
+
+/**
+ * \brief Get selected fields of a template
+ *
+ * If the template hasn't been seen before, the matching function is called for each field
+ * of the template and the result is cached.
+ * \warning The result is valid only until the next call of this function.
+ * \param[in] sel   Field selector
+ * \param[in] tmplt IPFIX (Options) Template
+ * \return Pointer to the result or NULL (memory allocation error)
+ */
+IPX_API const struct ipx_fsel_result *
+ipx_fsel_get(ipx_fsel_t *sel, const struct fds_template *tmplt);
+
+/**
+ * \brief Initialize an iterator over selected fields of a Data Record
+ * \param[out] it  Iterator
+ * \param[in]  res Selected fields of the template of the record (see ipx_fsel_get())
+ * \param[in]  rec Data Record (must be formatted by the template of the selection)
+ */
+IPX_API void
+ipx_fsel_iter_init(struct ipx_fsel_iter *it, const struct ipx_fsel_result *res,
+    const struct fds_drec *rec);
+
+/**
+ * \brief Get the next selected field of the Data Record
+ *
+ * Fields with a fixed offset are accessed directly. Offsets of other fields are determined
+ * by walking only through the part of the record before the field.
+ * \param[in] it Iterator
+ * \return #IPX_OK on success (the field is stored in \p it->field)
+ * \return #IPX_EOC if there are no more selected fields
+ */
+IPX_API int
+ipx_fsel_iter_next(struct ipx_fsel_iter *it);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_FIELD_SELECTOR_H
@@ -60,6 +60,10 @@ extern "C" {
  * the destruction of this message. It ensures that there are no objects _farther down_ in the
  * pipeline with references to this object, because that objects have been already destroyed.
  *
+ * \note The collector doesn't pass garbage messages through the pipeline. A message passed by
+ *   ipx_ctx_msg_pass() is held aside and destroyed as soon as all messages that existed
+ *   at the time of passing (and messages derived from them) are destroyed. Therefore, plugins
+ *   usually don't receive garbage messages even if they subscribe them.
  * \warning Already destroyed objects MUST never be used again.
  * \remark Identification type of this message is #IPX_MSG_GARBAGE.
  *
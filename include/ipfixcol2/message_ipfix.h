@@ -125,6 +125,10 @@ ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_
 
 /**
  * \brief Destroy a message wrapper with a parsed IPFIX packet
+ *
+ * If the message is shared by multiple destinations of the output manager (i.e. output
+ * instances or their private chains of intermediate instances), only the reference of the
+ * caller is released and the message is freed by the last destination.
  * \param[out] msg Pointer to the message
  */
 IPX_API void
@@ -137,6 +141,7 @@ ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg);
  * This function allow to directly access and modify the wrapped massage. It is recommended to
  * use the raw packet only read-only, because inappropriate modifications (e.g. removing/adding
  * sets/records/fields) can cause undefined behavior of API functions.
+ * The raw packet of a shared message (see ipx_msg_ipfix_cow()) MUST NOT be modified at all.
  *
  * \note Size of the message is stored directly in the header (network byte
  *   order) i.e. \code{.c} uint16_t real_len = ntohs(header->length); \endcode
@@ -186,6 +191,43 @@ ipx_msg_ipfix_get_drec_cnt(const ipx_msg_ipfix_t *msg);
 IPX_API struct ipx_ipfix_record *
 ipx_msg_ipfix_get_drec(ipx_msg_ipfix_t *msg, uint32_t idx);
 
+/**
+ * \brief Get a private (modifiable) wrapper of an IPFIX message
+ *
+ * Messages behind the output manager can be shared by multiple output instances or private
+ * chains of intermediate instances (see ipx_msg_ipfix_destroy()) and MUST NOT be modified
+ * in place. If the message is shared, a new wrapper of the message is created. The wrapper has
+ * its own copy of parsed sets and records (including extensions), but it still refers to the
+ * original raw packet, so creating the copy is cheap. The reference of the caller to the
+ * original message is taken over by the new wrapper, i.e. the original message MUST NOT be
+ * used anymore by the caller. If the message is not shared, the same message is returned.
+ *
+ * To modify content of a Data Record, use ipx_msg_ipfix_drec_modify().
+ * \param[in] msg Message
+ * \return Pointer to the private message (it can be the same as \p msg)
+ * \return NULL in case of a memory allocation error (\p msg is still valid)
+ */
+IPX_API ipx_msg_ipfix_t *
+ipx_msg_ipfix_cow(ipx_msg_ipfix_t *msg);
+
+/**
+ * \brief Get a pointer to a Data Record for modification of its content
+ *
+ * Only the content of the record (i.e. values of fields of the same size) can be modified. If
+ * the raw packet is shared with other messages, the record is copied first and modifications
+ * are not visible to other users of the original message. Modified records are serialized
+ * into a private copy of the raw packet as soon as the raw packet or its sets are accessed
+ * (see ipx_msg_ipfix_get_packet() and ipx_msg_ipfix_get_sets()).
+ * \warning The message MUST NOT be shared, see ipx_msg_ipfix_cow().
+ * \param[in] msg Private message
+ * \param[in] idx Index of the record (index starts at 0)
+ * \return On success returns the pointer.
+ * \return NULL if the index is out-of-range, the record is not a part of the raw packet or
+ *   a memory allocation error has occurred.
+ */
+IPX_API struct ipx_ipfix_record *
+ipx_msg_ipfix_drec_modify(ipx_msg_ipfix_t *msg, uint32_t idx);
+
 /**
  * \brief Cast from a source session message to a base message
  * \param[in] msg Pointer to the session message
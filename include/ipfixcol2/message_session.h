@@ -87,7 +87,8 @@ ipx_msg_session_create(const struct ipx_session *session, enum ipx_msg_session_e
 /**
  * \brief Destroy a status message
  *
- * Only destroy the message. A Source Session is not freed.
+ * Only destroy the message. A Source Session is not freed. If the message is shared by multiple
+ * destinations of the output manager, only the reference of the caller is released.
  * \param[in] msg Pointer to the message
  */
 IPX_API void
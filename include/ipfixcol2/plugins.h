@@ -383,6 +383,44 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg);
 IPX_API int
 ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t *mask_old);
 
+/**
+ * \brief Process messages by multiple worker threads (Intermediate plugins ONLY!)
+ *
+ * By default, ipx_plugin_process() of an instance is called by a single thread. If the instance
+ * is able to process multiple messages at the same time (i.e. the function is thread-safe and
+ * doesn't depend on the previous messages), the collector can call it concurrently from
+ * a pool of worker threads. Messages passed by the instance using ipx_ctx_msg_pass() are always
+ * forwarded to the successor in the same order as input messages have been received.
+ * Messages passed while processing a message are forwarded together, right after all messages
+ * passed while processing the preceding input messages.
+ *
+ * Workers can be distinguished using ipx_ctx_parallel_id(), for example, to access worker
+ * specific data structures (caches, etc.) without locking.
+ *
+ * \note By default, messages are processed by a single thread (i.e. 1 worker).
+ * \warning
+ *   This function can be called only during initialization of the instance. Other plugin
+ *   functions (initialization and destruction) are never called concurrently.
+ * \param[in] ctx     Plugin context
+ * \param[in] workers Number of worker threads (must be non-zero)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the plugin is not an Intermediate plugin being initialized or
+ *   \p workers is zero
+ */
+IPX_API int
+ipx_ctx_parallel_set(ipx_ctx_t *ctx, unsigned int workers);
+
+/**
+ * \brief Get the index of the worker thread that calls this function
+ *
+ * \see ipx_ctx_parallel_set()
+ * \param[in] ctx Plugin context
+ * \return Index of the worker (from 0 to number of workers - 1). If the function is not called
+ *   by a worker of the instance (e.g. during initialization), 0 is returned.
+ */
+IPX_API unsigned int
+ipx_ctx_parallel_id(const ipx_ctx_t *ctx);
+
 /**
  * \brief Get a manager of Information Elements
  *
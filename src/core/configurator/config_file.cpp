@@ -92,6 +92,7 @@ enum file_xml_nodes {
     OUT_PLUGIN_VERBOSITY,
     OUT_PLUGIN_ODID_ONLY,
     OUT_PLUGIN_ODID_EXCEPT,
+    OUT_PLUGIN_INTER,
 };
 
 /**
@@ -144,6 +145,7 @@ static const struct fds_xml_args args_instance_output[] = {
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_EXCEPT, "odidExcept", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_ONLY,   "odidOnly",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( OUT_PLUGIN_PARAMS,      "params",                        FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(OUT_PLUGIN_INTER, "intermediatePlugins", args_list_inter, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -243,13 +245,13 @@ file_parse_list_input(fds_xml_ctx_t *ctx, ipx_config_model &model)
 }
 
 /**
- * \brief Parse \<intermediate\> node and add the parsed intermediate instance to the model
- * \param[in] ctx   Parsed XML node
- * \param[in] model Configuration model
- * \throw invalid_argument if the parameters are not valid or missing
+ * \brief Parse \<intermediate\> node
+ * \note Parameters are checked when the instance is added to the model
+ * \param[in] ctx Parsed XML node
+ * \return Parsed intermediate instance
  */
-static void
-file_parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
+static struct ipx_plugin_inter
+file_parse_instance_inter(fds_xml_ctx_t *ctx)
 {
     struct ipx_plugin_inter inter;
 
@@ -274,7 +276,7 @@ file_parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
         }
     }
 
-    model.add_instance(inter);
+    return inter;
 }
 
 /**
@@ -295,7 +297,8 @@ file_parse_list_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
         cnt++;
 
         try {
-            file_parse_instance_inter(content->ptr_ctx, model);
+            struct ipx_plugin_inter inter = file_parse_instance_inter(content->ptr_ctx);
+            model.add_instance(inter);
         } catch (std::exception &ex) {
             throw std::runtime_error("Failed to parse the configuration of the "
                 + std::to_string(cnt) + ". intermediate plugin: " + ex.what());
@@ -303,6 +306,21 @@ file_parse_list_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
     }
 }
 
+/**
+ * \brief Parse \<intermediatePlugins\> node of an output instance (i.e. its private chain)
+ * \param[in] ctx    Parsed XML node
+ * \param[in] output Output instance
+ */
+static void
+file_parse_list_output_inter(fds_xml_ctx_t *ctx, struct ipx_plugin_output &output)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        assert(content->id == INSTANCE_INTER);
+        output.inters.push_back(file_parse_instance_inter(content->ptr_ctx));
+    }
+}
+
 /**
  * \brief Parse \<output\> node and add the parsed output instance to the model
  * \param[in] ctx   Parsed XML node
@@ -347,6 +365,9 @@ file_parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model &model)
                 break;
             }
             throw std::runtime_error("Multiple definitions of <odidExcept>/<odidOnly>!");
+        case OUT_PLUGIN_INTER:
+            file_parse_list_output_inter(content->ptr_ctx, output);
+            break;
         default:
             // Unexpected XML node within <output>!
             assert(false);
@@ -472,6 +493,15 @@ file_parse_model(const std::string &path)
 int
 ipx_config_file(ipx_configurator &conf, const std::string &path)
 {
+    /* Block signals before threads of the pipeline are created (the mask is inherited), so
+     * they are always delivered to this thread (SIGHUP would terminate the collector otherwise) */
+    sigset_t mask_new, mask_old;
+    sigemptyset(&mask_new);
+    sigaddset(&mask_new, SIGINT);
+    sigaddset(&mask_new, SIGTERM);
+    sigaddset(&mask_new, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &mask_new, &mask_old);
+
     // Try to parse the configuration model and start the pipeline
     ipx_config_model model;
     try {
@@ -479,16 +509,11 @@ ipx_config_file(ipx_configurator &conf, const std::string &path)
         conf.start(model);
     } catch (const std::exception &ex) {
         IPX_ERROR(comp_str, "%s", ex.what());
+        pthread_sigmask(SIG_SETMASK, &mask_old, NULL);
         return EXIT_FAILURE;
     }
 
-    // Wait for a termination signal
-    sigset_t mask_new, mask_old;
-    sigemptyset(&mask_new);
-    sigaddset(&mask_new, SIGINT);
-    sigaddset(&mask_new, SIGTERM);
-    pthread_sigmask(SIG_BLOCK, &mask_new, &mask_old);
-
+    // Wait for a termination signal (SIGHUP reloads the configuration file)
     while (true) {
         int sig;
         if (sigwait(&mask_new, &sig) != 0) { // Waits for _pending_ signals
@@ -499,6 +524,19 @@ ipx_config_file(ipx_configurator &conf, const std::string &path)
         if (sig == SIGINT || sig == SIGTERM) {
             break;
         }
+
+        if (sig != SIGHUP) {
+            continue;
+        }
+
+        IPX_INFO(comp_str, "Received SIGHUP. Reloading the configuration file '%s'.",
+            path.c_str());
+        try {
+            model = file_parse_model(path);
+            conf.reload(model);
+        } catch (const std::exception &ex) {
+            IPX_ERROR(comp_str, "Failed to reload the configuration: %s", ex.what());
+        }
     }
 
     IPX_INFO(comp_str, "Received a termination signal.", '\0');
@@ -39,6 +39,9 @@
  *
  */
 
+#include <algorithm>
+#include <cassert>
+#include <cctype>
 #include <memory>
 #include <iostream>
 #include <cstdlib>
@@ -48,6 +51,7 @@
 #include "configurator.hpp"
 
 extern "C" {
+#include "../epoch.h"
 #include "../message_terminate.h"
 #include "../plugin_parser.h"
 #include "../plugin_output_mgr.h"
@@ -61,6 +65,7 @@ ipx_configurator::ipx_configurator()
 {
     iemgr = nullptr;
     ring_size = RING_DEF_SIZE;
+    running_outmgr = nullptr;
 }
 
 ipx_configurator::~ipx_configurator()
@@ -166,6 +171,74 @@ ipx_configurator::set_buffer_size(uint32_t size)
     ring_size = size;
 }
 
+void
+ipx_configurator::tmplts_set_dir(const std::string &path)
+{
+    tmplts_dir = path;
+}
+
+/**
+ * \brief Get a path to the file with (Options) Templates of an instance of an input plugin
+ * \param[in] dir  Directory with (Options) Templates
+ * \param[in] name Name of the instance
+ * \return Path to the file (characters of the name that are not safe are replaced)
+ */
+static std::string
+tmplts_file(const std::string &dir, const std::string &name)
+{
+    std::string file = name;
+    for (char &c : file) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-' && c != '_') {
+            c = '_';
+        }
+    }
+
+    return dir + "/" + file + ".tmplts";
+}
+
+/**
+ * \brief Create a private chain of intermediate instances of an output instance
+ *
+ * The intermediate instances are connected to the output instance, which becomes their owner.
+ * \note The ODID filter of the output instance should be set before its input is used.
+ * \param[in] output Output instance (must not be initialized yet)
+ * \param[in] cfg    Configuration of the output instance
+ * \return Intermediate instances of the chain (for initialization)
+ * \throw runtime_error if a plugin is not available
+ */
+std::vector<ipx_instance_intermediate *>
+ipx_configurator::output_chain_create(ipx_instance_output *output, const ipx_plugin_output &cfg)
+{
+    std::vector<ipx_instance_intermediate *> chain;
+    for (const auto &inter : cfg.inters) {
+        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
+        std::unique_ptr<ipx_instance_intermediate> instance(
+            new ipx_instance_intermediate(inter.name, ref, ring_size));
+        chain.push_back(instance.get());
+        output->chain_add(std::move(instance));
+    }
+
+    return chain;
+}
+
+/**
+ * \brief Initialize a private chain of intermediate instances of an output instance
+ *
+ * Instances are initialized from the end of the chain (i.e. the closest to the output first).
+ * \param[in] chain Intermediate instances returned by output_chain_create()
+ * \param[in] cfg   Configuration of the output instance
+ * \throw runtime_error if any instance fails to initialize
+ */
+void
+ipx_configurator::output_chain_init(const std::vector<ipx_instance_intermediate *> &chain,
+    const ipx_plugin_output &cfg)
+{
+    for (size_t i = chain.size(); i-- > 0; ) {
+        const ipx_plugin_inter &inter = cfg.inters[i];
+        chain[i]->init(inter.params, iemgr, verbosity_str2level(inter.verbosity));
+    }
+}
+
 void
 ipx_configurator::start(const ipx_config_model &model)
 {
@@ -180,6 +253,7 @@ ipx_configurator::start(const ipx_config_model &model)
     std::vector<std::unique_ptr<ipx_instance_output> > outputs;
     std::vector<std::unique_ptr<ipx_instance_intermediate> > inters;
     std::vector<std::unique_ptr<ipx_instance_input> > inputs;
+    std::vector<std::vector<ipx_instance_intermediate *> > chains;
 
     // Phase 1. Create all instances (i.e. find plugins)
     for (const auto &output : model.outputs) {
@@ -203,7 +277,8 @@ ipx_configurator::start(const ipx_config_model &model)
 
     IPX_DEBUG(comp_str, "All plugins have been successfully loaded.", '\0');
 
-    // Phase 2. Connect instances (input -> inter -> ... -> inter -> output manager -> output)
+    /* Phase 2. Connect instances
+     * (input -> inter -> ... -> inter -> output manager -> [inter -> ... ->] output) */
     ipx_instance_intermediate *first_inter = inters.front().get();
     for (auto &input : inputs) {
         input->connect_to(*first_inter); // This can enable multi-writer mode
@@ -223,7 +298,9 @@ ipx_configurator::start(const ipx_config_model &model)
             instance->set_filter(cfg.odid_type, cfg.odid_expression);
         }
 
-        // Connect the output manager and the output instance
+        // Create the private chain of intermediate instances (if any)
+        chains.push_back(output_chain_create(instance, cfg));
+        // Connect the output manager and the output instance (or its chain)
         output_manager->connect_to(*instance);
     }
 
@@ -232,6 +309,7 @@ ipx_configurator::start(const ipx_config_model &model)
         ipx_instance_output *instance = outputs[i].get();
         const ipx_plugin_output &cfg = model.outputs[i];
         instance->init(cfg.params, iemgr, verbosity_str2level(cfg.verbosity));
+        output_chain_init(chains[i], cfg);
     }
 
     output_manager->init(iemgr, ipx_verb_level_get());
@@ -244,6 +322,9 @@ ipx_configurator::start(const ipx_config_model &model)
     for (size_t i = 0; i < model.inputs.size(); ++i) {
         ipx_instance_input *instance = inputs[i].get();
         const ipx_plugin_input &cfg = model.inputs[i];
+        if (!tmplts_dir.empty()) {
+            instance->set_tmplts_file(tmplts_file(tmplts_dir, cfg.name));
+        }
         instance->init(cfg.params, iemgr, verbosity_str2level(cfg.verbosity));
     }
 
@@ -266,6 +347,157 @@ ipx_configurator::start(const ipx_config_model &model)
     running_inputs = std::move(inputs);
     running_inter = std::move(inters);
     running_outputs = std::move(outputs);
+    running_outmgr = output_manager;
+    running_model = model;
+}
+
+void
+ipx_configurator::reload(const ipx_config_model &model)
+{
+    if (running_inputs.empty()) {
+        throw std::runtime_error("The pipeline is not running!");
+    }
+
+    model_check(model);
+    if (model.inputs != running_model.inputs) {
+        IPX_WARNING(comp_str, "Changes of input instances cannot be applied without restart of "
+            "the collector. The changes are ignored!", '\0');
+    }
+
+    // Phase 1. Create and initialize new instances (the running pipeline is not affected yet)
+    std::vector<ipx_instance_output *> outputs;                      // All outputs (new order)
+    std::vector<std::unique_ptr<ipx_instance_output> > outputs_new;  // Newly created outputs
+    std::vector<bool> outputs_kept(running_outputs.size(), false);
+
+    for (const auto &cfg : model.outputs) {
+        // Try to find the same running instance
+        size_t idx;
+        for (idx = 0; idx < running_model.outputs.size(); ++idx) {
+            if (!outputs_kept[idx] && running_model.outputs[idx] == cfg) {
+                break;
+            }
+        }
+
+        if (idx < running_model.outputs.size()) {
+            outputs_kept[idx] = true;
+            outputs.push_back(running_outputs[idx].get());
+            continue;
+        }
+
+        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_OUTPUT, cfg.plugin);
+        outputs_new.emplace_back(new ipx_instance_output(cfg.name, ref, ring_size));
+        ipx_instance_output *instance = outputs_new.back().get();
+        if (cfg.odid_type != IPX_ODID_FILTER_NONE) {
+            instance->set_filter(cfg.odid_type, cfg.odid_expression);
+        }
+        std::vector<ipx_instance_intermediate *> chain = output_chain_create(instance, cfg);
+        instance->init(cfg.params, iemgr, verbosity_str2level(cfg.verbosity));
+        output_chain_init(chain, cfg);
+        outputs.push_back(instance);
+    }
+
+    const bool inter_changed = (model.inters != running_model.inters);
+    std::vector<std::unique_ptr<ipx_instance_intermediate> > inters;
+    ipx_instance_outmgr *output_manager = nullptr;
+
+    if (inter_changed) {
+        for (const auto &cfg : model.inters) {
+            ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, cfg.plugin);
+            inters.emplace_back(new ipx_instance_intermediate(cfg.name, ref, ring_size));
+        }
+
+        output_manager = new ipx_instance_outmgr(ring_size);
+        inters.emplace_back(output_manager);
+
+        inters.front()->inputs_set(static_cast<unsigned int>(running_inputs.size()));
+        for (size_t i = 0; i < inters.size() - 1; ++i) { // Skip the last element
+            inters[i]->connect_to(*inters[i + 1]);
+        }
+        for (ipx_instance_output *output : outputs) {
+            output_manager->connect_to(*output);
+        }
+
+        output_manager->init(iemgr, ipx_verb_level_get());
+        for (size_t i = 0; i < model.inters.size(); ++i) {
+            const ipx_plugin_inter &cfg = model.inters[i];
+            inters[i]->init(cfg.params, iemgr, verbosity_str2level(cfg.verbosity));
+        }
+    }
+
+    IPX_DEBUG(comp_str, "New instances have been successfully initialized.", '\0');
+
+    // Phase 2. Start new output instances and new intermediate instances
+    for (auto &output : outputs_new) {
+        output->start();
+    }
+
+    /* New intermediate instances can process messages immediately, however, the new output
+     * manager must wait until the previous one is terminated (only one writer per output) */
+    for (size_t i = 0; inter_changed && i < inters.size() - 1; ++i) {
+        inters[i]->start();
+    }
+
+    // Phase 3. Connect new instances and disconnect previous ones
+    if (inter_changed) {
+        // Switch parsers to the new chain and terminate the previous one
+        for (auto &input : running_inputs) {
+            input->switch_to(*inters.front());
+        }
+
+        running_outmgr->detach();
+        running_inter.front()->terminate();
+        running_inter.clear(); // Wait for termination of all previous intermediate instances
+        running_outmgr = nullptr;
+    } else {
+        running_outmgr->replace(outputs);
+    }
+
+    // Removed output instances will not receive any new messages
+    std::vector<std::unique_ptr<ipx_instance_output> > outputs_old;
+    for (size_t i = 0; i < running_outputs.size(); ++i) {
+        if (!outputs_kept[i]) {
+            outputs_old.push_back(std::move(running_outputs[i]));
+        }
+    }
+
+    for (auto &output : outputs_old) {
+        output->terminate();
+    }
+    outputs_old.clear(); // Wait for termination
+
+    if (inter_changed) {
+        output_manager->start();
+        running_inter = std::move(inters);
+        running_outmgr = output_manager;
+    }
+
+    // Update the list of running output instances
+    std::vector<std::unique_ptr<ipx_instance_output> > outputs_running;
+    for (ipx_instance_output *output : outputs) {
+        auto it = std::find_if(running_outputs.begin(), running_outputs.end(),
+            [output](const std::unique_ptr<ipx_instance_output> &ptr) {
+                return ptr.get() == output;
+            });
+        if (it != running_outputs.end()) {
+            outputs_running.push_back(std::move(*it));
+            continue;
+        }
+
+        auto it_new = std::find_if(outputs_new.begin(), outputs_new.end(),
+            [output](const std::unique_ptr<ipx_instance_output> &ptr) {
+                return ptr.get() == output;
+            });
+        assert(it_new != outputs_new.end());
+        outputs_running.push_back(std::move(*it_new));
+    }
+
+    running_outputs = std::move(outputs_running);
+    running_model.inters = model.inters;
+    running_model.outputs = model.outputs;
+
+    IPX_INFO(comp_str, "New configuration has been applied (output instances: %zu started, "
+        "%zu kept; intermediate instances: %s).", outputs_new.size(),
+        outputs.size() - outputs_new.size(), inter_changed ? "replaced" : "kept");
 }
 
 void ipx_configurator::stop()
@@ -294,5 +526,7 @@ void ipx_configurator::stop()
     running_inter.clear();
     running_outputs.clear();
 
+    // All messages have been destroyed, destroy remaining retired objects
+    ipx_epoch_flush();
     IPX_DEBUG(comp_str, "All instances successfully terminated.", '\0');
 }
@@ -65,6 +65,8 @@ private:
     uint32_t ring_size;
     /** Directory with definitions of Information Elements                                     */
     std::string iemgr_dir;
+    /** Directory with (Options) Templates preserved by parsers (empty if disabled)            */
+    std::string tmplts_dir;
 
     /** Manager of Information Elements                                                        */
     fds_iemgr_t *iemgr;
@@ -74,10 +76,19 @@ private:
     std::vector<std::unique_ptr<ipx_instance_intermediate> > running_inter;
     /** Vector of running instances of output plugins                                          */
     std::vector<std::unique_ptr<ipx_instance_output> > running_outputs;
+    /** Running output manager (the last element of running intermediate instances)            */
+    ipx_instance_outmgr *running_outmgr;
+    /** Configuration model of running instances                                               */
+    ipx_config_model running_model;
 
     void model_check(const ipx_config_model &model);
     fds_iemgr_t *iemgr_load(const std::string dir);
     enum ipx_verb_level verbosity_str2level(const std::string &verb);
+    std::vector<ipx_instance_intermediate *>
+    output_chain_create(ipx_instance_output *output, const ipx_plugin_output &cfg);
+    void
+    output_chain_init(const std::vector<ipx_instance_intermediate *> &chain,
+        const ipx_plugin_output &cfg);
 
 public:
     /** Minimal size of ring buffers between instances of plugins                              */
@@ -110,6 +121,33 @@ public:
      */
     void start(const ipx_config_model &model);
 
+    /**
+     * \brief Apply a new model to the running configuration
+     *
+     * The new model is compared with the running one and only changed instances of
+     * intermediate and output plugins are stopped/started. Instances of input plugins (together
+     * with their IPFIX parsers, i.e. Transport Sessions and templates) are always kept, so
+     * exporters don't have to resend templates.
+     *
+     * - Output instances with the same name and configuration are kept. Other instances are
+     *   created and removed instances are terminated after their input ring buffers are
+     *   processed. The list of destinations of the output manager is replaced atomically.
+     *   An output instance with a private chain of intermediate instances is kept only if
+     *   the chain is also the same.
+     * - If the chain of intermediate instances is changed, a new chain (including a new output
+     *   manager) is created. Parsers are switched to the new chain and the previous one is
+     *   terminated after all its messages are processed. The new output manager is started
+     *   after the previous one is terminated, so the order of messages is preserved.
+     *
+     * \note Changes of input instances are not applied (a warning is printed). The manager of
+     *   Information Elements is not reloaded.
+     * \param[in] model Configuration model
+     * \throw runtime_error if the model is not valid or new instances cannot be initialized
+     *   (in this case, the running configuration is not changed) or if the new configuration
+     *   fails to start
+     */
+    void reload(const ipx_config_model &model);
+
     /**
      * \brief Stop and destroy all instances of all plugins
      */
@@ -125,6 +163,13 @@ public:
       * \param[in] size Size
       */
      void set_buffer_size(uint32_t size);
+     /**
+      * \brief Define a directory where parsers preserve (Options) Templates across restarts
+      *
+      * Each instance of an input plugin uses its own file named after the instance.
+      * \param[in] path Path (empty string disables the feature)
+      */
+     void tmplts_set_dir(const std::string &path);
 };
 
 #endif //IPFIXCOL_CONFIGURATOR_H
@@ -106,6 +106,13 @@ ipx_instance_input::~ipx_instance_input()
     ipx_ring_destroy(_parser_buffer);
 }
 
+void
+ipx_instance_input::set_tmplts_file(const std::string &path)
+{
+    assert(_state == state::NEW);
+    _tmplts_file = path;
+}
+
 void
 ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level)
 {
@@ -119,7 +126,8 @@ ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ip
     ipx_ctx_iemgr_set(_parser_ctx, iemgr);
 
     // Initialize
-    if (ipx_ctx_init(_parser_ctx, nullptr) != IPX_OK) {
+    const char *parser_params = (_tmplts_file.empty()) ? nullptr : _tmplts_file.c_str();
+    if (ipx_ctx_init(_parser_ctx, parser_params) != IPX_OK) {
         throw std::runtime_error("Failed to initialize the parser of IPFIX Messages!");
     }
 
@@ -163,4 +171,11 @@ ipx_instance_input::connect_to(ipx_instance_intermediate &intermediate)
         ipx_ring_mw_mode(intermediate.get_input(), true);
         ipx_ctx_term_cnt_set(intermediate._ctx, intermediate._inputs_cnt);
     }
-}
\ No newline at end of file
+}
+
+void
+ipx_instance_input::switch_to(ipx_instance_intermediate &intermediate)
+{
+    assert(_state == state::RUNNING);
+    ipx_ctx_ring_dst_switch(_parser_ctx, intermediate.get_input());
+}
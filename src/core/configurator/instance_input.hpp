@@ -89,6 +89,8 @@ protected:
     ipx_ring_t  *_parser_buffer;
     /** Instance of the parser plugin (internal)                                                 */
     ipx_ctx_t   *_parser_ctx;
+    /** File with (Options) Templates of the parser (empty if disabled)                          */
+    std::string  _tmplts_file;
 
     // Disable copy constructors
     ipx_instance_input(const ipx_instance_input &) = delete;
@@ -115,6 +117,16 @@ public:
      */
     ~ipx_instance_input();
 
+    /**
+     * \brief Set a file where the parser preserves (Options) Templates of UDP Transport Sessions
+     *
+     * Templates are loaded from the file during initialization of the instance and saved
+     * periodically and during its destruction.
+     * \note MUST be called before the instance is initialized.
+     * \param[in] path Path to the file (empty string disables the feature)
+     */
+    void set_tmplts_file(const std::string &path);
+
     /**
      * \brief Initialize the instance
      *
@@ -144,6 +156,16 @@ public:
      * \param[in] intermediate Intermediate plugin to receive our messages
      */
     void connect_to(ipx_instance_intermediate &intermediate);
+
+    /**
+     * \brief Connect the running input instance to another instance of an intermediate plugin
+     *
+     * After return, the parser of the instance will never pass a message to the previous
+     * intermediate instance. Template managers and Transport Sessions of the parser are kept.
+     * \note The intermediate instance MUST be prepared by ipx_instance_intermediate::inputs_set().
+     * \param[in] intermediate Intermediate plugin to receive our messages
+     */
+    void switch_to(ipx_instance_intermediate &intermediate);
 };
 
 #endif //IPFIXCOL_INSTANCE_INPUT_HPP
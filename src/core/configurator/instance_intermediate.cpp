@@ -39,8 +39,13 @@
  *
  */
 
+#include <algorithm>
 #include "instance_intermediate.hpp"
 
+extern "C" {
+#include "../message_terminate.h"
+}
+
 /**
  * \brief Internal components initializer
  *
@@ -134,4 +139,37 @@ ipx_instance_intermediate::connect_to(ipx_instance_intermediate &intermediate)
 {
     assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
     ipx_ctx_ring_dst_set(_ctx, intermediate.get_input());
-}
\ No newline at end of file
+}
+
+void
+ipx_instance_intermediate::connect_to(ipx_ring_t *ring)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_ctx_ring_dst_set(_ctx, ring);
+}
+
+void
+ipx_instance_intermediate::inputs_set(unsigned int cnt)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    assert(cnt > 0);
+    _inputs_cnt = cnt;
+    ipx_ring_mw_mode(_instance_buffer, cnt > 1);
+    ipx_ctx_term_cnt_set(_ctx, cnt);
+}
+
+void
+ipx_instance_intermediate::terminate()
+{
+    assert(_state == state::RUNNING); // Only running instances can be terminated
+
+    // The instance waits for a termination message from each input
+    for (unsigned int i = 0; i < std::max(_inputs_cnt, 1U); ++i) {
+        ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+        if (!msg) {
+            throw std::runtime_error("Failed to send a termination request to the intermediate "
+                "instance.");
+        }
+        ipx_ring_push(_instance_buffer, ipx_msg_terminate2base(msg));
+    }
+}
@@ -152,6 +152,33 @@ public:
      * \param[in] intermediate Intermediate plugin to receive our messages
      */
     virtual void connect_to(ipx_instance_intermediate &intermediate);
+
+    /**
+     * \brief Connect the intermediate instance to an input ring buffer of another instance
+     *
+     * Useful for private chains of intermediate instances in front of an output instance.
+     * \param[in] ring Ring buffer to receive our messages
+     */
+    void connect_to(ipx_ring_t *ring);
+
+    /**
+     * \brief Prepare the instance for connection of running input instances
+     *
+     * Set the number of writers to the input ring buffer and the number of termination messages
+     * to wait for. Running input instances can be connected by ipx_instance_input::switch_to().
+     * \param[in] cnt Number of input instances
+     */
+    void inputs_set(unsigned int cnt);
+
+    /**
+     * \brief Send a termination request to a running instance
+     *
+     * The instance processes all messages in its input ring buffer, then it is terminated and
+     * the request is passed to the next instance in the pipeline.
+     * \warning No other instance can write to the input ring buffer anymore!
+     * \throw runtime_error if the request cannot be sent
+     */
+    void terminate();
 };
 
 #endif //IPFIXCOL_INSTANCE_INTERMEDIATE_HPP
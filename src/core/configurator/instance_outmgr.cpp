@@ -112,4 +112,34 @@ ipx_instance_outmgr::connect_to(ipx_instance_output &output)
     if (ipx_output_mgr_list_add(_list, ring, filter_type, filter) != IPX_OK) {
         throw std::runtime_error("Failed to connect an output instance to the output manager!");
     }
-}
\ No newline at end of file
+}
+
+void
+ipx_instance_outmgr::replace(const std::vector<ipx_instance_output *> &outputs)
+{
+    std::unique_ptr<ipx_output_mgr_list_t, decltype(&ipx_output_mgr_list_destroy)> list(
+        ipx_output_mgr_list_create(), &ipx_output_mgr_list_destroy);
+    if (!list) {
+        throw std::runtime_error("Failed to initialize a list of output destinations!");
+    }
+
+    for (ipx_instance_output *output : outputs) {
+        auto connection = output->get_input();
+        ipx_ring_t *ring = std::get<0>(connection);
+        enum ipx_odid_filter_type filter_type = std::get<1>(connection);
+        const ipx_orange_t *filter = std::get<2>(connection);
+
+        if (ipx_output_mgr_list_add(list.get(), ring, filter_type, filter) != IPX_OK) {
+            throw std::runtime_error("Failed to connect an output instance to the output manager!");
+        }
+    }
+
+    // The previous destinations are destroyed together with the temporary list
+    ipx_output_mgr_list_swap(_list, list.get());
+}
+
+void
+ipx_instance_outmgr::detach()
+{
+    ipx_output_mgr_list_detach(_list);
+}
@@ -42,6 +42,7 @@
 #ifndef IPFIXCOL_INSTANCE_OUTMGR_HPP
 #define IPFIXCOL_INSTANCE_OUTMGR_HPP
 
+#include <vector>
 #include "instance_intermediate.hpp"
 #include "instance_output.hpp"
 
@@ -114,6 +115,25 @@ public:
      * \throw runtime_error if creating of the connection fails
      */
     void connect_to(ipx_instance_output &output);
+
+    /**
+     * \brief Replace all connected output instances
+     *
+     * The instances are replaced atomically, i.e. each message is passed either to the previous
+     * or to the new output instances. The function can be used even if the manager is running.
+     * After return, the previous output instances will not receive any new messages.
+     * \param[in] outputs New output instances
+     * \throw runtime_error if the list of output instances cannot be prepared
+     */
+    void replace(const std::vector<ipx_instance_output *> &outputs);
+
+    /**
+     * \brief Do not pass the termination message to connected output instances
+     *
+     * Useful if the manager is going to be terminated, but the output instances will be
+     * connected to another output manager.
+     */
+    void detach();
 };
 
 #endif //IPFIXCOL_INSTANCE_OUTMGR_HPP
@@ -41,6 +41,9 @@
 
 #include "instance_output.hpp"
 
+extern "C" {
+#include "../plugin_output_mgr.h"
+}
 
 ipx_instance_output::ipx_instance_output(const std::string &name,
     ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize) : ipx_instance(name, ref)
@@ -68,6 +71,8 @@ ipx_instance_output::ipx_instance_output(const std::string &name,
 
 ipx_instance_output::~ipx_instance_output()
 {
+    // The private chain passes the termination message to the output, destroy it first
+    _chain.clear();
     // Destroy context (if running, wait for termination of threads)
     ipx_ctx_destroy(_ctx);
     // Now we can destroy buffers
@@ -109,6 +114,18 @@ ipx_instance_output::set_filter(ipx_odid_filter_type type, const std::string &ex
     _filter = filter_wrap.release();
 }
 
+void
+ipx_instance_output::chain_add(std::unique_ptr<ipx_instance_intermediate> inter)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    if (!_chain.empty()) {
+        _chain.back()->connect_to(*inter);
+    }
+
+    inter->connect_to(_instance_buffer);
+    _chain.push_back(std::move(inter));
+}
+
 void ipx_instance_output::init(const std::string &params, const fds_iemgr_t *iemgr,
     ipx_verb_level level)
 {
@@ -134,10 +151,31 @@ ipx_instance_output::start()
         throw std::runtime_error("Failed to start a thread of the output instance.");
     }
     _state = state::RUNNING;
+
+    // Start the private chain from its end, so each instance has a running successor
+    for (auto it = _chain.rbegin(); it != _chain.rend(); ++it) {
+        (*it)->start();
+    }
 }
 
 std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *>
 ipx_instance_output::get_input()
 {
-    return std::make_tuple(_instance_buffer, _type, _filter);
+    ipx_ring_t *ring = (_chain.empty()) ? _instance_buffer : _chain.front()->get_input();
+    return std::make_tuple(ring, _type, _filter);
+}
+
+void
+ipx_instance_output::terminate()
+{
+    assert(_state == state::RUNNING); // Only running instances can be terminated
+    if (!_chain.empty()) {
+        // The request is passed through the chain to the output instance
+        _chain.front()->terminate();
+        return;
+    }
+
+    if (ipx_output_mgr_terminate(_instance_buffer) != IPX_OK) {
+        throw std::runtime_error("Failed to send a termination request to the output instance.");
+    }
 }
@@ -43,7 +43,9 @@
 #define IPFIXCOL_INSTANCE_OUTPUT_HPP
 
 #include <memory>
+#include <vector>
 #include "instance.hpp"
+#include "instance_intermediate.hpp"
 
 extern "C" {
 #include "../odid_range.h"
@@ -59,13 +61,20 @@ using unique_orange = std::unique_ptr<ipx_orange_t, decltype(&ipx_orange_destroy
  * - a plugin context of an output plugin
  * - an input ring buffer
  * - an ODID filter (only if configured)
+ * - an optional private chain of intermediate instances in front of the output instance
+ *
+ * Messages from the output manager are shared by all its destinations (i.e. they are passed
+ * by reference). Therefore, intermediate instances in the private chain must not modify
+ * the messages in place, because other destinations can process them at the same time.
+ * Instead, they can use copy-on-write functions (see ipx_msg_ipfix_cow()).
  *
  * \verbatim
- *              +--------+
- *              |        |
- *       +------> Output |
- *         ring |        |
- *              +--------+
+ *              +-------+           +-------+       +--------+
+ *              |       |           |       |       |        |
+ *       +------> Inter +--> ... ---> Inter +-------> Output |
+ *         ring |       |           |       |  ring |        |
+ *              +-------+           +-------+       +--------+
+ *              (optional private chain)
  * \endverbatim
  */
 class ipx_instance_output : public ipx_instance {
@@ -77,6 +86,8 @@ protected:
     enum ipx_odid_filter_type _type;
     /** ODID filter (nullptr, if type == IPX_ODID_FILTER_NONE                                    */
     ipx_orange_t *_filter;
+    /** Private chain of intermediate instances (the first one receives messages)                */
+    std::vector<std::unique_ptr<ipx_instance_intermediate> > _chain;
 public:
     /**
      * \brief Create an instance of an output plugin
@@ -110,6 +121,17 @@ public:
      */
     void set_filter(ipx_odid_filter_type type, const std::string &expr);
 
+    /**
+     * \brief Append an intermediate instance to the private chain of the output instance
+     *
+     * The output instance takes over the ownership of the intermediate instance and it takes care
+     * of its start, termination and destruction. However, the intermediate instance MUST be
+     * initialized by the caller (after it is added to the chain).
+     * \note Only uninitialized instances can be added.
+     * \param[in] inter Intermediate instance
+     */
+    void chain_add(std::unique_ptr<ipx_instance_intermediate> inter);
+
     /**
      * \brief Initialize the instance
      *
@@ -124,19 +146,32 @@ public:
     void init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level);
 
     /**
-     * \brief Start a thread of the instance
+     * \brief Start a thread of the instance (and threads of the private chain)
      * \throw runtime_error if a thread fails to the start
      */
     void start();
 
     /**
      * \brief Get the input ring buffer (for writing only)
+     *
+     * If the private chain of intermediate instances is defined, the input ring buffer of its
+     * first instance is returned.
      * \warning
      *   Do NOT use if there is already another active writer.
      * \return Pointer to the ring buffer and the ODID filter.
      */
     std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *>
     get_input();
+
+    /**
+     * \brief Send a termination request to a running instance
+     *
+     * The instance (including its private chain) processes all messages in its input ring buffer
+     * and then it is terminated.
+     * \warning The instance MUST be already disconnected from the output manager!
+     * \throw runtime_error if the request cannot be sent
+     */
+    void terminate();
 };
 
 #endif //IPFIXCOL_INSTANCE_OUTPUT_HPP
@@ -88,6 +88,33 @@ ipx_config_model::check_common(struct ipx_plugin_base *base)
     }
 }
 
+/**
+ * \brief Check that the name of an intermediate instance is not used by another one
+ *
+ * Names of intermediate instances must be unique within the common chain and all private chains
+ * of output instances.
+ * \param[in] name Name of the instance
+ */
+void
+ipx_config_model::check_inter_name(const std::string &name)
+{
+    bool found = false;
+    for (const struct ipx_plugin_inter &inter : inters) {
+        found |= (inter.name == name);
+    }
+
+    for (const struct ipx_plugin_output &output : outputs) {
+        for (const struct ipx_plugin_inter &inter : output.inters) {
+            found |= (inter.name == name);
+        }
+    }
+
+    if (found) {
+        throw std::invalid_argument("Multiple intermediate instances with the same <name> '"
+            + name + "' are not allowed!");
+    }
+}
+
 void
 ipx_config_model::add_instance(struct ipx_plugin_input &instance)
 {
@@ -110,15 +137,7 @@ ipx_config_model::add_instance(struct ipx_plugin_inter &instance)
 {
     // Check parameters and name collisions
     check_common(&instance);
-    for (struct ipx_plugin_inter &inter : inters) {
-        if (instance.name != inter.name) {
-            continue;
-        }
-
-        throw std::invalid_argument("Multiple intermediate instances with the same <name> '"
-            + instance.name + "' are not allowed!");
-    }
-
+    check_inter_name(instance.name);
     inters.push_back(instance);
 }
 
@@ -142,6 +161,19 @@ ipx_config_model::add_instance(struct ipx_plugin_output &instance)
             "output instance '" + instance.name + "' cannot be empty!");
     }
 
+    // Check the private chain of intermediate instances
+    for (size_t i = 0; i < instance.inters.size(); ++i) {
+        struct ipx_plugin_inter &inter = instance.inters[i];
+        check_common(&inter);
+        check_inter_name(inter.name);
+        for (size_t j = 0; j < i; ++j) {
+            if (instance.inters[j].name == inter.name) {
+                throw std::invalid_argument("Multiple intermediate instances with the same "
+                    "<name> '" + inter.name + "' are not allowed!");
+            }
+        }
+    }
+
     outputs.push_back(instance);
 }
 
@@ -176,6 +208,9 @@ ipx_config_model::dump()
     std::cout << "Output plugins:\n";
     for (auto &out : outputs) {
         std::cout << "\t- " << out.plugin << " / " << out.name << "\n";
+        for (auto &inter : out.inters) {
+            std::cout << "\t\t<- " << inter.plugin << " / " << inter.name << "\n";
+        }
     }
 
     if (outputs.empty()) {
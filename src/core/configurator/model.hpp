@@ -61,6 +61,19 @@ struct ipx_plugin_base {
     std::string verbosity;
 };
 
+/**
+ * \brief Compare common configuration parameters
+ * \param[in] lhs First configuration
+ * \param[in] rhs Second configuration
+ * \return True if the configurations are the same
+ */
+inline bool
+operator==(const ipx_plugin_base &lhs, const ipx_plugin_base &rhs)
+{
+    return lhs.plugin == rhs.plugin && lhs.name == rhs.name && lhs.params == rhs.params
+        && lhs.verbosity == rhs.verbosity;
+}
+
 /** Configuration of an input plugin                                          */
 struct ipx_plugin_input  : ipx_plugin_base {};
 
@@ -73,8 +86,27 @@ struct ipx_plugin_output : ipx_plugin_base {
     enum ipx_odid_filter_type odid_type;
     /** ODID filter expression                                                */
     std::string odid_expression;
+    /** Private chain of intermediate instances (only for this output)        */
+    std::vector<struct ipx_plugin_inter> inters;
 };
 
+/**
+ * \brief Compare configurations of output instances
+ * \param[in] lhs First configuration
+ * \param[in] rhs Second configuration
+ * \return True if the configurations are the same
+ */
+inline bool
+operator==(const ipx_plugin_output &lhs, const ipx_plugin_output &rhs)
+{
+    if (!(static_cast<const ipx_plugin_base &>(lhs) == static_cast<const ipx_plugin_base &>(rhs))
+            || lhs.odid_type != rhs.odid_type || lhs.inters != rhs.inters) {
+        return false;
+    }
+
+    return lhs.odid_type == IPX_ODID_FILTER_NONE || lhs.odid_expression == rhs.odid_expression;
+}
+
 /** Parsed configuration of the collector                                      */
 class ipx_config_model {
     friend class ipx_configurator;
@@ -87,6 +119,7 @@ private:
     std::vector<struct ipx_plugin_output> outputs;
 
     void check_common(struct ipx_plugin_base *base);
+    void check_inter_name(const std::string &name);
 public:
     ipx_config_model() = default;
     ~ipx_config_model() = default;
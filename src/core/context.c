@@ -45,12 +45,14 @@
 #include <errno.h>
 #include <signal.h>
 #include <sys/prctl.h>
+#include <unistd.h>
 
 #include "context.h"
 #include "verbose.h"
 #include "utils.h"
 #include "fpipe.h"
 #include "ring.h"
+#include "epoch.h"
 #include "message_ipfix.h"
 
 /** Identification of this component (for log) */
@@ -74,6 +76,83 @@ enum ipx_ctx_state {
     IPX_CS_RUNNING
 };
 
+/** Number of in-flight messages per worker thread of a parallel intermediate instance        */
+#define IPX_CTX_PAR_SLOTS_PER_WORKER 4U
+
+/**
+ * \brief Position of a message in the reordering buffer of a parallel intermediate instance
+ */
+struct ipx_ctx_par_slot {
+    /** Input message                                                                            */
+    ipx_msg_t *msg;
+    /** Pass the message to the processing callback (otherwise just forward it)                  */
+    bool process;
+    /** The message has been processed and messages of the slot are ready to be passed          */
+    bool done;
+
+    /** Messages passed by the instance while processing the input message (in order)          */
+    ipx_msg_t **out;
+    /** Number of valid messages in the array                                                    */
+    size_t out_cnt;
+    /** Allocated size of the array                                                              */
+    size_t out_max;
+};
+
+/**
+ * \brief Worker thread of a parallel intermediate instance
+ */
+struct ipx_ctx_par_worker {
+    /** Context of the instance                                                                  */
+    struct ipx_ctx *ctx;
+    /** Index of the worker                                                                      */
+    unsigned int id;
+    /** Thread identification                                                                    */
+    pthread_t thread_id;
+    /** Slot of a message that is being processed (NULL if none)                                 */
+    struct ipx_ctx_par_slot *slot;
+};
+
+/**
+ * \brief Worker pool of a parallel intermediate instance
+ *
+ * Messages are processed by worker threads in any order, however, messages passed by the
+ * instance are always forwarded in the same order as input messages have been received.
+ * All counters below are monotonic indexes to the circular array of slots.
+ */
+struct ipx_ctx_par {
+    /** Worker threads                                                                           */
+    struct ipx_ctx_par_worker *workers;
+    /** Number of workers                                                                        */
+    unsigned int workers_cnt;
+
+    /** Circular buffer of slots                                                                 */
+    struct ipx_ctx_par_slot *slots;
+    /** Number of slots                                                                          */
+    uint64_t slots_cnt;
+    /** Index of the next slot to submit                                                         */
+    uint64_t idx_submit;
+    /** Index of the next slot to process                                                        */
+    uint64_t idx_take;
+    /** Index of the next slot to forward                                                        */
+    uint64_t idx_emit;
+    /** Request to stop workers                                                                  */
+    bool stop;
+
+    /** Mutex of the pool                                                                        */
+    pthread_mutex_t lock;
+    /** Condition variable signalling a new message to process (or stop request)                 */
+    pthread_cond_t cond_work;
+    /** Condition variable signalling a forwarded slot                                           */
+    pthread_cond_t cond_space;
+};
+
+/** Worker of a parallel intermediate instance running in the current thread (if any)          */
+static __thread struct ipx_ctx_par_worker *par_worker_current = NULL;
+/** Number of running input instances that can still provide data (atomic)                     */
+static unsigned int inputs_active = 0;
+/** Delay between checks of the feedback pipe of an input instance without data                 */
+static const struct timespec input_idle_delay = {0, 10000000}; // 10ms
+
 /**
  * \brief Context a plugin instance
  */
@@ -115,6 +194,12 @@ struct ipx_ctx {
          * \note NULL for output plugins
          */
         ipx_ring_t *dst;
+        /**
+         * Lock of the destination of a running intermediate instance
+         * \note Held by the instance thread while processing a message, so the destination
+         *   can be replaced by ipx_ctx_ring_dst_switch().
+         */
+        pthread_mutex_t dst_lock;
     } pipeline; /**< Connection to internal communication pipeline                               */
 
     struct {
@@ -149,7 +234,15 @@ struct ipx_ctx {
          * the input plugins MUST have the value corresponding to the number of input instances.
          */
         unsigned int term_msg_cnt;
+        /**
+         * Number of worker threads processing messages of an intermediate instance in parallel.
+         * Value 1 means that messages are processed by the instance thread.
+         */
+        unsigned int workers_cnt;
     } cfg_system; /**< System configuration                                                      */
+
+    /** Worker pool of a parallel intermediate instance (NULL if not running)                    */
+    struct ipx_ctx_par *par;
 };
 
 ipx_ctx_t *
@@ -166,6 +259,12 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
         return NULL;
     }
 
+    if (pthread_mutex_init(&ctx->pipeline.dst_lock, NULL) != 0) {
+        free(ctx->name);
+        free(ctx);
+        return NULL;
+    }
+
     ctx->type = 0;           // Undefined type
     ctx->permissions = 0;    // No permissions
     ctx->plugin_cbs = callbacks;
@@ -176,6 +275,7 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
     ctx->cfg_system.msg_mask_selected = 0; // No messages to process selected
     ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     ctx->cfg_system.term_msg_cnt = 1; // By default, wait for 1 termination message
+    ctx->cfg_system.workers_cnt = 1; // By default, process messages by the instance thread
 
     if (callbacks == NULL) {
         // Dummy context for testing
@@ -215,6 +315,7 @@ ipx_ctx_destroy(ipx_ctx_t *ctx)
         ctx->pipeline.dst = tmp;
     }
 
+    pthread_mutex_destroy(&ctx->pipeline.dst_lock);
     free(ctx->name);
     free(ctx);
 }
@@ -290,6 +391,71 @@ ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t
     return IPX_OK;
 }
 
+int
+ipx_ctx_parallel_set(ipx_ctx_t *ctx, unsigned int workers)
+{
+    if (ctx->state != IPX_CS_NEW || ctx->plugin_cbs == NULL
+            || ctx->plugin_cbs->info->type != IPX_PT_INTERMEDIATE) {
+        IPX_CTX_DEBUG(ctx, "Called ipx_ctx_parallel_set() but the instance is not an "
+            "Intermediate plugin being initialized!", '\0');
+        return IPX_ERR_ARG;
+    }
+
+    if (workers == 0) {
+        return IPX_ERR_ARG;
+    }
+
+    ctx->cfg_system.workers_cnt = workers;
+    return IPX_OK;
+}
+
+unsigned int
+ipx_ctx_parallel_id(const ipx_ctx_t *ctx)
+{
+    const struct ipx_ctx_par_worker *worker = par_worker_current;
+    if (worker == NULL || worker->ctx != ctx) {
+        return 0;
+    }
+
+    return worker->id;
+}
+
+/**
+ * \brief Store a message passed by a worker of a parallel intermediate instance
+ *
+ * The message is added to the slot of the input message which is being processed by the worker
+ * and it will be forwarded as soon as all preceding slots are forwarded.
+ * \param[in] ctx    Instance context
+ * \param[in] worker Current worker
+ * \param[in] msg    Message to pass
+ */
+static void
+par_msg_store(struct ipx_ctx *ctx, struct ipx_ctx_par_worker *worker, ipx_msg_t *msg)
+{
+    struct ipx_ctx_par_slot *slot = worker->slot;
+    if (slot->out_cnt == slot->out_max) {
+        const size_t new_max = 2 * slot->out_max;
+        ipx_msg_t **new_out = realloc(slot->out, new_max * sizeof(*new_out));
+        if (!new_out) {
+            /* Forward the message immediately. The order of messages is not preserved, but it is
+             * still better than losing the message.
+             */
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            struct ipx_ctx_par *par = ctx->par;
+            pthread_mutex_lock(&par->lock);
+            ipx_ring_push(ctx->pipeline.dst, msg);
+            pthread_mutex_unlock(&par->lock);
+            return;
+        }
+
+        slot->out = new_out;
+        slot->out_max = new_max;
+    }
+
+    // The slot is owned by the worker, no lock is required
+    slot->out[slot->out_cnt++] = msg;
+}
+
 int
 ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
 {
@@ -300,6 +466,26 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
         return IPX_ERR_ARG;
     }
 
+    if (ipx_msg_get_type(msg) == IPX_MSG_GARBAGE && ctx->pipeline.dst != NULL) {
+        /* Garbage is not passed through the pipeline anymore. It is destroyed as soon as all
+         * messages that could reference it are destroyed.
+         */
+        ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_msg_garbage_destroy;
+        if (ipx_epoch_retire(msg, cb) == IPX_OK) {
+            return IPX_OK;
+        }
+
+        // Pass the message as usual (it will be destroyed by the last output instance)
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+
+    struct ipx_ctx_par_worker *worker = par_worker_current;
+    if (worker != NULL && worker->ctx == ctx && worker->slot != NULL) {
+        // Called by a worker of a parallel instance -> preserve the order of messages
+        par_msg_store(ctx, worker, msg);
+        return IPX_OK;
+    }
+
     if (!ctx->pipeline.dst) {
         /* Plugin has permission but the successor is not connected. This can happen only if
          * the destructor is called immediately after initialization without prepared pipeline ->
@@ -357,6 +543,15 @@ ipx_ctx_ring_dst_set(ipx_ctx_t *ctx, ipx_ring_t *ring)
     ctx->pipeline.dst = ring;
 }
 
+void
+ipx_ctx_ring_dst_switch(ipx_ctx_t *ctx, ipx_ring_t *ring)
+{
+    // Wait until the instance finishes processing of the current message
+    pthread_mutex_lock(&ctx->pipeline.dst_lock);
+    ctx->pipeline.dst = ring;
+    pthread_mutex_unlock(&ctx->pipeline.dst_lock);
+}
+
 
 // -------------------------------------------------------------------------------------------------
 
@@ -695,6 +890,7 @@ thread_input(void *arg)
     IPX_CTX_DEBUG(ctx, "Instance thread of the input plugin '%s' has started!", plugin_name);
 
     bool terminate = false;
+    bool finished = false; // the plugin cannot provide more data
 
     while (!terminate) {
         int rc = thread_input_process_pipe(ctx);
@@ -704,8 +900,35 @@ thread_input(void *arg)
             continue;
         }
 
+        if (finished) {
+            // Just wait for the request to destroy the instance
+            nanosleep(&input_idle_delay, NULL);
+            continue;
+        }
+
         // Try to get a new IPFIX message
-        ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private); // TODO: check return value
+        rc = ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private);
+        if (rc != IPX_ERR_EOF && rc != IPX_ERR_DENIED) {
+            continue;
+        }
+
+        finished = true;
+        if (rc == IPX_ERR_EOF) {
+            IPX_CTX_INFO(ctx, "The instance has reached the end of data.", '\0');
+        } else {
+            IPX_CTX_ERROR(ctx, "The instance has failed and it will not provide any data.", '\0');
+        }
+
+        if (__atomic_sub_fetch(&inputs_active, 1U, __ATOMIC_SEQ_CST) == 0) {
+            // The last input instance -> request termination of the collector
+            IPX_CTX_INFO(ctx, "No more data can be provided by any input instance. "
+                "Terminating the collector...", '\0');
+            kill(getpid(), SIGTERM);
+        }
+    }
+
+    if (!finished) {
+        __atomic_sub_fetch(&inputs_active, 1U, __ATOMIC_SEQ_CST);
     }
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the input plugin '%s' has been terminated!",
@@ -713,6 +936,244 @@ thread_input(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Forward messages of processed slots (in order)
+ *
+ * Messages of the slots are pushed to the output ring buffer until the first slot that has not
+ * been processed yet.
+ * \warning The mutex of the pool MUST be locked by the caller.
+ * \param[in] ctx Instance context
+ */
+static void
+par_emit(struct ipx_ctx *ctx)
+{
+    struct ipx_ctx_par *par = ctx->par;
+
+    while (par->idx_emit != par->idx_take) {
+        struct ipx_ctx_par_slot *slot = &par->slots[par->idx_emit % par->slots_cnt];
+        if (!slot->done) {
+            break;
+        }
+
+        for (size_t i = 0; i < slot->out_cnt; ++i) {
+            ipx_ring_push(ctx->pipeline.dst, slot->out[i]);
+        }
+
+        slot->msg = NULL;
+        slot->out_cnt = 0;
+        slot->done = false;
+        par->idx_emit++;
+        pthread_cond_broadcast(&par->cond_space);
+    }
+}
+
+/**
+ * \brief Worker thread of a parallel intermediate instance
+ *
+ * Infinite loop that takes messages from the reordering buffer, processes them and forwards
+ * them in the original order.
+ * \param[in] arg Worker description
+ * \return NULL
+ */
+static void *
+thread_intermediate_worker(void *arg)
+{
+    struct ipx_ctx_par_worker *worker = (struct ipx_ctx_par_worker *) arg;
+    struct ipx_ctx *ctx = worker->ctx;
+    struct ipx_ctx_par *par = ctx->par;
+    thread_set_name(ctx->name);
+    par_worker_current = worker;
+
+    pthread_mutex_lock(&par->lock);
+    while (true) {
+        while (!par->stop && par->idx_take == par->idx_submit) {
+            pthread_cond_wait(&par->cond_work, &par->lock);
+        }
+
+        if (par->idx_take == par->idx_submit) {
+            // Stop request and nothing to process
+            break;
+        }
+
+        struct ipx_ctx_par_slot *slot = &par->slots[par->idx_take % par->slots_cnt];
+        par->idx_take++;
+        pthread_mutex_unlock(&par->lock);
+
+        if (slot->process) {
+            worker->slot = slot;
+            // New messages can share objects with the processed one -> inherit its epoch
+            ipx_epoch_pin(ipx_msg_header_epoch(slot->msg));
+            ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, slot->msg); // TODO:check return value
+            ipx_epoch_unpin();
+            worker->slot = NULL;
+        } else {
+            // Not processed by the instance, just pass the message
+            slot->out[0] = slot->msg;
+            slot->out_cnt = 1;
+        }
+
+        pthread_mutex_lock(&par->lock);
+        slot->done = true;
+        par_emit(ctx);
+    }
+    pthread_mutex_unlock(&par->lock);
+
+    par_worker_current = NULL;
+    return NULL;
+}
+
+/**
+ * \brief Destroy a worker pool of a parallel intermediate instance
+ *
+ * All running workers are stopped after all submitted messages are processed and forwarded.
+ * \param[in] ctx     Instance context
+ * \param[in] running Number of running workers
+ */
+static void
+par_destroy(struct ipx_ctx *ctx, unsigned int running)
+{
+    struct ipx_ctx_par *par = ctx->par;
+
+    pthread_mutex_lock(&par->lock);
+    par->stop = true;
+    pthread_cond_broadcast(&par->cond_work);
+    pthread_mutex_unlock(&par->lock);
+
+    for (unsigned int i = 0; i < running; ++i) {
+        int rc = pthread_join(par->workers[i].thread_id, NULL);
+        if (rc != 0) {
+            const char *err_str;
+            ipx_strerror(rc, err_str);
+            IPX_CTX_WARNING(ctx, "pthread_join() failed: %s", err_str);
+        }
+    }
+
+    assert(par->idx_emit == par->idx_submit);
+    for (uint64_t i = 0; i < par->slots_cnt; ++i) {
+        free(par->slots[i].out);
+    }
+
+    pthread_cond_destroy(&par->cond_space);
+    pthread_cond_destroy(&par->cond_work);
+    pthread_mutex_destroy(&par->lock);
+    free(par->slots);
+    free(par->workers);
+    free(par);
+    ctx->par = NULL;
+}
+
+/**
+ * \brief Create a worker pool of a parallel intermediate instance and start its workers
+ * \param[in] ctx Instance context
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM or #IPX_ERR_DENIED on failure (the pool is not running)
+ */
+static int
+par_create(struct ipx_ctx *ctx)
+{
+    const unsigned int workers_cnt = ctx->cfg_system.workers_cnt;
+    struct ipx_ctx_par *par = calloc(1, sizeof(*par));
+    if (!par) {
+        return IPX_ERR_NOMEM;
+    }
+
+    par->workers_cnt = workers_cnt;
+    par->slots_cnt = (uint64_t) workers_cnt * IPX_CTX_PAR_SLOTS_PER_WORKER;
+    par->workers = calloc(workers_cnt, sizeof(*par->workers));
+    par->slots = calloc(par->slots_cnt, sizeof(*par->slots));
+    if (!par->workers || !par->slots) {
+        free(par->workers);
+        free(par->slots);
+        free(par);
+        return IPX_ERR_NOMEM;
+    }
+
+    for (uint64_t i = 0; i < par->slots_cnt; ++i) {
+        struct ipx_ctx_par_slot *slot = &par->slots[i];
+        slot->out_max = 2; // Usually just the processed message (garbage is retired immediately)
+        slot->out = malloc(slot->out_max * sizeof(*slot->out));
+        if (slot->out != NULL) {
+            continue;
+        }
+
+        for (uint64_t x = 0; x < i; ++x) {
+            free(par->slots[x].out);
+        }
+        free(par->slots);
+        free(par->workers);
+        free(par);
+        return IPX_ERR_NOMEM;
+    }
+
+    pthread_mutex_init(&par->lock, NULL);
+    pthread_cond_init(&par->cond_work, NULL);
+    pthread_cond_init(&par->cond_space, NULL);
+    ctx->par = par;
+
+    for (unsigned int i = 0; i < workers_cnt; ++i) {
+        struct ipx_ctx_par_worker *worker = &par->workers[i];
+        worker->ctx = ctx;
+        worker->id = i;
+
+        int rc = pthread_create(&worker->thread_id, NULL, &thread_intermediate_worker, worker);
+        if (rc != 0) {
+            const char *err_str;
+            ipx_strerror(rc, err_str);
+            IPX_CTX_ERROR(ctx, "Failed to start a worker thread. pthread_create() failed: %s",
+                err_str);
+            par_destroy(ctx, i);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Submit a message to the worker pool of a parallel intermediate instance
+ *
+ * The function blocks if the reordering buffer is full.
+ * \param[in] ctx     Instance context
+ * \param[in] msg     Message
+ * \param[in] process Pass the message to the processing callback of the instance
+ */
+static void
+par_submit(struct ipx_ctx *ctx, ipx_msg_t *msg, bool process)
+{
+    struct ipx_ctx_par *par = ctx->par;
+
+    pthread_mutex_lock(&par->lock);
+    while (par->idx_submit - par->idx_emit == par->slots_cnt) {
+        pthread_cond_wait(&par->cond_space, &par->lock);
+    }
+
+    struct ipx_ctx_par_slot *slot = &par->slots[par->idx_submit % par->slots_cnt];
+    slot->msg = msg;
+    slot->process = process;
+    slot->done = false;
+    slot->out_cnt = 0;
+    par->idx_submit++;
+
+    pthread_cond_signal(&par->cond_work);
+    pthread_mutex_unlock(&par->lock);
+}
+
+/**
+ * \brief Wait until all submitted messages are processed and forwarded
+ * \param[in] ctx Instance context
+ */
+static void
+par_flush(struct ipx_ctx *ctx)
+{
+    struct ipx_ctx_par *par = ctx->par;
+
+    pthread_mutex_lock(&par->lock);
+    while (par->idx_emit != par->idx_submit) {
+        pthread_cond_wait(&par->cond_space, &par->lock);
+    }
+    pthread_mutex_unlock(&par->lock);
+}
+
 /**
  * \brief Intermediate instance control thread
  *
@@ -731,6 +1192,16 @@ thread_intermediate(void *arg)
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has started!", plugin_name);
 
+    if (ctx->type == IPX_PT_INTERMEDIATE && ctx->cfg_system.workers_cnt > 1) {
+        if (par_create(ctx) == IPX_OK) {
+            IPX_CTX_INFO(ctx, "Processing messages by %u worker threads.",
+                ctx->cfg_system.workers_cnt);
+        } else {
+            IPX_CTX_WARNING(ctx, "Failed to start worker threads. Messages will be processed "
+                "by the instance thread!", '\0');
+        }
+    }
+
     ipx_msg_t *msg_ptr;
     enum ipx_msg_type msg_type;
 
@@ -743,6 +1214,9 @@ thread_intermediate(void *arg)
         msg_type = ipx_msg_get_type(msg_ptr);
         bool processed = false; // only not processed messages are automatically passed
 
+        // The destination cannot be replaced during processing of the message
+        pthread_mutex_lock(&ctx->pipeline.dst_lock);
+
         if (msg_type == IPX_MSG_TERMINATE) {
             ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
             enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
@@ -752,6 +1226,7 @@ thread_intermediate(void *arg)
                 IPX_CTX_DEBUG(ctx, "Termination message dropped. Waiting for %u remaining input "
                     "plugin(s) to terminate.", ctx->cfg_system.term_msg_cnt);
                 ipx_msg_termiante_destroy(terminate_msg);
+                pthread_mutex_unlock(&ctx->pipeline.dst_lock);
                 continue;
             }
 
@@ -762,10 +1237,22 @@ thread_intermediate(void *arg)
             }
         }
 
+        if (ctx->par != NULL) {
+            // Parallel processing (the order of messages is preserved by the worker pool)
+            if (terminate != true) {
+                bool process = process_en && (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+                par_submit(ctx, msg_ptr, process);
+                pthread_mutex_unlock(&ctx->pipeline.dst_lock);
+            }
+            continue;
+        }
+
         if ((process_en && (msg_type & ctx->cfg_system.msg_mask_selected) != 0)
                 || ctx->type == IPX_PT_OUTPUT_MGR) { // Always pass all messages to the output manager
-            // Process the message
+            // Process the message (new messages inherit its epoch as they can share objects)
+            ipx_epoch_pin(ipx_msg_header_epoch(msg_ptr));
             ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr); // TODO:check return value
+            ipx_epoch_unpin();
             processed = true;
         }
 
@@ -776,6 +1263,17 @@ thread_intermediate(void *arg)
             assert(ctx->type != IPX_PT_OUTPUT_MGR);
             ipx_ring_push(ctx->pipeline.dst, msg_ptr);
         }
+
+        if (!terminate) {
+            // Otherwise the lock is held until the termination message is passed
+            pthread_mutex_unlock(&ctx->pipeline.dst_lock);
+        }
+    }
+
+    if (ctx->par != NULL) {
+        // Forward all submitted messages and stop workers
+        par_flush(ctx);
+        par_destroy(ctx, ctx->par->workers_cnt);
     }
 
     // Destroy the instance (usually produce garbage messages)
@@ -788,6 +1286,7 @@ thread_intermediate(void *arg)
         // All intermediate plugins (except the output manager) have to pass the message here
         ipx_ring_push(ctx->pipeline.dst, msg_ptr);
     }
+    pthread_mutex_unlock(&ctx->pipeline.dst_lock);
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has been terminated!",
         plugin_name);
@@ -837,11 +1336,8 @@ thread_output(void *arg)
             }
         }
 
-        // Decrement the counter - DO NOT TOUCH the message from this point beyond
-        if (ipx_msg_header_cnt_dec(msg_ptr)) {
-            // This instance is the last user, destroy it
-            ipx_msg_destroy(msg_ptr);
-        }
+        // Release the reference (the last user destroys it) - DO NOT TOUCH the message anymore
+        ipx_msg_destroy(msg_ptr);
     }
 
     // Destroy the instance
@@ -885,6 +1381,9 @@ ipx_ctx_run(ipx_ctx_t *ctx)
     sigfillset(&set_new);
     pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
     ctx->state = IPX_CS_RUNNING;
+    if (ctx->type == IPX_PT_INPUT) {
+        __atomic_add_fetch(&inputs_active, 1U, __ATOMIC_SEQ_CST);
+    }
 
     // Start the thread
     int rc = pthread_create(&ctx->thread_id, NULL, thread_func, ctx);
@@ -893,6 +1392,9 @@ ipx_ctx_run(ipx_ctx_t *ctx)
     pthread_sigmask(SIG_SETMASK, &set_old, NULL);
 
     if (rc != 0) {
+        if (ctx->type == IPX_PT_INPUT) {
+            __atomic_sub_fetch(&inputs_active, 1U, __ATOMIC_SEQ_CST);
+        }
         const char *err_str;
         ipx_strerror(rc, err_str);
         IPX_CTX_ERROR(ctx, "Failed to start a instance thread. pthread_create() failed: %s",
@@ -223,6 +223,18 @@ ipx_ctx_ring_src_set(ipx_ctx_t *ctx, ipx_ring_t *ring);
 IPX_API void
 ipx_ctx_ring_dst_set(ipx_ctx_t *ctx, ipx_ring_t *ring);
 
+/**
+ * \brief Replace the destination ring buffer of a running intermediate instance
+ *
+ * The function waits until the instance finishes processing of the current message (if any),
+ * so after return the instance will never write to the previous ring buffer again.
+ * \warning Only for intermediate instances without parallel workers (e.g. the IPFIX parser)!
+ * \param[in] ctx  Plugin context
+ * \param[in] ring New destination ring buffer
+ */
+IPX_API void
+ipx_ctx_ring_dst_switch(ipx_ctx_t *ctx, ipx_ring_t *ring);
+
 /**
  * \brief Set a reference to a manager of Information Elements
  * \param[in] ctx Plugin context
@@ -0,0 +1,312 @@
+/**
+ * \file src/core/epoch.c
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Epoch based reclamation of shared objects (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "epoch.h"
+
+/**
+ * Number of epochs that can exist at the same time (must be a power of two)
+ *
+ * If all slots are occupied (i.e. the oldest epoch is still referenced), the current epoch is
+ * not advanced and newly retired objects are added to it.
+ */
+#define EPOCH_SLOTS (64U)
+
+/** Retired object */
+struct epoch_garbage {
+    /** Next object in the list */
+    struct epoch_garbage *next;
+    /** Object to destroy       */
+    void *object;
+    /** Destruction callback    */
+    ipx_msg_garbage_cb cb;
+};
+
+/** Slot of an epoch */
+struct epoch_slot {
+    /** Number of references (atomic)                       */
+    uint64_t refs;
+    /** First retired object (the oldest one, atomic read)  */
+    struct epoch_garbage *head;
+    /** Last retired object                                 */
+    struct epoch_garbage *tail;
+};
+
+/** Global epoch domain */
+static struct {
+    /** Lock of the domain (required for modification of epochs and retired objects) */
+    pthread_mutex_t lock;
+    /** Current epoch (atomic read)                                                  */
+    uint64_t current;
+    /** Oldest not reclaimed epoch (atomic read)                                     */
+    uint64_t oldest;
+    /** Slots of epochs (epoch X is stored in the slot X % EPOCH_SLOTS)              */
+    struct epoch_slot slots[EPOCH_SLOTS];
+} epoch_domain = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .current = 0,
+    .oldest = 0
+};
+
+/** Epoch pinned to the thread */
+static __thread uint64_t epoch_pinned = IPX_EPOCH_NONE;
+
+/**
+ * \brief Get the slot of an epoch
+ * \param[in] epoch Epoch
+ * \return Pointer to the slot
+ */
+static inline struct epoch_slot *
+epoch_slot(uint64_t epoch)
+{
+    return &epoch_domain.slots[epoch % EPOCH_SLOTS];
+}
+
+/**
+ * \brief Destroy a list of retired objects
+ * \param[in] list First object of the list
+ */
+static void
+epoch_garbage_destroy(struct epoch_garbage *list)
+{
+    while (list != NULL) {
+        struct epoch_garbage *next = list->next;
+        if (list->cb != NULL) {
+            list->cb(list->object);
+        }
+        free(list);
+        list = next;
+    }
+}
+
+/**
+ * \brief Try to close the current epoch (i.e. advance the current epoch)
+ *
+ * \warning The lock of the domain MUST be held by the caller.
+ * \return True on success
+ * \return False if the slot of the next epoch is not available
+ */
+static bool
+epoch_advance(void)
+{
+    const uint64_t next = epoch_domain.current + 1;
+    if (next - epoch_domain.oldest >= EPOCH_SLOTS) {
+        // The slot is still occupied by the oldest epoch
+        return false;
+    }
+
+    if (__atomic_load_n(&epoch_slot(next)->refs, __ATOMIC_SEQ_CST) != 0) {
+        // A stale reference of a thread that is just retrying ipx_epoch_enter()
+        return false;
+    }
+
+    __atomic_store_n(&epoch_domain.current, next, __ATOMIC_SEQ_CST);
+    return true;
+}
+
+/**
+ * \brief Detach retired objects of all closed epochs without references
+ *
+ * If the current epoch has retired objects, it is closed first. Detached objects should be
+ * destroyed by the caller after the lock is released, because destruction callbacks can
+ * retire other objects.
+ * \warning The lock of the domain MUST be held by the caller.
+ * \return List of objects to destroy (can be NULL)
+ */
+static struct epoch_garbage *
+epoch_reclaim(void)
+{
+    struct epoch_garbage *list_head = NULL;
+    struct epoch_garbage *list_tail = NULL;
+
+    while (true) {
+        const uint64_t oldest = epoch_domain.oldest;
+        struct epoch_slot *slot = epoch_slot(oldest);
+
+        if (oldest == epoch_domain.current) {
+            // The current epoch cannot be reclaimed, try to close it
+            if (slot->head == NULL || !epoch_advance()) {
+                break;
+            }
+            continue;
+        }
+
+        if (__atomic_load_n(&slot->refs, __ATOMIC_SEQ_CST) != 0) {
+            // Still referenced
+            break;
+        }
+
+        if (slot->head != NULL) {
+            if (list_tail != NULL) {
+                list_tail->next = slot->head;
+            } else {
+                list_head = slot->head;
+            }
+            list_tail = slot->tail;
+            __atomic_store_n(&slot->head, NULL, __ATOMIC_SEQ_CST);
+            slot->tail = NULL;
+        }
+
+        __atomic_store_n(&epoch_domain.oldest, oldest + 1, __ATOMIC_SEQ_CST);
+    }
+
+    return list_head;
+}
+
+uint64_t
+ipx_epoch_enter()
+{
+    uint64_t epoch = epoch_pinned;
+    if (epoch != IPX_EPOCH_NONE) {
+        // The epoch is referenced by the caller, so it cannot be reclaimed in the meantime
+        __atomic_add_fetch(&epoch_slot(epoch)->refs, 1, __ATOMIC_SEQ_CST);
+        return epoch;
+    }
+
+    while (true) {
+        epoch = __atomic_load_n(&epoch_domain.current, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&epoch_slot(epoch)->refs, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&epoch_domain.oldest, __ATOMIC_SEQ_CST) <= epoch) {
+            // The epoch has not been reclaimed before the reference was added
+            return epoch;
+        }
+
+        // The epoch has been closed and reclaimed in the meantime, try again
+        __atomic_sub_fetch(&epoch_slot(epoch)->refs, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void
+ipx_epoch_leave(uint64_t epoch)
+{
+    if (epoch == IPX_EPOCH_NONE) {
+        return;
+    }
+
+    if (__atomic_sub_fetch(&epoch_slot(epoch)->refs, 1, __ATOMIC_SEQ_CST) != 0) {
+        return;
+    }
+
+    if (epoch != __atomic_load_n(&epoch_domain.oldest, __ATOMIC_SEQ_CST)) {
+        // Nothing to reclaim, younger epochs are reclaimed after the oldest one
+        return;
+    }
+
+    if (epoch == __atomic_load_n(&epoch_domain.current, __ATOMIC_SEQ_CST)
+            && __atomic_load_n(&epoch_slot(epoch)->head, __ATOMIC_SEQ_CST) == NULL) {
+        // The current epoch without retired objects
+        return;
+    }
+
+    pthread_mutex_lock(&epoch_domain.lock);
+    struct epoch_garbage *list = epoch_reclaim();
+    pthread_mutex_unlock(&epoch_domain.lock);
+    epoch_garbage_destroy(list);
+}
+
+void
+ipx_epoch_pin(uint64_t epoch)
+{
+    epoch_pinned = epoch;
+}
+
+void
+ipx_epoch_unpin()
+{
+    epoch_pinned = IPX_EPOCH_NONE;
+}
+
+int
+ipx_epoch_retire(void *object, ipx_msg_garbage_cb cb)
+{
+    struct epoch_garbage *garbage = malloc(sizeof(*garbage));
+    if (!garbage) {
+        return IPX_ERR_NOMEM;
+    }
+
+    garbage->next = NULL;
+    garbage->object = object;
+    garbage->cb = cb;
+
+    pthread_mutex_lock(&epoch_domain.lock);
+    struct epoch_slot *slot = epoch_slot(epoch_domain.current);
+    if (slot->tail != NULL) {
+        slot->tail->next = garbage;
+    } else {
+        __atomic_store_n(&slot->head, garbage, __ATOMIC_SEQ_CST);
+    }
+    slot->tail = garbage;
+
+    struct epoch_garbage *list = epoch_reclaim();
+    pthread_mutex_unlock(&epoch_domain.lock);
+    epoch_garbage_destroy(list);
+    return IPX_OK;
+}
+
+void
+ipx_epoch_flush()
+{
+    struct epoch_garbage *list_head = NULL;
+    struct epoch_garbage *list_tail = NULL;
+
+    pthread_mutex_lock(&epoch_domain.lock);
+    for (uint64_t epoch = epoch_domain.oldest; epoch <= epoch_domain.current; ++epoch) {
+        struct epoch_slot *slot = epoch_slot(epoch);
+        if (slot->head == NULL) {
+            continue;
+        }
+
+        if (list_tail != NULL) {
+            list_tail->next = slot->head;
+        } else {
+            list_head = slot->head;
+        }
+        list_tail = slot->tail;
+        __atomic_store_n(&slot->head, NULL, __ATOMIC_SEQ_CST);
+        slot->tail = NULL;
+    }
+    pthread_mutex_unlock(&epoch_domain.lock);
+
+    epoch_garbage_destroy(list_head);
+}
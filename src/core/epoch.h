@@ -0,0 +1,146 @@
+/**
+ * \file src/core/epoch.h
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Epoch based reclamation of shared objects (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_EPOCH_H
+#define IPX_EPOCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+
+/**
+ * \defgroup ipx_epoch Epoch based reclamation
+ *
+ * \brief Deferred destruction of objects shared by messages in the collector pipeline
+ *
+ * Objects such as template snapshots or removed parser contexts can be referenced by messages
+ * that are still somewhere in the pipeline (in a ring buffer or processed by a plugin). Instead
+ * of wrapping them into garbage messages that must travel through the whole pipeline, such
+ * objects are retired to the current epoch and destroyed as soon as all messages that could
+ * reference them have been destroyed.
+ *
+ * Every message (except garbage messages) is stamped with an epoch when it is created and
+ * the epoch is left when the message is destroyed. The current (global) epoch is advanced
+ * when an object is retired, so each epoch with retired objects is eventually closed and
+ * its objects are destroyed after all messages of this and all previous epochs are gone.
+ *
+ * Messages created by a plugin while processing another message inherit the epoch of
+ * the processed message (see ipx_epoch_pin()), because they can share the same objects.
+ *
+ * \warning Messages that are never destroyed block reclamation of all objects retired later.
+ * @{
+ */
+
+/** Invalid epoch (i.e. the message is not accounted) */
+#define IPX_EPOCH_NONE UINT64_MAX
+
+/**
+ * \brief Enter an epoch (i.e. create a reference to the current epoch)
+ *
+ * If the calling thread has pinned an epoch, the pinned epoch is used instead of the current
+ * one.
+ * \note Each call MUST be paired with exactly one call of ipx_epoch_leave().
+ * \return Entered epoch
+ */
+IPX_API uint64_t
+ipx_epoch_enter();
+
+/**
+ * \brief Leave an epoch (i.e. remove a reference to the epoch)
+ *
+ * If this is the last reference to the oldest epoch, objects retired to closed epochs without
+ * references are destroyed.
+ * \param[in] epoch Epoch returned by ipx_epoch_enter() (#IPX_EPOCH_NONE is ignored)
+ */
+IPX_API void
+ipx_epoch_leave(uint64_t epoch);
+
+/**
+ * \brief Pin an epoch to the calling thread
+ *
+ * All subsequent calls of ipx_epoch_enter() by the thread enter the pinned epoch. The caller
+ * MUST hold a reference to the epoch (e.g. a message being processed) until the epoch is
+ * unpinned.
+ * \param[in] epoch Epoch to pin (#IPX_EPOCH_NONE unpins the current epoch)
+ */
+IPX_API void
+ipx_epoch_pin(uint64_t epoch);
+
+/**
+ * \brief Unpin an epoch from the calling thread
+ */
+IPX_API void
+ipx_epoch_unpin();
+
+/**
+ * \brief Retire an object
+ *
+ * The object is added to the current epoch and the epoch is closed (if possible). The object
+ * is destroyed by the callback as soon as all messages that entered this or any older epoch
+ * are destroyed. If there are no such messages, the object is destroyed immediately.
+ * \note The callback can be called by any thread.
+ * \param[in] object Object to destroy
+ * \param[in] cb     Destruction callback
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the object is not retired)
+ */
+IPX_API int
+ipx_epoch_retire(void *object, ipx_msg_garbage_cb cb);
+
+/**
+ * \brief Destroy all retired objects regardless of references
+ *
+ * \warning This function is supposed to be called only when the pipeline is not running and all
+ *   messages have been destroyed.
+ */
+IPX_API void
+ipx_epoch_flush();
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IPX_EPOCH_H
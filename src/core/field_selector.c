@@ -0,0 +1,420 @@
+/**
+ * \file src/core/field_selector.c
+ * \brief Per-template cache of selected fields (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ipfixcol2.h>
+
+/** Default number of slots in the hash table (must be a power of 2)                  */
+#define FSEL_SLOTS_DEF  64U
+/** Maximum number of cached templates (after that the cache is flushed)              */
+#define FSEL_CACHE_MAX  4096U
+
+/** Cached selection of a template                                                    */
+struct fsel_entry {
+    /** Template (key)                                                                */
+    const struct fds_template *tmplt;
+    /** Type of the template                                                          */
+    enum fds_template_type type;
+    /** Copy of the raw template (to detect reuse of the template memory)             */
+    uint8_t *raw;
+    /** Length of the raw template                                                    */
+    uint16_t raw_len;
+    /** Result of the selection                                                       */
+    struct ipx_fsel_result res;
+    // Private data of selected fields, their indexes and the raw template follow
+};
+
+/** Field selector                                                                    */
+struct ipx_fsel {
+    /** Field matching function (NULL, if the mapping function is used)               */
+    ipx_fsel_match_cb cb;
+    /** Field mapping function (NULL, if the matching function is used)               */
+    ipx_fsel_map_cb map_cb;
+    /** User data of the matching/mapping function                                    */
+    void *cb_data;
+
+    /** Hash table (open addressing with linear probing)                              */
+    struct fsel_entry **slots;
+    /** Number of slots in the table (always a power of 2)                            */
+    size_t slots_cnt;
+    /** Number of occupied slots                                                      */
+    size_t used;
+};
+
+/**
+ * \brief Hash function of a template pointer
+ * \param[in] tmplt Template
+ * \return Hash value
+ */
+static inline size_t
+fsel_hash(const struct fds_template *tmplt)
+{
+    uint64_t val = (uint64_t) (uintptr_t) tmplt;
+    val ^= val >> 33;
+    val *= 0xff51afd7ed558ccdULL;
+    val ^= val >> 33;
+    return (size_t) val;
+}
+
+/**
+ * \brief Remove all cached entries
+ * \param[in] sel Field selector
+ */
+static void
+fsel_flush(ipx_fsel_t *sel)
+{
+    for (size_t i = 0; i < sel->slots_cnt; ++i) {
+        free(sel->slots[i]);
+        sel->slots[i] = NULL;
+    }
+
+    sel->used = 0;
+}
+
+/**
+ * \brief Insert an entry into the hash table (without resizing)
+ * \param[in] slots     Hash table
+ * \param[in] slots_cnt Number of slots
+ * \param[in] entry     Entry to insert
+ */
+static void
+fsel_insert(struct fsel_entry **slots, size_t slots_cnt, struct fsel_entry *entry)
+{
+    size_t pos = fsel_hash(entry->tmplt) & (slots_cnt - 1);
+    while (slots[pos] != NULL) {
+        pos = (pos + 1) & (slots_cnt - 1);
+    }
+
+    slots[pos] = entry;
+}
+
+/**
+ * \brief Double the size of the hash table
+ * \param[in] sel Field selector
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+fsel_grow(ipx_fsel_t *sel)
+{
+    const size_t new_cnt = 2 * sel->slots_cnt;
+    struct fsel_entry **new_slots = calloc(new_cnt, sizeof(*new_slots));
+    if (!new_slots) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < sel->slots_cnt; ++i) {
+        if (sel->slots[i] != NULL) {
+            fsel_insert(new_slots, new_cnt, sel->slots[i]);
+        }
+    }
+
+    free(sel->slots);
+    sel->slots = new_slots;
+    sel->slots_cnt = new_cnt;
+    return IPX_OK;
+}
+
+/**
+ * \brief Create a new cache entry (i.e. perform selection of fields)
+ * \param[in] sel   Field selector
+ * \param[in] tmplt Template
+ * \return Pointer to the entry or NULL (memory allocation error)
+ */
+static struct fsel_entry *
+fsel_entry_create(ipx_fsel_t *sel, const struct fds_template *tmplt)
+{
+    // Determine selected fields (at most all fields of the template)
+    const uint16_t fields_cnt = tmplt->fields_cnt_total;
+    const size_t priv_size = (sel->map_cb != NULL) ? fields_cnt * sizeof(void *) : 0;
+    const size_t idx_size = fields_cnt * sizeof(uint16_t);
+    const size_t entry_size = sizeof(struct fsel_entry) + priv_size + idx_size
+        + tmplt->raw.length;
+    struct fsel_entry *entry = malloc(entry_size);
+    if (!entry) {
+        return NULL;
+    }
+
+    // Private data are placed right after the entry to be properly aligned
+    const void **priv = (sel->map_cb != NULL) ? (const void **) (entry + 1) : NULL;
+    uint16_t *idx = (uint16_t *) (((uint8_t *) (entry + 1)) + priv_size);
+
+    uint16_t cnt = 0;
+    bool dynamic = false;
+    for (uint16_t i = 0; i < fields_cnt; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (priv != NULL) {
+            const void *field_priv = sel->map_cb(tmplt, i, sel->cb_data);
+            if (!field_priv) {
+                continue;
+            }
+            priv[cnt] = field_priv;
+        } else if (!sel->cb(field, sel->cb_data)) {
+            continue;
+        }
+
+        idx[cnt++] = i;
+        if (field->offset == FDS_IPFIX_VAR_IE_LEN || field->length == FDS_IPFIX_VAR_IE_LEN) {
+            dynamic = true;
+        }
+    }
+
+    entry->tmplt = tmplt;
+    entry->type = tmplt->type;
+    entry->raw = ((uint8_t *) idx) + idx_size;
+    entry->raw_len = tmplt->raw.length;
+    memcpy(entry->raw, tmplt->raw.data, tmplt->raw.length);
+
+    entry->res.cnt = cnt;
+    entry->res.dynamic = dynamic;
+    entry->res.idx = idx;
+    entry->res.priv = priv;
+    return entry;
+}
+
+/**
+ * \brief Check that a cached entry still describes the template
+ *
+ * The template could have been freed and another template could have been allocated at
+ * the same address. In that case, the definition of the template is different.
+ * \param[in] entry Cached entry
+ * \param[in] tmplt Template
+ * \return True or false
+ */
+static inline bool
+fsel_entry_valid(const struct fsel_entry *entry, const struct fds_template *tmplt)
+{
+    return entry->type == tmplt->type
+        && entry->raw_len == tmplt->raw.length
+        && memcmp(entry->raw, tmplt->raw.data, entry->raw_len) == 0;
+}
+
+/**
+ * \brief Create a field selector
+ * \param[in] cb     Field matching function (NULL, if \p map_cb is used)
+ * \param[in] map_cb Field mapping function (NULL, if \p cb is used)
+ * \param[in] data   User data of the function
+ * \return Pointer to the selector or NULL (memory allocation error)
+ */
+static ipx_fsel_t *
+fsel_create(ipx_fsel_match_cb cb, ipx_fsel_map_cb map_cb, void *data)
+{
+    struct ipx_fsel *sel = calloc(1, sizeof(*sel));
+    if (!sel) {
+        return NULL;
+    }
+
+    sel->slots = calloc(FSEL_SLOTS_DEF, sizeof(*sel->slots));
+    if (!sel->slots) {
+        free(sel);
+        return NULL;
+    }
+
+    sel->cb = cb;
+    sel->map_cb = map_cb;
+    sel->cb_data = data;
+    sel->slots_cnt = FSEL_SLOTS_DEF;
+    return sel;
+}
+
+ipx_fsel_t *
+ipx_fsel_create(ipx_fsel_match_cb cb, void *data)
+{
+    assert(cb != NULL);
+    return fsel_create(cb, NULL, data);
+}
+
+ipx_fsel_t *
+ipx_fsel_create_map(ipx_fsel_map_cb cb, void *data)
+{
+    assert(cb != NULL);
+    return fsel_create(NULL, cb, data);
+}
+
+void
+ipx_fsel_destroy(ipx_fsel_t *sel)
+{
+    if (!sel) {
+        return;
+    }
+
+    fsel_flush(sel);
+    free(sel->slots);
+    free(sel);
+}
+
+const struct ipx_fsel_result *
+ipx_fsel_get(ipx_fsel_t *sel, const struct fds_template *tmplt)
+{
+    size_t pos = fsel_hash(tmplt) & (sel->slots_cnt - 1);
+    struct fsel_entry *entry;
+
+    while ((entry = sel->slots[pos]) != NULL) {
+        if (entry->tmplt == tmplt) {
+            break;
+        }
+        pos = (pos + 1) & (sel->slots_cnt - 1);
+    }
+
+    if (entry != NULL) {
+        if (fsel_entry_valid(entry, tmplt)) {
+            return &entry->res;
+        }
+
+        // The memory of the template has been reused by another template -> replace
+        struct fsel_entry *new_entry = fsel_entry_create(sel, tmplt);
+        if (!new_entry) {
+            return NULL;
+        }
+
+        free(entry);
+        sel->slots[pos] = new_entry;
+        return &new_entry->res;
+    }
+
+    // Unknown template
+    if (sel->used >= FSEL_CACHE_MAX) {
+        // Entries of already released templates are never removed, so flush them all
+        fsel_flush(sel);
+    }
+
+    if (2 * (sel->used + 1) > sel->slots_cnt && fsel_grow(sel) != IPX_OK) {
+        return NULL;
+    }
+
+    entry = fsel_entry_create(sel, tmplt);
+    if (!entry) {
+        return NULL;
+    }
+
+    fsel_insert(sel->slots, sel->slots_cnt, entry);
+    sel->used++;
+    return &entry->res;
+}
+
+void
+ipx_fsel_iter_init(struct ipx_fsel_iter *it, const struct ipx_fsel_result *res,
+    const struct fds_drec *rec)
+{
+    it->_res = res;
+    it->_rec = rec;
+    it->_pos = 0;
+    it->_walk_idx = 0;
+    it->_walk_offset = 0;
+}
+
+/**
+ * \brief Get the size of a field and the size of its length prefix
+ * \param[in]  field  Template field
+ * \param[in]  data   Start of the field in the record
+ * \param[out] prefix Size of the length prefix of a variable-length field (otherwise 0)
+ * \return Size of the field data
+ */
+static inline uint16_t
+fsel_field_size(const struct fds_tfield *field, const uint8_t *data, uint16_t *prefix)
+{
+    if (field->length != FDS_IPFIX_VAR_IE_LEN) {
+        *prefix = 0;
+        return field->length;
+    }
+
+    // Variable-length field (RFC 7011, Section 7)
+    if (data[0] != 255U) {
+        *prefix = 1;
+        return data[0];
+    }
+
+    *prefix = 3;
+    return (uint16_t) ((data[1] << 8) | data[2]);
+}
+
+int
+ipx_fsel_iter_next(struct ipx_fsel_iter *it)
+{
+    const struct ipx_fsel_result *res = it->_res;
+    if (it->_pos >= res->cnt) {
+        return IPX_EOC;
+    }
+
+    const struct fds_drec *rec = it->_rec;
+    const struct fds_template *tmplt = rec->tmplt;
+    it->priv = (res->priv != NULL) ? res->priv[it->_pos] : NULL;
+    const uint16_t idx = res->idx[it->_pos++];
+    const struct fds_tfield *field = &tmplt->fields[idx];
+
+    uint16_t offset = field->offset;
+    if (offset == FDS_IPFIX_VAR_IE_LEN) {
+        // Unknown offset -> walk through preceding fields (only from the last position)
+        uint16_t w_idx = it->_walk_idx;
+        uint16_t w_offset = it->_walk_offset;
+        assert(w_idx <= idx);
+
+        while (w_idx < idx) {
+            const struct fds_tfield *w_field = &tmplt->fields[w_idx];
+            if (w_field->offset != FDS_IPFIX_VAR_IE_LEN) {
+                w_offset = w_field->offset;
+            }
+
+            uint16_t prefix;
+            w_offset += fsel_field_size(w_field, rec->data + w_offset, &prefix);
+            w_offset += prefix;
+            w_idx++;
+        }
+
+        offset = w_offset;
+    }
+
+    uint16_t prefix;
+    const uint16_t size = fsel_field_size(field, rec->data + offset, &prefix);
+    assert(offset + prefix + size <= rec->size && "The record is malformed!");
+
+    it->field.data = rec->data + offset + prefix;
+    it->field.size = size;
+    it->field.info = field;
+
+    it->_walk_idx = idx + 1;
+    it->_walk_offset = offset + prefix + size;
+    return IPX_OK;
+}
@@ -84,7 +84,8 @@ print_help()
 {
     std::cout
         << "IPFIX Collector daemon\n"
-        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-e DIR] [-P FILE] [-r SIZE] [-vVhLdu]\n"
+        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-e DIR] [-P FILE] [-r SIZE] [-s DIR]\n"
+        << "                 [-vVhLdu]\n"
         << "  -c FILE   Path to the startup configuration file\n"
         << "            (default: " << IPX_DEFAULT_STARTUP_CONFIG << ")\n"
         << "  -p PATH   Add path to a directory with plugins or to a file\n"
@@ -94,6 +95,8 @@ print_help()
         << "  -P FILE   Path to a PID file (without this option, no PID file is created)\n"
         << "  -d        Run as a standalone daemon process\n"
         << "  -r SIZE   Ring buffer size (default: " << ipx_configurator::RING_DEF_SIZE << ")\n"
+        << "  -s DIR    Path to a directory where (Options) Templates of UDP sessions are preserved\n"
+        << "            across restarts (without this option, templates are not preserved)\n"
         << "  -h        Show this help message and exit\n"
         << "  -V        Show version information and exit\n"
         << "  -L        List all available plugins and exit\n"
@@ -209,7 +212,7 @@ int main(int argc, char *argv[])
     // Parse configuration
     int opt;
     opterr = 0; // Disable default error messages
-    while ((opt = getopt(argc, argv, "c:vVhLdp:e:P:r:u")) != -1) {
+    while ((opt = getopt(argc, argv, "c:vVhLdp:e:P:r:s:u")) != -1) {
         switch (opt) {
         case 'c': // Configuration file
             cfg_startup = optarg;
@@ -241,6 +244,9 @@ int main(int argc, char *argv[])
         case 'r': // Change ring size
             ring_size = optarg;
             break;
+        case 's': // Preserve (Options) Templates
+            conf.tmplts_set_dir(std::string(optarg));
+            break;
         case 'u': // Disable automatic plugin unload
             conf.plugins.auto_unload(false);
             break;
@@ -280,6 +286,14 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Print messages by a dedicated thread (remaining messages are printed on exit)
+    if (ipx_verb_async_start() == IPX_OK) {
+        atexit(&ipx_verb_async_stop);
+    } else {
+        IPX_WARNING(module, "Failed to start the logger thread. Messages will be printed "
+            "synchronously.", '\0');
+    }
+
     if (ring_size != nullptr && ring_size_change(conf, ring_size) != IPX_OK) {
         // Failed to set the size
         return EXIT_FAILURE;
@@ -302,6 +316,9 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    // All instances have been stopped, print remaining messages
+    ipx_verb_async_stop();
+
     // Destroy a PID file
     if (pid_file != nullptr) {
         pid_remove(pid_file);
@@ -45,6 +45,7 @@
 #include <ipfixcol2.h>
 #include <assert.h>
 #include "message_terminate.h"
+#include "epoch.h"
 
 /**
  * \internal
@@ -66,8 +67,10 @@
 struct ipx_msg {
     /** Type of the message                                                           */
     enum ipx_msg_type type;
-    /** Reference counter (set by the output manager, decremented by output plugins)  */
+    /** Reference counter (set by the output manager, released by destruction)        */
     unsigned int ref_cnt;
+    /** Entered epoch (see ipx_epoch_enter(), #IPX_EPOCH_NONE for garbage messages)   */
+    uint64_t epoch;
 }; // TODO: 64 bytes alignment
 
 static_assert(offsetof(struct ipx_msg, type) == 0,
@@ -75,6 +78,11 @@ static_assert(offsetof(struct ipx_msg, type) == 0,
 
 /**
  * \brief Initialize the header of a general message
+ *
+ * The message enters the current epoch (or the epoch pinned by the calling thread), so objects
+ * retired in the meantime are not destroyed until the message is destroyed. Garbage messages
+ * do not enter any epoch, because they can be retired themselves. The message has exactly one
+ * reference.
  * \param[in] header  Pointer to the header of the message
  * \param[in]  type   Type of the header
  * \return On success returns #IPX_OK. Otherwise returns non-zero value.
@@ -83,22 +91,41 @@ static inline void
 ipx_msg_header_init(struct ipx_msg *header, enum ipx_msg_type type)
 {
     header->type = type;
+    header->ref_cnt = 1;
+    header->epoch = (type != IPX_MSG_GARBAGE) ? ipx_epoch_enter() : IPX_EPOCH_NONE;
 }
 
 /**
  * \brief Destroy the header of a general message
  *
- * This functions is now just a placeholder for possible future implementation.
+ * The message leaves its epoch. If it is the last message of the oldest epoch, retired objects
+ * of closed epochs without references are destroyed.
  * \param[in] header Pointer to the header of the mesage
  */
 static inline void
 ipx_msg_header_destroy(struct ipx_msg *header)
 {
-    (void) header;
+    ipx_epoch_leave(header->epoch);
+    header->epoch = IPX_EPOCH_NONE;
+}
+
+/**
+ * \brief Get the epoch of a message
+ * \param[in] header Pointer to the header of the message
+ * \return Epoch or #IPX_EPOCH_NONE
+ */
+static inline uint64_t
+ipx_msg_header_epoch(const struct ipx_msg *header)
+{
+    return header->epoch;
 }
 
 /**
  * \brief Set the reference counter (only for the output manager)
+ *
+ * The message is shared by all destinations of the output manager (output instances or private
+ * chains of intermediate instances in front of them). Each destination holds one reference
+ * and releases it by destroying the message, so only the last destination frees the message.
  * \param[in] header Pointer to the header of the message
  * \param[in] cnt    Initial value
  */
@@ -109,7 +136,7 @@ ipx_msg_header_cnt_set(struct ipx_msg *header, unsigned int cnt)
 }
 
 /**
- * \brief Decrement the reference counter (only for output plugins)
+ * \brief Decrement the reference counter (i.e. release a reference to the message)
  * \param[in] header Pointer to the header of the message
  * \return True if this is the last reference and the message should be freed
  * \return False otherwise
@@ -120,6 +147,20 @@ ipx_msg_header_cnt_dec(struct ipx_msg *header)
     return (__atomic_sub_fetch(&header->ref_cnt, 1U, __ATOMIC_SEQ_CST) == 0);
 }
 
+/**
+ * \brief Is the message shared (i.e. referenced by more than one destination)?
+ *
+ * If the message is not shared, the caller is its only user and no other reference can be
+ * created in the meantime.
+ * \param[in] header Pointer to the header of the message
+ * \return True or false
+ */
+static inline bool
+ipx_msg_header_cnt_shared(const struct ipx_msg *header)
+{
+    return (__atomic_load_n(&header->ref_cnt, __ATOMIC_SEQ_CST) > 1U);
+}
+
 /**
  * \brief Cast from a base message to an IPFIX message
  * \param[in] msg Pointer to the base message
@@ -93,6 +93,11 @@ ipx_msg_garbage_create(void *object, ipx_msg_garbage_cb callback)
 void
 ipx_msg_garbage_destroy(ipx_msg_garbage_t *msg)
 {
+    if (!ipx_msg_header_cnt_dec((ipx_msg_t *) msg)) {
+        // The message is still shared by another destination of the output manager
+        return;
+    }
+
     // Destroy garbage
     msg->object_destructor(msg->object_ptr);
 
@@ -47,6 +47,10 @@
 
 #include <stddef.h> // offsetof
 #include <stdlib.h> // free
+#include <string.h> // memcpy
+
+/** Default number of pre-allocated ranges of modified records */
+#define RANGE_DEF_CNT (16)
 
 // Check correctness of structure implementation
 static_assert(offsetof(struct ipx_msg_ipfix, msg_header.type) == 0,
@@ -82,8 +86,20 @@ ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_
 void
 ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg)
 {
-    // Destroy the IPFIX packet
-    free(msg->raw_pkt);
+    if (!ipx_msg_header_cnt_dec((ipx_msg_t *) msg)) {
+        // The message is still shared by another destination of the output manager
+        return;
+    }
+
+    if (msg->cow.origin != NULL) {
+        // Private copy of the message -> release the reference to the shared (original) message
+        free(msg->cow.raw_pkt);
+        free(msg->cow.ranges);
+        ipx_msg_ipfix_destroy(msg->cow.origin);
+    } else {
+        // Destroy the IPFIX packet
+        free(msg->raw_pkt);
+    }
 
     // Destroy the wrapper
     if (msg->sets.extended) {
@@ -93,9 +109,92 @@ ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg)
     free(msg);
 }
 
+/**
+ * \brief Compare ranges of modified records (by their offset)
+ * \param[in] p1 First range
+ * \param[in] p2 Second range
+ * \return The same as strcmp()
+ */
+static int
+ipfix_range_cmp(const void *p1, const void *p2)
+{
+    const struct ipx_msg_ipfix_range *r1 = p1;
+    const struct ipx_msg_ipfix_range *r2 = p2;
+    return (r1->offset > r2->offset) - (r1->offset < r2->offset);
+}
+
+/**
+ * \brief Is the data in the private raw packet of the message?
+ * \param[in] msg  IPFIX Message wrapper
+ * \param[in] data Pointer to check
+ * \return True or false
+ */
+static inline bool
+ipfix_cow_is_private(const struct ipx_msg_ipfix *msg, const uint8_t *data)
+{
+    const uint8_t *start = msg->cow.raw_pkt;
+    return (start != NULL && data >= start && data < start + msg->raw_size);
+}
+
+/**
+ * \brief Serialize modified records of a copy-on-write message
+ *
+ * Unmodified parts of the shared raw packet are copied to the private raw packet (i.e. around
+ * already copied records) and all parsed sets and records are moved to the private packet.
+ * If there are no modified records, nothing is done.
+ * \param[in] msg IPFIX Message wrapper
+ */
+static void
+ipfix_cow_serialize(struct ipx_msg_ipfix *msg)
+{
+    const uint32_t ranges_cnt = msg->cow.cnt_valid;
+    if (ranges_cnt == 0) {
+        return;
+    }
+
+    uint8_t *pkt_old = msg->raw_pkt;
+    uint8_t *pkt_new = msg->cow.raw_pkt;
+    struct ipx_msg_ipfix_range *ranges = msg->cow.ranges;
+    assert(pkt_new != NULL && pkt_old != pkt_new);
+    msg->cow.cnt_valid = 0;
+
+    // Copy gaps between modified records
+    qsort(ranges, ranges_cnt, sizeof(*ranges), &ipfix_range_cmp);
+    uint16_t pos = 0;
+    for (uint32_t i = 0; i < ranges_cnt; ++i) {
+        assert(ranges[i].offset >= pos);
+        memcpy(pkt_new + pos, pkt_old + pos, ranges[i].offset - pos);
+        pos = ranges[i].offset + ranges[i].size;
+    }
+    memcpy(pkt_new + pos, pkt_old + pos, msg->raw_size - pos);
+
+    // Move references of sets and records
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &sets_cnt);
+    for (size_t i = 0; i < sets_cnt; ++i) {
+        const size_t offset = ((uint8_t *) sets[i].ptr) - pkt_old;
+        sets[i].ptr = (struct fds_ipfix_set_hdr *) (pkt_new + offset);
+    }
+
+    for (uint32_t i = 0; i < msg->rec_info.cnt_valid; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+        if (rec->rec.data < pkt_old || rec->rec.data >= pkt_old + msg->raw_size) {
+            // Already modified record (or not a part of the raw packet)
+            continue;
+        }
+
+        const size_t offset = rec->rec.data - pkt_old;
+        rec->rec.data = pkt_new + offset;
+    }
+
+    msg->raw_pkt = pkt_new;
+}
+
 uint8_t *
 ipx_msg_ipfix_get_packet(ipx_msg_ipfix_t *msg)
 {
+    ipfix_cow_serialize(msg);
     return msg->raw_pkt;
 }
 
@@ -108,6 +207,8 @@ ipx_msg_ipfix_get_ctx(ipx_msg_ipfix_t *msg)
 void
 ipx_msg_ipfix_get_sets(ipx_msg_ipfix_t *msg, struct ipx_ipfix_set **sets, size_t *size)
 {
+    ipfix_cow_serialize(msg);
+
     if (sets != NULL) {
         if (msg->sets.cnt_valid <= SET_DEF_CNT) {
             assert(msg->sets.extended == NULL);
@@ -140,6 +241,90 @@ ipx_msg_ipfix_get_drec(ipx_msg_ipfix_t *msg, uint32_t idx)
     return (struct ipx_ipfix_record *) rec_start;
 }
 
+ipx_msg_ipfix_t *
+ipx_msg_ipfix_cow(ipx_msg_ipfix_t *msg)
+{
+    if (!ipx_msg_header_cnt_shared((ipx_msg_t *) msg)) {
+        // The caller is the only user of the message
+        return msg;
+    }
+
+    // Copy the wrapper with parsed sets and records (but not the raw packet)
+    const uint32_t rec_cnt = (msg->rec_info.cnt_valid > 0) ? msg->rec_info.cnt_valid : 1U;
+    const size_t copy_size = ipx_msg_ipfix_size(rec_cnt, msg->rec_info.rec_size);
+    struct ipx_msg_ipfix *copy = malloc(copy_size);
+    if (!copy) {
+        return NULL;
+    }
+
+    memcpy(copy, msg, copy_size);
+    if (msg->sets.extended != NULL) {
+        const size_t sets_size = msg->sets.cnt_alloc * sizeof(struct ipx_ipfix_set);
+        copy->sets.extended = malloc(sets_size);
+        if (!copy->sets.extended) {
+            free(copy);
+            return NULL;
+        }
+        memcpy(copy->sets.extended, msg->sets.extended, sets_size);
+    }
+
+    ipx_msg_header_init(&copy->msg_header, IPX_MSG_IPFIX);
+    copy->rec_info.cnt_alloc = rec_cnt;
+    // The copy takes over the reference of the caller to the original message
+    copy->cow.origin = msg;
+    copy->cow.raw_pkt = NULL;
+    copy->cow.ranges = NULL;
+    copy->cow.cnt_valid = 0;
+    copy->cow.cnt_alloc = 0;
+    return copy;
+}
+
+struct ipx_ipfix_record *
+ipx_msg_ipfix_drec_modify(ipx_msg_ipfix_t *msg, uint32_t idx)
+{
+    assert(!ipx_msg_header_cnt_shared((ipx_msg_t *) msg) && "Shared message cannot be modified!");
+    struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, idx);
+    if (!rec || msg->cow.origin == NULL || ipfix_cow_is_private(msg, rec->rec.data)) {
+        // Out of range, not a copy (i.e. the raw packet is not shared) or already modifiable
+        return rec;
+    }
+
+    const uint8_t *pkt = msg->raw_pkt;
+    if (rec->rec.data < pkt || rec->rec.data + rec->rec.size > pkt + msg->raw_size) {
+        // The record is not part of the raw packet
+        return NULL;
+    }
+
+    if (!msg->cow.raw_pkt) {
+        msg->cow.raw_pkt = malloc(msg->raw_size);
+        if (!msg->cow.raw_pkt) {
+            return NULL;
+        }
+    }
+
+    if (msg->cow.cnt_valid == msg->cow.cnt_alloc) {
+        const uint32_t alloc_new = (msg->cow.cnt_alloc > 0)
+            ? 2U * msg->cow.cnt_alloc : RANGE_DEF_CNT;
+        struct ipx_msg_ipfix_range *ranges_new = realloc(msg->cow.ranges,
+            alloc_new * sizeof(*ranges_new));
+        if (!ranges_new) {
+            return NULL;
+        }
+
+        msg->cow.ranges = ranges_new;
+        msg->cow.cnt_alloc = alloc_new;
+    }
+
+    // Copy the record to the private raw packet (to the same position)
+    const uint16_t offset = (uint16_t) (rec->rec.data - pkt);
+    memcpy(msg->cow.raw_pkt + offset, rec->rec.data, rec->rec.size);
+    struct ipx_msg_ipfix_range *range = &msg->cow.ranges[msg->cow.cnt_valid++];
+    range->offset = offset;
+    range->size = rec->rec.size;
+    rec->rec.data = msg->cow.raw_pkt + offset;
+    return rec;
+}
+
 struct ipx_ipfix_set *
 ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg)
 {
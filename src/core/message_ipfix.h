@@ -52,6 +52,14 @@
 /** Default number of pre-allocated structures for parser IPFIX Data Records */
 #define REC_DEF_CNT (64)
 
+/** Range of a modified record in a private raw packet of a copy-on-write message */
+struct ipx_msg_ipfix_range {
+    /** Offset from the start of the packet */
+    uint16_t offset;
+    /** Size of the range                   */
+    uint16_t size;
+};
+
 /**
  * \brief Structure for a parsed IPFIX Message
  *
@@ -82,6 +90,19 @@ struct ipx_msg_ipfix {
         uint32_t cnt_alloc;
     } sets; /**< Parsed IPFIX (Data/Template/Options Template) Sets          */
 
+    struct {
+        /** Original (shared) message with the raw packet (NULL, if not a copy)      */
+        struct ipx_msg_ipfix *origin;
+        /** Private raw packet (NULL, if not allocated yet)                          */
+        uint8_t *raw_pkt;
+        /** Ranges of modified records in the private raw packet (not serialized yet) */
+        struct ipx_msg_ipfix_range *ranges;
+        /** Number of valid ranges                                                   */
+        uint32_t cnt_valid;
+        /** Number of allocated ranges                                               */
+        uint32_t cnt_alloc;
+    } cow; /**< Copy-on-write state (see ipx_msg_ipfix_cow())                        */
+
     struct {
         /** Size of a single record (depends on registered extensions)       */
         size_t rec_size;
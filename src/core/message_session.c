@@ -85,6 +85,11 @@ ipx_msg_session_create(const struct ipx_session *session, enum ipx_msg_session_e
 void
 ipx_msg_session_destroy(ipx_msg_session_t *msg)
 {
+    if (!ipx_msg_header_cnt_dec((ipx_msg_t *) msg)) {
+        // The message is still shared by another destination of the output manager
+        return;
+    }
+
     ipx_msg_header_destroy((ipx_msg_t *) msg);
     free(msg);
 }
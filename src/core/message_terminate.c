@@ -74,6 +74,11 @@ ipx_msg_terminate_create(enum ipx_msg_terminate_type type)
 void
 ipx_msg_termiante_destroy(ipx_msg_terminate_t *msg)
 {
+    if (!ipx_msg_header_cnt_dec((ipx_msg_t *) msg)) {
+        // The message is still shared by another destination of the output manager
+        return;
+    }
+
     ipx_msg_header_destroy((ipx_msg_t *) msg);
     free(msg);
 }
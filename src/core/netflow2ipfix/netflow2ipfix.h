@@ -178,6 +178,49 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper);
 void
 ipx_nf9_conv_verb(ipx_nf9_conv_t *conv, enum ipx_verb_level v_new);
 
+/**
+ * @brief Callback for ipx_nf9_conv_tmplts_for()
+ * @param[in] type Template type (::IPX_NF9_SET_TMPLT or ::IPX_NF9_SET_OPTS_TMPLT)
+ * @param[in] rec  Original NetFlow (Options) Template record
+ * @param[in] size Size of the record
+ * @param[in] data User data
+ */
+typedef void (*ipx_nf9_conv_tmplt_cb)(uint16_t type, const uint8_t *rec, uint16_t size,
+    void *data);
+
+/**
+ * @brief Call a function for each NetFlow (Options) Template known to the converter
+ *
+ * @param[in] conv Message converter
+ * @param[in] cb   Callback
+ * @param[in] data User data passed to the callback
+ */
+void
+ipx_nf9_conv_tmplts_for(const ipx_nf9_conv_t *conv, ipx_nf9_conv_tmplt_cb cb, void *data);
+
+/**
+ * @brief Restore a previously received NetFlow (Options) Template
+ *
+ * The template is converted and added into the converter as if it was received in a NetFlow
+ * Message. Its IPFIX counterpart is returned, so it can be added into a template manager of
+ * the converted IPFIX stream.
+ * @param[in]  conv     Message converter
+ * @param[in]  msg_ctx  Message context of the stream (only for log messages!)
+ * @param[in]  type     Template type (::IPX_NF9_SET_TMPLT or ::IPX_NF9_SET_OPTS_TMPLT)
+ * @param[in]  rec      NetFlow (Options) Template record (e.g. from ipx_nf9_conv_tmplts_for())
+ * @param[in]  size     Size of the record
+ * @param[out] ipx_rec  Converted IPFIX (Options) Template record (owned by the converter)
+ * @param[out] ipx_size Size of the converted record
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED if the template cannot be converted due to format incompatibility
+ *   (its Data Records will be dropped)
+ * @return #IPX_ERR_FORMAT if the record is malformed
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+ipx_nf9_conv_tmplt_restore(ipx_nf9_conv_t *conv, const struct ipx_msg_ctx *msg_ctx,
+    uint16_t type, const uint8_t *rec, uint16_t size, const uint8_t **ipx_rec, uint16_t *ipx_size);
+
 /**
  * @}
  */
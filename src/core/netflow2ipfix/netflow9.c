@@ -723,23 +723,25 @@ conv_tmplt_process(ipx_nf9_conv_t *conv, struct conv_tmplt_aux *aux, uint16_t fs
 }
 
 /**
- * @brief Parse and add IPFIX (Options) Template from a NetFlow (Options) Template record
+ * @brief Parse a NetFlow (Options) Template record and add it into the Template table
  *
  * The function tries to parse and convert a NetFlow (Options) Template record to IPFIX (Options)
- * Template record and append it to the new IPFIX Message. Once the Template is parsed, it is
- * also added into the internal Template table of already parsed templates and the next time
- * the template must be converted, it is possible to find it using conv_tmplt_from_table().
+ * Template record. Once the Template is parsed, it is added into the internal Template table
+ * of already parsed templates and the next time the template must be converted, it is possible
+ * to find it using conv_tmplt_from_table().
  *
- * @param[in] conv    Converter internals
- * @param[in] it      Template iterator (points to Template to be parsed)
- * @param[in] fset_id Template type (::IPX_NF9_SET_TMPLT or ::IPX_NF9_SET_OPTS_TMPLT)
+ * @param[in]  conv    Converter internals
+ * @param[in]  it      Template iterator (points to Template to be parsed)
+ * @param[in]  fset_id Template type (::IPX_NF9_SET_TMPLT or ::IPX_NF9_SET_OPTS_TMPLT)
+ * @param[out] trec    Added template record (only on success)
  * @return #IPX_OK on success
  * @return #IPX_ERR_DENIED if the IPFIX Template cannot be added due to format incompatibility.
  *   However, a dummy record that signalizes unsupported conversion is added into the Template table.
  * @return #IPX_ERR_NOMEM in case of a memory allocation error
  */
-static inline int
-conv_tmplt_from_data(ipx_nf9_conv_t *conv, const struct ipx_nf9_tset_iter *it, uint16_t fset_id)
+static int
+conv_tmplt_create(ipx_nf9_conv_t *conv, const struct ipx_nf9_tset_iter *it, uint16_t fset_id,
+    const struct nf9_trec **trec)
 {
     assert(fset_id == IPX_NF9_SET_TMPLT || fset_id == IPX_NF9_SET_OPTS_TMPLT);
     uint16_t tid = ntohs(it->ptr.trec->template_id);
@@ -794,6 +796,33 @@ conv_tmplt_from_data(ipx_nf9_conv_t *conv, const struct ipx_nf9_tset_iter *it, u
         return IPX_ERR_NOMEM;
     }
 
+    *trec = template;
+    return IPX_OK;
+}
+
+/**
+ * @brief Parse and add IPFIX (Options) Template from a NetFlow (Options) Template record
+ *
+ * The function tries to parse and convert a NetFlow (Options) Template record to IPFIX (Options)
+ * Template record (see conv_tmplt_create()) and append it to the new IPFIX Message.
+ *
+ * @param[in] conv    Converter internals
+ * @param[in] it      Template iterator (points to Template to be parsed)
+ * @param[in] fset_id Template type (::IPX_NF9_SET_TMPLT or ::IPX_NF9_SET_OPTS_TMPLT)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED if the IPFIX Template cannot be added due to format incompatibility.
+ *   However, a dummy record that signalizes unsupported conversion is added into the Template table.
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static inline int
+conv_tmplt_from_data(ipx_nf9_conv_t *conv, const struct ipx_nf9_tset_iter *it, uint16_t fset_id)
+{
+    const struct nf9_trec *template;
+    int rc = conv_tmplt_create(conv, it, fset_id, &template);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
     // Copy the template to the new message
     return conv_tmplt_append(conv, template);
 }
@@ -1274,4 +1303,68 @@ void
 ipx_nf9_conv_verb(ipx_nf9_conv_t *conv, enum ipx_verb_level v_new)
 {
     conv->vlevel = v_new;
-}
\ No newline at end of file
+}
+void
+ipx_nf9_conv_tmplts_for(const ipx_nf9_conv_t *conv, ipx_nf9_conv_tmplt_cb cb, void *data)
+{
+    for (size_t l1_idx = 0; l1_idx < TMPLTS_TABLE_SIZE; ++l1_idx) {
+        const struct tmplts_l2_table *l2_table = conv->l1_table.l2_tables[l1_idx];
+        if (!l2_table) {
+            continue;
+        }
+
+        for (size_t l2_idx = 0; l2_idx < TMPLTS_TABLE_SIZE; ++l2_idx) {
+            const struct nf9_trec *rec = l2_table->recs[l2_idx];
+            if (!rec) {
+                continue;
+            }
+
+            cb(rec->type, rec->nf9_data, rec->nf9_size, data);
+        }
+    }
+}
+
+int
+ipx_nf9_conv_tmplt_restore(ipx_nf9_conv_t *conv, const struct ipx_msg_ctx *msg_ctx,
+    uint16_t type, const uint8_t *rec, uint16_t size, const uint8_t **ipx_rec, uint16_t *ipx_size)
+{
+    if (type != IPX_NF9_SET_TMPLT && type != IPX_NF9_SET_OPTS_TMPLT) {
+        return IPX_ERR_FORMAT;
+    }
+
+    if (size > UINT16_MAX - IPX_NF9_SET_HDR_LEN) {
+        return IPX_ERR_FORMAT;
+    }
+
+    // Wrap the template into a FlowSet and check it using the same parser as received FlowSets
+    const size_t set_size = IPX_NF9_SET_HDR_LEN + size;
+    struct ipx_nf9_set_hdr *set = malloc(set_size);
+    if (!set) {
+        return IPX_ERR_NOMEM;
+    }
+
+    set->flowset_id = htons(type);
+    set->length = htons((uint16_t) set_size);
+    memcpy(((uint8_t *) set) + IPX_NF9_SET_HDR_LEN, rec, size);
+
+    conv->data.msg_ctx = msg_ctx; // For log messages only
+    struct ipx_nf9_tset_iter it;
+    ipx_nf9_tset_iter_init(&it, set);
+    int rc = ipx_nf9_tset_iter_next(&it);
+    if (rc != IPX_OK || it.size != size) {
+        // Malformed template or padding
+        free(set);
+        return IPX_ERR_FORMAT;
+    }
+
+    const struct nf9_trec *trec;
+    rc = conv_tmplt_create(conv, &it, type, &trec);
+    free(set);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    *ipx_rec = trec->ipx_data;
+    *ipx_size = trec->ipx_size;
+    return IPX_OK;
+}
@@ -40,7 +40,14 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <endian.h>
+#include <time.h>
+#include <unistd.h>
 #include <inttypes.h>
+#include <sys/socket.h>
 #include <libfds.h>
 #include <ipfixcol2.h>
 
@@ -57,6 +64,27 @@
 /** Default record of the stream structure */
 #define STREAM_DEF_RECS 1
 
+/** Magic number of the file with (Options) Templates ("IPXT")             */
+#define TSTATE_MAGIC 0x49505854U
+/** Version of the file with (Options) Templates                           */
+#define TSTATE_VERSION 1U
+/** Size of the file header (magic, version, reserved, number of streams)  */
+#define TSTATE_HDR_LEN 12U
+/** Size of a stream header in the file                                    */
+#define TSTATE_REC_LEN 44U
+/** Size of a template header in the file (type, size)                     */
+#define TSTATE_TMPLT_LEN 4U
+/**
+ * Maximum age of unmatched streams in the file (seconds)
+ * \note Templates cannot be restored after this time anyway, because the template lifetime of
+ *   UDP sessions is stored as a 16bit value.
+ */
+#define TSTATE_MAX_AGE UINT16_MAX
+/** Maximum number of kept template states of inactive streams (the oldest ones are replaced) */
+#define TSTATE_MAX_CNT (65536U)
+/** Minimal interval between removals of too old template states (seconds)                   */
+#define TSTATE_PRUNE_INTERVAL (300U)
+
 /** Auxiliary flags specific to each Stream ID within a Stream context */
 enum stream_info_flags {
     /** Stream has been seen                                           */
@@ -103,6 +131,8 @@ struct stream_ctx {
     uint16_t flags;
     /** Type of source messages (IPFIX/NetFlow)   */
     enum source_type type;
+    /** Export Time of the last message           */
+    uint32_t exp_time;
     /** Messages converters to IPFIX (based on source type) */
     union {
         /** Converter from NetFlow v5 to IPFIX    */
@@ -133,6 +163,38 @@ struct parser_rec {
     struct stream_ctx *ctx;
 };
 
+/**
+ * \brief Identification of a stream in the file with (Options) Templates
+ * \note Only UDP Transport Sessions are stored, therefore, the exporter is identified by its
+ *   IP address and port.
+ */
+struct parser_tkey {
+    /** IP address of the exporter (IPv4 addresses are mapped to IPv6) */
+    uint8_t addr[16];
+    /** Port of the exporter                                           */
+    uint16_t port;
+    /** Observation Domain ID                                          */
+    uint32_t odid;
+};
+
+/** (Options) Templates of an inactive stream (loaded from a file or of a closed session) */
+struct parser_tstate {
+    /** Identification of the stream                                   */
+    struct parser_tkey key;
+    /** Type of source messages (only #ST_IPFIX or #ST_NETFLOW9)       */
+    enum source_type type;
+    /** Export Time of the last message of the stream                  */
+    uint32_t exp_time;
+    /** Time when the stream was active (UNIX timestamp, collector)    */
+    uint64_t saved;
+    /** Number of templates                                            */
+    uint16_t tmplt_cnt;
+    /** Size of templates                                              */
+    uint32_t size;
+    /** Templates (type and size (both 16b, network byte order), raw template record, ...) */
+    uint8_t *data;
+};
+
 /** Main structure of IPFIX message parser         */
 struct ipx_parser {
     /** Plugin identification (for logs)           */
@@ -149,6 +211,17 @@ struct ipx_parser {
     size_t recs_valid;
     /** Array of records                           */
     struct parser_rec *recs;
+
+    /** Keep templates of removed UDP Transport Sessions (see ipx_parser_tmplts_keep()) */
+    bool tstates_keep;
+    /** Number of template states of inactive streams */
+    size_t tstates_cnt;
+    /** Number of pre-allocated template states       */
+    size_t tstates_alloc;
+    /** Array of template states (sorted, not matched with any Transport Session yet) */
+    struct parser_tstate *tstates;
+    /** Time of the next removal of too old template states (UNIX timestamp) */
+    uint64_t tstates_prune;
 };
 
 /**
@@ -1142,6 +1215,472 @@ parser_convert(ipx_parser_t *parser, struct parser_rec *rec, ipx_msg_ipfix_t *ms
     return IPX_OK;
 }
 
+/**
+ * \brief Compare identification of two template states
+ * \param[in] p1 First template state
+ * \param[in] p2 Second template state
+ * \return An integer less than, equal to, or greater than zero if the first argument is considered
+ *   to be respectively less than, equal to, or greater than the second.
+ */
+static int
+parser_tstate_cmp(const void *p1, const void *p2)
+{
+    const struct parser_tkey *key_l = &((const struct parser_tstate *) p1)->key;
+    const struct parser_tkey *key_r = &((const struct parser_tstate *) p2)->key;
+
+    int rc = memcmp(key_l->addr, key_r->addr, sizeof(key_l->addr));
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (key_l->port != key_r->port) {
+        return (key_l->port < key_r->port) ? (-1) : 1;
+    }
+
+    if (key_l->odid != key_r->odid) {
+        return (key_l->odid < key_r->odid) ? (-1) : 1;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Get identification of a stream for the file with (Options) Templates
+ * \param[in]  session Transport Session
+ * \param[in]  odid    Observation Domain ID
+ * \param[out] key     Identification
+ * \return True on success
+ * \return False if templates of the Transport Session cannot be stored (not UDP)
+ */
+static bool
+parser_tkey_get(const struct ipx_session *session, uint32_t odid, struct parser_tkey *key)
+{
+    if (session->type != FDS_SESSION_UDP) {
+        return false;
+    }
+
+    const struct ipx_session_net *net = &session->udp.net;
+    memset(key, 0, sizeof(*key));
+    if (net->l3_proto == AF_INET) {
+        // IPv4-mapped IPv6 address
+        key->addr[10] = 0xFF;
+        key->addr[11] = 0xFF;
+        memcpy(&key->addr[12], &net->addr_src.ipv4, 4U);
+    } else {
+        memcpy(key->addr, &net->addr_src.ipv6, 16U);
+    }
+
+    key->port = net->port_src;
+    key->odid = odid;
+    return true;
+}
+
+/**
+ * \brief Parse an (Options) Template and add it into a template manager
+ * \param[in] mgr  Template manager
+ * \param[in] type Type of the template
+ * \param[in] raw  Template record
+ * \param[in] size Size of the template record
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the template is malformed
+ * \return #IPX_ERR_DENIED if the template cannot be added
+ */
+static int
+parser_tstate_tmplt_add(fds_tmgr_t *mgr, enum fds_template_type type, const uint8_t *raw,
+    uint16_t size)
+{
+    struct fds_template *tmplt;
+    if (fds_template_parse(type, raw, &size, &tmplt) != FDS_OK) {
+        return IPX_ERR_FORMAT;
+    }
+
+    if (fds_tmgr_template_add(mgr, tmplt) != FDS_OK) {
+        fds_template_destroy(tmplt);
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+/** Auxiliary buffer for serialization of (Options) Templates of a stream */
+struct parser_tbuffer {
+    /** Serialized templates             */
+    uint8_t *data;
+    /** Allocated size of the buffer     */
+    size_t alloc;
+    /** Used size of the buffer          */
+    size_t used;
+    /** Number of templates              */
+    uint16_t cnt;
+    /** Memory allocation failed         */
+    bool failed;
+};
+
+/**
+ * \brief Append an (Options) Template to a serialization buffer
+ * \param[in] buffer Buffer
+ * \param[in] type   Type of the template (i.e. IPFIX/NetFlow v9 (Options) Template Set ID)
+ * \param[in] raw    Template record
+ * \param[in] size   Size of the template record
+ */
+static void
+parser_tbuffer_add(struct parser_tbuffer *buffer, uint16_t type, const uint8_t *raw,
+    uint16_t size)
+{
+    const size_t size_req = buffer->used + TSTATE_TMPLT_LEN + size;
+    if (buffer->failed || buffer->cnt == UINT16_MAX) {
+        return;
+    }
+
+    if (size_req > buffer->alloc) {
+        const size_t alloc_new = 2 * size_req;
+        uint8_t *data_new = realloc(buffer->data, alloc_new);
+        if (!data_new) {
+            buffer->failed = true;
+            return;
+        }
+
+        buffer->data = data_new;
+        buffer->alloc = alloc_new;
+    }
+
+    uint8_t *ptr = &buffer->data[buffer->used];
+    *(uint16_t *) &ptr[0] = htons(type);
+    *(uint16_t *) &ptr[2] = htons(size);
+    memcpy(&ptr[TSTATE_TMPLT_LEN], raw, size);
+    buffer->used = size_req;
+    buffer->cnt++;
+}
+
+/**
+ * \brief Append an IPFIX (Options) Template to a serialization buffer (callback)
+ * \param[in] tmplt Template
+ * \param[in] data  Buffer
+ * \return Always true (i.e. continue)
+ */
+static bool
+parser_tbuffer_ipfix_cb(const struct fds_template *tmplt, void *data)
+{
+    const uint16_t type = (tmplt->type == FDS_TYPE_TEMPLATE)
+        ? FDS_IPFIX_SET_TMPLT : FDS_IPFIX_SET_OPTS_TMPLT;
+    parser_tbuffer_add(data, type, tmplt->raw.data, tmplt->raw.length);
+    return true;
+}
+
+/**
+ * \brief Append a NetFlow v9 (Options) Template to a serialization buffer (callback)
+ * \param[in] type Template type
+ * \param[in] rec  Template record
+ * \param[in] size Size of the template record
+ * \param[in] data Buffer
+ */
+static void
+parser_tbuffer_nf9_cb(uint16_t type, const uint8_t *rec, uint16_t size, void *data)
+{
+    parser_tbuffer_add(data, type, rec, size);
+}
+
+/**
+ * \brief Serialize (Options) Templates of a stream
+ *
+ * Previous content of the buffer is replaced.
+ * \param[in] rec    Parser record of the stream
+ * \param[in] buffer Serialization buffer
+ * \return True on success
+ * \return False if the stream has no templates to store or its type is unknown
+ */
+static bool
+parser_tbuffer_fill(const struct parser_rec *rec, struct parser_tbuffer *buffer)
+{
+    const struct stream_ctx *ctx = rec->ctx;
+    buffer->used = 0;
+    buffer->cnt = 0;
+
+    if (ctx->type == ST_IPFIX) {
+        const fds_tsnapshot_t *snap;
+        if (fds_tmgr_snapshot_get(ctx->mgr, &snap) != FDS_OK) {
+            return false;
+        }
+        fds_tsnapshot_for(snap, &parser_tbuffer_ipfix_cb, buffer);
+    } else if (ctx->type == ST_NETFLOW9 && ctx->converter.nf9 != NULL) {
+        ipx_nf9_conv_tmplts_for(ctx->converter.nf9, &parser_tbuffer_nf9_cb, buffer);
+    } else {
+        return false;
+    }
+
+    return !buffer->failed && buffer->cnt > 0;
+}
+
+/**
+ * \brief Remove template states that are too old to be restored
+ * \param[in] parser Parser
+ * \param[in] now    Current time (UNIX timestamp)
+ */
+static void
+parser_tstate_prune(ipx_parser_t *parser, uint64_t now)
+{
+    size_t cnt_new = 0;
+    for (size_t idx = 0; idx < parser->tstates_cnt; ++idx) {
+        struct parser_tstate *state = &parser->tstates[idx];
+        if (state->saved + TSTATE_MAX_AGE < now) {
+            free(state->data);
+            continue;
+        }
+
+        parser->tstates[cnt_new++] = *state;
+    }
+
+    parser->tstates_cnt = cnt_new;
+    parser->tstates_prune = now + TSTATE_PRUNE_INTERVAL;
+}
+
+/**
+ * \brief Remove the oldest template state (i.e. the state of the longest inactive stream)
+ * \param[in] parser Parser
+ */
+static void
+parser_tstate_evict(ipx_parser_t *parser)
+{
+    assert(parser->tstates_cnt > 0);
+    size_t oldest = 0;
+    for (size_t idx = 1; idx < parser->tstates_cnt; ++idx) {
+        if (parser->tstates[idx].saved < parser->tstates[oldest].saved) {
+            oldest = idx;
+        }
+    }
+
+    struct parser_tstate *state = &parser->tstates[oldest];
+    free(state->data);
+    memmove(state, state + 1, (parser->tstates_cnt - oldest - 1) * sizeof(*state));
+    parser->tstates_cnt--;
+}
+
+/**
+ * \brief Find a position of a template state in the sorted array of template states
+ * \param[in]  parser Parser
+ * \param[in]  state  Template state with the identification of the stream
+ * \param[out] found  True if a state of the same stream is at the position
+ * \return Index of the state of the same stream or the index where it should be inserted
+ */
+static size_t
+parser_tstate_pos(const ipx_parser_t *parser, const struct parser_tstate *state, bool *found)
+{
+    size_t low = 0;
+    size_t high = parser->tstates_cnt;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int rc = parser_tstate_cmp(&parser->tstates[mid], state);
+        if (rc == 0) {
+            *found = true;
+            return mid;
+        } else if (rc < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *found = false;
+    return low;
+}
+
+/**
+ * \brief Keep (Options) Templates of streams of a Transport Session that is being removed
+ *
+ * Templates of each stream are stored as a template state (a previous state of the same stream
+ * is replaced), so they are saved together with templates of active streams and can be
+ * restored when the exporter appears again (e.g. after the collector is restarted). Only
+ * streams of UDP Transport Sessions are considered and only if enabled by
+ * ipx_parser_tmplts_keep(). Too old states are periodically removed and the number of states
+ * is limited to #TSTATE_MAX_CNT (states of the longest inactive streams are replaced).
+ * \note Failures are ignored, the templates are just not kept.
+ * \param[in] parser Parser
+ * \param[in] begin  Index of the first parser record of the session
+ * \param[in] end    Index of the "past-the-last" parser record of the session
+ */
+static void
+parser_tstate_keep(ipx_parser_t *parser, size_t begin, size_t end)
+{
+    if (!parser->tstates_keep) {
+        return;
+    }
+
+    const uint64_t now = (uint64_t) time(NULL);
+    if (now >= parser->tstates_prune) {
+        parser_tstate_prune(parser, now);
+    }
+
+    const size_t state_size = sizeof(*parser->tstates);
+    struct parser_tbuffer buffer = {NULL, 0, 0, 0, false};
+
+    for (size_t idx = begin; idx < end; ++idx) {
+        const struct parser_rec *rec = &parser->recs[idx];
+        struct parser_tstate state;
+        if ((rec->ctx->flags & SCF_BLOCK) != 0
+                || !parser_tkey_get(rec->session, rec->odid, &state.key)
+                || !parser_tbuffer_fill(rec, &buffer)) {
+            continue;
+        }
+
+        state.type = rec->ctx->type;
+        state.exp_time = rec->ctx->exp_time;
+        state.saved = now;
+        state.tmplt_cnt = buffer.cnt;
+        state.size = (uint32_t) buffer.used;
+        state.data = malloc(buffer.used);
+        if (!state.data) {
+            continue;
+        }
+        memcpy(state.data, buffer.data, buffer.used);
+
+        bool found;
+        size_t pos = parser_tstate_pos(parser, &state, &found);
+        if (found) {
+            free(parser->tstates[pos].data);
+            parser->tstates[pos] = state;
+            continue;
+        }
+
+        if (parser->tstates_cnt >= TSTATE_MAX_CNT) {
+            // Replace the state of the longest inactive stream
+            parser_tstate_evict(parser);
+            pos = parser_tstate_pos(parser, &state, &found);
+        }
+
+        if (parser->tstates_cnt == parser->tstates_alloc) {
+            const size_t alloc_new = (parser->tstates_alloc == 0) ? 16U : 2 * parser->tstates_alloc;
+            struct parser_tstate *states_new = realloc(parser->tstates, alloc_new * state_size);
+            if (!states_new) {
+                free(state.data);
+                continue;
+            }
+
+            parser->tstates = states_new;
+            parser->tstates_alloc = alloc_new;
+        }
+
+        // Insert the state and keep the array sorted
+        struct parser_tstate *ptr = &parser->tstates[pos];
+        memmove(ptr + 1, ptr, (parser->tstates_cnt - pos) * state_size);
+        *ptr = state;
+        parser->tstates_cnt++;
+    }
+
+    free(buffer.data);
+}
+
+/**
+ * \brief Restore (Options) Templates of a new stream from a loaded template state
+ *
+ * If there is a loaded state of the stream (i.e. the same exporter address, port and ODID) of
+ * the same type (IPFIX/NetFlow v9), its templates are added into the template manager of
+ * the stream (and the NetFlow converter, if necessary) as if they were received at Export Time
+ * of the message. Templates that would already expire (based on the difference of Export Time
+ * of the message and the last message before the state has been saved) are skipped. The state
+ * is removed from the parser.
+ * \param[in] parser Parser
+ * \param[in] rec    Parser record of the new stream
+ * \param[in] msg    The first message of the stream
+ */
+static void
+parser_tstate_restore(ipx_parser_t *parser, struct parser_rec *rec, const ipx_msg_ipfix_t *msg)
+{
+    const struct ipx_msg_ctx *msg_ctx = &msg->ctx;
+    const struct ipx_session *session = rec->session;
+    struct parser_tstate search;
+    if (!parser_tkey_get(session, rec->odid, &search.key)) {
+        return;
+    }
+
+    const size_t state_size = sizeof(*parser->tstates);
+    struct parser_tstate *state = bsearch(&search, parser->tstates, parser->tstates_cnt,
+        state_size, &parser_tstate_cmp);
+    if (!state) {
+        return;
+    }
+
+    // Export Time of the message (i.e. the same clock as Export Time in the state)
+    uint32_t exp_time;
+    const uint16_t version = (msg->raw_size >= sizeof(uint16_t))
+        ? ntohs(*(const uint16_t *) msg->raw_pkt) : 0;
+    if (state->type == ST_IPFIX && version == FDS_IPFIX_VERSION
+            && msg->raw_size >= FDS_IPFIX_MSG_HDR_LEN) {
+        exp_time = ntohl(((const struct fds_ipfix_msg_hdr *) msg->raw_pkt)->export_time);
+    } else if (state->type == ST_NETFLOW9 && version == IPX_NF9_VERSION
+            && msg->raw_size >= IPX_NF9_MSG_HDR_LEN) {
+        exp_time = ntohl(((const struct ipx_nf9_msg_hdr *) msg->raw_pkt)->unix_sec);
+    } else {
+        // Different type of the flow stream, templates cannot be used
+        return;
+    }
+
+    struct stream_ctx *ctx = rec->ctx;
+    if (fds_tmgr_set_time(ctx->mgr, exp_time) != FDS_OK) {
+        return;
+    }
+
+    if (state->type == ST_NETFLOW9) {
+        ctx->converter.nf9 = ipx_nf9_conv_init(parser->ident, parser->vlevel);
+        if (!ctx->converter.nf9) {
+            PARSER_ERROR(parser, msg_ctx, "Failed to initialize NetFlow v9 converter!", '\0');
+            return;
+        }
+    }
+    ctx->type = state->type;
+
+    const int64_t age = (int64_t) exp_time - (int64_t) state->exp_time;
+    unsigned int cnt_ok = 0;
+    unsigned int cnt_expired = 0;
+    unsigned int cnt_failed = 0;
+
+    const uint8_t *ptr = state->data; // Format of the data has been checked during loading
+    for (uint16_t i = 0; i < state->tmplt_cnt; ++i) {
+        uint16_t t_type = ntohs(*(const uint16_t *) &ptr[0]);
+        uint16_t t_size = ntohs(*(const uint16_t *) &ptr[2]);
+        const uint8_t *t_raw = &ptr[TSTATE_TMPLT_LEN];
+        ptr += TSTATE_TMPLT_LEN + t_size;
+
+        const bool opts = (state->type == ST_IPFIX)
+            ? (t_type == FDS_IPFIX_SET_OPTS_TMPLT) : (t_type == IPX_NF9_SET_OPTS_TMPLT);
+        const uint16_t lifetime = (opts)
+            ? session->udp.lifetime.opts_tmplts : session->udp.lifetime.tmplts;
+        if (lifetime != 0 && age > lifetime) {
+            cnt_expired++;
+            continue;
+        }
+
+        if (state->type == ST_NETFLOW9) {
+            int rc = ipx_nf9_conv_tmplt_restore(ctx->converter.nf9, msg_ctx, t_type, t_raw,
+                t_size, &t_raw, &t_size);
+            if (rc == IPX_ERR_DENIED) {
+                // Known to the converter, however, its records will be dropped
+                cnt_ok++;
+                continue;
+            } else if (rc != IPX_OK) {
+                cnt_failed++;
+                continue;
+            }
+        }
+
+        enum fds_template_type fds_type = (opts) ? FDS_TYPE_TEMPLATE_OPTS : FDS_TYPE_TEMPLATE;
+        if (parser_tstate_tmplt_add(ctx->mgr, fds_type, t_raw, t_size) != IPX_OK) {
+            cnt_failed++;
+            continue;
+        }
+
+        cnt_ok++;
+    }
+
+    PARSER_INFO(parser, msg_ctx, "%u (Options) Template(s) restored from the saved state "
+        "(%u expired, %u failed).", cnt_ok, cnt_expired, cnt_failed);
+
+    // The state cannot be used anymore
+    const size_t idx = state - parser->tstates;
+    free(state->data);
+    memmove(state, state + 1, (parser->tstates_cnt - idx - 1) * state_size);
+    parser->tstates_cnt--;
+}
+
 ipx_parser_t *
 ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
 {
@@ -1178,6 +1717,11 @@ ipx_parser_destroy(ipx_parser_t *parser)
         stream_ctx_destroy(parser->recs[idx].ctx);
     }
 
+    for (size_t idx = 0; idx < parser->tstates_cnt; ++idx) {
+        free(parser->tstates[idx].data);
+    }
+
+    free(parser->tstates);
     free(parser->ident);
     free(parser->recs);
     free(parser);
@@ -1226,6 +1770,11 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         return IPX_ERR_DENIED;
     }
 
+    if (rec->ctx->type == ST_UNKNOWN && parser->tstates_keep && parser->tstates_cnt > 0) {
+        // The first message of the stream, try to restore its templates
+        parser_tstate_restore(parser, rec, *ipfix);
+    }
+
     if ((info = stream_ctx_rec_get(&rec->ctx, msg_ctx->stream)) == NULL) {
         PARSER_ERROR(parser, msg_ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
         return IPX_ERR_NOMEM;
@@ -1282,6 +1831,7 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
 
     // Configure a template manager
     fds_tmgr_t *tmgr = rec->ctx->mgr;
+    rec->ctx->exp_time = ntohl(msg_data->export_time);
     int rc;
     if ((rc = fds_tmgr_set_time(tmgr, ntohl(msg_data->export_time))) != FDS_OK) {
         switch (rc) {
@@ -1450,6 +2000,9 @@ ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *sessio
         }
     }
 
+    // Keep templates of the session (i.e. they can be restored if the exporter appears again)
+    parser_tstate_keep(parser, idx_start, idx_end);
+
     // Move session data into garbage
     ipx_msg_garbage_t *garbage_msg = parser_rec_to_garbage(parser, idx_start, idx_end);
     /* Note: If the garbage message is NULL, allocation of the memory failed and information about
@@ -1520,3 +2073,441 @@ ipx_parser_session_for(ipx_parser_t *parser, ipx_parser_for_cb cb, void *data)
         cb(parser, now, data); // Number of valid records can be changed here!
     }
 }
+
+/**
+ * \brief Write a template state of a stream into a file
+ * \param[in] file  File
+ * \param[in] state Template state to write (all fields must be defined)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the write operation failed
+ */
+static int
+parser_tstate_write(FILE *file, const struct parser_tstate *state)
+{
+    uint8_t hdr[TSTATE_REC_LEN];
+    memcpy(&hdr[0], state->key.addr, 16U);
+    *(uint16_t *) &hdr[16] = htons(state->key.port);
+    hdr[18] = (state->type == ST_IPFIX) ? FDS_IPFIX_VERSION : IPX_NF9_VERSION;
+    hdr[19] = 0; // Reserved
+    *(uint32_t *) &hdr[20] = htonl(state->key.odid);
+    *(uint32_t *) &hdr[24] = htonl(state->exp_time);
+    *(uint64_t *) &hdr[28] = htobe64(state->saved);
+    *(uint16_t *) &hdr[36] = htons(state->tmplt_cnt);
+    *(uint16_t *) &hdr[38] = 0; // Reserved
+    *(uint32_t *) &hdr[40] = htonl(state->size);
+
+    if (fwrite(hdr, TSTATE_REC_LEN, 1, file) != 1) {
+        return IPX_ERR_DENIED;
+    }
+
+    if (state->size > 0 && fwrite(state->data, state->size, 1, file) != 1) {
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Write template states of all streams into a file
+ *
+ * \note The number of streams in the file header is always zero and it MUST be updated by
+ *   the caller.
+ * \param[in]  parser Parser
+ * \param[in]  file   File
+ * \param[out] cnt    Number of written streams
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the write operation failed
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+parser_tstates_write(ipx_parser_t *parser, FILE *file, uint32_t *cnt)
+{
+    const uint64_t now = (uint64_t) time(NULL);
+    uint32_t state_cnt = 0;
+    int rc = IPX_OK;
+
+    // Header (the number of streams is updated at the end)
+    uint8_t hdr[TSTATE_HDR_LEN];
+    *(uint32_t *) &hdr[0] = htonl(TSTATE_MAGIC);
+    *(uint16_t *) &hdr[4] = htons(TSTATE_VERSION);
+    *(uint16_t *) &hdr[6] = 0; // Reserved
+    *(uint32_t *) &hdr[8] = 0;
+    if (fwrite(hdr, TSTATE_HDR_LEN, 1, file) != 1) {
+        return IPX_ERR_DENIED;
+    }
+
+    // Kept states of streams processed by the parser (they are marked during a single pass)
+    bool *live = NULL;
+    if (parser->tstates_cnt > 0) {
+        live = calloc(parser->tstates_cnt, sizeof(*live));
+        if (!live) {
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    // Streams processed by the parser
+    struct parser_tbuffer buffer = {NULL, 0, 0, 0, false};
+    for (size_t idx = 0; rc == IPX_OK && idx < parser->recs_valid; ++idx) {
+        const struct parser_rec *rec = &parser->recs[idx];
+        const struct stream_ctx *ctx = rec->ctx;
+        struct parser_tstate state;
+
+        if (!parser_tkey_get(rec->session, rec->odid, &state.key)) {
+            continue;
+        }
+
+        if (live != NULL) {
+            bool found;
+            const size_t pos = parser_tstate_pos(parser, &state, &found);
+            if (found) {
+                live[pos] = true;
+            }
+        }
+
+        if ((ctx->flags & SCF_BLOCK) != 0) {
+            continue;
+        }
+
+        if (!parser_tbuffer_fill(rec, &buffer)) {
+            if (buffer.failed) {
+                rc = IPX_ERR_NOMEM;
+            }
+            continue;
+        }
+
+        state.type = ctx->type;
+        state.exp_time = ctx->exp_time;
+        state.saved = now;
+        state.tmplt_cnt = buffer.cnt;
+        state.size = (uint32_t) buffer.used;
+        state.data = buffer.data;
+        rc = parser_tstate_write(file, &state);
+        state_cnt++;
+    }
+    free(buffer.data);
+
+    // Kept streams that are not active now (unless they are too old)
+    for (size_t idx = 0; rc == IPX_OK && idx < parser->tstates_cnt; ++idx) {
+        const struct parser_tstate *state = &parser->tstates[idx];
+        if (state->saved + TSTATE_MAX_AGE < now || live[idx]) {
+            continue;
+        }
+
+        rc = parser_tstate_write(file, state);
+        state_cnt++;
+    }
+    free(live);
+
+    *cnt = state_cnt;
+    return rc;
+}
+
+int
+ipx_parser_tmplts_dump(ipx_parser_t *parser, uint8_t **data, size_t *size)
+{
+    char *buffer = NULL;
+    size_t buffer_size = 0;
+    FILE *file = open_memstream(&buffer, &buffer_size);
+    if (!file) {
+        IPX_ERROR(parser->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    uint32_t state_cnt = 0;
+    int rc = parser_tstates_write(parser, file, &state_cnt);
+    if (fclose(file) != 0 && rc == IPX_OK) {
+        rc = IPX_ERR_NOMEM;
+    }
+
+    if (rc == IPX_OK && buffer_size < TSTATE_HDR_LEN) {
+        rc = IPX_ERR_NOMEM;
+    }
+
+    if (rc != IPX_OK) {
+        // Writing into a memory stream fails only if the buffer cannot be extended
+        IPX_ERROR(parser->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        free(buffer);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Update the number of streams
+    *(uint32_t *) &buffer[8] = htonl(state_cnt);
+    *data = (uint8_t *) buffer;
+    *size = buffer_size;
+    return IPX_OK;
+}
+
+int
+ipx_parser_tmplts_write(const char *ident, const char *path, const uint8_t *data, size_t size)
+{
+    const char *err_str;
+
+    // Write everything into a temporary file first, so the previous file is never corrupted
+    const size_t tmp_size = strlen(path) + 5U; // ".tmp" + '\0'
+    char *tmp_path = malloc(tmp_size);
+    if (!tmp_path) {
+        IPX_ERROR(ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+    snprintf(tmp_path, tmp_size, "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "wb");
+    if (!file) {
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(ident, "Failed to create a file '%s' with (Options) Templates: %s",
+            tmp_path, err_str);
+        free(tmp_path);
+        return IPX_ERR_DENIED;
+    }
+
+    int rc = IPX_OK;
+    if (fwrite(data, size, 1, file) != 1 || fflush(file) != 0 || fsync(fileno(file)) != 0) {
+        rc = IPX_ERR_DENIED;
+    }
+    int errno_write = errno;
+    if (fclose(file) != 0 && rc == IPX_OK) {
+        rc = IPX_ERR_DENIED;
+        errno_write = errno;
+    }
+
+    if (rc == IPX_OK && rename(tmp_path, path) != 0) {
+        rc = IPX_ERR_DENIED;
+        errno_write = errno;
+    }
+
+    if (rc != IPX_OK) {
+        ipx_strerror(errno_write, err_str);
+        IPX_ERROR(ident, "Failed to save (Options) Templates to '%s': %s", path, err_str);
+        unlink(tmp_path);
+    }
+
+    free(tmp_path);
+    return rc;
+}
+
+int
+ipx_parser_tmplts_save(ipx_parser_t *parser, const char *path)
+{
+    uint8_t *data;
+    size_t size;
+    int rc = ipx_parser_tmplts_dump(parser, &data, &size);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    rc = ipx_parser_tmplts_write(parser->ident, path, data, size);
+    free(data);
+    return rc;
+}
+
+void
+ipx_parser_tmplts_keep(ipx_parser_t *parser, bool enable)
+{
+    parser->tstates_keep = enable;
+}
+
+/**
+ * \brief Parse template states from a content of a file
+ * \param[in]  data   Content of the file
+ * \param[in]  size   Size of the content
+ * \param[out] states Array of template states (sorted)
+ * \param[out] cnt    Number of template states
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the content is malformed
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+parser_tstates_parse(const uint8_t *data, size_t size, struct parser_tstate **states,
+    size_t *cnt)
+{
+    if (size < TSTATE_HDR_LEN
+            || ntohl(*(const uint32_t *) &data[0]) != TSTATE_MAGIC
+            || ntohs(*(const uint16_t *) &data[4]) != TSTATE_VERSION) {
+        return IPX_ERR_FORMAT;
+    }
+
+    const uint32_t state_cnt = ntohl(*(const uint32_t *) &data[8]);
+    if (state_cnt > (size - TSTATE_HDR_LEN) / TSTATE_REC_LEN) {
+        return IPX_ERR_FORMAT;
+    }
+
+    struct parser_tstate *array = calloc(state_cnt + 1U, sizeof(*array));
+    if (!array) {
+        return IPX_ERR_NOMEM;
+    }
+
+    const uint8_t *ptr = &data[TSTATE_HDR_LEN];
+    const uint8_t *end = &data[size];
+    size_t idx;
+    int rc = IPX_OK;
+
+    for (idx = 0; idx < state_cnt; ++idx) {
+        if ((size_t) (end - ptr) < TSTATE_REC_LEN) {
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        struct parser_tstate *state = &array[idx];
+        memcpy(state->key.addr, &ptr[0], 16U);
+        state->key.port = ntohs(*(const uint16_t *) &ptr[16]);
+        state->key.odid = ntohl(*(const uint32_t *) &ptr[20]);
+        state->exp_time = ntohl(*(const uint32_t *) &ptr[24]);
+        state->saved = be64toh(*(const uint64_t *) &ptr[28]);
+        state->tmplt_cnt = ntohs(*(const uint16_t *) &ptr[36]);
+        state->size = ntohl(*(const uint32_t *) &ptr[40]);
+
+        switch (ptr[18]) {
+        case FDS_IPFIX_VERSION:
+            state->type = ST_IPFIX;
+            break;
+        case IPX_NF9_VERSION:
+            state->type = ST_NETFLOW9;
+            break;
+        default:
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        ptr += TSTATE_REC_LEN;
+        if (rc != IPX_OK || state->size > (size_t) (end - ptr)) {
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        // Check all templates
+        const uint8_t *t_ptr = ptr;
+        const uint8_t *t_end = ptr + state->size;
+        for (uint16_t i = 0; rc == IPX_OK && i < state->tmplt_cnt; ++i) {
+            if ((size_t) (t_end - t_ptr) < TSTATE_TMPLT_LEN) {
+                rc = IPX_ERR_FORMAT;
+                break;
+            }
+
+            const uint16_t t_type = ntohs(*(const uint16_t *) &t_ptr[0]);
+            const uint16_t t_size = ntohs(*(const uint16_t *) &t_ptr[2]);
+            const bool type_ok = (state->type == ST_IPFIX)
+                ? (t_type == FDS_IPFIX_SET_TMPLT || t_type == FDS_IPFIX_SET_OPTS_TMPLT)
+                : (t_type == IPX_NF9_SET_TMPLT || t_type == IPX_NF9_SET_OPTS_TMPLT);
+            t_ptr += TSTATE_TMPLT_LEN;
+            if (!type_ok || t_size == 0 || t_size > (size_t) (t_end - t_ptr)) {
+                rc = IPX_ERR_FORMAT;
+                break;
+            }
+            t_ptr += t_size;
+        }
+
+        if (rc != IPX_OK || t_ptr != t_end) {
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        state->data = malloc(state->size + 1U); // Prevent zero size allocation
+        if (!state->data) {
+            rc = IPX_ERR_NOMEM;
+            break;
+        }
+
+        memcpy(state->data, ptr, state->size);
+        ptr += state->size;
+    }
+
+    if (rc == IPX_OK && ptr != end) {
+        rc = IPX_ERR_FORMAT;
+    }
+
+    if (rc != IPX_OK) {
+        for (size_t i = 0; i < state_cnt; ++i) {
+            free(array[i].data);
+        }
+        free(array);
+        return rc;
+    }
+
+    qsort(array, state_cnt, sizeof(*array), &parser_tstate_cmp);
+    *states = array;
+    *cnt = state_cnt;
+    return IPX_OK;
+}
+
+int
+ipx_parser_tmplts_load(ipx_parser_t *parser, const char *path)
+{
+    const char *err_str;
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        if (errno == ENOENT) {
+            return IPX_ERR_NOTFOUND;
+        }
+
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(parser->ident, "Failed to open a file '%s' with (Options) Templates: %s",
+            path, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    // Read the whole file
+    uint8_t *data = NULL;
+    size_t size = 0;
+    size_t alloc = 0;
+    int rc = IPX_OK;
+
+    while (true) {
+        if (size == alloc) {
+            const size_t alloc_new = (alloc == 0) ? 4096U : 2 * alloc;
+            uint8_t *data_new = realloc(data, alloc_new);
+            if (!data_new) {
+                rc = IPX_ERR_NOMEM;
+                break;
+            }
+
+            data = data_new;
+            alloc = alloc_new;
+        }
+
+        size_t ret = fread(&data[size], 1, alloc - size, file);
+        size += ret;
+        if (ret == 0) {
+            if (ferror(file)) {
+                rc = IPX_ERR_DENIED;
+            }
+            break;
+        }
+    }
+    fclose(file);
+
+    struct parser_tstate *states = NULL;
+    size_t states_cnt = 0;
+    if (rc == IPX_OK) {
+        rc = parser_tstates_parse(data, size, &states, &states_cnt);
+    }
+    free(data);
+
+    switch (rc) {
+    case IPX_OK:
+        break;
+    case IPX_ERR_FORMAT:
+        IPX_ERROR(parser->ident, "File '%s' with (Options) Templates is malformed or has been "
+            "created by an incompatible version of the collector.", path);
+        return rc;
+    case IPX_ERR_NOMEM:
+        IPX_ERROR(parser->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return rc;
+    default:
+        IPX_ERROR(parser->ident, "Failed to read a file '%s' with (Options) Templates.", path);
+        return rc;
+    }
+
+    // Replace previously loaded states
+    for (size_t idx = 0; idx < parser->tstates_cnt; ++idx) {
+        free(parser->tstates[idx].data);
+    }
+    free(parser->tstates);
+
+    parser->tstates = states;
+    parser->tstates_cnt = states_cnt;
+    parser->tstates_alloc = states_cnt + 1U; // See parser_tstates_parse()
+    parser_tstate_prune(parser, (uint64_t) time(NULL));
+    IPX_INFO(parser->ident, "(Options) Templates of %zu stream(s) loaded from '%s'.",
+        parser->tstates_cnt, path);
+    return IPX_OK;
+}
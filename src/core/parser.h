@@ -214,6 +214,96 @@ typedef void (*ipx_parser_for_cb)(ipx_parser_t *parser, const struct ipx_session
 IPX_API void
 ipx_parser_session_for(ipx_parser_t *parser, ipx_parser_for_cb cb, void *data);
 
+/**
+ * \brief Enable or disable keeping and restoring (Options) Templates of UDP Transport Sessions
+ *
+ * If enabled, templates of UDP Transport Sessions removed by ipx_parser_session_remove() are kept
+ * by the parser (so they can be saved by ipx_parser_tmplts_save()) and templates of kept or
+ * loaded streams are restored when the same exporter appears again. The number of kept streams
+ * is limited and streams which are inactive for too long are removed. By default, it is disabled
+ * and templates are never restored, i.e. the parser behaves as if the exporter was new.
+ * \param[in] parser Parser
+ * \param[in] enable Enable/disable
+ */
+IPX_API void
+ipx_parser_tmplts_keep(ipx_parser_t *parser, bool enable);
+
+/**
+ * \brief Save (Options) Templates of all UDP Transport Sessions to a file
+ *
+ * For each combination of an exporter (i.e. IP address and port of a UDP Transport Session) and
+ * an ODID, currently valid IPFIX (Options) Templates or NetFlow v9 (Options) Templates are stored
+ * together with Export Time of the last processed message. Templates of UDP Transport Sessions
+ * removed by ipx_parser_session_remove() and templates loaded by ipx_parser_tmplts_load() that
+ * have not been restored yet are stored too.
+ *
+ * The file is written atomically, i.e. a temporary file is created first and then renamed.
+ * \note Templates of other types of Transport Sessions are never stored because the exporter
+ *   MUST send them again after a connection is reestablished.
+ * \param[in] parser Parser
+ * \param[in] path   Path to the file
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the file cannot be written (an error message is printed)
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_parser_tmplts_save(ipx_parser_t *parser, const char *path);
+
+/**
+ * \brief Serialize (Options) Templates of all UDP Transport Sessions into a memory buffer
+ *
+ * The content of the buffer is the same as the content of the file written by
+ * ipx_parser_tmplts_save(). It allows to write the file by another thread (see
+ * ipx_parser_tmplts_write()), so the parser is not blocked by I/O operations.
+ * \param[in]  parser Parser
+ * \param[out] data   Newly allocated buffer (must be freed by the caller using free())
+ * \param[out] size   Size of the buffer
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_parser_tmplts_dump(ipx_parser_t *parser, uint8_t **data, size_t *size);
+
+/**
+ * \brief Atomically write (Options) Templates serialized by ipx_parser_tmplts_dump() to a file
+ *
+ * A temporary file is written and synchronized first and then renamed.
+ * \note The function doesn't access any parser, so it can be called by any thread.
+ * \param[in] ident Identification of the parser (for logs)
+ * \param[in] path  Path to the file
+ * \param[in] data  Serialized templates
+ * \param[in] size  Size of serialized templates
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the file cannot be written (an error message is printed)
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_parser_tmplts_write(const char *ident, const char *path, const uint8_t *data, size_t size);
+
+/**
+ * \brief Load (Options) Templates from a file created by ipx_parser_tmplts_save()
+ *
+ * Templates are not immediately added into any template manager. When the first message of a new
+ * UDP Transport Session and ODID with the same identification (exporter IP address, port, ODID)
+ * and the same format (IPFIX/NetFlow v9) is processed, the templates are restored as if they
+ * were received at Export Time of the message, unless they would have already expired during
+ * the time since the last message before the file was saved (based on the template lifetime
+ * of the session). Therefore, data records can be interpreted from the first message even if
+ * the exporter sends templates only periodically.
+ * \warning Templates are restored only if enabled by ipx_parser_tmplts_keep().
+ * \note Templates of inactive streams (previously loaded or of removed sessions) that have not
+ *   been restored yet are replaced.
+ * \param[in] parser Parser
+ * \param[in] path   Path to the file
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the file doesn't exist
+ * \return #IPX_ERR_FORMAT if the file is malformed (an error message is printed)
+ * \return #IPX_ERR_DENIED if the file cannot be read (an error message is printed)
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_parser_tmplts_load(ipx_parser_t *parser, const char *path);
+
 /**
  * @}
  */
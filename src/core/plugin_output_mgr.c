@@ -41,6 +41,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <pthread.h>
 #include "plugin_output_mgr.h"
 #include "message_base.h"
 #include "context.h"
@@ -61,6 +62,10 @@ struct ipx_output_mgr_list {
     size_t size;
     /** Array of records           */
     struct ipx_output_mgr_rec *recs;
+    /** Lock (held by the output manager while a message is being passed)   */
+    pthread_mutex_t lock;
+    /** Termination messages are not passed to output instances             */
+    bool detached;
 };
 
 ipx_output_mgr_list_t *
@@ -71,18 +76,46 @@ ipx_output_mgr_list_create()
         return NULL;
     }
 
+    if (pthread_mutex_init(&result->lock, NULL) != 0) {
+        free(result);
+        return NULL;
+    }
+
     result->size = 0;
     result->recs = NULL;
+    result->detached = false;
     return result;
 }
 
 void
 ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list)
 {
+    pthread_mutex_destroy(&list->lock);
     free(list->recs);
     free(list);
 }
 
+void
+ipx_output_mgr_list_swap(ipx_output_mgr_list_t *list, ipx_output_mgr_list_t *other)
+{
+    pthread_mutex_lock(&list->lock);
+    size_t tmp_size = list->size;
+    struct ipx_output_mgr_rec *tmp_recs = list->recs;
+    list->size = other->size;
+    list->recs = other->recs;
+    other->size = tmp_size;
+    other->recs = tmp_recs;
+    pthread_mutex_unlock(&list->lock);
+}
+
+void
+ipx_output_mgr_list_detach(ipx_output_mgr_list_t *list)
+{
+    pthread_mutex_lock(&list->lock);
+    list->detached = true;
+    pthread_mutex_unlock(&list->lock);
+}
+
 bool
 ipx_output_mgr_list_empty(const ipx_output_mgr_list_t *list)
 {
@@ -121,6 +154,21 @@ ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
     return IPX_OK;
 }
 
+int
+ipx_output_mgr_terminate(ipx_ring_t *ring)
+{
+    ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+    if (!msg) {
+        return IPX_ERR_NOMEM;
+    }
+
+    // Only one output instance will receive the message
+    ipx_msg_t *msg_base = ipx_msg_terminate2base(msg);
+    ipx_msg_header_cnt_set(msg_base, 1U);
+    ipx_ring_push(ring, msg_base);
+    return IPX_OK;
+}
+
 // ------------------------------------------------------------------------------------------------
 
 const struct ipx_plugin_info ipx_plugin_output_mgr_info = {
@@ -163,8 +211,18 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
     assert(list != NULL);
 
+    // The list of destinations cannot be modified while the message is being passed
+    pthread_mutex_lock(&list->lock);
+
     // Only IPFIX messages are filtered
     enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    if (msg_type == IPX_MSG_TERMINATE && list->detached) {
+        // Output instances are connected to another output manager, don't terminate them
+        ipx_msg_termiante_destroy(ipx_msg_base2terminate(msg));
+        pthread_mutex_unlock(&list->lock);
+        return IPX_OK;
+    }
+
     if (msg_type != IPX_MSG_IPFIX) {
         // Set the number of references and pass the message to all output instances
         ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
@@ -173,6 +231,7 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
             ipx_ring_push(list->recs[i].ring, msg);
         }
 
+        pthread_mutex_unlock(&list->lock);
         return IPX_OK;
     }
 
@@ -208,6 +267,7 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     if (dest_cnt == 0) {
         // No-one wants the message -> destroy
         ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg));
+        pthread_mutex_unlock(&list->lock);
         return IPX_OK;
     }
 
@@ -223,5 +283,6 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         ipx_ring_push(rec->ring, msg);
     }
 
+    pthread_mutex_unlock(&list->lock);
     return IPX_OK;
 }
\ No newline at end of file
@@ -89,6 +89,43 @@ int
 ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
     enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter);
 
+/**
+ * \brief Exchange destinations of two lists
+ *
+ * The function is safe to use even if the output manager is running and uses the \p list.
+ * After return, the output manager will never pass a message to previous destinations of
+ * the \p list, so it is possible to send termination messages to them.
+ * \warning The \p other list MUST NOT be used by any running output manager.
+ * \param[in] list  Output manager list (can be used by a running output manager)
+ * \param[in] other Another output manager list
+ */
+void
+ipx_output_mgr_list_swap(ipx_output_mgr_list_t *list, ipx_output_mgr_list_t *other);
+
+/**
+ * \brief Detach the list from output instances
+ *
+ * All messages are still passed to the destinations, however, a termination message is
+ * destroyed instead. This is useful if the output manager should be terminated but its output
+ * instances must keep running (i.e. they will be connected to another output manager).
+ * \param[in] list Output manager list
+ */
+void
+ipx_output_mgr_list_detach(ipx_output_mgr_list_t *list);
+
+/**
+ * \brief Send a termination message to an output instance
+ *
+ * The function is useful to terminate an output instance that has been removed from the list
+ * of destinations of a running output manager (see ipx_output_mgr_list_swap()).
+ * \warning The ring buffer MUST NOT be used by any output manager.
+ * \param[in] ring Input ring buffer of the output instance
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+int
+ipx_output_mgr_terminate(ipx_ring_t *ring);
+
 // ------------------------------------------------------------------------------------------------
 
 /** Description of the output manager plugin */
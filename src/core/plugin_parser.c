@@ -39,6 +39,12 @@
  *
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <signal.h>
+
 #include "fpipe.h"
 #include "context.h"
 #include "plugin_parser.h"
@@ -53,11 +59,154 @@ const struct ipx_plugin_info ipx_plugin_parser_info = {
     .ipx_min = "2.0.0"
 };
 
+/** Interval between periodic saves of (Options) Templates (in seconds)              */
+#define PARSER_TMPLTS_INTERVAL (60)
+/** Number of processed IPFIX Messages between checks of the periodic save interval  */
+#define PARSER_TMPLTS_CHECK (256U)
+
+/** Instance data of the parser plugin */
+struct parser_plugin {
+    /** IPFIX Message parser                                                  */
+    ipx_parser_t *parser;
+    /** File with (Options) Templates of UDP Transport Sessions (can be NULL) */
+    char *tmplts_file;
+    /** Time of the next periodic save of (Options) Templates                 */
+    time_t tmplts_next;
+    /** Number of IPFIX Messages processed since the last check of the time   */
+    unsigned int tmplts_msgs;
+
+    struct {
+        /** Identification of the instance (for logs)                        */
+        const char *ident;
+        /** Thread writing serialized templates to the file                   */
+        pthread_t thread;
+        /** The thread is running                                             */
+        bool running;
+        /** Lock of the request                                               */
+        pthread_mutex_t lock;
+        /** Condition variable of the request                                 */
+        pthread_cond_t cond;
+        /** Serialized templates to write (NULL if there is no request)       */
+        uint8_t *data;
+        /** Size of serialized templates                                      */
+        size_t size;
+        /** Stop the thread                                                   */
+        bool stop;
+    } writer; /**< Writer of periodically saved (Options) Templates           */
+};
+
+/**
+ * \brief Thread writing periodically saved (Options) Templates to the file
+ *
+ * The parser only serializes templates into a memory buffer, so it is never blocked by writing
+ * and synchronizing the file. If a new request arrives before the previous one has been written,
+ * the previous one is replaced.
+ * \param[in] arg Instance data
+ * \return Always NULL
+ */
+static void *
+parser_plugin_writer(void *arg)
+{
+    struct parser_plugin *plugin = (struct parser_plugin *) arg;
+
+    pthread_mutex_lock(&plugin->writer.lock);
+    while (true) {
+        while (plugin->writer.data == NULL && !plugin->writer.stop) {
+            pthread_cond_wait(&plugin->writer.cond, &plugin->writer.lock);
+        }
+
+        if (plugin->writer.stop) {
+            // The final state is saved by the instance during its destruction
+            break;
+        }
+
+        uint8_t *data = plugin->writer.data;
+        size_t size = plugin->writer.size;
+        plugin->writer.data = NULL;
+        pthread_mutex_unlock(&plugin->writer.lock);
+
+        ipx_parser_tmplts_write(plugin->writer.ident, plugin->tmplts_file, data, size);
+        free(data);
+
+        pthread_mutex_lock(&plugin->writer.lock);
+    }
+
+    free(plugin->writer.data);
+    plugin->writer.data = NULL;
+    pthread_mutex_unlock(&plugin->writer.lock);
+    return NULL;
+}
+
+/**
+ * \brief Start the writer of periodically saved (Options) Templates
+ *
+ * All signals are blocked in the thread, so they are always delivered to the main thread.
+ * \param[in] ctx    Plugin context
+ * \param[in] plugin Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the thread cannot be started
+ */
+static int
+parser_plugin_writer_start(ipx_ctx_t *ctx, struct parser_plugin *plugin)
+{
+    plugin->writer.ident = ipx_ctx_name_get(ctx);
+    plugin->writer.data = NULL;
+    plugin->writer.stop = false;
+    if (pthread_mutex_init(&plugin->writer.lock, NULL) != 0) {
+        return IPX_ERR_DENIED;
+    }
+    if (pthread_cond_init(&plugin->writer.cond, NULL) != 0) {
+        pthread_mutex_destroy(&plugin->writer.lock);
+        return IPX_ERR_DENIED;
+    }
+
+    sigset_t set_new, set_old;
+    sigfillset(&set_new);
+    pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
+    int rc = pthread_create(&plugin->writer.thread, NULL, &parser_plugin_writer, plugin);
+    pthread_sigmask(SIG_SETMASK, &set_old, NULL);
+
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to start a thread saving (Options) Templates. "
+            "pthread_create() failed: %s", err_str);
+        pthread_cond_destroy(&plugin->writer.cond);
+        pthread_mutex_destroy(&plugin->writer.lock);
+        return IPX_ERR_DENIED;
+    }
+
+    plugin->writer.running = true;
+    return IPX_OK;
+}
+
+/**
+ * \brief Stop the writer of periodically saved (Options) Templates (if running)
+ *
+ * A pending request (if any) is discarded.
+ * \param[in] plugin Instance data
+ */
+static void
+parser_plugin_writer_stop(struct parser_plugin *plugin)
+{
+    if (!plugin->writer.running) {
+        return;
+    }
+
+    pthread_mutex_lock(&plugin->writer.lock);
+    plugin->writer.stop = true;
+    pthread_cond_signal(&plugin->writer.cond);
+    pthread_mutex_unlock(&plugin->writer.lock);
+
+    pthread_join(plugin->writer.thread, NULL);
+    pthread_cond_destroy(&plugin->writer.cond);
+    pthread_mutex_destroy(&plugin->writer.lock);
+    plugin->writer.running = false;
+}
+
 int
 ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
 {
-    (void) params; // Not used
-
     // Subscribe to receive IPFIX and Session messages
     const uint16_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
@@ -88,14 +237,51 @@ ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
         ipx_msg_garbage_destroy(garbage);
     }
 
-    ipx_ctx_private_set(ctx, parser);
+    struct parser_plugin *plugin = calloc(1, sizeof(*plugin));
+    if (!plugin) {
+        IPX_CTX_ERROR(ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        ipx_parser_destroy(parser);
+        return IPX_ERR_DENIED;
+    }
+    plugin->parser = parser;
+
+    if (params != NULL && params[0] != '\0') {
+        // Templates of UDP Transport Sessions are preserved in a file
+        plugin->tmplts_file = strdup(params);
+        if (!plugin->tmplts_file) {
+            IPX_CTX_ERROR(ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+            ipx_parser_destroy(parser);
+            free(plugin);
+            return IPX_ERR_DENIED;
+        }
+
+        // Failures are not fatal, the templates will be received from exporters again
+        ipx_parser_tmplts_keep(parser, true);
+        ipx_parser_tmplts_load(parser, plugin->tmplts_file);
+        plugin->tmplts_next = time(NULL) + PARSER_TMPLTS_INTERVAL;
+
+        if (parser_plugin_writer_start(ctx, plugin) != IPX_OK) {
+            IPX_CTX_WARNING(ctx, "(Options) Templates will be saved only on exit.", '\0');
+        }
+    }
+
+    ipx_ctx_private_set(ctx, plugin);
     return IPX_OK;
 }
 
 void
 ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
 {
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
+    struct parser_plugin *plugin = (struct parser_plugin *) cfg;
+    ipx_parser_t *parser = plugin->parser;
+
+    if (plugin->tmplts_file != NULL) {
+        // Templates of already closed Transport Sessions are still kept by the parser
+        parser_plugin_writer_stop(plugin);
+        ipx_parser_tmplts_save(parser, plugin->tmplts_file);
+        free(plugin->tmplts_file);
+    }
+    free(plugin);
 
     // Create a garbage message
     ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_parser_destroy;
@@ -283,16 +469,55 @@ parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_ipfix_
     return rc;
 }
 
+/**
+ * \brief Periodically save (Options) Templates of UDP Transport Sessions (if enabled)
+ *
+ * To avoid unnecessary system calls, the current time is checked only once per
+ * #PARSER_TMPLTS_CHECK processed IPFIX Messages. Templates are only serialized here and
+ * the file is written by the writer thread.
+ * \param[in] plugin Instance data
+ */
+static inline void
+parser_plugin_tmplts_save(struct parser_plugin *plugin)
+{
+    if (!plugin->writer.running || ++plugin->tmplts_msgs < PARSER_TMPLTS_CHECK) {
+        return;
+    }
+
+    plugin->tmplts_msgs = 0;
+    const time_t now = time(NULL);
+    if (now < plugin->tmplts_next) {
+        return;
+    }
+
+    plugin->tmplts_next = now + PARSER_TMPLTS_INTERVAL;
+
+    uint8_t *data;
+    size_t size;
+    if (ipx_parser_tmplts_dump(plugin->parser, &data, &size) != IPX_OK) {
+        return;
+    }
+
+    pthread_mutex_lock(&plugin->writer.lock);
+    free(plugin->writer.data); // The previous request hasn't been written yet
+    plugin->writer.data = data;
+    plugin->writer.size = size;
+    pthread_cond_signal(&plugin->writer.cond);
+    pthread_mutex_unlock(&plugin->writer.lock);
+}
+
 int
 ipx_plugin_parser_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
     int rc;
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
+    struct parser_plugin *plugin = (struct parser_plugin *) cfg;
+    ipx_parser_t *parser = plugin->parser;
 
     switch (ipx_msg_get_type(msg)) {
     case IPX_MSG_IPFIX:
         // Process IPFIX Message
         rc = parser_plugin_process_ipfix(ctx, parser, ipx_msg_base2ipfix(msg));
+        parser_plugin_tmplts_save(plugin);
         break;
     case IPX_MSG_SESSION:
         // Process Transport Session
@@ -49,8 +49,12 @@ extern const struct ipx_plugin_info ipx_plugin_parser_info;
 
 /**
  * \brief Initialize an IPFIX parser
+ *
+ * If a path to a file is given, (Options) Templates of UDP Transport Sessions are loaded from
+ * the file (if exists) and saved periodically and before the parser is destroyed, so data
+ * records of already known exporters can be interpreted immediately after restart.
  * \param[in] ctx    Plugin context
- * \param[in] params Ignored (should be NULL)
+ * \param[in] params Path to a file with (Options) Templates (can be NULL or empty)
  * \return #IPX_OK on success
  * \return #IPX_ERR_DENIED in case of a fatal error
  */
@@ -41,8 +41,14 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
 #include <syslog.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
 
 #include <ipfixcol2.h>
 #include "build_config.h"
@@ -55,6 +61,99 @@ static enum ipx_verb_level vlevel = IPX_VERB_ERROR;
 /** Do not use syslog unless specified otherwise */
 static bool use_syslog = false;
 
+/** Number of entries in a ring buffer of a thread (must be a power of two)     */
+#define VERB_RING_SIZE    (128U)
+/** Maximum size of a message (including the terminating null byte)            */
+#define VERB_ENTRY_SIZE   (1024U)
+/** Number of message sites tracked by each thread (must be a power of two)     */
+#define VERB_SITES        (256U)
+/** Maximum number of messages of a site per interval                           */
+#define VERB_RL_BURST     (10U)
+/** Length of a rate limiting interval (seconds)                                */
+#define VERB_RL_INTERVAL  (1U)
+/** Sleep interval of the logger thread without messages (nanoseconds)          */
+#define VERB_IDLE_SLEEP   (10000000L)
+
+/** Message in a ring buffer */
+struct verb_entry {
+    /** Verbosity level                              */
+    enum ipx_verb_level level;
+    /** Formatted message (with a new line character) */
+    char text[VERB_ENTRY_SIZE];
+};
+
+/** Message site (i.e. a place in the code that produces messages) */
+struct verb_site {
+    /** Plugin context (NULL for core messages)             */
+    const ipx_ctx_t *ctx;
+    /** Format string (NULL if the site is not used)        */
+    const char *fmt;
+    /** Beginning of the current interval (seconds, atomic) */
+    time_t window;
+    /** Number of messages in the current interval          */
+    uint32_t cnt;
+    /** Number of suppressed messages since the last report (atomic) */
+    uint64_t suppressed;
+};
+
+/** Ring buffer of messages of a thread (single producer, single consumer) */
+struct verb_ring {
+    /** Next ring in the list (protected by the lock of the logger)             */
+    struct verb_ring *next;
+    /** The owner thread has terminated (atomic)                                */
+    bool closed;
+    /** Number of dropped messages due to full ring buffer (atomic)             */
+    uint64_t dropped;
+    /** Number of suppressed messages not reported by message sites (atomic)    */
+    uint64_t forgotten;
+    /** Position of the next entry to write (written only by the owner thread)  */
+    uint32_t head;
+    /** Position of the next entry to read (written only by the logger thread)  */
+    uint32_t tail;
+    /** Message sites (used by the owner thread, see verb_ring_expire())        */
+    struct verb_site sites[VERB_SITES];
+    /** Entries                                                                 */
+    struct verb_entry entries[VERB_RING_SIZE];
+};
+
+/** Asynchronous logger */
+static struct {
+    /** Logger thread is running (atomic)         */
+    bool running;
+    /** Logger thread                             */
+    pthread_t thread;
+    /** Lock of the list of ring buffers          */
+    pthread_mutex_t lock;
+    /** List of ring buffers                      */
+    struct verb_ring *rings;
+    /** Key for detection of a thread termination */
+    pthread_key_t key;
+    /** The key has been initialized              */
+    bool key_ready;
+    /** Coarse monotonic time in seconds (updated by the logger thread, atomic) */
+    time_t now;
+    /** Time of the last check of expired message sites (only for the logger thread) */
+    time_t expired;
+} verb_async = {
+    .running = false,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .rings = NULL,
+    .key_ready = false
+};
+
+/** Names of verbosity levels */
+static const char *verb_level_str[] = {
+    [IPX_VERB_ERROR]   = "ERROR",
+    [IPX_VERB_WARNING] = "WARNING",
+    [IPX_VERB_INFO]    = "INFO",
+    [IPX_VERB_DEBUG]   = "DEBUG"
+};
+
+/** Ring buffer of the thread (NULL if not created yet) */
+static __thread struct verb_ring *verb_ring_local = NULL;
+/** Ring buffer of the thread cannot be created        */
+static __thread bool verb_ring_failed = false;
+
 // Get verbosity level of the collector
 enum ipx_verb_level
 ipx_verb_level_get()
@@ -112,6 +211,451 @@ ipx_verb_level2syslog(const enum ipx_verb_level level)
     return LOG_ERR;
 }
 
+/**
+ * \brief Get the ring buffer of the calling thread (create it, if necessary)
+ * \return Pointer to the ring buffer or NULL (memory allocation error)
+ */
+static struct verb_ring *
+verb_ring_get()
+{
+    struct verb_ring *ring = verb_ring_local;
+    if (ring != NULL || verb_ring_failed) {
+        return ring;
+    }
+
+    ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        verb_ring_failed = true;
+        return NULL;
+    }
+
+    pthread_setspecific(verb_async.key, ring);
+    pthread_mutex_lock(&verb_async.lock);
+    ring->next = verb_async.rings;
+    verb_async.rings = ring;
+    pthread_mutex_unlock(&verb_async.lock);
+
+    verb_ring_local = ring;
+    return ring;
+}
+
+/**
+ * \brief Get a free entry of a ring buffer
+ * \param[in] ring Ring buffer
+ * \return Pointer to the entry or NULL (the ring buffer is full)
+ */
+static inline struct verb_entry *
+verb_ring_reserve(struct verb_ring *ring)
+{
+    const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (ring->head - tail >= VERB_RING_SIZE) {
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    return &ring->entries[ring->head % VERB_RING_SIZE];
+}
+
+/**
+ * \brief Publish the entry previously returned by verb_ring_reserve()
+ * \param[in] ring Ring buffer
+ */
+static inline void
+verb_ring_commit(struct verb_ring *ring)
+{
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Apply rate limiting of a message site
+ *
+ * If the message can be printed and previous messages of the site have been suppressed,
+ * the number of suppressed messages is returned via \p suppressed.
+ * \param[in]  ring       Ring buffer of the calling thread
+ * \param[in]  ctx        Plugin context (can be NULL)
+ * \param[in]  fmt        Format string
+ * \param[out] suppressed Number of previously suppressed messages
+ * \return True if the message can be printed
+ * \return False if the message should be suppressed
+ */
+static inline bool
+verb_site_check(struct verb_ring *ring, const ipx_ctx_t *ctx, const char *fmt,
+    uint64_t *suppressed)
+{
+    const uintptr_t key = ((uintptr_t) fmt >> 3) ^ ((uintptr_t) ctx >> 6);
+    struct verb_site *site = &ring->sites[(key ^ (key >> 8)) % VERB_SITES];
+
+    const time_t now = __atomic_load_n(&verb_async.now, __ATOMIC_RELAXED);
+
+    if (site->fmt != fmt || site->ctx != ctx) {
+        // A new site replaces the previous one (suppressed messages are reported as forgotten)
+        uint64_t prev = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+        if (prev > 0) {
+            __atomic_add_fetch(&ring->forgotten, prev, __ATOMIC_RELAXED);
+        }
+        site->ctx = ctx;
+        site->fmt = fmt;
+        __atomic_store_n(&site->window, now, __ATOMIC_RELAXED);
+        site->cnt = 0;
+    }
+
+    if (now - site->window >= (time_t) VERB_RL_INTERVAL) {
+        // New interval
+        __atomic_store_n(&site->window, now, __ATOMIC_RELAXED);
+        site->cnt = 0;
+    }
+
+    if (site->cnt >= VERB_RL_BURST) {
+        __atomic_add_fetch(&site->suppressed, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    site->cnt++;
+    // The logger thread might have already taken the number (see verb_ring_expire())
+    *suppressed = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * \brief Add a report about suppressed messages to a ring buffer
+ * \param[in] ring  Ring buffer
+ * \param[in] level Verbosity level of the suppressed messages
+ * \param[in] name  Name of the plugin instance or component
+ * \param[in] cnt   Number of suppressed messages
+ */
+static void
+verb_async_suppressed(struct verb_ring *ring, enum ipx_verb_level level, const char *name,
+    uint64_t cnt)
+{
+    struct verb_entry *entry = verb_ring_reserve(ring);
+    if (!entry) {
+        return;
+    }
+
+    entry->level = level;
+    snprintf(entry->text, VERB_ENTRY_SIZE, "%s: %s: Suppressed %" PRIu64 " similar message(s) "
+        "since the last report of the following message.\n", verb_level_str[level], name, cnt);
+    verb_ring_commit(ring);
+}
+
+/**
+ * \brief Add a message to the ring buffer of the calling thread
+ *
+ * Messages of plugins are formatted directly into the ring buffer as "<LEVEL>: <name>: <fmt>\n".
+ * Core messages (i.e. without the plugin context) already contain the prefix and the new line
+ * character in the format string.
+ * \param[in] level Verbosity level
+ * \param[in] ctx   Plugin context (NULL for core messages)
+ * \param[in] name  Name of the plugin instance (ignored for core messages)
+ * \param[in] fmt   Format string (also identifies the message site)
+ * \param[in] ap    Arguments of the format string
+ * \return True if the message has been processed (i.e. added, suppressed or dropped)
+ * \return False if the message must be printed synchronously
+ */
+static bool
+verb_async_add(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *name,
+    const char *fmt, va_list ap)
+{
+    struct verb_ring *ring = verb_ring_get();
+    if (!ring) {
+        return false;
+    }
+
+    uint64_t suppressed;
+    if (!verb_site_check(ring, ctx, fmt, &suppressed)) {
+        return true;
+    }
+
+    if (suppressed > 0) {
+        verb_async_suppressed(ring, level, (ctx != NULL) ? name : "Core", suppressed);
+    }
+
+    struct verb_entry *entry = verb_ring_reserve(ring);
+    if (!entry) {
+        return true;
+    }
+
+    size_t len = 0;
+    if (ctx != NULL) {
+        int rv = snprintf(entry->text, VERB_ENTRY_SIZE, "%s: %s: ", verb_level_str[level], name);
+        len = (rv > 0) ? (size_t) rv : 0;
+    }
+
+    if (len < VERB_ENTRY_SIZE) {
+        int rv = vsnprintf(entry->text + len, VERB_ENTRY_SIZE - len, fmt, ap);
+        len = (rv > 0) ? len + (size_t) rv : len;
+    }
+
+    if (len >= VERB_ENTRY_SIZE - 1) {
+        // Truncated message (make sure that it ends with a new line)
+        static const char trunc[] = "...\n";
+        memcpy(&entry->text[VERB_ENTRY_SIZE - sizeof(trunc)], trunc, sizeof(trunc));
+    } else if (ctx != NULL) {
+        entry->text[len] = '\n';
+        entry->text[len + 1] = '\0';
+    }
+
+    entry->level = level;
+    verb_ring_commit(ring);
+    return true;
+}
+
+/**
+ * \brief Take suppressed messages of message sites with an expired interval
+ *
+ * Suppressed messages of a site are reported by the owner thread before the next printed
+ * message of the site. If the site doesn't print anything anymore, they would never be
+ * reported. Therefore, once the rate limiting interval of the site expires, the number of
+ * suppressed messages is moved to the number of messages reported by the logger.
+ * \param[in] ring Ring buffer
+ * \param[in] now  Current coarse time
+ * \param[in] all  Take suppressed messages of all sites (e.g. the owner thread has terminated)
+ */
+static void
+verb_ring_expire(struct verb_ring *ring, time_t now, bool all)
+{
+    uint64_t cnt = 0;
+
+    for (size_t i = 0; i < VERB_SITES; ++i) {
+        struct verb_site *site = &ring->sites[i];
+        if (__atomic_load_n(&site->suppressed, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+
+        const time_t window = __atomic_load_n(&site->window, __ATOMIC_RELAXED);
+        if (!all && now - window < (time_t) VERB_RL_INTERVAL) {
+            continue;
+        }
+
+        cnt += __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+    }
+
+    if (cnt > 0) {
+        __atomic_add_fetch(&ring->forgotten, cnt, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * \brief Print all messages of a ring buffer (only for the logger thread)
+ * \param[in] ring Ring buffer
+ * \return Number of printed messages
+ */
+static size_t
+verb_ring_drain(struct verb_ring *ring)
+{
+    const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = ring->tail;
+    size_t cnt = 0;
+
+    uint64_t dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+    if (dropped > 0) {
+        printf("WARNING: Logger: %" PRIu64 " message(s) dropped due to a full log buffer\n",
+            dropped);
+        if (use_syslog) {
+            syslog(LOG_WARNING, "WARNING: Logger: %" PRIu64 " message(s) dropped due to a full "
+                "log buffer\n", dropped);
+        }
+        cnt++;
+    }
+
+    uint64_t forgotten = __atomic_exchange_n(&ring->forgotten, 0, __ATOMIC_RELAXED);
+    if (forgotten > 0) {
+        printf("WARNING: Logger: %" PRIu64 " message(s) suppressed by rate limiting\n", forgotten);
+        if (use_syslog) {
+            syslog(LOG_WARNING, "WARNING: Logger: %" PRIu64 " message(s) suppressed by rate "
+                "limiting\n", forgotten);
+        }
+        cnt++;
+    }
+
+    while (tail != head) {
+        const struct verb_entry *entry = &ring->entries[tail % VERB_RING_SIZE];
+        fputs(entry->text, stdout);
+        if (use_syslog) {
+            syslog(ipx_verb_level2syslog(entry->level), "%s", entry->text);
+        }
+
+        tail++;
+        cnt++;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    return cnt;
+}
+
+/**
+ * \brief Print messages of all ring buffers (only for the logger thread)
+ *
+ * Ring buffers of terminated threads are freed after all their messages are printed.
+ * \return Number of printed messages
+ */
+static size_t
+verb_async_drain()
+{
+    size_t cnt = 0;
+
+    // Message sites are checked for expired intervals only once per second
+    const time_t now = __atomic_load_n(&verb_async.now, __ATOMIC_RELAXED);
+    const bool expire = (now != verb_async.expired);
+    verb_async.expired = now;
+
+    pthread_mutex_lock(&verb_async.lock);
+    struct verb_ring **ring_ptr = &verb_async.rings;
+    while (*ring_ptr != NULL) {
+        struct verb_ring *ring = *ring_ptr;
+        // The flag must be read before the last messages are drained
+        bool closed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE);
+        if (expire || closed) {
+            verb_ring_expire(ring, now, closed);
+        }
+        cnt += verb_ring_drain(ring);
+
+        if (closed) {
+            *ring_ptr = ring->next;
+            free(ring);
+            continue;
+        }
+
+        ring_ptr = &ring->next;
+    }
+    pthread_mutex_unlock(&verb_async.lock);
+
+    if (cnt > 0) {
+        fflush(stdout);
+    }
+
+    return cnt;
+}
+
+/**
+ * \brief Mark the ring buffer of a terminated thread as closed
+ *
+ * If the logger thread is running, the ring buffer is freed by the logger thread after all its
+ * messages are printed. Otherwise, remaining messages are printed and the ring buffer is freed
+ * immediately.
+ * \param[in] arg Ring buffer
+ */
+static void
+verb_ring_release(void *arg)
+{
+    struct verb_ring *ring = (struct verb_ring *) arg;
+
+    pthread_mutex_lock(&verb_async.lock);
+    if (__atomic_load_n(&verb_async.running, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&ring->closed, true, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&verb_async.lock);
+        return;
+    }
+
+    struct verb_ring **ring_ptr = &verb_async.rings;
+    while (*ring_ptr != NULL && *ring_ptr != ring) {
+        ring_ptr = &(*ring_ptr)->next;
+    }
+    if (*ring_ptr != NULL) {
+        *ring_ptr = ring->next;
+    }
+    verb_ring_expire(ring, 0, true);
+    verb_ring_drain(ring);
+    pthread_mutex_unlock(&verb_async.lock);
+
+    fflush(stdout);
+    free(ring);
+}
+
+/**
+ * \brief Update the coarse time used for rate limiting
+ */
+static void
+verb_async_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    __atomic_store_n(&verb_async.now, ts.tv_sec, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Logger thread
+ *
+ * Periodically prints messages of all ring buffers until the logger is stopped. It also updates
+ * the coarse time for rate limiting, so producers don't have to read the clock.
+ * \param[in] arg Unused
+ * \return NULL
+ */
+static void *
+verb_async_thread(void *arg)
+{
+    (void) arg;
+    const struct timespec idle = {0, VERB_IDLE_SLEEP};
+
+    while (__atomic_load_n(&verb_async.running, __ATOMIC_ACQUIRE)) {
+        verb_async_time();
+        if (verb_async_drain() == 0) {
+            nanosleep(&idle, NULL);
+        }
+    }
+
+    verb_async_drain();
+    return NULL;
+}
+
+int
+ipx_verb_async_start()
+{
+    if (__atomic_load_n(&verb_async.running, __ATOMIC_ACQUIRE)) {
+        return IPX_OK;
+    }
+
+    if (!verb_async.key_ready) {
+        if (pthread_key_create(&verb_async.key, &verb_ring_release) != 0) {
+            return IPX_ERR_NOMEM;
+        }
+        verb_async.key_ready = true;
+    }
+
+    verb_async_time();
+    __atomic_store_n(&verb_async.running, true, __ATOMIC_RELEASE);
+
+    // Block all signals in the logger thread (they must be delivered to the main thread)
+    sigset_t set_new, set_old;
+    sigfillset(&set_new);
+    pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
+    int rc = pthread_create(&verb_async.thread, NULL, &verb_async_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &set_old, NULL);
+
+    if (rc != 0) {
+        __atomic_store_n(&verb_async.running, false, __ATOMIC_RELEASE);
+        return IPX_ERR_NOMEM;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_verb_async_stop()
+{
+    if (!__atomic_load_n(&verb_async.running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    // Wait for the logger thread first, so nobody else accesses the ring buffers
+    __atomic_store_n(&verb_async.running, false, __ATOMIC_RELEASE);
+    pthread_join(verb_async.thread, NULL);
+
+    /* Print remaining messages (if any) and free ring buffers of terminated threads. Ring buffers
+     * of other threads cannot be freed because the threads can still hold them. They are freed
+     * by the threads on termination (see verb_ring_release()).
+     */
+    verb_async_drain();
+
+    struct verb_ring *ring = verb_ring_local;
+    if (ring != NULL) {
+        // The ring buffer of the calling thread
+        pthread_setspecific(verb_async.key, NULL);
+        verb_ring_local = NULL;
+        verb_ring_release(ring);
+    }
+}
+
 void
 ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *fmt, ...)
 {
@@ -127,6 +671,17 @@ ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *
     const size_t fmt_size = 512;
     char fmt_buffer[fmt_size];
 
+    if (__atomic_load_n(&verb_async.running, __ATOMIC_RELAXED)) {
+        // Pass the message to the logger thread
+        va_list ap;
+        va_start(ap, fmt);
+        bool done = verb_async_add(level, ctx, plugin, fmt, ap);
+        va_end(ap);
+        if (done) {
+            return;
+        }
+    }
+
     // Create a new format message
     int rv = snprintf(fmt_buffer, fmt_size, fmt_pattern[level], plugin, fmt);
     if (rv < 0 || ((size_t) rv) >= fmt_size) {
@@ -158,6 +713,16 @@ ipx_verb_print(enum ipx_verb_level level, const char *fmt, ...)
 {
     va_list ap;
 
+    if (__atomic_load_n(&verb_async.running, __ATOMIC_RELAXED)) {
+        // Pass the message to the logger thread (the format already contains the prefix)
+        va_start(ap, fmt);
+        bool done = verb_async_add(level, NULL, NULL, fmt, ap);
+        va_end(ap);
+        if (done) {
+            return;
+        }
+    }
+
     va_start(ap, fmt);
     vprintf(fmt, ap);
     va_end(ap);
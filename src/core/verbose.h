@@ -125,6 +125,34 @@ ipx_verb_level_get();
 IPX_API void
 ipx_verb_level_set(enum ipx_verb_level level);
 
+/**
+ * \brief Start the asynchronous logger
+ *
+ * Messages are not printed by the calling threads anymore. Instead, each thread adds messages
+ * into its own lock-free ring buffer and a dedicated logger thread prints them. Messages of
+ * the same site (i.e. the same format string and plugin context) are rate limited and
+ * the number of suppressed messages is reported before the next printed message of the site
+ * or by the logger thread, if the site doesn't print anything until its interval expires.
+ * If a ring buffer is full, new messages of the thread are dropped and only their number is
+ * reported.
+ * \note Before the logger is started (and after it is stopped), messages are printed
+ *   synchronously by the calling threads.
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if the logger thread cannot be started
+ */
+IPX_API int
+ipx_verb_async_start();
+
+/**
+ * \brief Stop the asynchronous logger
+ *
+ * The logger thread is joined and all messages in ring buffers are printed before the function
+ * returns. Ring buffers of threads that are still running are freed when the threads terminate.
+ * \warning The function is supposed to be called only when other threads don't print messages.
+ */
+IPX_API void
+ipx_verb_async_stop();
+
 /**
  * \brief Internal printing function
  *
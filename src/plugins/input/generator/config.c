@@ -0,0 +1,272 @@
+/**
+ * \file src/plugins/input/generator/config.c
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Configuration parser of the generator plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <strings.h>
+#include "config.h"
+
+/*
+ * <params>
+ *  <format>...</format>                   <!-- optional: IPFIX/NetFlowV9/NetFlowV5 -->
+ *  <odid>...</odid>                       <!-- optional -->
+ *  <exporters>...</exporters>             <!-- optional -->
+ *  <templates>...</templates>             <!-- optional -->
+ *  <fields>...</fields>                   <!-- optional -->
+ *  <records>...</records>                 <!-- optional -->
+ *  <messages>...</messages>               <!-- optional -->
+ *  <rate>...</rate>                       <!-- optional -->
+ *  <templateRefresh>...</templateRefresh> <!-- optional -->
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_FORMAT = 1,
+    NODE_ODID,
+    NODE_EXPORTERS,
+    NODE_TEMPLATES,
+    NODE_FIELDS,
+    NODE_RECORDS,
+    NODE_MESSAGES,
+    NODE_RATE,
+    NODE_REFRESH
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_FORMAT,    "format",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODID,      "odid",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_EXPORTERS, "exporters",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TEMPLATES, "templates",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_FIELDS,    "fields",          FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RECORDS,   "records",         FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MESSAGES,  "messages",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RATE,      "rate",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_REFRESH,   "templateRefresh", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Check that a value is within a range
+ * \param[in] ctx  Plugin context
+ * \param[in] name Name of the parameter
+ * \param[in] val  Value
+ * \param[in] min  Minimal value
+ * \param[in] max  Maximal value
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the value is out of range
+ */
+static int
+config_check_range(ipx_ctx_t *ctx, const char *name, uint64_t val, uint64_t min, uint64_t max)
+{
+    if (val >= min && val <= max) {
+        return IPX_OK;
+    }
+
+    IPX_CTX_ERROR(ctx, "The value of <%s> must be between %" PRIu64 " .. %" PRIu64 "!",
+        name, min, max);
+    return IPX_ERR_FORMAT;
+}
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(root, &content) != FDS_EOC) {
+        int rc = IPX_OK;
+        switch (content->id) {
+        case NODE_FORMAT:
+            // Format of messages
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "IPFIX") == 0) {
+                cfg->format = GEN_FMT_IPFIX;
+            } else if (strcasecmp(content->ptr_string, "NetFlowV9") == 0) {
+                cfg->format = GEN_FMT_NF9;
+            } else if (strcasecmp(content->ptr_string, "NetFlowV5") == 0) {
+                cfg->format = GEN_FMT_NF5;
+            } else {
+                IPX_CTX_ERROR(ctx, "Unknown message format '%s'!", content->ptr_string);
+                rc = IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_ODID:
+            // Observation Domain ID
+            assert(content->type == FDS_OPTS_T_UINT);
+            rc = config_check_range(ctx, "odid", content->val_uint, 0, UINT32_MAX);
+            cfg->odid = (uint32_t) content->val_uint;
+            break;
+        case NODE_EXPORTERS:
+            // Number of exporters
+            assert(content->type == FDS_OPTS_T_UINT);
+            rc = config_check_range(ctx, "exporters", content->val_uint, 1, UINT16_MAX);
+            cfg->exporters = (uint32_t) content->val_uint;
+            break;
+        case NODE_TEMPLATES:
+            // Number of templates per exporter
+            assert(content->type == FDS_OPTS_T_UINT);
+            rc = config_check_range(ctx, "templates", content->val_uint, 1, 256);
+            cfg->templates = (uint32_t) content->val_uint;
+            break;
+        case NODE_FIELDS:
+            // Number of fields per record
+            assert(content->type == FDS_OPTS_T_UINT);
+            rc = config_check_range(ctx, "fields", content->val_uint, 1, GEN_FIELDS_MAX);
+            cfg->fields = (uint32_t) content->val_uint;
+            break;
+        case NODE_RECORDS:
+            // Number of records per message
+            assert(content->type == FDS_OPTS_T_UINT);
+            rc = config_check_range(ctx, "records", content->val_uint, 1, 512);
+            cfg->records = (uint32_t) content->val_uint;
+            break;
+        case NODE_MESSAGES:
+            // Number of messages to generate
+            assert(content->type == FDS_OPTS_T_UINT);
+            cfg->messages = content->val_uint;
+            break;
+        case NODE_RATE:
+            // Maximum number of messages per second
+            assert(content->type == FDS_OPTS_T_UINT);
+            cfg->rate = content->val_uint;
+            break;
+        case NODE_REFRESH:
+            // Template refresh
+            assert(content->type == FDS_OPTS_T_UINT);
+            rc = config_check_range(ctx, "templateRefresh", content->val_uint, 0, UINT32_MAX);
+            cfg->refresh = (uint32_t) content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+
+        if (rc != IPX_OK) {
+            return rc;
+        }
+    }
+
+    if (cfg->format == GEN_FMT_NF5 && cfg->records > 30) {
+        IPX_CTX_ERROR(ctx, "NetFlow v5 messages can consist of up to 30 records!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Set default parameters of the configuration
+ * \param[in] cfg Configuration
+ */
+static void
+config_default_set(struct instance_config *cfg)
+{
+    cfg->format = GEN_FMT_IPFIX;
+    cfg->odid = 1;
+    cfg->exporters = 1;
+    cfg->templates = 1;
+    cfg->fields = 8;
+    cfg->records = 30;
+    cfg->messages = 0;
+    cfg->rate = 0;
+    cfg->refresh = 1000;
+}
+
+struct instance_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct instance_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    config_default_set(cfg);
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        free(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        free(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        free(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        free(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct instance_config *cfg)
+{
+    free(cfg);
+}
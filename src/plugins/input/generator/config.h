@@ -0,0 +1,100 @@
+/**
+ * \file src/plugins/input/generator/config.h
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Configuration parser of the generator plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+
+/** Maximum number of fields in a generated record (without the timestamp field) */
+#define GEN_FIELDS_MAX (16U)
+
+/** Format of generated messages */
+enum gen_format {
+    /** IPFIX                   */
+    GEN_FMT_IPFIX,
+    /** NetFlow v9              */
+    GEN_FMT_NF9,
+    /** NetFlow v5              */
+    GEN_FMT_NF5
+};
+
+/** Configuration of a instance of the generator plugin                                          */
+struct instance_config {
+    /** Format of generated messages                                                            */
+    enum gen_format format;
+    /** Observation Domain ID (IPFIX) or Source ID (NetFlow v9) of generated messages           */
+    uint32_t odid;
+    /** Number of simulated exporters (i.e. Transport Sessions)                                 */
+    uint32_t exporters;
+    /** Number of templates per exporter (ignored for NetFlow v5)                               */
+    uint32_t templates;
+    /** Number of fields per record (ignored for NetFlow v5)                                    */
+    uint32_t fields;
+    /** Number of records per message                                                           */
+    uint32_t records;
+    /** Total number of messages to generate (0 = unlimited)                                    */
+    uint64_t messages;
+    /** Maximum number of messages per second (0 = unlimited)                                   */
+    uint64_t rate;
+    /** Number of data messages of an exporter between template refreshes (0 = never)          */
+    uint32_t refresh;
+};
+
+/**
+ * \brief Parse configuration of the plugin
+ * \param[in] ctx    Instance context
+ * \param[in] params XML parameters
+ * \return Pointer to the parse configuration of the instance on success
+ * \return NULL if arguments are not valid or if a memory allocation error has occurred
+ */
+struct instance_config *
+config_parse(ipx_ctx_t *ctx, const char *params);
+
+/**
+ * \brief Destroy parsed configuration
+ * \param[in] cfg Parsed configuration
+ */
+void
+config_destroy(struct instance_config *cfg);
+
+#endif // CONFIG_H
@@ -0,0 +1,654 @@
+/**
+ * \file src/plugins/input/generator/generator.c
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Generator of synthetic flow data (input plugin for benchmarking)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include "config.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INPUT,
+    // Plugin identification name
+    .name = "generator",
+    // Brief description of plugin
+    .dsc = "Generator of synthetic flow data for benchmarking.",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** First Template ID of generated templates                                 */
+#define GEN_TMPLT_ID (256U)
+/** IE ID of observationTimeNanoseconds (generation time of IPFIX messages)   */
+#define GEN_TS_ID (325U)
+/** Size of observationTimeNanoseconds field                                 */
+#define GEN_TS_SIZE (8U)
+
+/** NetFlow v5 Message header (all values in Network Byte Order)             */
+struct __attribute__((__packed__)) gen_nf5_hdr {
+    uint16_t version;
+    uint16_t count;
+    uint32_t sys_uptime;
+    uint32_t unix_sec;
+    uint32_t unix_nsec;
+    uint32_t flow_seq;
+    uint8_t  engine_type;
+    uint8_t  engine_id;
+    uint16_t sampling_interval;
+};
+
+/** NetFlow v9 Message header (all values in Network Byte Order)             */
+struct __attribute__((__packed__)) gen_nf9_hdr {
+    uint16_t version;
+    uint16_t count;
+    uint32_t sys_uptime;
+    uint32_t unix_sec;
+    uint32_t seq_number;
+    uint32_t source_id;
+};
+
+/** Size of a NetFlow v5 record                                              */
+#define GEN_NF5_REC_SIZE (48U)
+/** Size of a Set (FlowSet) header (the same for IPFIX and NetFlow v9)       */
+#define GEN_SET_HDR_SIZE (4U)
+
+/** Definition of a field of generated records */
+struct gen_field {
+    /** Information Element ID */
+    uint16_t id;
+    /** Size of the field      */
+    uint16_t size;
+};
+
+/** Fields of generated records (templates use different subsets/orders)     */
+static const struct gen_field gen_fields[GEN_FIELDS_MAX] = {
+    {8, 4},  // sourceIPv4Address
+    {12, 4}, // destinationIPv4Address
+    {7, 2},  // sourceTransportPort
+    {11, 2}, // destinationTransportPort
+    {4, 1},  // protocolIdentifier
+    {6, 1},  // tcpControlBits
+    {2, 8},  // packetDeltaCount
+    {1, 8},  // octetDeltaCount
+    {22, 4}, // flowStartSysUpTime
+    {21, 4}, // flowEndSysUpTime
+    {10, 4}, // ingressInterface
+    {14, 4}, // egressInterface
+    {5, 1},  // ipClassOfService
+    {15, 4}, // ipNextHopIPv4Address
+    {16, 4}, // bgpSourceAsNumber
+    {17, 4}  // bgpDestinationAsNumber
+};
+
+/** Prepared message (header values are updated before sending) */
+struct gen_msg {
+    /** Message data       */
+    uint8_t *data;
+    /** Size of the data   */
+    uint16_t size;
+    /** Number of records  */
+    uint16_t rec_cnt;
+};
+
+/** Simulated exporter */
+struct gen_exporter {
+    /** Transport Session (NULL if not opened yet)                                */
+    struct ipx_session *session;
+    /** Sequence number (data records for IPFIX, packets for NetFlow v9, flows for NetFlow v5) */
+    uint32_t seq;
+    /** Number of data messages since the last template refresh                  */
+    uint32_t data_cnt;
+    /** Index of the next data message to send (i.e. the template to use)       */
+    uint32_t msg_idx;
+};
+
+/** Instance */
+struct instance_data {
+    /** Parsed configuration of the instance                  */
+    struct instance_config *config;
+    /** Simulated exporters                                   */
+    struct gen_exporter *exporters;
+    /** Index of the next exporter (round-robin)              */
+    uint32_t exp_idx;
+    /** Message with all templates (data is NULL for NetFlow v5) */
+    struct gen_msg tmplts;
+    /** Data messages (one per template)                      */
+    struct gen_msg *msgs;
+    /** Number of data messages                               */
+    uint32_t msgs_cnt;
+    /** Number of generated data messages                     */
+    uint64_t msgs_sent;
+    /** Start of the generator (CLOCK_MONOTONIC)              */
+    struct timespec ts_start;
+    /** Time of the next message (only if rate is limited)    */
+    struct timespec ts_next;
+};
+
+/**
+ * \brief Generate a pseudo-random number (xorshift64)
+ * \param[in,out] state State of the generator (must not be zero)
+ * \return Random number
+ */
+static inline uint64_t
+gen_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/**
+ * \brief Fill a memory with pseudo-random bytes
+ * \param[in]     data  Memory to fill
+ * \param[in]     size  Size of the memory
+ * \param[in,out] state State of the random generator
+ */
+static void
+gen_fill(uint8_t *data, size_t size, uint64_t *state)
+{
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (uint8_t) gen_random(state);
+    }
+}
+
+/**
+ * \brief Get a field of a template
+ * \param[in] tmplt Index of the template
+ * \param[in] idx   Index of the field in the template
+ * \return Field definition
+ */
+static inline const struct gen_field *
+gen_tmplt_field(uint32_t tmplt, uint32_t idx)
+{
+    return &gen_fields[(tmplt + idx) % GEN_FIELDS_MAX];
+}
+
+/**
+ * \brief Get the size of a data record of a template
+ * \param[in] cfg   Configuration
+ * \param[in] tmplt Index of the template
+ * \return Size of the record
+ */
+static size_t
+gen_tmplt_rec_size(const struct instance_config *cfg, uint32_t tmplt)
+{
+    size_t size = (cfg->format == GEN_FMT_IPFIX) ? GEN_TS_SIZE : 0;
+    for (uint32_t i = 0; i < cfg->fields; ++i) {
+        size += gen_tmplt_field(tmplt, i)->size;
+    }
+    return size;
+}
+
+/**
+ * \brief Write a 16-bit value in Network Byte Order
+ * \param[in] ptr Destination
+ * \param[in] val Value
+ * \return Pointer after the written value
+ */
+static inline uint8_t *
+gen_put16(uint8_t *ptr, uint16_t val)
+{
+    val = htons(val);
+    memcpy(ptr, &val, sizeof(val));
+    return ptr + sizeof(val);
+}
+
+/**
+ * \brief Prepare a message with all templates (IPFIX and NetFlow v9 only)
+ * \param[in]  cfg Configuration
+ * \param[out] msg Prepared message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+gen_prepare_tmplts(const struct instance_config *cfg, struct gen_msg *msg)
+{
+    const bool is_ipfix = (cfg->format == GEN_FMT_IPFIX);
+    const size_t hdr_size = is_ipfix ? FDS_IPFIX_MSG_HDR_LEN : sizeof(struct gen_nf9_hdr);
+    const size_t field_cnt = cfg->fields + (is_ipfix ? 1U : 0U);
+    const size_t size = hdr_size + GEN_SET_HDR_SIZE + cfg->templates * (4U + 4U * field_cnt);
+
+    uint8_t *data = calloc(1, size);
+    if (!data) {
+        return IPX_ERR_NOMEM;
+    }
+
+    // The message header is filled before sending
+    uint8_t *ptr = data + hdr_size;
+    ptr = gen_put16(ptr, is_ipfix ? FDS_IPFIX_SET_TMPLT : 0U);
+    ptr = gen_put16(ptr, (uint16_t) (size - hdr_size));
+
+    for (uint32_t t = 0; t < cfg->templates; ++t) {
+        ptr = gen_put16(ptr, (uint16_t) (GEN_TMPLT_ID + t));
+        ptr = gen_put16(ptr, (uint16_t) field_cnt);
+        if (is_ipfix) {
+            ptr = gen_put16(ptr, GEN_TS_ID);
+            ptr = gen_put16(ptr, GEN_TS_SIZE);
+        }
+
+        for (uint32_t i = 0; i < cfg->fields; ++i) {
+            const struct gen_field *field = gen_tmplt_field(t, i);
+            ptr = gen_put16(ptr, field->id);
+            ptr = gen_put16(ptr, field->size);
+        }
+    }
+
+    assert(ptr == data + size);
+    msg->data = data;
+    msg->size = (uint16_t) size;
+    msg->rec_cnt = (uint16_t) cfg->templates;
+    return IPX_OK;
+}
+
+/**
+ * \brief Prepare a data message
+ * \param[in]     cfg   Configuration
+ * \param[in]     tmplt Index of the template
+ * \param[in,out] state State of the random generator
+ * \param[out]    msg   Prepared message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+gen_prepare_data(const struct instance_config *cfg, uint32_t tmplt, uint64_t *state,
+    struct gen_msg *msg)
+{
+    size_t hdr_size;
+    size_t rec_size;
+    switch (cfg->format) {
+    case GEN_FMT_IPFIX:
+        hdr_size = FDS_IPFIX_MSG_HDR_LEN + GEN_SET_HDR_SIZE;
+        rec_size = gen_tmplt_rec_size(cfg, tmplt);
+        break;
+    case GEN_FMT_NF9:
+        hdr_size = sizeof(struct gen_nf9_hdr) + GEN_SET_HDR_SIZE;
+        rec_size = gen_tmplt_rec_size(cfg, tmplt);
+        break;
+    default:
+        hdr_size = sizeof(struct gen_nf5_hdr);
+        rec_size = GEN_NF5_REC_SIZE;
+        break;
+    }
+
+    const size_t size = hdr_size + cfg->records * rec_size;
+    uint8_t *data = calloc(1, size);
+    if (!data) {
+        return IPX_ERR_NOMEM;
+    }
+
+    // The message header is filled before sending
+    if (cfg->format != GEN_FMT_NF5) {
+        uint8_t *set_hdr = data + hdr_size - GEN_SET_HDR_SIZE;
+        set_hdr = gen_put16(set_hdr, (uint16_t) (GEN_TMPLT_ID + tmplt));
+        gen_put16(set_hdr, (uint16_t) (size - hdr_size + GEN_SET_HDR_SIZE));
+    }
+
+    gen_fill(data + hdr_size, size - hdr_size, state);
+    msg->data = data;
+    msg->size = (uint16_t) size;
+    msg->rec_cnt = (uint16_t) cfg->records;
+    return IPX_OK;
+}
+
+/**
+ * \brief Prepare all messages of the generator
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+gen_prepare(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    const struct instance_config *cfg = data->config;
+    uint64_t state = 0x9E3779B97F4A7C15ULL; // The same data for each run
+
+    if (cfg->format != GEN_FMT_NF5 && gen_prepare_tmplts(cfg, &data->tmplts) != IPX_OK) {
+        return IPX_ERR_NOMEM;
+    }
+
+    data->msgs_cnt = (cfg->format != GEN_FMT_NF5) ? cfg->templates : 1U;
+    data->msgs = calloc(data->msgs_cnt, sizeof(*data->msgs));
+    if (!data->msgs) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (uint32_t i = 0; i < data->msgs_cnt; ++i) {
+        if (gen_prepare_data(cfg, i, &state, &data->msgs[i]) != IPX_OK) {
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    IPX_CTX_INFO(ctx, "Prepared %" PRIu32 " data message(s) with %" PRIu32 " record(s) of "
+        "%" PRIu16 " - %" PRIu16 " bytes.", data->msgs_cnt, cfg->records,
+        data->msgs[0].size, data->msgs[data->msgs_cnt - 1].size);
+    return IPX_OK;
+}
+
+/**
+ * \brief Open Transport Sessions of simulated exporters
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of failure
+ */
+static int
+gen_sessions_open(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    for (uint32_t i = 0; i < data->config->exporters; ++i) {
+        // Each exporter has a different source IPv4 address (10.0.0.1, 10.0.0.2, ...)
+        struct ipx_session_net net_cfg;
+        memset(&net_cfg, 0, sizeof(net_cfg));
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = 50000;
+        net_cfg.port_dst = 4739;
+        net_cfg.addr_src.ipv4.s_addr = htonl(0x0A000000U + i + 1);
+        net_cfg.addr_dst.ipv4.s_addr = htonl(0x7F000001U);
+
+        struct ipx_session *session = ipx_session_new_udp(&net_cfg, 0, 0);
+        if (!session) {
+            IPX_CTX_ERROR(ctx, "ipx_session_new_udp() failed!", '\0');
+            return IPX_ERR_DENIED;
+        }
+
+        // Inform other plugins about the new Transport Session
+        ipx_msg_session_t *msg = ipx_msg_session_create(session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            ipx_session_destroy(session);
+            return IPX_ERR_DENIED;
+        }
+
+        ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg));
+        data->exporters[i].session = session;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Create a copy of a prepared message with an updated header
+ * \param[in] data Instance data
+ * \param[in] exp  Exporter
+ * \param[in] msg  Prepared message
+ * \param[in] is_data Is it a data message (i.e. not templates)?
+ * \return Pointer to the message or NULL (memory allocation error)
+ */
+static uint8_t *
+gen_msg_build(struct instance_data *data, struct gen_exporter *exp, const struct gen_msg *msg,
+    bool is_data)
+{
+    uint8_t *buffer = malloc(msg->size);
+    if (!buffer) {
+        return NULL;
+    }
+
+    memcpy(buffer, msg->data, msg->size);
+
+    struct timespec ts_real;
+    struct timespec ts_mono;
+    clock_gettime(CLOCK_REALTIME, &ts_real);
+    clock_gettime(CLOCK_MONOTONIC, &ts_mono);
+    const uint32_t uptime = (uint32_t) ((ts_mono.tv_sec - data->ts_start.tv_sec) * 1000
+        + (ts_mono.tv_nsec - data->ts_start.tv_nsec) / 1000000);
+
+    switch (data->config->format) {
+    case GEN_FMT_IPFIX: {
+        struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) buffer;
+        hdr->version = htons(FDS_IPFIX_VERSION);
+        hdr->length = htons(msg->size);
+        hdr->export_time = htonl((uint32_t) ts_real.tv_sec);
+        hdr->seq_num = htonl(exp->seq);
+        hdr->odid = htonl(data->config->odid);
+        if (is_data) {
+            // Generation time in the first record (for latency measurement)
+            uint8_t *field = buffer + FDS_IPFIX_MSG_HDR_LEN + GEN_SET_HDR_SIZE;
+            fds_set_datetime_hp_be(field, GEN_TS_SIZE, FDS_ET_DATE_TIME_NANOSECONDS, ts_real);
+            exp->seq += msg->rec_cnt;
+        }
+        break;
+    }
+    case GEN_FMT_NF9: {
+        struct gen_nf9_hdr *hdr = (struct gen_nf9_hdr *) buffer;
+        hdr->version = htons(9);
+        hdr->count = htons(msg->rec_cnt);
+        hdr->sys_uptime = htonl(uptime);
+        hdr->unix_sec = htonl((uint32_t) ts_real.tv_sec);
+        hdr->seq_number = htonl(exp->seq++);
+        hdr->source_id = htonl(data->config->odid);
+        break;
+    }
+    case GEN_FMT_NF5: {
+        struct gen_nf5_hdr *hdr = (struct gen_nf5_hdr *) buffer;
+        hdr->version = htons(5);
+        hdr->count = htons(msg->rec_cnt);
+        hdr->sys_uptime = htonl(uptime);
+        hdr->unix_sec = htonl((uint32_t) ts_real.tv_sec);
+        hdr->unix_nsec = htonl((uint32_t) ts_real.tv_nsec);
+        hdr->flow_seq = htonl(exp->seq);
+        hdr->engine_type = 0;
+        hdr->engine_id = 0;
+        hdr->sampling_interval = 0;
+        exp->seq += msg->rec_cnt;
+        break;
+    }
+    }
+
+    return buffer;
+}
+
+/**
+ * \brief Wait until the next message can be generated (only if the rate is limited)
+ * \param[in] data Instance data
+ */
+static void
+gen_rate_wait(struct instance_data *data)
+{
+    const uint64_t rate = data->config->rate;
+    if (rate == 0) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > data->ts_next.tv_sec + 1) {
+        // Too late (e.g. the pipeline is full), don't try to catch up
+        data->ts_next = now;
+    }
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &data->ts_next, NULL);
+
+    const uint64_t step = 1000000000ULL / rate;
+    data->ts_next.tv_sec += (time_t) (step / 1000000000ULL);
+    data->ts_next.tv_nsec += (long) (step % 1000000000ULL);
+    if (data->ts_next.tv_nsec >= 1000000000L) {
+        data->ts_next.tv_sec++;
+        data->ts_next.tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * \brief Destroy the instance data
+ * \param[in] data Instance data
+ */
+static void
+gen_destroy(struct instance_data *data)
+{
+    for (uint32_t i = 0; data->msgs != NULL && i < data->msgs_cnt; ++i) {
+        free(data->msgs[i].data);
+    }
+
+    free(data->msgs);
+    free(data->tmplts.data);
+    free(data->exporters);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    // Parse configuration of the instance
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    data->exporters = calloc(data->config->exporters, sizeof(*data->exporters));
+    if (!data->exporters || gen_prepare(ctx, data) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        gen_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &data->ts_start);
+    data->ts_next = data->ts_start;
+
+    // Store the instance data
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    for (uint32_t i = 0; i < data->config->exporters; ++i) {
+        struct ipx_session *session = data->exporters[i].session;
+        if (!session) {
+            continue;
+        }
+
+        // Inform other plugins that the Transport Session is closed
+        ipx_msg_session_t *close_event = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+        ipx_ctx_msg_pass(ctx, ipx_msg_session2base(close_event));
+
+        /* The session cannot be freed because other plugin still have access to it.
+         * Send it as a garbage message after the Transport Session close event.
+         */
+        ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+        ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(session, cb);
+        ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage));
+    }
+
+    IPX_CTX_INFO(ctx, "Generated %" PRIu64 " data message(s).", data->msgs_sent);
+    gen_destroy(data);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    const struct instance_config *config = data->config;
+
+    if (config->messages != 0 && data->msgs_sent >= config->messages) {
+        // All messages have been generated
+        return IPX_ERR_EOF;
+    }
+
+    if (data->exporters[0].session == NULL && gen_sessions_open(ctx, data) != IPX_OK) {
+        return IPX_ERR_DENIED;
+    }
+
+    // Select the exporter and the message to send
+    struct gen_exporter *exp = &data->exporters[data->exp_idx];
+    const struct gen_msg *msg;
+    bool is_data = true;
+
+    if (data->tmplts.data != NULL && exp->data_cnt == 0) {
+        // (Re)send templates
+        msg = &data->tmplts;
+        is_data = false;
+        exp->data_cnt = 1;
+    } else {
+        msg = &data->msgs[exp->msg_idx];
+        exp->msg_idx = (exp->msg_idx + 1) % data->msgs_cnt;
+        if (config->refresh != 0 && exp->data_cnt++ >= config->refresh) {
+            exp->data_cnt = 0;
+        }
+        data->exp_idx = (data->exp_idx + 1) % config->exporters;
+        data->msgs_sent++;
+    }
+
+    gen_rate_wait(data);
+    uint8_t *buffer = gen_msg_build(data, exp, msg, is_data);
+    if (!buffer) {
+        // Allocation failed, but this is not a fatal error - just skip the message
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_OK;
+    }
+
+    // Insert the message and info about source into a wrapper
+    // Source ID is not available in NetFlow v5 -> always 0
+    struct ipx_msg_ctx msg_ctx = {
+        .session = exp->session,
+        .odid = (config->format != GEN_FMT_NF5) ? config->odid : 0,
+        .stream = 0
+    };
+
+    ipx_msg_ipfix_t *msg2send = ipx_msg_ipfix_create(ctx, &msg_ctx, buffer, msg->size);
+    if (!msg2send) {
+        // Allocation failed, but this is not a fatal error - just skip the message
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(buffer);
+        return IPX_OK;
+    }
+
+    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg2send));
+    return IPX_OK;
+}
@@ -65,6 +65,14 @@
 #define TIMER_INTERVAL    (2)
 /** Required minimal size of receive buffer size [bytes] (otherwise produces a warning message)  */
 #define UDP_RMEM_REQ      (1024*1024)
+/** Initial number of buckets of the table of active Transport Sessions (power of two)          */
+#define ACTIVE_TABLE_DEF  (64U)
+/** Number of bits of a slot index of the timer wheel (i.e. 64 slots per level)                  */
+#define TW_SLOT_BITS      (6U)
+/** Number of slots per level of the timer wheel                                                 */
+#define TW_SLOTS          (1U << TW_SLOT_BITS)
+/** Number of levels of the timer wheel (the range is TW_SLOTS^TW_LEVELS timer events)          */
+#define TW_LEVELS         (3U)
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -149,10 +157,17 @@ struct udp_source {
     /** Description of  the Transport Session                                                    */
     struct ipx_session *session;
 
-    /** Timestamp of check when the source was last seen                                         */
-    time_t last_seen;
-    /** Number of received messages since last check                                             */
-    uint32_t msg_cnt;
+    /** Hash of the identification (local socket, remote IP address and port)                    */
+    uint64_t hash;
+    /** Next Session in the same bucket of the table of active Sessions                          */
+    struct udp_source *hash_next;
+    /** Next Session in the same slot of the timer wheel                                         */
+    struct udp_source *tw_next;
+
+    /** Timer event (tick) in which the source was last seen                                     */
+    uint64_t last_tick;
+    /** Timer event (tick) in which the Session should be checked for inactivity                 */
+    uint64_t expire_tick;
     /** No message has been received from the Session yet                                        */
     bool new_connection;
 };
@@ -179,11 +194,22 @@ struct udp_data {
     } listen; /**< Sockets to listen for data                                                    */
 
     struct {
-        /** Size of the array                                                                    */
+        /** Number of active Sessions                                                            */
         size_t cnt;
-        /** Array of active sources (identification and corresponding Transport Session)         */
-        struct udp_source **sources;
+        /** Number of buckets (power of two)                                                     */
+        size_t size;
+        /** Hash table of active sources (identification and corresponding Transport Session)    */
+        struct udp_source **buckets;
     } active; /**< Active connections                                                            */
+
+    struct {
+        /** Number of timer events since the start of the instance (current tick)               */
+        uint64_t now;
+        /** Inactivity timeout of Sessions (in ticks)                                            */
+        uint64_t timeout;
+        /** Slots of all levels (level L covers TW_SLOTS^L .. TW_SLOTS^(L+1) - 1 ticks ahead)    */
+        struct udp_source *slots[TW_LEVELS][TW_SLOTS];
+    } tw; /**< Hierarchical timer wheel for expiration of inactive Sessions                      */
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -543,17 +569,156 @@ listener_destroy(struct udp_data *instance)
     close(instance->listen.timer_fd);
 }
 
+/**
+ * \brief Calculate a hash of a Transport Session identification
+ * \param[in] src_fd Socket descriptor of local address on which the source data come
+ * \param[in] addr   Remote IPv4/IPv6 address and port
+ * \return Hash value
+ */
+static uint64_t
+active_hash(int src_fd, const struct sockaddr *addr)
+{
+    const uint8_t *data;
+    size_t size;
+    uint16_t port;
+
+    if (addr->sa_family == AF_INET) {
+        const struct sockaddr_in *addr_v4 = (const struct sockaddr_in *) addr;
+        data = (const uint8_t *) &addr_v4->sin_addr;
+        size = sizeof(addr_v4->sin_addr);
+        port = addr_v4->sin_port;
+    } else {
+        assert(addr->sa_family == AF_INET6);
+        const struct sockaddr_in6 *addr_v6 = (const struct sockaddr_in6 *) addr;
+        data = (const uint8_t *) &addr_v6->sin6_addr;
+        size = sizeof(addr_v6->sin6_addr);
+        port = addr_v6->sin6_port;
+    }
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+
+    hash = (hash ^ port) * 1099511628211ULL;
+    hash = (hash ^ (uint32_t) src_fd) * 1099511628211ULL;
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * \brief Compare identification of a Transport Session
+ * \param[in] src    Transport Session
+ * \param[in] src_fd Socket descriptor of local address on which the source data come
+ * \param[in] addr   Remote IPv4/IPv6 address and port
+ * \return True if the identification matches, false otherwise
+ */
+static bool
+active_match(const struct udp_source *src, int src_fd, const struct sockaddr *addr)
+{
+    if (src->local_fd != src_fd) {
+        return false; // Different local socket
+    }
+
+    if (src->src_addr.ss_family != addr->sa_family) {
+        return false; // Different IP address family (IPv4 vs IPv6)
+    }
+
+    if (addr->sa_family == AF_INET) {
+        // IPv4 addresses
+        const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
+        const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
+        return to_find->sin_port == to_cmp->sin_port
+            && memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) == 0;
+    } else {
+        // IPv6 addresses
+        assert(addr->sa_family == AF_INET6);
+        const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
+        const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
+        return to_find->sin6_port == to_cmp->sin6_port
+            && memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) == 0;
+    }
+}
+
+/**
+ * \brief Resize the table of active Transport Sessions (double the number of buckets)
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the table is unchanged)
+ */
+static int
+active_table_grow(struct udp_data *instance)
+{
+    const size_t new_size = (instance->active.size != 0) ? 2 * instance->active.size
+        : ACTIVE_TABLE_DEF;
+    struct udp_source **new_buckets = calloc(new_size, sizeof(*new_buckets));
+    if (!new_buckets) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < instance->active.size; ++i) {
+        struct udp_source *src = instance->active.buckets[i];
+        while (src != NULL) {
+            struct udp_source *next = src->hash_next;
+            const size_t idx = src->hash & (new_size - 1);
+            src->hash_next = new_buckets[idx];
+            new_buckets[idx] = src;
+            src = next;
+        }
+    }
+
+    free(instance->active.buckets);
+    instance->active.buckets = new_buckets;
+    instance->active.size = new_size;
+    return IPX_OK;
+}
+
+/**
+ * \brief Schedule a check of inactivity of a Transport Session
+ *
+ * The Session is inserted into the timer wheel based on its expiration tick.
+ * \param[in] instance Instance data
+ * \param[in] src      Transport Session (must not be in the timer wheel)
+ */
+static void
+tw_insert(struct udp_data *instance, struct udp_source *src)
+{
+    const uint64_t now = instance->tw.now;
+    const uint64_t range = 1ULL << (TW_SLOT_BITS * TW_LEVELS);
+
+    if (src->expire_tick < now) {
+        // Already expired, check it during the next tick
+        src->expire_tick = now + 1;
+    } else if (src->expire_tick - now >= range) {
+        // Out of range of the wheel, check it sooner
+        src->expire_tick = now + range - 1;
+    }
+
+    const uint64_t delta = src->expire_tick - now;
+    unsigned int level = 0;
+    while (delta >= (1ULL << (TW_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+
+    assert(level < TW_LEVELS);
+    const size_t slot = (src->expire_tick >> (TW_SLOT_BITS * level)) & (TW_SLOTS - 1);
+    src->tw_next = instance->tw.slots[level][slot];
+    instance->tw.slots[level][slot] = src;
+}
+
 /**
  * \brief Add a new record of a Transport Session
  *
- * New record is added into the list of active connections.
+ * New record is added into the table of active connections and its inactivity check is
+ * scheduled.
  * \param[in] instance Instance data
  * \param[in] src_fd   Socket descriptor of local address on which the source data come
  * \param[in] src_addr Remote IPv4/IPv6 address to add
+ * \param[in] hash     Hash of the identification (see active_hash())
  * \return Pointer to the newly added record or NULL (memory allocation error)
  */
 static struct udp_source *
-active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_addr)
+active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_addr, uint64_t hash)
 {
     socklen_t src_addrlen;
 
@@ -610,6 +775,12 @@ active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_add
         return NULL;
     }
 
+    // Make sure that there is enough space in the table (load factor <= 1)
+    if (instance->active.cnt >= instance->active.size && active_table_grow(instance) != IPX_OK) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
     char src_addr_str[INET6_ADDRSTRLEN] = {0};
     inet_ntop(net.l3_proto, &net.addr_src, src_addr_str, INET6_ADDRSTRLEN);
 
@@ -632,41 +803,34 @@ active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_add
     rec2add->local_fd = src_fd;
     memcpy(&rec2add->src_addr, src_addr, src_addrlen);
     rec2add->session = session;
-    rec2add->last_seen = time(NULL); // now!
-    rec2add->msg_cnt = 0;
+    rec2add->hash = hash;
+    rec2add->last_tick = instance->tw.now; // now!
+    rec2add->expire_tick = instance->tw.now + instance->tw.timeout;
     rec2add->new_connection = true; // Session Message hasn't been send yet
 
-    // Append the list of active connections
-    const size_t new_size = (instance->active.cnt + 1) * sizeof(struct udp_source *);
-    struct udp_source **new_sources = realloc(instance->active.sources, new_size);
-    if (!new_sources) {
-        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(rec2add);
-        ipx_session_destroy(session);
-        return NULL;
-    }
+    // Insert into the table of active connections and schedule the inactivity check
+    const size_t idx = hash & (instance->active.size - 1);
+    rec2add->hash_next = instance->active.buckets[idx];
+    instance->active.buckets[idx] = rec2add;
+    instance->active.cnt++;
+    tw_insert(instance, rec2add);
 
     IPX_CTX_INFO(instance->ctx, "New exporter connected from '%s'.", src_addr_str);
-    new_sources[instance->active.cnt] = rec2add;
-    instance->active.sources = new_sources;
-    instance->active.cnt++;
     return rec2add;
 }
 
 /**
- * \brief Remove an active Transport Session with a given index
+ * \brief Close a Transport Session and free its record
  *
- * Generate and pass a Session Message - connect event (if necessary) and remove the corresponding
- * session (defined by an index) from the list.
- * \note After removing of the Session the array of active Transport Sessions is not order by
- *   activity anymore.
+ * Generate and pass a Session Message - close event (if necessary) and free the record.
+ * \warning The record MUST be already removed from the table of active Sessions and from
+ *   the timer wheel.
  * \param[in] instance Instance data
- * \param[in] idx      Index of the instance to remove
+ * \param[in] src      Transport Session to close
  */
 static void
-active_remove_by_id(struct udp_data *instance, size_t idx)
+active_close(struct udp_data *instance, struct udp_source *src)
 {
-    struct udp_source *src = instance->active.sources[idx];
     IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
 
     // Have we received at least one valid record?
@@ -700,83 +864,34 @@ active_remove_by_id(struct udp_data *instance, size_t idx)
 
     // Now we can free the wrapper
     free(src);
-    if (idx == instance->active.cnt - 1) {
-        // The last element in the array
-        instance->active.cnt--;
-    } else {
-        // Replace it with the last one
-        instance->active.sources[idx] = instance->active.sources[instance->active.cnt - 1];
-        instance->active.cnt--;
-    }
 }
 
 /**
- * \brief Find a record of an active Transport Session
+ * \brief Remove a Transport Session from the table of active Sessions
  *
+ * \note The Session is not removed from the timer wheel!
  * \param[in] instance Instance data
- * \param[in] src_fd   Socket descriptor of local address on which the source data come
- * \param[in] addr     Remote IPv4/IPv6 Address to find
- * \return Pointer to the record or NULL (the record doesn't exist)
+ * \param[in] src      Transport Session to remove
  */
-static struct udp_source *
-active_find(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
+static void
+active_unlink(struct udp_data *instance, struct udp_source *src)
 {
-    size_t idx;
-
-    // The array is not sorted, we have to go through
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        struct udp_source *src = instance->active.sources[idx];
-        if (src->local_fd != src_fd) {
-            continue; // Different local socket
-        }
-
-        if (src->src_addr.ss_family != addr->sa_family) {
-            continue; // Different IP address family (IPv4 vs IPv6)
-        }
-
-        if (addr->sa_family == AF_INET) {
-            // IPv4 addresses
-            const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
-            const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
-            if (to_find->sin_port != to_cmp->sin_port) {
-                continue; // Different ports
-            }
-
-            if (memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
-        } else {
-            // IPv6 addresses
-            assert(addr->sa_family == AF_INET6);
-            const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
-            const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
-            if (to_find->sin6_port != to_cmp->sin6_port) {
-                continue; // Different ports
-            }
-
-            if (memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
-        }
+    struct udp_source **ptr = &instance->active.buckets[src->hash & (instance->active.size - 1)];
+    while (*ptr != src) {
+        assert(*ptr != NULL);
+        ptr = &(*ptr)->hash_next;
     }
 
-    if (idx == instance->active.cnt) {
-        // Not found
-        return NULL;
-    }
-
-    return instance->active.sources[idx];
+    *ptr = src->hash_next;
+    src->hash_next = NULL;
+    instance->active.cnt--;
 }
 
 /**
  * \brief Get a reference to a Transport Session
  *
  * First, try to find in among already active Transport Sessions. If it is not present, create
- * a new one and store it into the array of active Sessions.
+ * a new one and store it into the table of active Sessions.
  * \param[in] instance Instance data
  * \param[in] src_fd   Socket descriptor to which is the Session connected
  * \param[in] addr     Remove IPv4/IPv6 address (and port) of the session
@@ -785,85 +900,97 @@ active_find(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
 static struct udp_source *
 active_get(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
 {
+    if (addr->sa_family != AF_INET && addr->sa_family != AF_INET6) {
+        IPX_CTX_ERROR(instance->ctx, "New connection has an unsupported IP address family "
+            "(family ID: %u)!", (unsigned) addr->sa_family);
+        return NULL;
+    }
+
     // Try to find
-    struct udp_source *src = active_find(instance, src_fd, addr);
-    if (src != NULL) {
-        return src;
+    const uint64_t hash = active_hash(src_fd, addr);
+    if (instance->active.size != 0) {
+        struct udp_source *src = instance->active.buckets[hash & (instance->active.size - 1)];
+        for (; src != NULL; src = src->hash_next) {
+            if (src->hash == hash && active_match(src, src_fd, addr)) {
+                return src;
+            }
+        }
     }
 
     // Not found, add a new record
-    return active_add(instance, src_fd, addr);
+    return active_add(instance, src_fd, addr, hash);
 }
 
 /**
- * \brief Compare 2 active Transport Session by activity
+ * \brief Process Sessions of a slot of the timer wheel with the expiration tick
  *
- * \note The sessions are primary sorted by number of messages received since the last reset of
- * counters. Secondary, if the both counters are zero, the sessions are sorted by the timestamp
- * of their last occurrence.
- * \param p1 First Transport Session
- * \param p2 Second Transport Session
- * \return
- *   The comparison function returns an integer less than, equal to, or greater than zero if the
- *   first Session is considered to be respectively more, equal to, or less active than the
- *   second.
+ * Sessions which have been seen in the meantime are rescheduled, the others are closed.
+ * \param[in] instance Instance data
+ * \param[in] list     Detached list of Sessions of the slot
  */
-static int
-active_cmp_activity(const void *p1, const void *p2)
+static void
+tw_expire(struct udp_data *instance, struct udp_source *list)
 {
-    const struct udp_source *left =  *(const struct udp_source **) p1;
-    const struct udp_source *right = *(const struct udp_source **) p2;
-
-    // Primary, compare by number of messages since the last reset of counter
-    if (left->msg_cnt != right->msg_cnt) {
-        return (left->msg_cnt > right->msg_cnt) ? (-1) : 1; // Sort in descending order
-    }
-
-    if (left->msg_cnt != 0) {
-        // Both have the same non-zero value of counters,
-        return 0;
-    }
+    const uint64_t now = instance->tw.now;
+    while (list != NULL) {
+        struct udp_source *src = list;
+        list = src->tw_next;
+        src->tw_next = NULL;
+
+        const uint64_t expire = src->last_tick + instance->tw.timeout;
+        if (expire > now) {
+            // The Session has been active in the meantime
+            src->expire_tick = expire;
+            tw_insert(instance, src);
+            continue;
+        }
 
-    assert(left->msg_cnt == 0 && right->msg_cnt == 0);
-    // Secondary, compare by the last seen timestamps
-    if (left->last_seen == right->last_seen) {
-        return 0;
+        // Remove and generate Session message - close event, if necessary
+        active_unlink(instance, src);
+        active_close(instance, src);
     }
-
-    return (left->last_seen > right->last_seen) ? (-1) : 1;
 }
 
 /**
- * \brief Sort all active Transport Session by activity and reset activity counters
+ * \brief Move to the next tick of the timer wheel
  *
- * The most active Transport Session go to the front. Activity is compared by number of received
- * IPFIX Messages since the last restart of counters.
+ * Sessions of higher levels are moved (cascaded) to lower levels when their time approaches
+ * and Sessions of the current slot of the lowest level are checked for inactivity.
  * \param[in] instance Instance data
  */
 static void
-active_sort_and_reset(struct udp_data *instance)
+tw_tick(struct udp_data *instance)
 {
-    const size_t rec_size = sizeof(*instance->active.sources);
-    qsort(instance->active.sources, instance->active.cnt, rec_size, &active_cmp_activity);
-
-    time_t now = time(NULL);
-    for (size_t i = 0; i < instance->active.cnt; ++i) {
-        struct udp_source *src = instance->active.sources[i];
-        if (src->msg_cnt == 0) {
-            // No new messages since the last check
-            continue;
+    const uint64_t now = ++instance->tw.now;
+
+    // Cascade Sessions from higher levels
+    for (unsigned int level = 1; level < TW_LEVELS; ++level) {
+        if (((now >> (TW_SLOT_BITS * (level - 1))) & (TW_SLOTS - 1)) != 0) {
+            break;
         }
 
-        src->last_seen = now;
-        src->msg_cnt = 0;
+        const size_t slot = (now >> (TW_SLOT_BITS * level)) & (TW_SLOTS - 1);
+        struct udp_source *list = instance->tw.slots[level][slot];
+        instance->tw.slots[level][slot] = NULL;
+        while (list != NULL) {
+            struct udp_source *src = list;
+            list = src->tw_next;
+            tw_insert(instance, src);
+        }
     }
+
+    // Check Sessions with the expiration in this tick
+    const size_t slot = now & (TW_SLOTS - 1);
+    struct udp_source *list = instance->tw.slots[0][slot];
+    instance->tw.slots[0][slot] = NULL;
+    tw_expire(instance, list);
 }
 
 /**
  * \brief Process a timer event
  *
- * Sort all sources by their activity (number of messages sent between timer events) and
- * close inactive Transport Sessions.
+ * Move the timer wheel by the number of expired timer intervals and close inactive Transport
+ * Sessions.
  * \param[in] instance Instance data
  * \param[in] fd       File descriptor of a timer
  */
@@ -882,24 +1009,8 @@ process_timer(struct udp_data *instance, int fd)
         return;
     }
 
-    // The inactive Transport Sessions will be at the end of the (sorted) array
-    active_sort_and_reset(instance);
-
-    time_t now = time(NULL);
-    size_t idx;
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        if (instance->active.sources[idx]->last_seen + instance->config->timeout_conn >= now) {
-            continue;
-        }
-
-        // Close this Session and all that follows
-        break;
-    }
-
-    while (idx < instance->active.cnt) {
-        // Remove and generate Session message - close event, if necessary
-        assert(instance->active.sources[idx]->last_seen + instance->config->timeout_conn < now);
-        active_remove_by_id(instance, idx);
+    for (uint64_t i = 0; i < event_cnt; ++i) {
+        tw_tick(instance);
     }
 
     IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
@@ -1043,7 +1154,7 @@ process_socket(struct udp_data *instance, int sd)
     }
 
     ipx_ctx_msg_pass(instance->ctx, ipx_msg_ipfix2base(msg));
-    source->msg_cnt++;
+    source->last_tick = instance->tw.now;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -1059,7 +1170,8 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 
     data->ctx = ctx;
     data->active.cnt = 0;
-    data->active.sources = NULL;
+    data->active.size = 0;
+    data->active.buckets = NULL;
 
     // Parse configuration
     data->config = config_parse(ctx, params);
@@ -1068,6 +1180,10 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Inactive Sessions are closed after at least the timeout (rounded up to timer intervals)
+    data->tw.now = 0;
+    data->tw.timeout = (data->config->timeout_conn + TIMER_INTERVAL - 1) / TIMER_INTERVAL + 1;
+
     // Bind to local addresses and arm a timer
     if (listener_init(data) != IPX_OK) {
         config_destroy(data->config);
@@ -1088,10 +1204,15 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     listener_destroy(data);
 
     // Close all Transport Session (this generates Session messages per each active Session)
-    while (data->active.cnt > 0) {
-        active_remove_by_id(data, 0);
+    for (size_t i = 0; i < data->active.size; ++i) {
+        struct udp_source *src = data->active.buckets[i];
+        while (src != NULL) {
+            struct udp_source *next = src->hash_next;
+            active_close(data, src);
+            src = next;
+        }
     }
-    free(data->active.sources);
+    free(data->active.buckets);
 
     config_destroy(data->config);
     free(data);
@@ -83,6 +83,14 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <wmmintrin.h>
+#define PAN_HAVE_AESNI 1
+#endif
 
 #ifdef HAVE_STDINT_H
 #include <stdint.h>
@@ -93,14 +101,223 @@
 static	uint8_t m_key[16]; //128 bit secret key
 static	uint8_t m_pad[16]; //128 bit secret pad
 
+/** Number of slots of the cache of IPv4 addresses (must be a power of 2)         */
+#define CACHE_V4_ADDR   4096U
+/** Number of slots of the cache of IPv4 prefixes (must be a power of 2)          */
+#define CACHE_V4_PREFIX 4096U
+/** Length of cached IPv4 prefixes (in bits)                                      */
+#define CACHE_V4_PLEN   24
+/** Number of slots of the cache of IPv6 addresses (must be a power of 2)         */
+#define CACHE_V6_ADDR   1024U
+/** Number of slots of the cache of IPv6 prefixes (must be a power of 2)          */
+#define CACHE_V6_PREFIX 1024U
+/** Length of cached IPv6 prefixes (in bits, must be a multiple of 8)             */
+#define CACHE_V6_PLEN   64
+
+/**
+ * \brief Cache of already anonymized addresses and prefixes
+ *
+ * Thanks to the prefix-preserving property, the first N bits of the one-time-pad depend only
+ * on the first N bits of the original address. Therefore, the pad bits of frequent prefixes
+ * can be reused and only the remaining bits must be computed. Fully anonymized addresses are
+ * cached too. All tables are direct-mapped, i.e. colliding entries are simply replaced.
+ *
+ * Each thread has its own cache, so no locking is required.
+ */
+struct pan_cache {
+    /** Key generation of the cached entries                                      */
+    uint32_t generation;
+
+    struct {
+        uint32_t orig;      /**< Original address                                 */
+        uint32_t anon;      /**< Anonymized address                               */
+        bool valid;         /**< The slot is occupied                             */
+    } v4_addr[CACHE_V4_ADDR];
+
+    struct {
+        uint32_t prefix;    /**< Original prefix (top bits of the address)        */
+        uint32_t pad;       /**< One-time-pad bits of the prefix                  */
+        bool valid;         /**< The slot is occupied                             */
+    } v4_prefix[CACHE_V4_PREFIX];
+
+    struct {
+        uint64_t orig[2];   /**< Original address                                 */
+        uint64_t anon[2];   /**< Anonymized address                               */
+        bool valid;         /**< The slot is occupied                             */
+    } v6_addr[CACHE_V6_ADDR];
+
+    struct {
+        uint8_t prefix[CACHE_V6_PLEN / 8];  /**< Original prefix                  */
+        uint8_t pad[CACHE_V6_PLEN / 8];     /**< One-time-pad bytes of the prefix */
+        bool valid;                         /**< The slot is occupied             */
+    } v6_prefix[CACHE_V6_PREFIX];
+};
+
+/** Generation of the key (caches of previous generations are invalid)           */
+static uint32_t m_generation = 0;
+/** Thread specific cache                                                        */
+static pthread_key_t m_cache_key;
+/** Creation of the thread specific cache key                                    */
+static pthread_once_t m_cache_once = PTHREAD_ONCE_INIT;
+
+/** Block cipher (128-bit block) used as a pseudorandom function                 */
+typedef void (*block_encrypt_fn)(const uint8_t in[16], uint8_t out[16]);
+/** Selected implementation of the block cipher                                  */
+static block_encrypt_fn m_encrypt = NULL;
+
+/**
+ * \brief Software implementation of the block cipher (table-based Rijndael)
+ */
+static void
+encrypt_soft(const uint8_t in[16], uint8_t out[16])
+{
+    Rijndael_blockEncrypt(in, 128, out);
+}
+
+#ifdef PAN_HAVE_AESNI
+/** Expanded AES-128 key for AES-NI                                              */
+static __m128i m_aes_keys[11];
+
+/**
+ * \brief Single step of AES-128 key expansion
+ * \param[in] key       Previous round key
+ * \param[in] keygened  Result of AESKEYGENASSIST instruction
+ * \return New round key
+ */
+__attribute__((target("aes,sse2")))
+static inline __m128i
+aesni_expand_step(__m128i key, __m128i keygened)
+{
+    keygened = _mm_shuffle_epi32(keygened, _MM_SHUFFLE(3, 3, 3, 3));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, keygened);
+}
+
+/**
+ * \brief Prepare AES-128 round keys for AES-NI
+ * \param[in] key 128-bit secret key
+ */
+__attribute__((target("aes,sse2")))
+static void
+aesni_init(const uint8_t key[16])
+{
+    __m128i *k = m_aes_keys;
+    k[0] = _mm_loadu_si128((const __m128i *) key);
+    // Round constants must be immediate values
+    k[1]  = aesni_expand_step(k[0], _mm_aeskeygenassist_si128(k[0], 0x01));
+    k[2]  = aesni_expand_step(k[1], _mm_aeskeygenassist_si128(k[1], 0x02));
+    k[3]  = aesni_expand_step(k[2], _mm_aeskeygenassist_si128(k[2], 0x04));
+    k[4]  = aesni_expand_step(k[3], _mm_aeskeygenassist_si128(k[3], 0x08));
+    k[5]  = aesni_expand_step(k[4], _mm_aeskeygenassist_si128(k[4], 0x10));
+    k[6]  = aesni_expand_step(k[5], _mm_aeskeygenassist_si128(k[5], 0x20));
+    k[7]  = aesni_expand_step(k[6], _mm_aeskeygenassist_si128(k[6], 0x40));
+    k[8]  = aesni_expand_step(k[7], _mm_aeskeygenassist_si128(k[7], 0x80));
+    k[9]  = aesni_expand_step(k[8], _mm_aeskeygenassist_si128(k[8], 0x1B));
+    k[10] = aesni_expand_step(k[9], _mm_aeskeygenassist_si128(k[9], 0x36));
+}
+
+/**
+ * \brief AES-NI implementation of the block cipher (AES-128)
+ */
+__attribute__((target("aes,sse2")))
+static void
+encrypt_aesni(const uint8_t in[16], uint8_t out[16])
+{
+    const __m128i *k = m_aes_keys;
+    __m128i block = _mm_loadu_si128((const __m128i *) in);
+    block = _mm_xor_si128(block, k[0]);
+    for (int i = 1; i < 10; ++i) {
+        block = _mm_aesenc_si128(block, k[i]);
+    }
+    block = _mm_aesenclast_si128(block, k[10]);
+    _mm_storeu_si128((__m128i *) out, block);
+}
+
+/**
+ * \brief Check if the CPU supports AES-NI instructions
+ */
+static bool
+aesni_supported()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+
+    return (ecx & bit_AES) != 0 && (edx & bit_SSE2) != 0;
+}
+#endif // PAN_HAVE_AESNI
+
+/** Create a key of thread specific caches (destroyed with threads)              */
+static void
+cache_key_create()
+{
+    pthread_key_create(&m_cache_key, &free);
+}
+
+/**
+ * \brief Get the cache of the calling thread
+ * \return Pointer to the cache or NULL (memory allocation error, caching is skipped)
+ */
+static struct pan_cache *
+cache_get()
+{
+    struct pan_cache *cache = pthread_getspecific(m_cache_key);
+    if (!cache) {
+        cache = calloc(1, sizeof(*cache));
+        if (!cache || pthread_setspecific(m_cache_key, cache) != 0) {
+            free(cache);
+            return NULL;
+        }
+        cache->generation = m_generation;
+    }
+
+    if (cache->generation != m_generation) {
+        // The key has been changed
+        memset(cache, 0, sizeof(*cache));
+        cache->generation = m_generation;
+    }
+
+    return cache;
+}
+
+/**
+ * \brief Hash function of cache keys
+ */
+static inline uint32_t
+cache_hash(uint64_t val)
+{
+    val ^= val >> 33;
+    val *= 0xff51afd7ed558ccdULL;
+    val ^= val >> 33;
+    return (uint32_t) val;
+}
+
 // Init
 void PAnonymizer_Init(uint8_t * key) {
   //initialize the 128-bit secret key.
   memcpy(m_key, key, 16);
   //initialize the Rijndael cipher.
   Rijndael_init(ECB, Encrypt, key, Key16Bytes, NULL);
+  m_encrypt = &encrypt_soft;
+#ifdef PAN_HAVE_AESNI
+  if (aesni_supported()) {
+    aesni_init(key);
+    m_encrypt = &encrypt_aesni;
+  }
+#endif
   //initialize the 128-bit secret pad. The pad is encrypted before being used for padding.
-  Rijndael_blockEncrypt(key + 16, 128, m_pad);
+  m_encrypt(key + 16, m_pad);
+
+  //invalidate all cached results of the previous key
+  pthread_once(&m_cache_once, &cache_key_create);
+  m_generation++;
+}
+
+const char *PAnonymizer_Backend() {
+  return (m_encrypt == &encrypt_soft) ? "software" : "AES-NI";
 }
 
 int ParseCryptoPAnKey ( char *s, char *key ) {
@@ -141,8 +358,16 @@ uint32_t len = strlen(s);
 
 } // End of ParseCryptoPAnKey
 
-//Anonymization funtion
-uint32_t anonymize(const uint32_t orig_addr) {
+/**
+ * \brief Compute bits of the IPv4 one-time-pad for a range of prefix lengths
+ * \param[in] orig_addr Original address
+ * \param[in] pos_from  First prefix length
+ * \param[in] pos_to    Last prefix length
+ * \return Pad bits (other bits are zeros)
+ */
+static uint32_t
+anonymize_pad(const uint32_t orig_addr, int pos_from, int pos_to)
+{
     uint8_t rin_output[16];
     uint8_t rin_input[16];
 
@@ -157,7 +382,7 @@ uint32_t anonymize(const uint32_t orig_addr) {
     // For each prefixes with length from 0 to 31, generate a bit using the Rijndael cipher,
     // which is used as a pseudorandom function here. The bits generated in every rounds
     // are combineed into a pseudorandom one-time-pad.
-    for (pos = 0; pos <= 31 ; pos++) {
+    for (pos = pos_from; pos <= pos_to ; pos++) {
 
 	//Padding: The most significant pos bits are taken from orig_addr. The other 128-pos
         //bits are taken from m_pad. The variables first4bytes_pad and first4bytes_input are used
@@ -175,33 +400,69 @@ uint32_t anonymize(const uint32_t orig_addr) {
 
 	//Encryption: The Rijndael cipher is used as pseudorandom function. During each
 	//round, only the first bit of rin_output is used.
-	Rijndael_blockEncrypt(rin_input, 128, rin_output);
+	m_encrypt(rin_input, rin_output);
 
 	//Combination: the bits are combined into a pseudorandom one-time-pad
 	result |=  (rin_output[0] >> 7) << (31-pos);
     }
+    return result;
+}
+
+//Anonymization funtion
+uint32_t anonymize(const uint32_t orig_addr) {
+    struct pan_cache *cache = cache_get();
+    if (!cache) {
+        return anonymize_pad(orig_addr, 0, 31) ^ orig_addr;
+    }
+
+    // Already anonymized address?
+    const uint32_t addr_idx = cache_hash(orig_addr) & (CACHE_V4_ADDR - 1);
+    if (cache->v4_addr[addr_idx].valid && cache->v4_addr[addr_idx].orig == orig_addr) {
+        return cache->v4_addr[addr_idx].anon;
+    }
+
+    // Reuse the pad of the prefix, if possible
+    const uint32_t prefix = orig_addr >> (32 - CACHE_V4_PLEN);
+    const uint32_t prefix_idx = cache_hash(prefix) & (CACHE_V4_PREFIX - 1);
+    uint32_t pad;
+    if (cache->v4_prefix[prefix_idx].valid && cache->v4_prefix[prefix_idx].prefix == prefix) {
+        pad = cache->v4_prefix[prefix_idx].pad;
+    } else {
+        pad = anonymize_pad(orig_addr, 0, CACHE_V4_PLEN - 1);
+        cache->v4_prefix[prefix_idx].prefix = prefix;
+        cache->v4_prefix[prefix_idx].pad = pad;
+        cache->v4_prefix[prefix_idx].valid = true;
+    }
+
+    pad |= anonymize_pad(orig_addr, CACHE_V4_PLEN, 31);
+
     //XOR the orginal address with the pseudorandom one-time-pad
-    return result ^ orig_addr;
+    const uint32_t result = pad ^ orig_addr;
+    cache->v4_addr[addr_idx].orig = orig_addr;
+    cache->v4_addr[addr_idx].anon = result;
+    cache->v4_addr[addr_idx].valid = true;
+    return result;
 }
 
-/* little endian CPU's are boring! - but give it a try
- * orig_addr is a ptr to memory, return by inet_pton for IPv6
- * anon_addr return the result in the same order
+/**
+ * \brief Compute bits of the IPv6 one-time-pad for a range of prefix lengths
+ * \param[in]  orig_bytes Original address
+ * \param[out] result     Pad (only bits of the given range are set)
+ * \param[in]  pos_from   First prefix length
+ * \param[in]  pos_to     Last prefix length
  */
-void anonymize_v6(const uint64_t orig_addr[2], uint64_t *anon_addr) {
-    uint8_t rin_output[16], *orig_bytes, *result;
+static void
+anonymize_v6_pad(const uint8_t *orig_bytes, uint8_t *result, int pos_from, int pos_to)
+{
+    uint8_t rin_output[16];
     uint8_t rin_input[16];
 
     int pos, i, bit_num, left_byte;
 
-	anon_addr[0] = anon_addr[1] = 0;
-	result 		 = (uint8_t *)anon_addr;
-	orig_bytes 	 = (uint8_t *)orig_addr;
-
     // For each prefixes with length from 0 to 127, generate a bit using the Rijndael cipher,
     // which is used as a pseudorandom function here. The bits generated in every rounds
     // are combineed into a pseudorandom one-time-pad.
-    for (pos = 0; pos <= 127 ; pos++) {
+    for (pos = pos_from; pos <= pos_to ; pos++) {
 		bit_num = pos & 0x7;
 		left_byte = (pos >> 3);
 
@@ -215,14 +476,68 @@ void anonymize_v6(const uint64_t orig_addr[2], uint64_t *anon_addr) {
 
 		//Encryption: The Rijndael cipher is used as pseudorandom function. During each
 		//round, only the first bit of rin_output is used.
-		Rijndael_blockEncrypt(rin_input, 128, rin_output);
+		m_encrypt(rin_input, rin_output);
 
 		//Combination: the bits are combined into a pseudorandom one-time-pad
 		result[left_byte] |= (rin_output[0] >> 7) << bit_num;
 
     }
+}
+
+/* little endian CPU's are boring! - but give it a try
+ * orig_addr is a ptr to memory, return by inet_pton for IPv6
+ * anon_addr return the result in the same order
+ */
+void anonymize_v6(const uint64_t orig_addr[2], uint64_t *anon_addr) {
+    uint8_t *orig_bytes, *result;
+
+	anon_addr[0] = anon_addr[1] = 0;
+	result 		 = (uint8_t *)anon_addr;
+	orig_bytes 	 = (uint8_t *)orig_addr;
+
+    struct pan_cache *cache = cache_get();
+    if (!cache) {
+        anonymize_v6_pad(orig_bytes, result, 0, 127);
+        anon_addr[0] ^= orig_addr[0];
+        anon_addr[1] ^= orig_addr[1];
+        return;
+    }
+
+    // Already anonymized address?
+    const uint32_t addr_idx = cache_hash(orig_addr[0] ^ cache_hash(orig_addr[1]))
+        & (CACHE_V6_ADDR - 1);
+    if (cache->v6_addr[addr_idx].valid
+            && cache->v6_addr[addr_idx].orig[0] == orig_addr[0]
+            && cache->v6_addr[addr_idx].orig[1] == orig_addr[1]) {
+        anon_addr[0] = cache->v6_addr[addr_idx].anon[0];
+        anon_addr[1] = cache->v6_addr[addr_idx].anon[1];
+        return;
+    }
+
+    // Reuse the pad of the prefix, if possible
+    const size_t plen_bytes = CACHE_V6_PLEN / 8;
+    uint64_t prefix_key = 0;
+    memcpy(&prefix_key, orig_bytes, plen_bytes < 8 ? plen_bytes : 8);
+    const uint32_t prefix_idx = cache_hash(prefix_key) & (CACHE_V6_PREFIX - 1);
+    if (cache->v6_prefix[prefix_idx].valid
+            && memcmp(cache->v6_prefix[prefix_idx].prefix, orig_bytes, plen_bytes) == 0) {
+        memcpy(result, cache->v6_prefix[prefix_idx].pad, plen_bytes);
+    } else {
+        anonymize_v6_pad(orig_bytes, result, 0, CACHE_V6_PLEN - 1);
+        memcpy(cache->v6_prefix[prefix_idx].prefix, orig_bytes, plen_bytes);
+        memcpy(cache->v6_prefix[prefix_idx].pad, result, plen_bytes);
+        cache->v6_prefix[prefix_idx].valid = true;
+    }
+
+    anonymize_v6_pad(orig_bytes, result, CACHE_V6_PLEN, 127);
+
     //XOR the orginal address with the pseudorandom one-time-pad
 	anon_addr[0] ^= orig_addr[0];
 	anon_addr[1] ^= orig_addr[1];
 
+    cache->v6_addr[addr_idx].orig[0] = orig_addr[0];
+    cache->v6_addr[addr_idx].orig[1] = orig_addr[1];
+    cache->v6_addr[addr_idx].anon[0] = anon_addr[0];
+    cache->v6_addr[addr_idx].anon[1] = anon_addr[1];
+    cache->v6_addr[addr_idx].valid = true;
 }
@@ -87,6 +87,9 @@
 // The second 128 bits of the key are used as the secret pad for padding
 void PAnonymizer_Init(uint8_t * key);
 
+// Name of the block cipher implementation selected by PAnonymizer_Init
+const char *PAnonymizer_Backend();
+
 int ParseCryptoPAnKey ( char *s, char *key );
 
 uint32_t anonymize( const uint32_t orig_addr);
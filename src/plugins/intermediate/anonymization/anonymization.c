@@ -67,8 +67,29 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
 struct instance_data {
     /** Parsed configuration of the instance  */
     struct anon_config *config;
+    /** Selectors of IPv4/IPv6 address fields (one per worker thread) */
+    ipx_fsel_t **fsel;
 };
 
+/**
+ * \brief Select IPv4/IPv6 address fields
+ * \param[in] field Template field
+ * \param[in] data  Unused
+ * \return True if the field is an IPv4/IPv6 address
+ */
+static bool
+select_address(const struct fds_tfield *field, void *data)
+{
+    (void) data;
+    if (field->def == NULL) {
+        // Skip unknown fields
+        return false;
+    }
+
+    const enum fds_iemgr_element_type type = field->def->data_type;
+    return (type == FDS_ET_IPV4_ADDRESS || type == FDS_ET_IPV6_ADDRESS);
+}
+
 /**
  * \brief Anonymize an IPv4/IPv6 address by setting lower half of the address to be zeros
  * \param field IPFIX field with an address to anonymize
@@ -127,8 +148,34 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    const unsigned int threads = data->config->threads;
+    if ((data->fsel = calloc(threads, sizeof(*data->fsel))) == NULL) {
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    for (unsigned int i = 0; i < threads; ++i) {
+        if ((data->fsel[i] = ipx_fsel_create(&select_address, NULL)) != NULL) {
+            continue;
+        }
+
+        for (unsigned int x = 0; x < i; ++x) {
+            ipx_fsel_destroy(data->fsel[x]);
+        }
+        free(data->fsel);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (threads > 1 && ipx_ctx_parallel_set(ctx, threads) != IPX_OK) {
+        IPX_CTX_WARNING(ctx, "Failed to enable parallel processing of messages!", '\0');
+    }
+
     if (data->config->mode == AN_CRYPTOPAN) {
         PAnonymizer_Init((uint8_t *)data->config->crypto_key);
+        IPX_CTX_INFO(ctx, "CryptoPAn implementation: %s", PAnonymizer_Backend());
     }
 
     ipx_ctx_private_set(ctx, data);
@@ -141,6 +188,10 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) ctx; // Suppress warnings
     struct instance_data *data = (struct instance_data *) cfg;
 
+    for (unsigned int i = 0; i < data->config->threads; ++i) {
+        ipx_fsel_destroy(data->fsel[i]);
+    }
+    free(data->fsel);
     config_destroy(data->config);
     free(data);
 }
@@ -149,30 +200,57 @@ int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
     struct instance_data *data = (struct instance_data *) cfg;
+    // Each worker thread uses its own selector
+    ipx_fsel_t *fsel = data->fsel[ipx_ctx_parallel_id(ctx)];
+
+    // The message can be shared by other output instances, get a private one
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_cow(ipx_msg_base2ipfix(msg));
+    if (!ipfix_msg) {
+        // Never pass the message without anonymization
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg));
+        return IPX_ERR_NOMEM;
+    }
+    msg = ipx_msg_ipfix2base(ipfix_msg);
 
     // Process all data records in the IPFIX message
-    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+    const struct fds_template *last_tmplt = NULL;
+    const struct ipx_fsel_result *fields = NULL;
+
     for (uint32_t i = 0; i < rec_cnt; ++i) {
         struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
 
-        // Go through the record and anonymize all IPv4/IPv6 addresses
-        struct fds_drec_iter it;
-        fds_drec_iter_init(&it, &rec->rec, 0);
-
-        while (fds_drec_iter_next(&it) != FDS_EOC) {
-            const struct fds_tfield *info = it.field.info;
-            if (info->def == NULL) {
-                // Skip unknown fields
-                continue;
+        // Get positions of IPv4/IPv6 addresses in the record (records of the same template follow)
+        if (rec->rec.tmplt != last_tmplt) {
+            fields = ipx_fsel_get(fsel, rec->rec.tmplt);
+            last_tmplt = rec->rec.tmplt;
+            if (!fields) {
+                // Never pass the message without anonymization
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                ipx_msg_ipfix_destroy(ipfix_msg);
+                return IPX_ERR_NOMEM;
             }
+        }
 
-            const enum fds_iemgr_element_type type = info->def->data_type;
-            if (type != FDS_ET_IPV4_ADDRESS && type != FDS_ET_IPV6_ADDRESS) {
-                // Not an IPv4/IPv6 address
-                continue;
-            }
+        if (fields->cnt == 0) {
+            // No IPv4/IPv6 addresses
+            continue;
+        }
+
+        // Get the record for modification (copied only if the raw packet is shared)
+        rec = ipx_msg_ipfix_drec_modify(ipfix_msg, i);
+        if (!rec) {
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            ipx_msg_ipfix_destroy(ipfix_msg);
+            return IPX_ERR_NOMEM;
+        }
+
+        // Go through the record and anonymize all IPv4/IPv6 addresses
+        struct ipx_fsel_iter it;
+        ipx_fsel_iter_init(&it, fields, &rec->rec);
 
+        while (ipx_fsel_iter_next(&it) == IPX_OK) {
             if (it.field.size != 4U && it.field.size != 16U) {
                 IPX_CTX_DEBUG(ctx, "Unable to anonymize an IP address with invalid size "
                     "(%" PRIu16 "bytes)!", it.field.size);
@@ -52,7 +52,8 @@
 /** XML nodes */
 enum params_xml_nodes {
     ANON_TYPE = 1,
-    ANON_KEY
+    ANON_KEY,
+    ANON_THREADS
 };
 
 /** Definition of the \<params\> node  */
@@ -60,6 +61,7 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(ANON_TYPE, "type", FDS_OPTS_T_STRING, 0),
     FDS_OPTS_ELEM(ANON_KEY,  "key",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ANON_THREADS, "threads", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -111,6 +113,15 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct anon_config *cfg)
                 return IPX_ERR_FORMAT;
             }
             break;
+        case ANON_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > ANON_THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of <threads> must be between 1 and %u.",
+                    (unsigned int) ANON_THREADS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->threads = (unsigned int) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -172,6 +183,7 @@ config_parse(ipx_ctx_t *ctx, const char *params)
 
     // Set default parameters
     cfg->crypto_key = NULL;
+    cfg->threads = 1;
 
     // Create an XML parser
     fds_xml_t *parser = fds_xml_create();
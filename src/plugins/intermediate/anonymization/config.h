@@ -48,6 +48,9 @@
 /** Length of anonymization key                          */
 #define ANON_KEY_LEN 32
 
+/** Maximal number of worker threads                   */
+#define ANON_THREADS_MAX 64
+
 /** Supported anonymization techniques                   */
 enum anon_mode {
     /** Crypto-PAn anonymization technique               */
@@ -62,6 +65,8 @@ struct anon_config {
     enum anon_mode mode;
     /** CryptoPan key (can be NULL, if not set)          */
     char *crypto_key;
+    /** Number of worker threads                         */
+    unsigned int threads;
 
 };
 
@@ -0,0 +1,364 @@
+/**
+ * \file src/plugins/output/counter/counter.c
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Counter of processed flow data (output plugin for benchmarking)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "config.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_OUTPUT,
+    // Plugin identification name
+    .name = "counter",
+    // Brief description of plugin
+    .dsc = "Counter of processed flow data for benchmarking.",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** IE ID of observationTimeNanoseconds (generation time of IPFIX messages)  */
+#define CNT_TS_ID (325U)
+/** Number of buckets of the latency histogram (powers of two in nanoseconds) */
+#define CNT_HIST_BUCKETS (64U)
+
+/** Statistics of a period */
+struct cnt_stats {
+    /** Start of the period (CLOCK_MONOTONIC)                 */
+    struct timespec ts_start;
+    /** CPU time of the process at the start of the period    */
+    struct timespec cpu_start;
+
+    /** Number of IPFIX Messages                               */
+    uint64_t msgs;
+    /** Number of Data Records                                 */
+    uint64_t recs;
+    /** Number of bytes of IPFIX Messages                      */
+    uint64_t bytes;
+
+    /** Number of latency samples                              */
+    uint64_t lat_cnt;
+    /** Sum of latencies (nanoseconds)                         */
+    uint64_t lat_sum;
+    /** Maximal latency (nanoseconds)                          */
+    uint64_t lat_max;
+    /** Histogram of latencies (bucket X contains [2^(X-1), 2^X) nanoseconds) */
+    uint64_t lat_hist[CNT_HIST_BUCKETS];
+};
+
+/** Instance */
+struct instance_data {
+    /** Parsed configuration of the instance                  */
+    struct instance_config *config;
+    /** Output file for JSON reports (can be NULL)            */
+    FILE *file;
+    /** Statistics of the current interval                   */
+    struct cnt_stats interval;
+    /** Statistics since the start of the plugin              */
+    struct cnt_stats total;
+};
+
+/**
+ * \brief Get a difference of two timestamps in nanoseconds
+ * \param[in] end   Later timestamp
+ * \param[in] start Earlier timestamp
+ * \return Difference (can be negative)
+ */
+static inline int64_t
+cnt_ts_diff(const struct timespec *end, const struct timespec *start)
+{
+    return ((int64_t) end->tv_sec - start->tv_sec) * 1000000000LL
+        + ((int64_t) end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ * \brief Reset statistics and start a new period
+ * \param[in] stats Statistics
+ */
+static void
+cnt_stats_reset(struct cnt_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    clock_gettime(CLOCK_MONOTONIC, &stats->ts_start);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stats->cpu_start);
+}
+
+/**
+ * \brief Add a latency sample to statistics
+ * \param[in] stats   Statistics
+ * \param[in] latency Latency (nanoseconds)
+ */
+static void
+cnt_stats_latency(struct cnt_stats *stats, uint64_t latency)
+{
+    unsigned int bucket = (latency != 0) ? 64U - (unsigned int) __builtin_clzll(latency) : 0U;
+    if (bucket >= CNT_HIST_BUCKETS) {
+        bucket = CNT_HIST_BUCKETS - 1;
+    }
+
+    stats->lat_hist[bucket]++;
+    stats->lat_cnt++;
+    stats->lat_sum += latency;
+    if (latency > stats->lat_max) {
+        stats->lat_max = latency;
+    }
+}
+
+/**
+ * \brief Get an approximate percentile of latencies
+ *
+ * The result is the upper bound of the histogram bucket that contains the percentile, i.e.
+ * the real value is at most two times smaller.
+ * \param[in] stats Statistics
+ * \param[in] perc  Percentile (0 - 100)
+ * \return Latency (nanoseconds)
+ */
+static uint64_t
+cnt_stats_percentile(const struct cnt_stats *stats, unsigned int perc)
+{
+    if (stats->lat_cnt == 0) {
+        return 0;
+    }
+
+    const uint64_t limit = (stats->lat_cnt * perc + 99U) / 100U;
+    uint64_t sum = 0;
+    for (unsigned int i = 0; i < CNT_HIST_BUCKETS; ++i) {
+        sum += stats->lat_hist[i];
+        if (sum >= limit) {
+            const uint64_t bound = (i == 0) ? 0 : (1ULL << i) - 1;
+            return (bound < stats->lat_max) ? bound : stats->lat_max;
+        }
+    }
+
+    return stats->lat_max;
+}
+
+/**
+ * \brief Print a report of a period
+ * \param[in] ctx   Plugin context
+ * \param[in] data  Instance data
+ * \param[in] stats Statistics of the period
+ * \param[in] type  Type of the report ("interval" or "total")
+ */
+static void
+cnt_report(ipx_ctx_t *ctx, struct instance_data *data, const struct cnt_stats *stats,
+    const char *type)
+{
+    struct timespec now;
+    struct timespec cpu_now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_now);
+
+    int64_t duration_ns = cnt_ts_diff(&now, &stats->ts_start);
+    if (duration_ns <= 0) {
+        duration_ns = 1;
+    }
+
+    const double duration = (double) duration_ns / 1e9;
+    const double msg_rate = (double) stats->msgs / duration;
+    const double rec_rate = (double) stats->recs / duration;
+    const double mbps = (double) stats->bytes * 8.0 / duration / 1e6;
+    const double cpu_rec = (stats->recs != 0)
+        ? (double) cnt_ts_diff(&cpu_now, &stats->cpu_start) / (double) stats->recs : 0.0;
+
+    const uint64_t lat_avg = (stats->lat_cnt != 0) ? stats->lat_sum / stats->lat_cnt : 0;
+    const uint64_t lat_p50 = cnt_stats_percentile(stats, 50);
+    const uint64_t lat_p99 = cnt_stats_percentile(stats, 99);
+
+    IPX_CTX_INFO(ctx, "[%s] %.3f s: %" PRIu64 " msgs (%.0f msg/s), %" PRIu64 " recs "
+        "(%.0f rec/s), %.2f Mbps, CPU %.1f ns/rec, latency [us] avg %.1f, p50 %.1f, p99 %.1f, "
+        "max %.1f", type, duration, stats->msgs, msg_rate, stats->recs, rec_rate, mbps, cpu_rec,
+        lat_avg / 1e3, lat_p50 / 1e3, lat_p99 / 1e3, stats->lat_max / 1e3);
+
+    if (!data->file) {
+        return;
+    }
+
+    fprintf(data->file, "{\"type\":\"%s\",\"time\":%" PRIu64 ",\"duration\":%.6f,"
+        "\"messages\":%" PRIu64 ",\"records\":%" PRIu64 ",\"bytes\":%" PRIu64 ","
+        "\"msg_rate\":%.1f,\"rec_rate\":%.1f,\"mbps\":%.3f,\"cpu_per_rec_ns\":%.1f,"
+        "\"latency_ns\":{\"samples\":%" PRIu64 ",\"avg\":%" PRIu64 ",\"p50\":%" PRIu64 ","
+        "\"p99\":%" PRIu64 ",\"max\":%" PRIu64 "}}\n",
+        type, (uint64_t) time(NULL), duration, stats->msgs, stats->recs, stats->bytes,
+        msg_rate, rec_rate, mbps, cpu_rec,
+        stats->lat_cnt, lat_avg, lat_p50, lat_p99, stats->lat_max);
+    fflush(data->file);
+}
+
+/**
+ * \brief Get the latency of an IPFIX Message
+ *
+ * The generation time of the message is expected in observationTimeNanoseconds of the first
+ * Data Record (see the generator input plugin).
+ * \param[in]  msg     IPFIX Message
+ * \param[out] latency Latency (nanoseconds)
+ * \return True on success
+ * \return False if the generation time is not available
+ */
+static bool
+cnt_latency(ipx_msg_ipfix_t *msg, uint64_t *latency)
+{
+    struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, 0);
+    if (!rec) {
+        return false;
+    }
+
+    struct fds_drec_field field;
+    if (fds_drec_find(&rec->rec, 0, CNT_TS_ID, &field) == FDS_EOC) {
+        return false;
+    }
+
+    struct timespec ts_gen;
+    if (fds_get_datetime_hp_be(field.data, field.size, FDS_ET_DATE_TIME_NANOSECONDS, &ts_gen)
+            != FDS_OK) {
+        return false;
+    }
+
+    struct timespec ts_now;
+    clock_gettime(CLOCK_REALTIME, &ts_now);
+    const int64_t diff = cnt_ts_diff(&ts_now, &ts_gen);
+    if (diff < 0) {
+        return false;
+    }
+
+    *latency = (uint64_t) diff;
+    return true;
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (data->config->file != NULL) {
+        data->file = fopen(data->config->file, "a");
+        if (!data->file) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(ctx, "Failed to open file '%s': %s", data->config->file, err_str);
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    cnt_stats_reset(&data->interval);
+    cnt_stats_reset(&data->total);
+    ipx_ctx_private_set(ctx, data);
+
+    // Subscribe to receive only IPFIX messages
+    uint16_t new_mask = IPX_MSG_IPFIX;
+    ipx_ctx_subscribe(ctx, &new_mask, NULL);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    // Final summary
+    cnt_report(ctx, data, &data->total, "total");
+    if (data->file) {
+        fclose(data->file);
+    }
+
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+
+    const struct fds_ipfix_msg_hdr *hdr;
+    hdr = (const struct fds_ipfix_msg_hdr *) ipx_msg_ipfix_get_packet(ipfix_msg);
+    const uint64_t bytes = ntohs(hdr->length);
+    const uint64_t recs = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+
+    data->interval.msgs++;
+    data->interval.recs += recs;
+    data->interval.bytes += bytes;
+    data->total.msgs++;
+    data->total.recs += recs;
+    data->total.bytes += bytes;
+
+    uint64_t latency;
+    if (cnt_latency(ipfix_msg, &latency)) {
+        cnt_stats_latency(&data->interval, latency);
+        cnt_stats_latency(&data->total, latency);
+    }
+
+    if (data->config->interval == 0) {
+        return IPX_OK;
+    }
+
+    // Periodic report (only when a message is received)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec - data->interval.ts_start.tv_sec >= (time_t) data->config->interval) {
+        cnt_report(ctx, data, &data->interval, "interval");
+        cnt_stats_reset(&data->interval);
+    }
+
+    return IPX_OK;
+}
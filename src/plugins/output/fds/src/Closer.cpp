@@ -0,0 +1,112 @@
+/**
+ * \file src/plugins/output/fds/src/Closer.cpp
+ * \brief Background closer of FDS files (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cstring>
+#include <ctime>
+#include "Closer.hpp"
+#include "Exception.hpp"
+
+Closer::Closer(ipx_ctx_t *ctx) : m_ctx(ctx)
+{
+    pthread_mutex_init(&m_mutex, nullptr);
+    pthread_cond_init(&m_cond, nullptr);
+
+    int rc = pthread_create(&m_thread, nullptr, &Closer::thread_closer, this);
+    if (rc != 0) {
+        pthread_cond_destroy(&m_cond);
+        pthread_mutex_destroy(&m_mutex);
+        throw FDS_exception("Failed to start a thread for closing files: "
+            + std::string(strerror(rc)));
+    }
+}
+
+Closer::~Closer()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_stop = true;
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_join(m_thread, nullptr);
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void
+Closer::push(fds_file_t *file, const std::string &name)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (m_file != nullptr) {
+        // The previous file is still being closed
+        pthread_cond_wait(&m_cond, &m_mutex);
+    }
+
+    m_file = file;
+    m_name = name;
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void
+Closer::wait(const std::string &name)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (m_file != nullptr && m_name == name) {
+        pthread_cond_wait(&m_cond, &m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * @brief Closer thread
+ *
+ * Wait for a file to close and close it. The thread is stopped when a stop request is received
+ * and there is no file to close.
+ * @param[in] arg Instance of the closer
+ * @return nullptr
+ */
+void *
+Closer::thread_closer(void *arg)
+{
+    auto *self = reinterpret_cast<Closer *>(arg);
+
+    pthread_mutex_lock(&self->m_mutex);
+    while (true) {
+        while (self->m_file == nullptr && !self->m_stop) {
+            pthread_cond_wait(&self->m_cond, &self->m_mutex);
+        }
+
+        if (self->m_file == nullptr) {
+            // Stop request and nothing to close
+            break;
+        }
+
+        fds_file_t *file = self->m_file;
+        const std::string name = self->m_name;
+        pthread_mutex_unlock(&self->m_mutex);
+
+        // Flush and close the file
+        struct timespec ts_start, ts_end;
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        fds_file_close(file);
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+
+        const double duration = (ts_end.tv_sec - ts_start.tv_sec)
+            + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+        IPX_CTX_DEBUG(self->m_ctx, "File '%s' has been closed (in %.3f seconds)", name.c_str(),
+            duration);
+
+        pthread_mutex_lock(&self->m_mutex);
+        self->m_file = nullptr;
+        pthread_cond_broadcast(&self->m_cond);
+    }
+    pthread_mutex_unlock(&self->m_mutex);
+
+    return nullptr;
+}
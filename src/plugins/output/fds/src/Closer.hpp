@@ -0,0 +1,81 @@
+/**
+ * \file src/plugins/output/fds/src/Closer.hpp
+ * \brief Background closer of FDS files (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_FDS_CLOSER_HPP
+#define IPFIXCOL2_FDS_CLOSER_HPP
+
+#include <ipfixcol2.h>
+#include <pthread.h>
+#include <string>
+#include <libfds.h>
+
+/**
+ * @brief Background closer of FDS files
+ *
+ * Closing of a file includes flushing and compression of the last blocks, which might take
+ * a while. The closer performs it in a dedicated thread so the file of a new time window can be
+ * opened and filled immediately. At most one file is being closed at the same time,
+ * i.e. the old and the new window are double-buffered.
+ */
+class Closer {
+public:
+    /**
+     * @brief Create a closer and start its thread
+     * @param[in] ctx Plugin context (only for log)
+     * @throw FDS_exception if the thread cannot be started
+     */
+    Closer(ipx_ctx_t *ctx);
+    /// Close all remaining files and stop the thread
+    ~Closer();
+
+    // Disable copy constructors
+    Closer(const Closer &other) = delete;
+    Closer &operator=(const Closer &other) = delete;
+
+    /**
+     * @brief Hand over a file to close
+     *
+     * If the previous file is still being closed, the function waits until it is finished.
+     * @param[in] file File to close (the closer takes ownership)
+     * @param[in] name Name of the file
+     */
+    void
+    push(fds_file_t *file, const std::string &name);
+
+    /**
+     * @brief Wait until a file of the given name is closed
+     *
+     * Useful before reopening of the same file (for example, in append mode).
+     * @param[in] name Name of the file
+     */
+    void
+    wait(const std::string &name);
+
+private:
+    /// Plugin context (only for log!)
+    ipx_ctx_t *m_ctx;
+
+    /// Mutex protecting variables below
+    pthread_mutex_t m_mutex;
+    /// Condition variable signalling a change of the state
+    pthread_cond_t m_cond;
+    /// File to close (nullptr, if none)
+    fds_file_t *m_file = nullptr;
+    /// Name of the file to close
+    std::string m_name;
+    /// Stop the thread after the current file is closed
+    bool m_stop = false;
+    /// Closer thread
+    pthread_t m_thread;
+
+    static void *
+    thread_closer(void *arg);
+};
+
+#endif // IPFIXCOL2_FDS_CLOSER_HPP
@@ -21,6 +21,14 @@
  *     <align>...</align>                 <!-- optional -->
  *   </dumpInterval>
  *   <asyncIO>...</asyncIO>               <!-- optional -->
+ *   <shards>...</shards>                 <!-- optional -->
+ *   <index>                              <!-- optional -->
+ *     <field>...</field>                 <!-- multiple -->
+ *     <falsePositiveProbability>...</falsePositiveProbability> <!-- optional -->
+ *     <estimatedItemCount>...</estimatedItemCount> <!-- optional -->
+ *     <autosize>...</autosize>           <!-- optional -->
+ *     <blockRecords>...</blockRecords>   <!-- optional -->
+ *   </index>
  * </params>
  */
 
@@ -30,9 +38,17 @@ enum params_xml_nodes {
     NODE_COMPRESS,
     NODE_DUMP,
     NODE_ASYNCIO,
+    NODE_SHARDS,
+    NODE_INDEX,
 
     DUMP_WINDOW,
-    DUMP_ALIGN
+    DUMP_ALIGN,
+
+    INDEX_FIELD,
+    INDEX_PROB,
+    INDEX_ITEMS,
+    INDEX_AUTOSIZE,
+    INDEX_BLOCK
 };
 
 /// Definition of the \<dumpInterval\> node
@@ -42,6 +58,16 @@ static const struct fds_xml_args args_dump[] = {
     FDS_OPTS_END
 };
 
+/// Definition of the \<index\> node
+static const struct fds_xml_args args_index[] = {
+    FDS_OPTS_ELEM(INDEX_FIELD,    "field",                    FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(INDEX_PROB,     "falsePositiveProbability", FDS_OPTS_T_DOUBLE, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INDEX_ITEMS,    "estimatedItemCount",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INDEX_AUTOSIZE, "autosize",                 FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INDEX_BLOCK,    "blockRecords",             FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
 /// Definition of the \<params\> node
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
@@ -49,6 +75,8 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_COMPRESS, "compression",        FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(NODE_DUMP,   "dumpInterval",       args_dump,         FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_ASYNCIO,  "asyncIO",            FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SHARDS,   "shards",             FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(NODE_INDEX,  "index",              args_index,        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -90,9 +118,16 @@ Config::set_default()
     m_path.clear();
     m_calg = calg::NONE;
     m_async = true;
+    m_shards = 1;
 
     m_window.align = true;
     m_window.size = WINDOW_SIZE;
+
+    m_index.fields.clear();
+    m_index.fp_prob = INDEX_FP_PROB;
+    m_index.est_items = INDEX_EST_ITEMS;
+    m_index.autosize = true;
+    m_index.block_recs = 0;
 }
 
 /**
@@ -109,6 +144,20 @@ Config::validate()
     if (m_window.size == 0) {
         throw std::runtime_error("Window size cannot be zero!");
     }
+
+    if (m_shards == 0 || m_shards > SHARDS_MAX) {
+        throw std::runtime_error("Number of shards must be between 1 and "
+            + std::to_string(SHARDS_MAX) + "!");
+    }
+
+    if (m_index.fp_prob < 0.000001 || m_index.fp_prob >= 1.0) {
+        throw std::runtime_error("False positive probability of the index must be in range "
+            "0.000001 - 1 (exclusive)!");
+    }
+
+    if (m_index.est_items == 0) {
+        throw std::runtime_error("Estimated item count of the index cannot be zero!");
+    }
 }
 
 /**
@@ -146,11 +195,24 @@ Config::parse_root(fds_xml_ctx_t *ctx)
             assert(content->type == FDS_OPTS_T_BOOL);
             m_async = content->val_bool;
             break;
+        case NODE_SHARDS:
+            // Number of shards
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Number of shards is too high!");
+            }
+            m_shards = static_cast<uint32_t>(content->val_uint);
+            break;
         case NODE_DUMP:
             // Dump window
             assert(content->type == FDS_OPTS_T_CONTEXT);
             parse_dump(content->ptr_ctx);
             break;
+        case NODE_INDEX:
+            // Index of files
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_index(content->ptr_ctx);
+            break;
         default:
             // Internal error
             throw std::runtime_error("Unknown XML node");
@@ -187,4 +249,50 @@ Config::parse_dump(fds_xml_ctx_t *ctx)
             throw std::runtime_error("Unknown XML node");
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Auxiliary function for parsing \<index\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_index(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case INDEX_FIELD:
+            // Indexed field
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_index.fields.emplace_back(content->ptr_string);
+            break;
+        case INDEX_PROB:
+            // False positive probability
+            assert(content->type == FDS_OPTS_T_DOUBLE);
+            m_index.fp_prob = content->val_double;
+            break;
+        case INDEX_ITEMS:
+            // Estimated item count
+            assert(content->type == FDS_OPTS_T_UINT);
+            m_index.est_items = content->val_uint;
+            break;
+        case INDEX_AUTOSIZE:
+            // Automatic resize
+            assert(content->type == FDS_OPTS_T_BOOL);
+            m_index.autosize = content->val_bool;
+            break;
+        case INDEX_BLOCK:
+            // Records per block
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Number of records per block is too high!");
+            }
+            m_index.block_recs = static_cast<uint32_t>(content->val_uint);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
@@ -12,6 +12,7 @@
 #define IPFIXCOL2_FDS_CONFIG_HPP
 
 #include <string>
+#include <vector>
 #include <libfds.h>
 
 /**
@@ -39,15 +40,31 @@ public:
     calg m_calg;
     /// Asynchronous I/O enabled
     bool m_async;
+    /// Number of files (shards) per time window
+    uint32_t m_shards;
 
     struct {
         bool     align;   ///< Enable/disable window alignment
         uint32_t size;    ///< Time window size
     } m_window;   ///< Window alignment
 
+    struct {
+        std::vector<std::string> fields; ///< Indexed fields (empty = index disabled)
+        double   fp_prob;    ///< False positive probability of the Bloom filter
+        uint64_t est_items;  ///< Expected number of unique items in the Bloom filter
+        bool     autosize;   ///< Enable/disable automatic resize of the Bloom filter
+        uint32_t block_recs; ///< Records per block with own min/max ranges (0 = disabled)
+    } m_index;    ///< Index of files
+
 private:
     /// Default window size
     static const uint32_t WINDOW_SIZE = 300U;
+    /// Maximum number of shards
+    static const uint32_t SHARDS_MAX = 64U;
+    /// Default false positive probability of the Bloom filter index
+    static constexpr double INDEX_FP_PROB = 0.01;
+    /// Default expected number of unique items in the Bloom filter index
+    static const uint64_t INDEX_EST_ITEMS = 100000U;
 
     void
     set_default();
@@ -58,6 +75,8 @@ private:
     parse_root(fds_xml_ctx_t *ctx);
     void
     parse_dump(fds_xml_ctx_t *ctx);
+    void
+    parse_index(fds_xml_ctx_t *ctx);
 };
 
 
@@ -0,0 +1,779 @@
+/**
+ * \file src/plugins/output/fds/src/Index.cpp
+ * \brief Index of flow storage files (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <endian.h>
+#include <sys/stat.h>
+#include "Exception.hpp"
+#include "Index.hpp"
+
+/// Magic bytes at the beginning of an index file
+static const char IDX_MAGIC[4] = {'F', 'D', 'S', 'I'};
+/// Version of the index file format
+static const uint8_t IDX_VERSION = 1;
+/// Maximum number of hash functions of the Bloom filter
+static const uint32_t BF_HASH_MAX = 32;
+
+/// Tolerance coefficient of the Bloom filter size (based on the number of stored items)
+#define BF_TOL_COEFF(x) ((x > 10000000) ? 1.1 : (x > 100000) ? 1.2 : \
+    (x > 30000) ? 1.5 : (x > 5000) ? 2 : \
+    (x > 500) ? 3 : 10)
+/// Upper tolerance (should be small, more items than expected increase false positive rate)
+#define BF_UPPER_TOLERANCE(val, coeff) \
+    ((uint64_t)(val * (1 + coeff * 0.05)))
+/// Lower tolerance (can be benevolent, too large filter only wastes space)
+#define BF_LOWER_TOLERANCE(val, coeff) \
+    ((uint64_t)(val * (1 + coeff * ((coeff > 1.2) ? 1.3 : 0.5) )))
+
+Index::Index(ipx_ctx_t *ctx, const Config &cfg)
+    : m_ctx(ctx), m_fp_prob(cfg.m_index.fp_prob), m_autosize(cfg.m_index.autosize),
+    m_block_recs(cfg.m_index.block_recs)
+{
+    const fds_iemgr_t *iemgr = ipx_ctx_iemgr_get(ctx);
+    if (!iemgr) {
+        throw FDS_exception("Manager of Information Elements is not available!");
+    }
+
+    for (const auto &name : cfg.m_index.fields) {
+        const struct fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, name.c_str());
+        if (!elem) {
+            throw FDS_exception("Unknown Information Element '" + name + "'");
+        }
+
+        struct field info;
+        memset(&info, 0, sizeof(info));
+        info.en = elem->scope->pen;
+        info.id = elem->id;
+        info.type = elem->data_type;
+
+        switch (elem->data_type) {
+        case FDS_ET_IPV4_ADDRESS:
+        case FDS_ET_IPV6_ADDRESS:
+        case FDS_ET_MAC_ADDRESS:
+        case FDS_ET_STRING:
+        case FDS_ET_OCTET_ARRAY:
+            info.kind = field_kind::BLOOM;
+            m_bloom_en = true;
+            break;
+        case FDS_ET_UNSIGNED_8:
+        case FDS_ET_UNSIGNED_16:
+        case FDS_ET_UNSIGNED_32:
+        case FDS_ET_UNSIGNED_64:
+            info.kind = field_kind::MM_UINT;
+            break;
+        case FDS_ET_SIGNED_8:
+        case FDS_ET_SIGNED_16:
+        case FDS_ET_SIGNED_32:
+        case FDS_ET_SIGNED_64:
+            info.kind = field_kind::MM_INT;
+            break;
+        case FDS_ET_FLOAT_32:
+        case FDS_ET_FLOAT_64:
+            info.kind = field_kind::MM_FLOAT;
+            break;
+        case FDS_ET_DATE_TIME_SECONDS:
+        case FDS_ET_DATE_TIME_MILLISECONDS:
+        case FDS_ET_DATE_TIME_MICROSECONDS:
+        case FDS_ET_DATE_TIME_NANOSECONDS:
+            info.kind = field_kind::MM_TIME;
+            break;
+        default:
+            throw FDS_exception("Information Element '" + name + "' cannot be indexed "
+                "(unsupported data type)");
+        }
+
+        if (info.kind != field_kind::BLOOM) {
+            info.range_idx = m_range_cnt++;
+        }
+        m_fields.push_back(info);
+    }
+
+    m_fsel.reset(ipx_fsel_create(&Index::field_match_cb, this));
+    if (!m_fsel) {
+        throw FDS_exception("Failed to create a field selector");
+    }
+
+    m_bloom.est_items = cfg.m_index.est_items;
+    m_bloom.stored_items = 0;
+    m_bloom.hash_cnt = 0;
+}
+
+Index::~Index()
+{
+    window_close();
+}
+
+/**
+ * @brief Select indexed fields of a template
+ * @param[in] tfield Template field
+ * @param[in] data   Instance of the index
+ * @return True if the field is indexed
+ */
+bool
+Index::field_match_cb(const struct fds_tfield *tfield, void *data)
+{
+    auto self = reinterpret_cast<const Index *>(data);
+    for (const auto &info : self->m_fields) {
+        if (info.en == tfield->en && info.id == tfield->id) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+Index::window_new(const std::string &file_name, const std::string &flow_file, time_t ts)
+{
+    // Store the index of the previous window
+    window_close();
+
+    if (m_bloom_en) {
+        bool reinit = (m_state == state::INIT || m_state == state::ERROR);
+
+        if (!reinit && m_autosize) {
+            // Recalculate the expected item count based on the previous window
+            const uint64_t act_cnt = m_bloom.stored_items;
+            const double coeff = BF_TOL_COEFF(act_cnt);
+            const uint64_t est_low = BF_LOWER_TOLERANCE(act_cnt, coeff);
+            const uint64_t est_high = BF_UPPER_TOLERANCE(act_cnt, coeff);
+
+            if (est_high > m_bloom.est_items) {
+                // More items -> make a bigger filter
+                m_bloom.est_items = act_cnt * coeff;
+                reinit = true;
+            } else if (est_low < m_bloom.est_items && act_cnt > 0 && m_state == state::FULL) {
+                // Less items -> save space (only based on the full previous window)
+                m_bloom.est_items = act_cnt * coeff;
+                reinit = true;
+            }
+        }
+
+        if (reinit) {
+            bloom_prepare();
+        } else {
+            std::fill(m_bloom.bits.begin(), m_bloom.bits.end(), 0);
+            m_bloom.stored_items = 0;
+        }
+    }
+
+    m_file_name = file_name;
+    m_window_ts = ts;
+    m_rec_cnt = 0;
+    m_blocks.clear();
+    for (auto &info : m_fields) {
+        info.window.present = false;
+    }
+
+    switch (m_state) {
+    case state::INIT:
+        m_state = (m_autosize) ? state::FIRST_PARTIAL : state::FULL;
+        break;
+    case state::FIRST_PARTIAL:
+    case state::ERROR:
+        m_state = state::FULL;
+        break;
+    case state::FULL:
+        // Do not change the state
+        break;
+    }
+
+    // The flow file is opened in append mode, so the index must cover previous records too
+    struct stat file_info;
+    if (stat(m_file_name.c_str(), &file_info) != 0 && errno == ENOENT
+            && stat(flow_file.c_str(), &file_info) == 0) {
+        // Records of the existing flow file are unknown, the index would give false negatives
+        IPX_CTX_WARNING(m_ctx, "Flow file '%s' already exists without an index (e.g. after "
+            "a crash). The window will not be indexed.", flow_file.c_str());
+        return;
+    }
+
+    if (!load()) {
+        IPX_CTX_WARNING(m_ctx, "Existing index '%s' cannot be extended by new records (it is "
+            "malformed or has been created with a different configuration). The window will "
+            "not be indexed.", m_file_name.c_str());
+        remove(m_file_name.c_str());
+        return;
+    }
+
+    m_opened = true;
+}
+
+void
+Index::window_close()
+{
+    if (!m_opened) {
+        return;
+    }
+
+    save();
+    m_opened = false;
+}
+
+/**
+ * @brief Create a Bloom filter of the current size parameters
+ * @throw FDS_exception if the filter cannot be allocated
+ */
+void
+Index::bloom_prepare()
+{
+    const double n = static_cast<double>((m_bloom.est_items > 0) ? m_bloom.est_items : 1);
+    const double ln2 = std::log(2.0);
+    const double bits = std::ceil(-n * std::log(m_fp_prob) / (ln2 * ln2));
+    const uint64_t words = (static_cast<uint64_t>(bits) + 63U) / 64U;
+
+    double hash_cnt = std::round((words * 64U) / n * ln2);
+    hash_cnt = std::max(1.0, std::min(hash_cnt, static_cast<double>(BF_HASH_MAX)));
+
+    try {
+        std::vector<uint64_t> new_bits(words, 0);
+        m_bloom.bits.swap(new_bits);
+    } catch (std::bad_alloc &ex) {
+        m_state = state::ERROR;
+        throw FDS_exception("Failed to allocate a Bloom filter of " + std::to_string(words * 8U)
+            + " bytes");
+    }
+
+    m_bloom.hash_cnt = static_cast<uint32_t>(hash_cnt);
+    m_bloom.stored_items = 0;
+    IPX_CTX_DEBUG(m_ctx, "Bloom filter index prepared (expected items: %" PRIu64 ", bits: %"
+        PRIu64 ", hash functions: %" PRIu32 ")", m_bloom.est_items, words * 64U,
+        m_bloom.hash_cnt);
+}
+
+/**
+ * @brief Add a value to the Bloom filter
+ * @param[in] data Value
+ * @param[in] size Size of the value
+ */
+void
+Index::bloom_add(const uint8_t *data, size_t size)
+{
+    // FNV-1a
+    uint64_t h1 = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h1 ^= data[i];
+        h1 *= 0x100000001b3ULL;
+    }
+
+    // MurMur3 finalizer
+    uint64_t h2 = h1;
+    h2 ^= h2 >> 33;
+    h2 *= 0xff51afd7ed558ccdULL;
+    h2 ^= h2 >> 33;
+    h2 *= 0xc4ceb9fe1a85ec53ULL;
+    h2 ^= h2 >> 33;
+    h2 |= 1U;
+
+    const uint64_t bit_cnt = m_bloom.bits.size() * 64U;
+    bool changed = false;
+    for (uint32_t i = 0; i < m_bloom.hash_cnt; ++i) {
+        const uint64_t pos = (h1 + i * h2) % bit_cnt;
+        uint64_t &word = m_bloom.bits[pos / 64U];
+        const uint64_t mask = uint64_t(1) << (pos % 64U);
+        if ((word & mask) == 0) {
+            word |= mask;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        m_bloom.stored_items++;
+    }
+}
+
+/**
+ * @brief Extend a min/max range by a value
+ * @param[in,out] rng  Range
+ * @param[in]     kind Kind of the values
+ * @param[in]     val  Value (both minimum and maximum are the same)
+ */
+void
+Index::range_add(struct range &rng, field_kind kind, const struct range &val)
+{
+    if (!rng.present) {
+        rng = val;
+        return;
+    }
+
+    switch (kind) {
+    case field_kind::MM_UINT:
+    case field_kind::MM_TIME:
+        rng.min.u = std::min(rng.min.u, val.min.u);
+        rng.max.u = std::max(rng.max.u, val.max.u);
+        break;
+    case field_kind::MM_INT:
+        rng.min.i = std::min(rng.min.i, val.min.i);
+        rng.max.i = std::max(rng.max.i, val.max.i);
+        break;
+    case field_kind::MM_FLOAT:
+        rng.min.f = std::min(rng.min.f, val.min.f);
+        rng.max.f = std::max(rng.max.f, val.max.f);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Get a value of a min/max field
+ * @param[in]  info Indexed field
+ * @param[in]  data Field of a Data Record
+ * @param[out] val  Range with the value as both the minimum and the maximum
+ * @return True on success. False if the value is malformed (or NaN).
+ */
+bool
+Index::value_get(const struct field &info, const struct fds_drec_field &data, struct range &val)
+{
+    int rc;
+
+    switch (info.kind) {
+    case field_kind::MM_UINT:
+        rc = fds_get_uint_be(data.data, data.size, &val.min.u);
+        break;
+    case field_kind::MM_INT:
+        rc = fds_get_int_be(data.data, data.size, &val.min.i);
+        break;
+    case field_kind::MM_FLOAT:
+        rc = fds_get_float_be(data.data, data.size, &val.min.f);
+        if (rc == FDS_OK && std::isnan(val.min.f)) {
+            return false;
+        }
+        break;
+    case field_kind::MM_TIME:
+        rc = fds_get_datetime_lp_be(data.data, data.size, info.type, &val.min.u);
+        break;
+    default:
+        return false;
+    }
+
+    if (rc != FDS_OK) {
+        return false;
+    }
+
+    val.present = true;
+    val.max = val.min;
+    return true;
+}
+
+void
+Index::process_msg(ipx_msg_ipfix_t *msg)
+{
+    if (!m_opened) {
+        return;
+    }
+
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    const struct fds_template *last_tmplt = nullptr;
+    const struct ipx_fsel_result *fields = nullptr;
+    const bool bloom_ready = m_bloom_en && m_state != state::ERROR;
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+
+        struct block *blk = nullptr;
+        if (m_block_recs != 0) {
+            if (m_blocks.empty() || m_blocks.back().rec_cnt >= m_block_recs) {
+                m_blocks.emplace_back();
+                m_blocks.back().rec_first = m_rec_cnt;
+                m_blocks.back().rec_cnt = 0;
+                m_blocks.back().ranges.resize(m_range_cnt);
+                for (auto &rng : m_blocks.back().ranges) {
+                    rng.present = false;
+                }
+            }
+
+            blk = &m_blocks.back();
+            blk->rec_cnt++;
+        }
+        m_rec_cnt++;
+
+        // Get positions of indexed fields (records of the same template usually follow)
+        if (rec->rec.tmplt != last_tmplt) {
+            fields = ipx_fsel_get(m_fsel.get(), rec->rec.tmplt);
+            last_tmplt = rec->rec.tmplt;
+            if (!fields) {
+                throw FDS_exception("Memory allocation error (field selector)");
+            }
+        }
+
+        if (fields->cnt == 0) {
+            continue;
+        }
+
+        struct ipx_fsel_iter it;
+        ipx_fsel_iter_init(&it, fields, &rec->rec);
+        while (ipx_fsel_iter_next(&it) == IPX_OK) {
+            for (auto &info : m_fields) {
+                if (info.en != it.field.info->en || info.id != it.field.info->id) {
+                    continue;
+                }
+
+                if (info.kind == field_kind::BLOOM) {
+                    if (bloom_ready) {
+                        bloom_add(it.field.data, it.field.size);
+                    }
+                    break;
+                }
+
+                struct range val;
+                if (!value_get(info, it.field, val)) {
+                    break;
+                }
+
+                range_add(info.window, info.kind, val);
+                if (blk) {
+                    range_add(blk->ranges[info.range_idx], info.kind, val);
+                }
+                break;
+            }
+        }
+    }
+}
+
+/// Auxiliary reader for deserialization of an index (bounds are checked)
+struct idx_reader {
+    const std::vector<uint8_t> &data;
+    size_t pos = 0;
+    bool failed = false;
+
+    explicit idx_reader(const std::vector<uint8_t> &buffer) : data(buffer) {}
+
+    const uint8_t *
+    get_raw(size_t size) {
+        if (failed || data.size() - pos < size) {
+            failed = true;
+            return nullptr;
+        }
+        const uint8_t *ptr = &data[pos];
+        pos += size;
+        return ptr;
+    }
+    uint8_t
+    get_u8() {
+        const uint8_t *ptr = get_raw(1);
+        return (ptr != nullptr) ? *ptr : 0;
+    }
+    uint16_t
+    get_u16() {
+        uint16_t val = 0;
+        const uint8_t *ptr = get_raw(sizeof(val));
+        if (ptr != nullptr) {
+            memcpy(&val, ptr, sizeof(val));
+        }
+        return be16toh(val);
+    }
+    uint32_t
+    get_u32() {
+        uint32_t val = 0;
+        const uint8_t *ptr = get_raw(sizeof(val));
+        if (ptr != nullptr) {
+            memcpy(&val, ptr, sizeof(val));
+        }
+        return be32toh(val);
+    }
+    uint64_t
+    get_u64() {
+        uint64_t val = 0;
+        const uint8_t *ptr = get_raw(sizeof(val));
+        if (ptr != nullptr) {
+            memcpy(&val, ptr, sizeof(val));
+        }
+        return be64toh(val);
+    }
+};
+
+/**
+ * @brief Load the index of the current window stored by a previous run (if exists)
+ *
+ * If the flow file of the window already exists, new records are appended to it. Therefore,
+ * the stored index is loaded and new records extend it, i.e. numbering of records and blocks
+ * continues and the Bloom filter (including its size) and min/max ranges are taken over.
+ * The index can be extended only if it has been created with the same configuration of fields
+ * and blocks.
+ * @return True if there is no stored index or it has been loaded
+ * @return False if the stored index cannot be extended
+ */
+bool
+Index::load()
+{
+    FILE *file = fopen(m_file_name.c_str(), "rb");
+    if (!file) {
+        // Usually the index doesn't exist (i.e. a new window)
+        return (errno == ENOENT);
+    }
+
+    std::vector<uint8_t> content;
+    try {
+        uint8_t chunk[4096];
+        size_t ret;
+        while ((ret = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            content.insert(content.end(), chunk, chunk + ret);
+        }
+    } catch (std::bad_alloc &ex) {
+        fclose(file);
+        return false;
+    }
+
+    const bool read_failed = (ferror(file) != 0);
+    fclose(file);
+    if (read_failed) {
+        return false;
+    }
+
+    // Header
+    idx_reader reader(content);
+    const uint8_t *magic = reader.get_raw(sizeof(IDX_MAGIC));
+    if (!magic || memcmp(magic, IDX_MAGIC, sizeof(IDX_MAGIC)) != 0
+            || reader.get_u8() != IDX_VERSION) {
+        return false;
+    }
+    reader.get_raw(3);
+    const uint64_t window_ts = reader.get_u64();
+    const uint64_t rec_cnt = reader.get_u64();
+    const uint16_t field_cnt = reader.get_u16();
+    reader.get_raw(2);
+    const uint32_t block_recs = reader.get_u32();
+    const uint32_t block_cnt = reader.get_u32();
+    if (reader.failed || window_ts != static_cast<uint64_t>(m_window_ts)
+            || field_cnt != m_fields.size()
+            || (block_cnt > 0 && block_recs != m_block_recs)) {
+        return false;
+    }
+
+    // Deserialization of a min/max range (the union is stored as an 8-byte value)
+    auto range_get_fn = [&reader](struct range &rng, bool present) {
+        const uint64_t min = reader.get_u64();
+        const uint64_t max = reader.get_u64();
+        rng.present = present;
+        memcpy(&rng.min, &min, sizeof(min));
+        memcpy(&rng.max, &max, sizeof(max));
+    };
+
+    // Fields (must be the same)
+    std::vector<struct range> windows(m_fields.size());
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+        const struct field &info = m_fields[i];
+        const uint32_t en = reader.get_u32();
+        const uint16_t id = reader.get_u16();
+        const uint8_t kind = reader.get_u8();
+        const bool present = (reader.get_u8() != 0);
+        range_get_fn(windows[i], present);
+        if (reader.failed || en != info.en || id != info.id
+                || kind != static_cast<uint8_t>(info.kind)) {
+            return false;
+        }
+    }
+
+    // Bloom filter
+    const uint64_t bloom_bits = reader.get_u64();
+    const uint32_t bloom_hash_cnt = reader.get_u32();
+    reader.get_raw(4);
+    const uint64_t bloom_items = reader.get_u64();
+    const bool bloom_ready = m_bloom_en && m_state != state::ERROR;
+    if (reader.failed || bloom_bits % 64U != 0
+            || (bloom_bits / 64U) > (content.size() - reader.pos) / 8U) {
+        return false;
+    }
+    if (bloom_ready && rec_cnt > 0 && (bloom_bits == 0 || bloom_hash_cnt == 0
+            || bloom_hash_cnt > BF_HASH_MAX)) {
+        // Previous records are not in the filter, it would give false negatives
+        return false;
+    }
+
+    std::vector<uint64_t> bits;
+    try {
+        bits.resize(bloom_bits / 64U);
+    } catch (std::bad_alloc &ex) {
+        return false;
+    }
+    for (auto &word : bits) {
+        word = reader.get_u64();
+    }
+
+    // Blocks
+    std::vector<struct block> blocks;
+    uint64_t block_next = 0;
+    try {
+        blocks.resize(block_cnt);
+    } catch (std::bad_alloc &ex) {
+        return false;
+    }
+    for (auto &blk : blocks) {
+        blk.rec_first = reader.get_u64();
+        blk.rec_cnt = reader.get_u32();
+        reader.get_raw(4);
+        blk.ranges.resize(m_range_cnt);
+        for (auto &rng : blk.ranges) {
+            const bool present = (reader.get_u8() != 0);
+            reader.get_raw(7);
+            range_get_fn(rng, present);
+        }
+
+        if (reader.failed || blk.rec_first != block_next) {
+            return false;
+        }
+        block_next += blk.rec_cnt;
+    }
+
+    if (reader.failed || (m_block_recs != 0 && block_next != rec_cnt)) {
+        // Blocks must cover all records
+        return false;
+    }
+
+    // Take over the loaded index
+    m_rec_cnt = rec_cnt;
+    m_blocks.swap(blocks);
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+        m_fields[i].window = windows[i];
+    }
+
+    if (bloom_ready && !bits.empty()) {
+        m_bloom.bits.swap(bits);
+        m_bloom.hash_cnt = bloom_hash_cnt;
+        m_bloom.stored_items = bloom_items;
+    }
+
+    IPX_CTX_INFO(m_ctx, "Index '%s' loaded and will be extended (records: %" PRIu64 ")",
+        m_file_name.c_str(), m_rec_cnt);
+    return true;
+}
+
+/// Auxiliary buffer for serialization of an index
+struct idx_buffer {
+    std::vector<uint8_t> data;
+
+    void
+    add_u8(uint8_t val) {
+        data.push_back(val);
+    }
+    void
+    add_u16(uint16_t val) {
+        val = htobe16(val);
+        add_raw(&val, sizeof(val));
+    }
+    void
+    add_u32(uint32_t val) {
+        val = htobe32(val);
+        add_raw(&val, sizeof(val));
+    }
+    void
+    add_u64(uint64_t val) {
+        val = htobe64(val);
+        add_raw(&val, sizeof(val));
+    }
+    void
+    add_zeros(size_t cnt) {
+        data.insert(data.end(), cnt, 0);
+    }
+    void
+    add_raw(const void *ptr, size_t size) {
+        auto bytes = reinterpret_cast<const uint8_t *>(ptr);
+        data.insert(data.end(), bytes, bytes + size);
+    }
+};
+
+/**
+ * @brief Store the index of the current window into its file
+ *
+ * The file is created atomically. Errors are only reported, because the index is not
+ * necessary for the flow file itself.
+ */
+void
+Index::save()
+{
+    const std::string tmp_name = m_file_name + ".tmp";
+    idx_buffer buffer;
+
+    // Serialization of a min/max range (the union is stored as an 8-byte value)
+    auto range_add_fn = [&buffer](const struct range &rng) {
+        uint64_t min = 0, max = 0;
+        if (rng.present) {
+            memcpy(&min, &rng.min, sizeof(min));
+            memcpy(&max, &rng.max, sizeof(max));
+        }
+        buffer.add_u64(min);
+        buffer.add_u64(max);
+    };
+
+    try {
+        const bool bloom_ready = m_bloom_en && m_state != state::ERROR;
+
+        // Header
+        buffer.add_raw(IDX_MAGIC, sizeof(IDX_MAGIC));
+        buffer.add_u8(IDX_VERSION);
+        buffer.add_zeros(3);
+        buffer.add_u64(static_cast<uint64_t>(m_window_ts));
+        buffer.add_u64(m_rec_cnt);
+        buffer.add_u16(static_cast<uint16_t>(m_fields.size()));
+        buffer.add_zeros(2);
+        buffer.add_u32(m_block_recs);
+        buffer.add_u32(static_cast<uint32_t>(m_blocks.size()));
+
+        // Fields
+        for (const auto &info : m_fields) {
+            buffer.add_u32(info.en);
+            buffer.add_u16(info.id);
+            buffer.add_u8(static_cast<uint8_t>(info.kind));
+            buffer.add_u8(info.window.present ? 1U : 0U);
+            range_add_fn(info.window);
+        }
+
+        // Bloom filter (empty, if not used)
+        buffer.add_u64(bloom_ready ? m_bloom.bits.size() * 64U : 0U);
+        buffer.add_u32(bloom_ready ? m_bloom.hash_cnt : 0U);
+        buffer.add_zeros(4);
+        buffer.add_u64(bloom_ready ? m_bloom.stored_items : 0U);
+        if (bloom_ready) {
+            for (uint64_t word : m_bloom.bits) {
+                buffer.add_u64(word);
+            }
+        }
+
+        // Blocks
+        for (const auto &blk : m_blocks) {
+            buffer.add_u64(blk.rec_first);
+            buffer.add_u32(blk.rec_cnt);
+            buffer.add_zeros(4);
+            for (const auto &rng : blk.ranges) {
+                buffer.add_u8(rng.present ? 1U : 0U);
+                buffer.add_zeros(7);
+                range_add_fn(rng);
+            }
+        }
+    } catch (std::bad_alloc &ex) {
+        IPX_CTX_ERROR(m_ctx, "Failed to store index '%s': memory allocation error",
+            m_file_name.c_str());
+        return;
+    }
+
+    FILE *file = fopen(tmp_name.c_str(), "wb");
+    if (!file) {
+        const char *err_str = strerror(errno);
+        IPX_CTX_ERROR(m_ctx, "Failed to create index '%s': %s", tmp_name.c_str(), err_str);
+        return;
+    }
+
+    bool failed = (fwrite(buffer.data.data(), 1, buffer.data.size(), file) != buffer.data.size());
+    failed |= (fclose(file) != 0);
+    if (failed || rename(tmp_name.c_str(), m_file_name.c_str()) != 0) {
+        remove(tmp_name.c_str());
+        IPX_CTX_ERROR(m_ctx, "Failed to store index '%s'", m_file_name.c_str());
+        return;
+    }
+
+    IPX_CTX_DEBUG(m_ctx, "Index '%s' has been stored (records: %" PRIu64 ", unique Bloom "
+        "filter items: %" PRIu64 ", blocks: %zu)", m_file_name.c_str(), m_rec_cnt,
+        m_bloom.stored_items, m_blocks.size());
+}
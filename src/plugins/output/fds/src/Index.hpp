@@ -0,0 +1,226 @@
+/**
+ * \file src/plugins/output/fds/src/Index.hpp
+ * \brief Index of flow storage files (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_FDS_INDEX_HPP
+#define IPFIXCOL2_FDS_INDEX_HPP
+
+#include <ipfixcol2.h>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+#include <libfds.h>
+
+#include "Config.hpp"
+
+/**
+ * @brief Index of a flow storage file
+ *
+ * The index helps tools to quickly decide whether a file (i.e. time window) can contain
+ * a record of interest without decompression of the whole file. Values of configured fields
+ * of all Data Records are added either into a Bloom filter (addresses, strings and octet arrays)
+ * or into min/max ranges (numbers and timestamps). Min/max ranges are also kept for blocks
+ * of consecutive records in the order they have been written to the file.
+ *
+ * The index of each window is stored into "<window>.idx" file next to the flow file when
+ * the window is closed. Because flow files are opened in append mode, an existing index of
+ * the same window (e.g. before a restart of the collector) is loaded and extended by new
+ * records. If it cannot be extended or the flow file already exists without an index (e.g.
+ * after a crash), the window is not indexed. The file starts with a header followed by
+ * the description of fields, the Bloom filter and blocks (all integers are in network byte
+ * order):
+ *
+ * @verbatim
+ *   Header:     magic "FDSI" (4B), version (1B), reserved (3B), window timestamp (8B),
+ *               record count (8B), field count (2B), reserved (2B), records per block (4B),
+ *               block count (4B)
+ *   Field:      PEN (4B), ID (2B), kind (1B), present (1B), min (8B), max (8B)
+ *   Bloom:      bit count (8B), hash count (4B), reserved (4B), stored item count (8B), bits
+ *   Block:      first record (8B), record count (4B), reserved (4B),
+ *               and for each min/max field: present (1B), reserved (7B), min (8B), max (8B)
+ * @endverbatim
+ *
+ * Bit positions of a value in the Bloom filter are (h1 + i * h2) mod bit_count, where h1 is
+ * 64-bit FNV-1a hash of the value, h2 is the MurMur3 finalizer of h1 with the lowest bit set
+ * and i = 0 .. hash count - 1. Bits are stored as 64-bit words, i.e. bit p is the bit
+ * (p mod 64) of the word (p / 64). Min/max values of timestamps are expressed in milliseconds
+ * since the Epoch, floats are stored as IEEE 754 double.
+ */
+class Index {
+public:
+    /**
+     * @brief Create an index
+     *
+     * Names of configured fields are resolved using the manager of Information Elements
+     * of the plugin context.
+     * @param[in] ctx Plugin context
+     * @param[in] cfg Configuration
+     * @throw FDS_exception if a field is unknown or cannot be indexed
+     */
+    Index(ipx_ctx_t *ctx, const Config &cfg);
+    /// Store the index of the current window (if any)
+    ~Index();
+
+    // Disable copy constructors
+    Index(const Index &other) = delete;
+    Index &operator=(const Index &other) = delete;
+
+    /**
+     * @brief Create a new time window
+     *
+     * The index of the previous window is stored, if exists. If autosize is enabled,
+     * the Bloom filter is resized based on the number of items in the previous window.
+     * If an index of the new window already exists, it is loaded and extended.
+     * @warning The function MUST be called before the flow file is created (or opened).
+     * @param[in] file_name Name of the index file of the new window
+     * @param[in] flow_file Name of the flow file of the new window
+     * @param[in] ts        Timestamp of the window
+     * @throw FDS_exception if the Bloom filter cannot be prepared
+     */
+    void
+    window_new(const std::string &file_name, const std::string &flow_file, time_t ts);
+
+    /**
+     * @brief Close the current time window and store its index
+     * @note No more Data Records will be added until a new window is created!
+     */
+    void
+    window_close();
+
+    /**
+     * @brief Add all Data Records of an IPFIX Message to the index
+     * @note If a time window is not opened, nothing is done.
+     * @param[in] msg Message to process
+     * @throw FDS_exception if processing fails
+     */
+    void
+    process_msg(ipx_msg_ipfix_t *msg);
+
+private:
+    /// Kind of an indexed field
+    enum class field_kind : uint8_t {
+        BLOOM = 1,    ///< Value is added to the Bloom filter
+        MM_UINT = 2,  ///< Min/max range of unsigned integers
+        MM_INT = 3,   ///< Min/max range of signed integers
+        MM_FLOAT = 4, ///< Min/max range of floats
+        MM_TIME = 5   ///< Min/max range of timestamps
+    };
+
+    /// Value of a min/max field (the member is given by the kind of the field)
+    union value {
+        uint64_t u; ///< Unsigned integer or timestamp (milliseconds)
+        int64_t i;  ///< Signed integer
+        double f;   ///< Float
+    };
+
+    /// Min/max range of values
+    struct range {
+        /// At least one value has been added
+        bool present;
+        /// Minimum value
+        union value min;
+        /// Maximum value
+        union value max;
+    };
+
+    /// Indexed field
+    struct field {
+        /// Private Enterprise Number
+        uint32_t en;
+        /// Information Element ID
+        uint16_t id;
+        /// Data type of the Information Element
+        enum fds_iemgr_element_type type;
+        /// Kind of the index
+        field_kind kind;
+        /// Position of the min/max range in blocks (only for min/max fields)
+        uint16_t range_idx;
+        /// Min/max range of the current window (only for min/max fields)
+        struct range window;
+    };
+
+    /// Min/max ranges of a block of consecutive records
+    struct block {
+        /// Index of the first record of the block
+        uint64_t rec_first;
+        /// Number of records in the block
+        uint32_t rec_cnt;
+        /// Min/max ranges of min/max fields
+        std::vector<struct range> ranges;
+    };
+
+    /// Bloom filter
+    struct bloom {
+        /// Expected number of items
+        uint64_t est_items;
+        /// Number of items that changed at least one bit (estimate of unique items)
+        uint64_t stored_items;
+        /// Number of hash functions
+        uint32_t hash_cnt;
+        /// Bits of the filter
+        std::vector<uint64_t> bits;
+    };
+
+    /// State of the index (see autosize of the Bloom filter)
+    enum class state {
+        INIT,          ///< Before creating of the first window
+        FIRST_PARTIAL, ///< First window (probably not of full length, not suitable for shrinking)
+        FULL,          ///< Full length window
+        ERROR          ///< The Bloom filter is not ready
+    };
+
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Indexed fields
+    std::vector<struct field> m_fields;
+    /// Number of min/max fields
+    uint16_t m_range_cnt = 0;
+    /// At least one field is added to the Bloom filter
+    bool m_bloom_en = false;
+    /// False positive probability of the Bloom filter
+    double m_fp_prob;
+    /// Enable automatic resize of the Bloom filter
+    bool m_autosize;
+    /// Number of records per block (0 = blocks are disabled)
+    uint32_t m_block_recs;
+    /// Selector of indexed fields
+    std::unique_ptr<ipx_fsel_t, decltype(&ipx_fsel_destroy)> m_fsel = {nullptr, &ipx_fsel_destroy};
+
+    /// State of the index
+    enum state m_state = state::INIT;
+    /// A time window is opened
+    bool m_opened = false;
+    /// Name of the index file of the current window
+    std::string m_file_name;
+    /// Timestamp of the current window
+    time_t m_window_ts = 0;
+    /// Number of records in the current window
+    uint64_t m_rec_cnt = 0;
+    /// Bloom filter of the current window
+    struct bloom m_bloom;
+    /// Blocks of the current window
+    std::vector<struct block> m_blocks;
+
+    static bool
+    field_match_cb(const struct fds_tfield *tfield, void *data);
+    void
+    bloom_prepare();
+    void
+    bloom_add(const uint8_t *data, size_t size);
+    static void
+    range_add(struct range &rng, field_kind kind, const struct range &val);
+    static bool
+    value_get(const struct field &info, const struct fds_drec_field &data, struct range &val);
+    bool
+    load();
+    void
+    save();
+};
+
+#endif // IPFIXCOL2_FDS_INDEX_HPP
@@ -0,0 +1,389 @@
+/**
+ * \file src/plugins/output/fds/src/Shards.cpp
+ * \brief Flow storage sharded across multiple files (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <libgen.h>
+#include "Shards.hpp"
+
+Shards::Shards(ipx_ctx_t *ctx, const Config &cfg) : m_ctx(ctx), m_path(cfg.m_path)
+{
+    m_shards.reserve(cfg.m_shards);
+
+    try {
+        for (uint32_t i = 0; i < cfg.m_shards; ++i) {
+            std::unique_ptr<shard> new_shard(new shard);
+            new_shard->ctx = ctx;
+            new_shard->id = i;
+            new_shard->storage.reset(new Storage(ctx, cfg, "." + std::to_string(i)));
+            if (!cfg.m_index.fields.empty()) {
+                new_shard->index.reset(new Index(ctx, cfg));
+            }
+
+            pthread_mutex_init(&new_shard->mutex, nullptr);
+            pthread_cond_init(&new_shard->cond_cmd, nullptr);
+            pthread_cond_init(&new_shard->cond_space, nullptr);
+
+            shard *ptr = new_shard.get();
+            int rc = pthread_create(&ptr->thread, nullptr, &Shards::thread_writer, ptr);
+            if (rc != 0) {
+                pthread_cond_destroy(&ptr->cond_space);
+                pthread_cond_destroy(&ptr->cond_cmd);
+                pthread_mutex_destroy(&ptr->mutex);
+                throw FDS_exception("Failed to start a writer thread: " + std::string(strerror(rc)));
+            }
+
+            m_shards.emplace_back(std::move(new_shard));
+        }
+    } catch (...) {
+        // Stop already running threads
+        stop();
+        throw;
+    }
+}
+
+Shards::~Shards()
+{
+    stop();
+}
+
+/**
+ * @brief Stop writer threads of all shards
+ *
+ * All commands in the queues are processed and the files are closed before the threads
+ * are stopped.
+ */
+void
+Shards::stop()
+{
+    cmd_push_all(cmd_type::STOP, 0);
+
+    for (auto &shard_ptr : m_shards) {
+        pthread_join(shard_ptr->thread, nullptr);
+        pthread_cond_destroy(&shard_ptr->cond_space);
+        pthread_cond_destroy(&shard_ptr->cond_cmd);
+        pthread_mutex_destroy(&shard_ptr->mutex);
+    }
+
+    m_shards.clear();
+}
+
+void
+Shards::window_new(time_t ts)
+{
+    // Close the current window if exists
+    window_close();
+
+    // Indices must be prepared before flow files are created by writer threads
+    const std::string window = Storage::window_name(m_path, ts);
+    for (auto &shard_ptr : m_shards) {
+        if (shard_ptr->index) {
+            const std::string shard_id = "." + std::to_string(shard_ptr->id);
+            shard_ptr->index->window_new(window + shard_id + ".idx",
+                Storage::file_name(m_path, ts, shard_id), ts);
+        }
+    }
+
+    manifest_create(ts);
+    cmd_push_all(cmd_type::OPEN, ts);
+    m_opened = true;
+}
+
+void
+Shards::window_close()
+{
+    if (m_opened) {
+        cmd_push_all(cmd_type::CLOSE, 0);
+        m_opened = false;
+    }
+
+    for (auto &shard_ptr : m_shards) {
+        if (shard_ptr->index) {
+            shard_ptr->index->window_close();
+        }
+    }
+
+    // New files don't know any Templates
+    m_snaps.clear();
+}
+
+/// Auxiliary data structure used in the snapshot iterator
+struct tmplt_copy_data {
+    /// Status of template processing
+    bool is_ok;
+    /// Copies of Templates
+    std::vector<storage_tmplt> *tmplts;
+};
+
+/**
+ * @brief Callback function for copying of an IPFIX (Options) Template
+ * @param[in] tmplt Template to process
+ * @param[in] data  Auxiliary data structure \ref tmplt_copy_data
+ * @return On success returns true. Otherwise returns false.
+ */
+static bool
+tmplt_copy_cb(const struct fds_template *tmplt, void *data)
+{
+    auto info = reinterpret_cast<tmplt_copy_data *>(data);
+
+    // No exceptions can be thrown in the C callback!
+    try {
+        info->tmplts->emplace_back();
+        storage_tmplt &copy = info->tmplts->back();
+        copy.id = tmplt->id;
+        copy.type = tmplt->type;
+        copy.raw.assign(tmplt->raw.data, tmplt->raw.data + tmplt->raw.length);
+    } catch (...) {
+        info->is_ok = false;
+    }
+
+    return info->is_ok;
+}
+
+/**
+ * @brief Create a new job for Data Records of an IPFIX Message
+ *
+ * If the Template snapshot differs from the last snapshot passed to the shard, copies of all
+ * Templates of the snapshot are added to the job.
+ * @param[in] msg_ctx  Message context (Transport Session and ODID)
+ * @param[in] exp_time Export time of the message
+ * @param[in] snap     Template snapshot of the records
+ * @return New job
+ * @throw FDS_exception if the job cannot be created
+ */
+std::unique_ptr<storage_job>
+Shards::job_create(const struct ipx_msg_ctx *msg_ctx, uint32_t exp_time,
+    const fds_tsnapshot_t *snap)
+{
+    std::unique_ptr<storage_job> job(new storage_job);
+    job->session = msg_ctx->session;
+    Storage::session_ipx2fds(msg_ctx->session, &job->session_desc);
+    job->session_name = msg_ctx->session->ident;
+    job->odid = msg_ctx->odid;
+    job->exp_time = exp_time;
+    job->snap = snap;
+
+    const odid_key key = {msg_ctx->session, msg_ctx->odid};
+    auto snap_it = m_snaps.find(key);
+    if (snap_it != m_snaps.end() && snap_it->second == snap) {
+        // The shard already knows the Templates
+        return job;
+    }
+
+    struct tmplt_copy_data data;
+    data.is_ok = true;
+    data.tmplts = &job->tmplts;
+    fds_tsnapshot_for(snap, &tmplt_copy_cb, &data);
+    if (!data.is_ok) {
+        throw FDS_exception("Failed to copy Template definitions");
+    }
+
+    m_snaps[key] = snap;
+    return job;
+}
+
+void
+Shards::process_msg(ipx_msg_ipfix_t *msg)
+{
+    if (!m_opened) {
+        IPX_CTX_DEBUG(m_ctx, "Ignoring IPFIX Message due to undefined output files!", '\0');
+        return;
+    }
+
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    if (rec_cnt == 0) {
+        return;
+    }
+
+    // Select the shard
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    const odid_key key = {msg_ctx->session, msg_ctx->odid};
+    shard &dst = *m_shards[odid_key_hash()(key) % m_shards.size()];
+    if (dst.index) {
+        dst.index->process_msg(msg);
+    }
+
+    auto hdr_ptr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg));
+    assert(ntohs(hdr_ptr->version) == FDS_IPFIX_VERSION && "Unexpected packet version");
+    const uint32_t exp_time = ntohl(hdr_ptr->export_time);
+
+    // Copy Data Records (a new job is created for each Template snapshot)
+    const size_t msg_size = ntohs(hdr_ptr->length);
+    std::unique_ptr<storage_job> job;
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+
+        if (!job || job->snap != rec_ptr->rec.snap) {
+            if (job) {
+                std::unique_ptr<cmd> new_cmd(new cmd{cmd_type::DATA, 0, std::move(job)});
+                cmd_push(dst, std::move(new_cmd));
+            }
+
+            job = job_create(msg_ctx, exp_time, rec_ptr->rec.snap);
+            job->data.reserve(msg_size);
+            job->recs.reserve(rec_cnt - i);
+        }
+
+        struct storage_rec rec;
+        rec.offset = static_cast<uint32_t>(job->data.size());
+        rec.size = rec_ptr->rec.size;
+        rec.tmplt_id = rec_ptr->rec.tmplt->id;
+        job->data.insert(job->data.end(), rec_ptr->rec.data, rec_ptr->rec.data + rec.size);
+        job->recs.push_back(rec);
+    }
+
+    std::unique_ptr<cmd> new_cmd(new cmd{cmd_type::DATA, 0, std::move(job)});
+    cmd_push(dst, std::move(new_cmd));
+}
+
+/**
+ * @brief Push a command to the queue of a shard
+ *
+ * If the queue is full, the function waits until there is a free space.
+ * @param[in] dst     Shard
+ * @param[in] new_cmd Command
+ */
+void
+Shards::cmd_push(shard &dst, std::unique_ptr<cmd> new_cmd)
+{
+    pthread_mutex_lock(&dst.mutex);
+    while (dst.queue.size() >= QUEUE_SIZE) {
+        pthread_cond_wait(&dst.cond_space, &dst.mutex);
+    }
+
+    dst.queue.emplace_back(std::move(new_cmd));
+    pthread_cond_signal(&dst.cond_cmd);
+    pthread_mutex_unlock(&dst.mutex);
+}
+
+/**
+ * @brief Push a command without Data Records to queues of all shards
+ * @param[in] type Type of the command
+ * @param[in] ts   Timestamp of the window (only for cmd_type::OPEN)
+ */
+void
+Shards::cmd_push_all(cmd_type type, time_t ts)
+{
+    for (auto &shard_ptr : m_shards) {
+        std::unique_ptr<cmd> new_cmd(new cmd{type, ts, nullptr});
+        cmd_push(*shard_ptr, std::move(new_cmd));
+    }
+}
+
+/**
+ * @brief Create a manifest of a time window
+ *
+ * The manifest is a JSON file "<window>.manifest" with the timestamp of the window and the list
+ * of files (i.e. shards) of the window. The manifest is created atomically.
+ * @param[in] ts Timestamp of the window
+ * @throw FDS_exception if the manifest cannot be created
+ */
+void
+Shards::manifest_create(time_t ts)
+{
+    const std::string window = Storage::window_name(m_path, ts);
+    const std::string file_name = window + ".manifest";
+    const std::string tmp_name = file_name + ".tmp";
+
+    // Create the directory
+    std::unique_ptr<char, decltype(&free)> window_cpy(strdup(window.c_str()), &free);
+    char *dir2create;
+    if (!window_cpy || (dir2create = dirname(window_cpy.get())) == nullptr) {
+        throw FDS_exception("Failed to generate name of an output directory!");
+    }
+
+    if (ipx_utils_mkdir(dir2create, IPX_UTILS_MKDIR_DEF) != FDS_OK) {
+        throw FDS_exception("Failed to create directory '" + std::string(dir2create) + "'");
+    }
+
+    // Files of shards are described relative to the manifest
+    std::unique_ptr<char, decltype(&free)> base_cpy(strdup(window.c_str()), &free);
+    if (!base_cpy) {
+        throw FDS_exception("Failed to generate name of a window!");
+    }
+    const std::string base_name = basename(base_cpy.get());
+
+    FILE *file = fopen(tmp_name.c_str(), "w");
+    if (!file) {
+        throw FDS_exception("Failed to create manifest '" + tmp_name + "': " + strerror(errno));
+    }
+
+    fprintf(file, "{\n    \"window\": %" PRId64 ",\n    \"files\": [\n", int64_t(ts));
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        const char *delim = (i + 1 < m_shards.size()) ? "," : "";
+        fprintf(file, "        \"%s.%zu.fds\"%s\n", base_name.c_str(), i, delim);
+    }
+    fprintf(file, "    ]\n}\n");
+
+    bool failed = (ferror(file) != 0);
+    failed |= (fclose(file) != 0);
+    if (failed || rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        remove(tmp_name.c_str());
+        throw FDS_exception("Failed to create manifest '" + file_name + "'");
+    }
+}
+
+/**
+ * @brief Writer thread of a shard
+ *
+ * Process commands from the queue of the shard until a stop command is received.
+ * @param[in] arg Shard
+ * @return nullptr
+ */
+void *
+Shards::thread_writer(void *arg)
+{
+    auto *self = reinterpret_cast<shard *>(arg);
+    Storage &storage = *self->storage;
+
+    while (true) {
+        pthread_mutex_lock(&self->mutex);
+        while (self->queue.empty()) {
+            pthread_cond_wait(&self->cond_cmd, &self->mutex);
+        }
+
+        std::unique_ptr<cmd> next = std::move(self->queue.front());
+        self->queue.pop_front();
+        pthread_cond_signal(&self->cond_space);
+        pthread_mutex_unlock(&self->mutex);
+
+        if (next->type == cmd_type::STOP) {
+            break;
+        }
+
+        try {
+            switch (next->type) {
+            case cmd_type::OPEN:
+                storage.window_new(next->ts);
+                break;
+            case cmd_type::CLOSE:
+                storage.window_close();
+                break;
+            case cmd_type::DATA:
+                storage.process_job(*next->job);
+                break;
+            default:
+                break;
+            }
+        } catch (std::exception &ex) {
+            IPX_CTX_ERROR(self->ctx, "Shard %u: %s", self->id, ex.what());
+            IPX_CTX_ERROR(self->ctx, "Due to the previous error(s), the output file of the shard "
+                "%u is possibly corrupted. Therefore, no flow records are stored to the shard "
+                "until a new file is automatically opened after current window expiration.",
+                self->id);
+            storage.window_close();
+        }
+    }
+
+    // Close the file of the current window
+    storage.window_close();
+    return nullptr;
+}
@@ -0,0 +1,159 @@
+/**
+ * \file src/plugins/output/fds/src/Shards.hpp
+ * \brief Flow storage sharded across multiple files (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_FDS_SHARDS_HPP
+#define IPFIXCOL2_FDS_SHARDS_HPP
+
+#include <ipfixcol2.h>
+#include <deque>
+#include <memory>
+#include <pthread.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Config.hpp"
+#include "Index.hpp"
+#include "Storage.hpp"
+
+/**
+ * @brief Flow storage sharded across multiple files
+ *
+ * Each time window is split into N files (i.e. shards) named "<window>.<shard>.fds". Data Records
+ * are distributed among shards based on a hash of their Transport Session and ODID, therefore,
+ * all records of a flow exporter are stored in the same file. Each shard has its own writer
+ * thread, so compression and I/O of shards run in parallel. A manifest "<window>.manifest"
+ * describes the set of files of the window. If enabled, each file has its own index
+ * "<window>.<shard>.idx" built by the processing thread.
+ *
+ * Because IPFIX Messages and their Templates cannot be referenced after processing of the
+ * message, Data Records and Template definitions are copied and handed over to the writer
+ * threads as jobs.
+ */
+class Shards {
+public:
+    /**
+     * @brief Create shards and start their writer threads
+     *
+     * @note
+     *   Output files for the current window MUST be specified using new_window() function.
+     *   Otherwise, no flow records are stored.
+     * @param[in] ctx Plugin context (only for log)
+     * @param[in] cfg Configuration
+     * @throw FDS_exception if the shards cannot be created
+     */
+    Shards(ipx_ctx_t *ctx, const Config &cfg);
+    /// Store all remaining Data Records, close files and stop writer threads
+    ~Shards();
+
+    // Disable copy constructors
+    Shards(const Shards &other) = delete;
+    Shards &operator=(const Shards &other) = delete;
+
+    /**
+     * @brief Create a new time window
+     *
+     * @note Previous window is automatically closed, if exists.
+     * @param[in] ts Timestamp of the window
+     * @throw FDS_exception if the manifest of the new window cannot be created
+     */
+    void
+    window_new(time_t ts);
+
+    /**
+     * @brief Close the current time window
+     * @note No more Data Records will be added until a new window is created!
+     */
+    void
+    window_close();
+
+    /**
+     * @brief Process IPFIX message
+     *
+     * Copy all IPFIX Data Records in the message and pass them to the writer thread of
+     * the corresponding shard.
+     * @note If a time window is not opened, no Data Records are stored and no exception is thrown.
+     * @param[in] msg Message to process
+     * @throw FDS_exception if processing fails
+     */
+    void
+    process_msg(ipx_msg_ipfix_t *msg);
+
+private:
+    /// Maximum number of commands waiting in a queue of a shard
+    static constexpr size_t QUEUE_SIZE = 256;
+
+    /// Type of a command for a writer thread
+    enum class cmd_type {
+        OPEN,  ///< Open a new time window
+        CLOSE, ///< Close the current time window
+        DATA,  ///< Store Data Records
+        STOP   ///< Stop the thread
+    };
+
+    /// Command for a writer thread
+    struct cmd {
+        /// Type of the command
+        cmd_type type;
+        /// Timestamp of the window to open
+        time_t ts;
+        /// Data Records to store
+        std::unique_ptr<storage_job> job;
+    };
+
+    /// Shard of the storage
+    struct shard {
+        /// Plugin context (only for log!)
+        ipx_ctx_t *ctx;
+        /// Index of the shard
+        unsigned int id;
+        /// Storage of the shard (accessed only by the writer thread)
+        std::unique_ptr<Storage> storage;
+        /// Index of the shard (only if enabled, accessed only by the processing thread)
+        std::unique_ptr<Index> index;
+
+        /// Mutex protecting the queue
+        pthread_mutex_t mutex;
+        /// Condition variable signalling a new command in the queue
+        pthread_cond_t cond_cmd;
+        /// Condition variable signalling a free space in the queue
+        pthread_cond_t cond_space;
+        /// Queue of commands
+        std::deque<std::unique_ptr<cmd>> queue;
+        /// Writer thread
+        pthread_t thread;
+    };
+
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Storage path
+    std::string m_path;
+    /// Shards
+    std::vector<std::unique_ptr<shard>> m_shards;
+    /// A time window is opened
+    bool m_opened = false;
+    /// Last Template snapshot passed to a shard for each combination of a Session and an ODID
+    std::unordered_map<odid_key, const fds_tsnapshot_t *, odid_key_hash> m_snaps;
+
+    void
+    stop();
+    void
+    cmd_push(shard &dst, std::unique_ptr<cmd> new_cmd);
+    void
+    cmd_push_all(cmd_type type, time_t ts);
+    void
+    manifest_create(time_t ts);
+    std::unique_ptr<storage_job>
+    job_create(const struct ipx_msg_ctx *msg_ctx, uint32_t exp_time, const fds_tsnapshot_t *snap);
+
+    static void *
+    thread_writer(void *arg);
+};
+
+#endif // IPFIXCOL2_FDS_SHARDS_HPP
@@ -17,7 +17,8 @@
 #include <libgen.h>
 #include "Storage.hpp"
 
-Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) : m_ctx(ctx), m_path(cfg.m_path)
+Storage::Storage(ipx_ctx_t *ctx, const Config &cfg, const std::string &suffix)
+    : m_ctx(ctx), m_path(cfg.m_path), m_suffix(suffix)
 {
     // Check if the directory exists
     struct stat file_info;
@@ -44,6 +45,7 @@ Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) : m_ctx(ctx), m_path(cfg.m_p
     }
 
     m_flags |= FDS_FILE_APPEND;
+    m_closer.reset(new Closer(m_ctx));
 }
 
 void
@@ -65,6 +67,9 @@ Storage::window_new(time_t ts)
         throw FDS_exception("Failed to create directory '" + std::string(dir2create) + "'");
     }
 
+    // The same file might be still being closed (the file is opened in append mode)
+    m_closer->wait(new_file);
+
     m_file.reset(fds_file_init());
     if (!m_file) {
         throw FDS_exception("Failed to create FDS file handler!");
@@ -75,13 +80,21 @@ Storage::window_new(time_t ts)
         m_file.reset();
         throw FDS_exception("Failed to create/append file '" + new_file + "': " + err_msg);
     }
+
+    m_file_name = new_file;
 }
 
 void
 Storage::window_close()
 {
-    m_file.reset();
-    m_session2params.clear();
+    if (m_file) {
+        // Flush and close the file in the background
+        m_closer->push(m_file.release(), m_file_name);
+    }
+
+    m_odid_last = nullptr;
+    m_odid2params.clear();
+    m_session2id.clear();
 }
 
 void
@@ -92,44 +105,96 @@ Storage::process_msg(ipx_msg_ipfix_t *msg)
         return;
     }
 
-    // Specify a Transport Session context
+    // Specify a Transport Session and ODID context
     struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
-    session_ctx &file_ctx = session_get(msg_ctx->session);
+    odid_ctx &file_ctx = odid_get(msg_ctx->session, msg_ctx->odid);
 
     auto hdr_ptr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg));
     assert(ntohs(hdr_ptr->version) == FDS_IPFIX_VERSION && "Unexpected packet version");
     const uint32_t exp_time = ntohl(hdr_ptr->export_time);
 
-    if (fds_file_write_ctx(m_file.get(), file_ctx.id, msg_ctx->odid, exp_time) != FDS_OK) {
-        const char *err_msg = fds_file_error(m_file.get());
+    fds_file_t *file = m_file.get();
+    if (fds_file_write_ctx(file, file_ctx.id, msg_ctx->odid, exp_time) != FDS_OK) {
+        const char *err_msg = fds_file_error(file);
         throw FDS_exception("Failed to configure the writer: " + std::string(err_msg));
     }
 
     // Get info about the last seen Template snapshot
-    struct snap_info &snap_last = file_ctx.odid2snap[msg_ctx->odid];
+    struct snap_info &snap_last = file_ctx.snap_last;
 
-    // For each Data Record in the file
+    /* Process Data Records in runs of records with the same Template (usually the whole Data Set)
+     * so the Template snapshot and Template ID are checked only once per run
+     */
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
-    for (uint32_t i = 0; i < rec_cnt; ++i) {
-        ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+    uint32_t idx = 0;
+    while (idx < rec_cnt) {
+        ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, idx);
+        const struct fds_template *run_tmplt = rec_ptr->rec.tmplt;
+        const fds_tsnapshot_t *run_snap = rec_ptr->rec.snap;
 
         // Check if the templates has been changed (detected by change of template snapshots)
-        if (rec_ptr->rec.snap != snap_last.ptr) {
+        if (run_snap != snap_last.ptr) {
             const char *session_name = msg_ctx->session->ident;
             uint32_t session_odid = msg_ctx->odid;
             IPX_CTX_DEBUG(m_ctx, "Template snapshot of '%s' [ODID %" PRIu32 "] has been changed. "
                 "Updating template definitions...", session_name, session_odid);
 
-            tmplts_update(snap_last, rec_ptr->rec.snap);
+            tmplts_update(snap_last, run_snap);
+        }
+
+        // Write the Data Records of the run
+        const uint16_t tmplt_id = run_tmplt->id;
+        do {
+            if (fds_file_write_rec(file, tmplt_id, rec_ptr->rec.data, rec_ptr->rec.size) != FDS_OK) {
+                const char *err_msg = fds_file_error(file);
+                throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
+            }
+
+            if (++idx == rec_cnt) {
+                break;
+            }
+
+            rec_ptr = ipx_msg_ipfix_get_drec(msg, idx);
+        } while (rec_ptr->rec.tmplt == run_tmplt && rec_ptr->rec.snap == run_snap);
+    }
+}
+
+void
+Storage::process_job(const struct storage_job &job)
+{
+    if (!m_file) {
+        IPX_CTX_DEBUG(m_ctx, "Ignoring Data Records due to undefined output file!", '\0');
+        return;
+    }
+
+    // Specify a Transport Session and ODID context
+    const char *session_name = job.session_name.c_str();
+    odid_ctx &file_ctx = odid_get(job.session, job.odid, &job.session_desc, session_name);
+
+    fds_file_t *file = m_file.get();
+    if (fds_file_write_ctx(file, file_ctx.id, job.odid, job.exp_time) != FDS_OK) {
+        const char *err_msg = fds_file_error(file);
+        throw FDS_exception("Failed to configure the writer: " + std::string(err_msg));
+    }
+
+    // Check if the templates has been changed (i.e. the snapshot or the file is different)
+    struct snap_info &snap_last = file_ctx.snap_last;
+    if (job.snap != snap_last.ptr) {
+        if (job.tmplts.empty()) {
+            // Definitions are sent only with the first job of a snapshot after opening a window
+            throw FDS_exception("Template definitions of '" + job.session_name + "' are missing");
         }
 
-        // Write the Data Record
-        const uint8_t *rec_data = rec_ptr->rec.data;
-        uint16_t rec_size = rec_ptr->rec.size;
-        uint16_t tmplt_id = rec_ptr->rec.tmplt->id;
+        IPX_CTX_DEBUG(m_ctx, "Template snapshot of '%s' [ODID %" PRIu32 "] has been changed. "
+            "Updating template definitions...", session_name, job.odid);
+        tmplts_update(snap_last, job.snap, job.tmplts);
+    }
 
-        if (fds_file_write_rec(m_file.get(), tmplt_id, rec_data, rec_size) != FDS_OK) {
-            const char *err_msg = fds_file_error(m_file.get());
+    // Write the Data Records
+    const uint8_t *data = job.data.data();
+    for (const auto &rec : job.recs) {
+        if (fds_file_write_rec(file, rec.tmplt_id, data + rec.offset, rec.size) != FDS_OK) {
+            const char *err_msg = fds_file_error(file);
             throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
         }
     }
@@ -149,11 +214,60 @@ struct tmplt_update_data {
 };
 
 /**
- * @brief Callback function for updating definition of an IPFIX (Options) Template
+ * @brief Update definition of an IPFIX (Options) Template
  *
  * The function checks if the same Template is already defined in the current context of the file.
  * If the Template is not present or it's different, the new Template definition is added to the
  * file.
+ * @param[in] info   Auxiliary data structure \ref tmplt_update_data
+ * @param[in] t_id   Template ID
+ * @param[in] t_type Template type
+ * @param[in] t_data Raw Template definition
+ * @param[in] t_size Size of the raw Template definition
+ * @throw FDS_exception if the update fails
+ */
+static void
+tmplt_sync(struct tmplt_update_data *info, uint16_t t_id, enum fds_template_type t_type,
+    const uint8_t *t_data, uint16_t t_size)
+{
+    // Template type, raw data and size in the file
+    enum fds_template_type f_type;
+    const uint8_t *f_data;
+    uint16_t f_size;
+
+    info->ids.emplace(t_id);
+
+    // Get definition of the Template specified in the file
+    int res = fds_file_write_tmplt_get(info->file, t_id, &f_type, &f_data, &f_size);
+
+    if (res != FDS_OK && res != FDS_ERR_NOTFOUND) {
+        // Something bad happened
+        const char *err_msg = fds_file_error(info->file);
+        throw FDS_exception("fds_file_write_tmplt_get() failed: " + std::string(err_msg));
+    }
+
+    // Should we add/redefine the definition of the Template
+    if (res == FDS_OK
+            && t_type == f_type
+            && t_size == f_size
+            && memcmp(t_data, f_data, f_size) == 0) {
+        // The same -> nothing to do
+        return;
+    }
+
+    // Add the definition (i.e. templates are different or the template hasn't been defined)
+    IPX_CTX_DEBUG(info->ctx, "Adding/updating definition of Template ID %" PRIu16, t_id);
+
+    if (fds_file_write_tmplt_add(info->file, t_type, t_data, t_size) != FDS_OK) {
+        const char *err_msg = fds_file_error(info->file);
+        throw FDS_exception("fds_file_write_tmplt_add() failed: " + std::string(err_msg));
+    }
+}
+
+/**
+ * @brief Callback function for updating definition of an IPFIX (Options) Template
+ *
+ * See tmplt_sync() for more details.
  * @param[in] tmplt Template to process
  * @param[in] data  Auxiliary data structure \ref tmplt_update_data
  * @return On success returns true. Otherwise returns false.
@@ -161,48 +275,11 @@ struct tmplt_update_data {
 static bool
 tmplt_update_cb(const struct fds_template *tmplt, void *data)
 {
-    // Template type, raw data and size
-    enum fds_template_type t_type;
-    const uint8_t *t_data;
-    uint16_t t_size;
-
     auto info = reinterpret_cast<tmplt_update_data *>(data);
 
     // No exceptions can be thrown in the C callback!
     try {
-        uint16_t t_id = tmplt->id;
-        info->ids.emplace(t_id);
-
-        // Get definition of the Template specified in the file
-        int res = fds_file_write_tmplt_get(info->file, t_id, &t_type, &t_data, &t_size);
-
-        if (res != FDS_OK && res != FDS_ERR_NOTFOUND) {
-            // Something bad happened
-            const char *err_msg = fds_file_error(info->file);
-            throw FDS_exception("fds_file_write_tmplt_get() failed: " + std::string(err_msg));
-        }
-
-        // Should we add/redefine the definition of the Template
-        if (res == FDS_OK
-                && tmplt->type == t_type
-                && tmplt->raw.length == t_size
-                && memcmp(tmplt->raw.data, t_data, t_size) == 0) {
-            // The same -> nothing to do
-            return info->is_ok;
-        }
-
-        // Add the definition (i.e. templates are different or the template hasn't been defined)
-        IPX_CTX_DEBUG(info->ctx, "Adding/updating definition of Template ID %" PRIu16, t_id);
-
-        t_type = tmplt->type;
-        t_data = tmplt->raw.data;
-        t_size = tmplt->raw.length;
-
-        if (fds_file_write_tmplt_add(info->file, t_type, t_data, t_size) != FDS_OK) {
-            const char *err_msg = fds_file_error(info->file);
-            throw FDS_exception("fds_file_write_tmplt_add() failed: " + std::string(err_msg));
-        }
-
+        tmplt_sync(info, tmplt->id, tmplt->type, tmplt->raw.data, tmplt->raw.length);
     } catch (std::exception &ex) {
         // Exceptions
         IPX_CTX_ERROR(info->ctx, "Failure during update of Template ID %" PRIu16 ": %s", tmplt->id,
@@ -253,9 +330,50 @@ Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap)
         throw FDS_exception("Failed to update Template definitions");
     }
 
+    tmplts_remove(info, data.ids);
+    info.ptr = snap;
+}
+
+/**
+ * @brief Update Template definitions for the current Transport Session and ODID
+ *
+ * Same as tmplts_update(), but Template definitions of the snapshot are given as copies.
+ * @param[in] info   Information about the last update of Templates
+ * @param[in] snap   New Template snapshot (only for identification, never dereferenced!)
+ * @param[in] tmplts All valid Template definitions of the new snapshot
+ */
+void
+Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap,
+    const std::vector<storage_tmplt> &tmplts)
+{
+    struct tmplt_update_data data;
+    data.is_ok = true;
+    data.ctx = m_ctx;
+    data.file = m_file.get();
+    data.ids.clear();
+
+    for (const auto &tmplt : tmplts) {
+        tmplt_sync(&data, tmplt.id, tmplt.type, tmplt.raw.data(), tmplt.raw.size());
+    }
+
+    tmplts_remove(info, data.ids);
+    info.ptr = snap;
+}
+
+/**
+ * @brief Remove Template definitions that are not available anymore
+ *
+ * Definitions of Templates that were available in the previous snapshot (see \p info) but
+ * not available in the new one are removed. Finally, the list of IDs in \p info is replaced
+ * with the new one.
+ * @param[in] info    Information about the last update of Templates
+ * @param[in] ids_new Template IDs in the new snapshot (content is moved to \p info)
+ */
+void
+Storage::tmplts_remove(struct snap_info &info, std::set<uint16_t> &ids_new)
+{
     // Check if there are any Template IDs that have been removed
     std::set<uint16_t> &ids_old = info.tmplt_ids;
-    std::set<uint16_t> &ids_new = data.ids;
     std::set<uint16_t> ids2remove;
     // Old Template IDs - New Templates IDs = Template IDs to remove
     std::set_difference(ids_old.begin(), ids_old.end(), ids_new.begin(), ids_new.end(),
@@ -282,22 +400,13 @@ Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap)
     }
 
     // Update information about the last update of Templates
-    info.ptr = snap;
-    std::swap(info.tmplt_ids, data.ids);
+    std::swap(info.tmplt_ids, ids_new);
 }
 
-/**
- * @brief Create a filename based for a user defined timestamp
- * @note The timestamp will be expressed in Coordinated Universal Time (UTC)
- *
- * @param[in] ts Timestamp of the file
- * @return New filename
- * @throw FDS_exception if formatting functions fail.
- */
 std::string
-Storage::filename_gen(const time_t &ts)
+Storage::window_name(const std::string &path, const time_t &ts)
 {
-    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S.fds";
+    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S";
     constexpr size_t buffer_size = 64;
     char buffer_data[buffer_size];
 
@@ -310,7 +419,7 @@ Storage::filename_gen(const time_t &ts)
         throw FDS_exception("strftime() failed");
     }
 
-    std::string new_path = m_path;
+    std::string new_path = path;
     if (new_path.back() != '/') {
         new_path += '/';
     }
@@ -318,6 +427,26 @@ Storage::filename_gen(const time_t &ts)
     return new_path + buffer_data;
 }
 
+std::string
+Storage::file_name(const std::string &path, const time_t &ts, const std::string &suffix)
+{
+    return window_name(path, ts) + suffix + ".fds";
+}
+
+/**
+ * @brief Create a filename based for a user defined timestamp
+ * @note The timestamp will be expressed in Coordinated Universal Time (UTC)
+ *
+ * @param[in] ts Timestamp of the file
+ * @return New filename
+ * @throw FDS_exception if formatting functions fail.
+ */
+std::string
+Storage::filename_gen(const time_t &ts)
+{
+    return file_name(m_path, ts, m_suffix);
+}
+
 /**
  * @brief Convert IPv4 address to IPv4-mapped IPv6 address
  *
@@ -341,14 +470,17 @@ Storage::ipv4toipv6(const uint8_t *in, uint8_t *out)
  * a new internal record for it.
  *
  * @param[in] sptr Transport Session to find
- * @return Internal description
+ * @param[in] desc FDS specific description of the session (if nullptr, converted from \p sptr)
+ * @param[in] name Name of the session (if nullptr, taken from \p sptr)
+ * @return Session ID used in the file
  * @throw FDS_exception if the function failed to add a new Transport Session
  */
-struct Storage::session_ctx &
-Storage::session_get(const struct ipx_session *sptr)
+fds_file_sid_t
+Storage::session_get(const struct ipx_session *sptr, const struct fds_file_session *desc,
+    const char *name)
 {
-    auto res_it = m_session2params.find(sptr);
-    if (res_it != m_session2params.end()) {
+    auto res_it = m_session2id.find(sptr);
+    if (res_it != m_session2id.end()) {
         // Found
         return res_it->second;
     }
@@ -359,25 +491,58 @@ Storage::session_get(const struct ipx_session *sptr)
     struct fds_file_session new_session;
     fds_file_sid_t new_sid;
 
-    session_ipx2fds(sptr, &new_session);
-    if (fds_file_session_add(m_file.get(), &new_session, &new_sid) != FDS_OK) {
+    if (desc == nullptr) {
+        session_ipx2fds(sptr, &new_session);
+        desc = &new_session;
+        name = sptr->ident;
+    }
+
+    if (fds_file_session_add(m_file.get(), desc, &new_sid) != FDS_OK) {
         const char *err_msg = fds_file_error(m_file.get());
-        throw FDS_exception("Failed to register Transport Session '" + std::string(sptr->ident)
+        throw FDS_exception("Failed to register Transport Session '" + std::string(name)
             + "': " + err_msg);
     }
 
-    // Create a new session
-    struct session_ctx &ctx = m_session2params[sptr];
-    ctx.id = new_sid;
-    return ctx;
+    m_session2id.emplace(sptr, new_sid);
+    return new_sid;
 }
 
 /**
- * @brief Convert IPFIXcol representation of a Transport Session to FDS representation
- * @param[in]  ipx_desc IPFIXcol specific representation
- * @param[out] fds_desc FDS specific representation
- * @throw FDS_exception if conversion fails due to unsupported Transport Session type
+ * @brief Get internal description of a combination of a Transport Session and an ODID
+ *
+ * Consecutive messages usually belong to the same combination, therefore, the last result
+ * is remembered and returned without any lookup. If the description doesn't exist, a new one
+ * is created (and the Transport Session is eventually added to the file).
+ *
+ * @param[in] sptr Transport Session
+ * @param[in] odid Observation Domain ID
+ * @param[in] desc FDS specific description of the session (see session_get())
+ * @param[in] name Name of the session (see session_get())
+ * @return Internal description
+ * @throw FDS_exception if the function failed to add a new Transport Session
  */
+struct Storage::odid_ctx &
+Storage::odid_get(const struct ipx_session *sptr, uint32_t odid,
+    const struct fds_file_session *desc, const char *name)
+{
+    const odid_key key = {sptr, odid};
+    if (m_odid_last != nullptr && m_odid_last_key == key) {
+        return *m_odid_last;
+    }
+
+    auto res_it = m_odid2params.find(key);
+    if (res_it == m_odid2params.end()) {
+        // Not found -> create a new one (references to elements are never invalidated)
+        fds_file_sid_t sid = session_get(sptr, desc, name);
+        res_it = m_odid2params.emplace(key, odid_ctx()).first;
+        res_it->second.id = sid;
+    }
+
+    m_odid_last = &res_it->second;
+    m_odid_last_key = key;
+    return *m_odid_last;
+}
+
 void
 Storage::session_ipx2fds(const struct ipx_session *ipx_desc, struct fds_file_session *fds_desc)
 {
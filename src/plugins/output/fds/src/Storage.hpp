@@ -12,14 +12,90 @@
 #define IPFIXCOL2_FDS_STORAGE_HPP
 
 #include <ipfixcol2.h>
-#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <libfds.h>
 
 #include "Exception.hpp"
 #include "Config.hpp"
+#include "Closer.hpp"
+
+/// Identification of a combination of a Transport Session and an ODID
+struct odid_key {
+    /// Transport Session
+    const struct ipx_session *session;
+    /// Observation Domain ID
+    uint32_t odid;
+
+    bool
+    operator==(const odid_key &other) const {
+        return session == other.session && odid == other.odid;
+    }
+};
+
+/// Hash function of the combination of a Transport Session and an ODID
+struct odid_key_hash {
+    size_t
+    operator()(const odid_key &key) const {
+        uint64_t val = reinterpret_cast<uintptr_t>(key.session) ^ (uint64_t(key.odid) << 32);
+        val ^= val >> 33;
+        val *= 0xff51afd7ed558ccdULL;
+        val ^= val >> 33;
+        return static_cast<size_t>(val);
+    }
+};
+
+/// Copy of an IPFIX (Options) Template definition
+struct storage_tmplt {
+    /// Template ID
+    uint16_t id;
+    /// Template type
+    enum fds_template_type type;
+    /// Raw Template definition
+    std::vector<uint8_t> raw;
+};
+
+/// Reference to a copy of a Data Record
+struct storage_rec {
+    /// Offset of the record in the data buffer
+    uint32_t offset;
+    /// Size of the record
+    uint16_t size;
+    /// Template ID of the record
+    uint16_t tmplt_id;
+};
+
+/**
+ * @brief Copy of Data Records of an IPFIX Message (or its part) that share the same Template snapshot
+ *
+ * Unlike an IPFIX Message, the job can be processed after the original message and its Templates
+ * have been freed (see Storage::process_job()).
+ */
+struct storage_job {
+    /// Transport Session (only for identification, never dereferenced!)
+    const struct ipx_session *session;
+    /// Description of the Transport Session
+    struct fds_file_session session_desc;
+    /// Name of the Transport Session (only for log)
+    std::string session_name;
+    /// Observation Domain ID
+    uint32_t odid;
+    /// Export time of the IPFIX Message
+    uint32_t exp_time;
+
+    /// Template snapshot of the records (only for identification, never dereferenced!)
+    const fds_tsnapshot_t *snap;
+    /// All Templates of the snapshot (filled only if the snapshot has been changed)
+    std::vector<storage_tmplt> tmplts;
+
+    /// Data Records
+    std::vector<uint8_t> data;
+    /// References to the Data Records
+    std::vector<storage_rec> recs;
+};
 
 /// Flow storage file
 class Storage {
@@ -31,11 +107,12 @@ public:
      *   Output file for the current window MUST be specified using new_window() function.
      *   Otherwise, no flow records are stored.
      *
-     * @param[in] ctx  Plugin context (only for log)
-     * @param[in] cfg  Configuration
+     * @param[in] ctx    Plugin context (only for log)
+     * @param[in] cfg    Configuration
+     * @param[in] suffix Suffix of filenames (added before the extension)
      * @throw FDS_exception if @p path directory doesn't exist in the system
      */
-    Storage(ipx_ctx_t *ctx, const Config &cfg);
+    Storage(ipx_ctx_t *ctx, const Config &cfg, const std::string &suffix = "");
     virtual ~Storage() = default;
 
     // Disable copy constructors
@@ -45,7 +122,9 @@ public:
     /**
      * @brief Create a new time window
      *
-     * @note Previous window is automatically closed, if exists.
+     * @note
+     *   Previous window is automatically closed, if exists. The file of the previous window is
+     *   finalized in the background and the new file is opened immediately.
      * @param[in] ts Timestamp of the window
      * @throw FDS_exception if the new window cannot be created
      */
@@ -55,6 +134,8 @@ public:
     /**
      * @brief Close the current time window
      * @note
+     *   The file is flushed and closed in the background (see Closer).
+     * @note
      *   This can be also useful if a fatal error has occurred and we should not add more flow
      *   records to the file.
      * @note
@@ -74,6 +155,48 @@ public:
     void
     process_msg(ipx_msg_ipfix_t *msg);
 
+    /**
+     * @brief Process a copy of Data Records
+     *
+     * Same as process_msg(), but Data Records and Template definitions are copied.
+     * @note If a time window is not opened, no Data Records are stored and no exception is thrown.
+     * @param[in] job Data Records to store
+     * @throw FDS_exception if processing fails
+     */
+    void
+    process_job(const struct storage_job &job);
+
+    /**
+     * @brief Get the name of a time window
+     * @note The timestamp will be expressed in Coordinated Universal Time (UTC)
+     * @param[in] path Storage path
+     * @param[in] ts   Timestamp of the window
+     * @return Path of window files without the extension
+     * @throw FDS_exception if formatting functions fail.
+     */
+    static std::string
+    window_name(const std::string &path, const time_t &ts);
+
+    /**
+     * @brief Get the name of a flow file of a time window
+     * @param[in] path   Storage path
+     * @param[in] ts     Timestamp of the window
+     * @param[in] suffix Suffix of the file name (e.g. identification of a shard)
+     * @return Path of the flow file
+     * @throw FDS_exception if formatting functions fail.
+     */
+    static std::string
+    file_name(const std::string &path, const time_t &ts, const std::string &suffix = "");
+
+    /**
+     * @brief Convert IPFIXcol representation of a Transport Session to FDS representation
+     * @param[in]  ipx_desc IPFIXcol specific representation
+     * @param[out] fds_desc FDS specific representation
+     * @throw FDS_exception if conversion fails due to unsupported Transport Session type
+     */
+    static void
+    session_ipx2fds(const struct ipx_session *ipx_desc, struct fds_file_session *fds_desc);
+
 private:
     /// Information about Templates in a snapshot
     struct snap_info {
@@ -88,36 +211,55 @@ private:
         }
     };
 
-    /// Description parameters of a Transport Session
-    struct session_ctx {
+    /// Description parameters of a combination of a Transport Session and an ODID
+    struct odid_ctx {
         /// Session ID used in the FDS file
         fds_file_sid_t id;
-        /// Last seen snapshot for a specific ODID of the Transport Session
-        std::map<uint32_t, struct snap_info> odid2snap;
+        /// Last seen snapshot
+        struct snap_info snap_last;
     };
 
     /// Plugin context only for logging!
     ipx_ctx_t *m_ctx;
     /// Storage path
     std::string m_path;
+    /// Suffix of filenames
+    std::string m_suffix;
     /// Flags for opening file
     uint32_t m_flags;
 
+    /// Background closer of files of previous windows
+    std::unique_ptr<Closer> m_closer;
     /// Output FDS file
     std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
-    /// Mapping of Transport Sessions to FDS specific parameters
-    std::map<const struct ipx_session *, struct session_ctx> m_session2params;
+    /// Name of the output FDS file
+    std::string m_file_name;
+    /// Mapping of Transport Sessions to Session IDs used in the FDS file
+    std::unordered_map<const struct ipx_session *, fds_file_sid_t> m_session2id;
+    /// Mapping of combinations of Transport Sessions and ODIDs to FDS specific parameters
+    std::unordered_map<odid_key, struct odid_ctx, odid_key_hash> m_odid2params;
+    /// Parameters of the last processed combination (nullptr, if undefined)
+    struct odid_ctx *m_odid_last = nullptr;
+    /// Key of the last processed combination
+    odid_key m_odid_last_key;
 
     std::string
     filename_gen(const time_t &ts);
     static void
     ipv4toipv6(const uint8_t *in, uint8_t *out);
-    struct session_ctx &
-    session_get(const struct ipx_session *sptr);
-    void
-    session_ipx2fds(const struct ipx_session *ipx_desc, struct fds_file_session *fds_desc);
+    fds_file_sid_t
+    session_get(const struct ipx_session *sptr, const struct fds_file_session *desc,
+        const char *name);
+    struct odid_ctx &
+    odid_get(const struct ipx_session *sptr, uint32_t odid,
+        const struct fds_file_session *desc = nullptr, const char *name = nullptr);
     void
     tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap);
+    void
+    tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap,
+        const std::vector<storage_tmplt> &tmplts);
+    void
+    tmplts_remove(struct snap_info &info, std::set<uint16_t> &ids_new);
 };
 
 
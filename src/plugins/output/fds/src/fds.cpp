@@ -15,6 +15,8 @@
 #include <unistd.h>
 
 #include "Config.hpp"
+#include "Index.hpp"
+#include "Shards.hpp"
 #include "Storage.hpp"
 
 /// Plugin description
@@ -37,8 +39,12 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
 struct Instance {
     /// Parsed configuration
     std::unique_ptr<Config> config_ptr = nullptr;
-    /// Storage file
+    /// Storage file (only if the window is not sharded)
     std::unique_ptr<Storage> storage_ptr = nullptr;
+    /// Storage sharded across multiple files (only if the window is sharded)
+    std::unique_ptr<Shards> shards_ptr = nullptr;
+    /// Index of the storage file (only if enabled and the window is not sharded)
+    std::unique_ptr<Index> index_ptr = nullptr;
     /// Start of the current window
     time_t window_start = 0;
 };
@@ -62,7 +68,16 @@ window_check(struct Instance &inst)
     }
 
     inst.window_start = now;
-    inst.storage_ptr->window_new(now);
+    if (inst.shards_ptr) {
+        inst.shards_ptr->window_new(now);
+    } else {
+        // The index must be prepared before the flow file is created
+        if (inst.index_ptr) {
+            inst.index_ptr->window_new(Storage::window_name(cfg.m_path, now) + ".idx",
+                Storage::file_name(cfg.m_path, now), now);
+        }
+        inst.storage_ptr->window_new(now);
+    }
 }
 
 int
@@ -72,7 +87,14 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         // Parse configuration, try to create a storage and time window
         std::unique_ptr<Instance> instance(new Instance);
         instance->config_ptr.reset(new Config(params));
-        instance->storage_ptr.reset(new Storage(ctx, *instance->config_ptr));
+        if (instance->config_ptr->m_shards > 1) {
+            instance->shards_ptr.reset(new Shards(ctx, *instance->config_ptr));
+        } else {
+            instance->storage_ptr.reset(new Storage(ctx, *instance->config_ptr));
+            if (!instance->config_ptr->m_index.fields.empty()) {
+                instance->index_ptr.reset(new Index(ctx, *instance->config_ptr));
+            }
+        }
         window_check(*instance);
         // Everything seems OK
         ipx_ctx_private_set(ctx, instance.release());
@@ -94,6 +116,8 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 
     try {
         auto inst = reinterpret_cast<Instance *>(cfg);
+        inst->shards_ptr.reset();
+        inst->index_ptr.reset();
         inst->storage_ptr.reset();
         inst->config_ptr.reset();
         delete inst;
@@ -112,7 +136,15 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         // Check if the current time window should be closed
         window_check(*inst);
         ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
-        inst->storage_ptr->process_msg(msg_ipfix);
+        if (inst->shards_ptr) {
+            inst->shards_ptr->process_msg(msg_ipfix);
+        } else {
+            if (inst->index_ptr) {
+                // Index first, so it covers all records even if storing fails
+                inst->index_ptr->process_msg(msg_ipfix);
+            }
+            inst->storage_ptr->process_msg(msg_ipfix);
+        }
     } catch (const FDS_exception &ex) {
         IPX_CTX_ERROR(ctx, "%s", ex.what());
         failed = true;
@@ -128,7 +160,14 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         IPX_CTX_ERROR(ctx, "Due to the previous error(s), the output file is possibly corrupted. "
             "Therefore, no flow records are stored until a new file is automatically opened "
             "after current window expiration.");
-        inst->storage_ptr->window_close();
+        if (inst->shards_ptr) {
+            inst->shards_ptr->window_close();
+        } else {
+            inst->storage_ptr->window_close();
+            if (inst->index_ptr) {
+                inst->index_ptr->window_close();
+            }
+        }
     }
 
     return IPX_OK;
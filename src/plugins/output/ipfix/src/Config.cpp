@@ -43,6 +43,7 @@
 
 #include <stdexcept>
 #include <memory>
+#include <cstdint>
 
 /// XML nodes
 enum params_xml_nodes {
@@ -51,7 +52,9 @@ enum params_xml_nodes {
     PARAM_WINDOW_SIZE,
     PARAM_ALIGN_WINDOWS,
     PARAM_PRESERVE_ORIGINAL,
-    PARAM_SPLIT_ON_EXPORT_TIME
+    PARAM_SPLIT_ON_EXPORT_TIME,
+    PARAM_DIRECT_IO,
+    PARAM_PREALLOC_SIZE
 };
 
 /// Description of XML document
@@ -63,6 +66,8 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(PARAM_ALIGN_WINDOWS, "alignWindows", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(PARAM_PRESERVE_ORIGINAL,    "preserveOriginal",   FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(PARAM_SPLIT_ON_EXPORT_TIME, "rotateOnExportTime", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_DIRECT_IO,            "directIO",           FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_PREALLOC_SIZE,        "preallocSize",       FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -73,6 +78,8 @@ void Config::set_defaults() {
     align_windows = true;
     preserve_original = false;
     split_on_export_time = false;
+    direct_io = false;
+    prealloc_size = 0;
 }
 
 void Config::parse_params(fds_xml_ctx_t *params)
@@ -104,6 +111,17 @@ void Config::parse_params(fds_xml_ctx_t *params)
             assert(content->type == FDS_OPTS_T_BOOL);
             split_on_export_time = content->val_bool;
             break;
+        case PARAM_DIRECT_IO:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            direct_io = content->val_bool;
+            break;
+        case PARAM_PREALLOC_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Preallocation size is too big!");
+            }
+            prealloc_size = content->val_uint * 1024 * 1024; // MiB to bytes
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <params>!");
         }
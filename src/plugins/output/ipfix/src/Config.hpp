@@ -78,6 +78,10 @@ public:
     bool preserve_original;
     /// Split on IPFIX Export Time instead on system time
     bool split_on_export_time;
+    /// Bypass the page cache when writing files (O_DIRECT)
+    bool direct_io;
+    /// Size of file space preallocation chunks (in bytes, 0 = disabled)
+    uint64_t prealloc_size;
 
     /**
      * @brief Parse configuration of the IPFIX plugin
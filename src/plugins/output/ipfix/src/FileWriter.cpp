@@ -0,0 +1,342 @@
+/**
+ * \file src/plugins/output/ipfix/src/FileWriter.cpp
+ * \brief Buffered writer of output files (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "FileWriter.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cinttypes>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+FileWriter::FileWriter(const std::string &filename, bool direct_io, uint64_t prealloc,
+    const ipx_ctx *ctx) : plugin_context(ctx), filename(filename), prealloc(prealloc)
+{
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&cond_full, nullptr);
+    pthread_cond_init(&cond_free, nullptr);
+
+    // Open the file
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (direct_io) {
+        fd = open(filename.c_str(), flags | O_DIRECT, 0666);
+        if (fd >= 0) {
+            this->direct_io = true;
+        } else if (errno == EINVAL) {
+            IPX_CTX_WARNING(plugin_context, "Direct I/O is not supported by the file system of "
+                "'%s'. Falling back to buffered I/O.", filename.c_str());
+        }
+    }
+
+    if (fd < 0) {
+        fd = open(filename.c_str(), flags, 0666);
+    }
+
+    if (fd < 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        std::string err_msg = "Failed to create file '" + filename + "': " + std::string(err_str);
+        release();
+        throw std::runtime_error(err_msg);
+    }
+
+    // Preallocate the first chunk of the file
+    if (this->prealloc != 0) {
+        prealloc_extend(1);
+    }
+
+    // Prepare the ring of aligned buffers
+    for (size_t i = 0; i < BUFFER_CNT; ++i) {
+        void *ptr;
+        if (posix_memalign(&ptr, BUFFER_ALIGN, BUFFER_SIZE) != 0) {
+            release();
+            throw std::runtime_error("Memory allocation failed");
+        }
+        ring.push_back(reinterpret_cast<uint8_t *>(ptr));
+    }
+
+    // Start the writer thread
+    if (pthread_create(&thread, nullptr, &FileWriter::thread_writer, this) != 0) {
+        release();
+        throw std::runtime_error("Failed to start a writer thread of file '" + filename + "'");
+    }
+
+    thread_running = true;
+}
+
+FileWriter::~FileWriter()
+{
+    close();
+}
+
+/**
+ * \brief Release all resources (buffers, synchronization primitives and file descriptor)
+ * \warning The writer thread must not be running!
+ */
+void
+FileWriter::release()
+{
+    for (uint8_t *buffer : ring) {
+        free(buffer);
+    }
+    ring.clear();
+
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+
+    pthread_cond_destroy(&cond_free);
+    pthread_cond_destroy(&cond_full);
+    pthread_mutex_destroy(&mutex);
+}
+
+/**
+ * \brief Make sure that the file has preallocated space at least of a given size
+ *
+ * The space is allocated in multiples of the preallocation chunk. If the file system doesn't
+ * support preallocation, it is disabled.
+ * \param[in] size Required size of the file
+ */
+void
+FileWriter::prealloc_extend(uint64_t size)
+{
+    if (prealloc == 0 || size <= prealloc_size) {
+        return;
+    }
+
+    const uint64_t new_size = ((size + prealloc - 1) / prealloc) * prealloc;
+    if (fallocate(fd, 0, off_t(prealloc_size), off_t(new_size - prealloc_size)) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(plugin_context, "Failed to preallocate space of file '%s' (%s). "
+            "Preallocation of the file is disabled.", filename.c_str(), err_str);
+        prealloc = 0;
+        return;
+    }
+
+    prealloc_size = new_size;
+}
+
+/**
+ * \brief Write data at a given offset of the file
+ * \param[in] data   Data to write
+ * \param[in] size   Size of the data
+ * \param[in] offset Offset in the file
+ * \return True on success. Otherwise (an error is reported) false.
+ */
+bool
+FileWriter::write_at(const uint8_t *data, size_t size, uint64_t offset)
+{
+    prealloc_extend(offset + size);
+
+    while (size > 0) {
+        ssize_t ret = pwrite(fd, data, size, off_t(offset));
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(plugin_context, "Failed to write to file '%s' (%s). All following data "
+                "of the file will be lost!", filename.c_str(), err_str);
+            return false;
+        }
+
+        data += ret;
+        size -= size_t(ret);
+        offset += uint64_t(ret);
+    }
+
+    return true;
+}
+
+/**
+ * \brief Pass the currently filled buffer to the writer thread
+ *
+ * If all buffers are waiting for writing, the function waits until the oldest one is written.
+ */
+void
+FileWriter::buffer_submit()
+{
+    pthread_mutex_lock(&mutex);
+    pending++;
+    submitted++;
+    pthread_cond_signal(&cond_full);
+
+    // Buffers are written in order, so the next buffer is the oldest one
+    fill_idx = (fill_idx + 1) % BUFFER_CNT;
+    fill_used = 0;
+    while (pending == BUFFER_CNT) {
+        pthread_cond_wait(&cond_free, &mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void
+FileWriter::write(const struct iovec *iov, int iovcnt)
+{
+    for (int i = 0; i < iovcnt; ++i) {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(iov[i].iov_base);
+        size_t size = iov[i].iov_len;
+
+        while (size > 0) {
+            const size_t to_copy = std::min(size, BUFFER_SIZE - fill_used);
+            std::memcpy(ring[fill_idx] + fill_used, data, to_copy);
+            fill_used += to_copy;
+            data += to_copy;
+            size -= to_copy;
+
+            if (fill_used == BUFFER_SIZE) {
+                buffer_submit();
+            }
+        }
+    }
+}
+
+void
+FileWriter::write(const void *data, size_t size)
+{
+    struct iovec iov;
+    iov.iov_base = const_cast<void *>(data);
+    iov.iov_len = size;
+    write(&iov, 1);
+}
+
+bool
+FileWriter::close()
+{
+    if (fd < 0) {
+        return !failed;
+    }
+
+    // Wait until all full buffers are written
+    if (thread_running) {
+        pthread_mutex_lock(&mutex);
+        stop = true;
+        pthread_cond_signal(&cond_full);
+        pthread_mutex_unlock(&mutex);
+
+        pthread_join(thread, nullptr);
+        thread_running = false;
+    }
+
+    // Write the rest of data (O_DIRECT doesn't allow writing of unaligned blocks)
+    const uint64_t offset = submitted * BUFFER_SIZE;
+    if (!failed && fill_used > 0) {
+        if (direct_io) {
+            int flags = fcntl(fd, F_GETFL);
+            fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+        }
+
+        failed = !write_at(ring[fill_idx], fill_used, offset);
+    }
+
+    // Release unused preallocated space
+    const uint64_t file_size = offset + fill_used;
+    if (prealloc_size > file_size && ftruncate(fd, off_t(file_size)) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(plugin_context, "Failed to truncate file '%s' (%s)",
+            filename.c_str(), err_str);
+    }
+
+    if (::close(fd) != 0) {
+        failed = true;
+    }
+
+    fd = -1;
+    release();
+    return !failed;
+}
+
+/**
+ * \brief Writer thread
+ *
+ * Writes submitted buffers to the file in order. After a write failure, all following
+ * buffers are just released.
+ * \param[in] arg Instance of the writer
+ * \return Nothing
+ */
+void *
+FileWriter::thread_writer(void *arg)
+{
+    FileWriter *self = reinterpret_cast<FileWriter *>(arg);
+    size_t idx = 0;
+    uint64_t offset = 0;
+
+    pthread_mutex_lock(&self->mutex);
+    while (true) {
+        while (self->pending == 0 && !self->stop) {
+            pthread_cond_wait(&self->cond_full, &self->mutex);
+        }
+
+        if (self->pending == 0) {
+            // Stop request and nothing to write
+            break;
+        }
+
+        const bool skip = self->failed;
+        pthread_mutex_unlock(&self->mutex);
+
+        bool status = true;
+        if (!skip) {
+            status = self->write_at(self->ring[idx], BUFFER_SIZE, offset);
+        }
+
+        pthread_mutex_lock(&self->mutex);
+        if (!status) {
+            self->failed = true;
+        }
+
+        idx = (idx + 1) % BUFFER_CNT;
+        offset += BUFFER_SIZE;
+        self->pending--;
+        pthread_cond_signal(&self->cond_free);
+    }
+    pthread_mutex_unlock(&self->mutex);
+    return nullptr;
+}
@@ -0,0 +1,158 @@
+/**
+ * \file src/plugins/output/ipfix/src/FileWriter.hpp
+ * \brief Buffered writer of output files (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#ifndef FILEWRITER_HPP
+#define FILEWRITER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <pthread.h>
+#include <sys/uio.h>
+
+#include <ipfixcol2.h>
+
+/**
+ * \brief Writer of an output file
+ *
+ * Data are copied into a ring of large aligned buffers. Full buffers are written to the file
+ * by a dedicated thread, therefore, the calling thread doesn't wait for I/O operations unless
+ * all buffers are full. Optionally, the file can be opened with O_DIRECT (i.e. bypassing
+ * the page cache) and its space can be preallocated in large chunks to reduce fragmentation.
+ */
+class FileWriter {
+public:
+    /**
+     * \brief Create a new file (an existing file is truncated)
+     * \param[in] filename   Path of the file
+     * \param[in] direct_io  Try to bypass the page cache (O_DIRECT)
+     * \param[in] prealloc   Size of preallocation chunks in bytes (0 = disabled)
+     * \param[in] ctx        Plugin context (for log only!)
+     * \throw runtime_error if the file cannot be created
+     */
+    FileWriter(const std::string &filename, bool direct_io, uint64_t prealloc, const ipx_ctx *ctx);
+    /// Flush buffered data and close the file (see close())
+    ~FileWriter();
+
+    /**
+     * \brief Write data to the file
+     * \note
+     *   In case of a write failure, the error is reported and all following data are dropped.
+     * \param[in] iov    Array of data blocks
+     * \param[in] iovcnt Number of data blocks
+     */
+    void
+    write(const struct iovec *iov, int iovcnt);
+    /**
+     * \brief Write data to the file
+     * \param[in] data Data to write
+     * \param[in] size Size of the data
+     */
+    void
+    write(const void *data, size_t size);
+
+    /**
+     * \brief Flush buffered data, release unused preallocated space and close the file
+     * \return True on success. False, if any write has failed.
+     */
+    bool
+    close();
+
+private:
+    /// Size of each buffer (multiple of the alignment)
+    static constexpr size_t BUFFER_SIZE = 1024 * 1024;
+    /// Number of buffers in the ring
+    static constexpr size_t BUFFER_CNT = 4;
+    /// Alignment of buffers, file offsets and write sizes required by O_DIRECT
+    static constexpr size_t BUFFER_ALIGN = 4096;
+
+    /// Plugin context (only for log!)
+    const ipx_ctx *plugin_context;
+    /// File name (only for log!)
+    std::string filename;
+    /// File descriptor (-1 if closed)
+    int fd = -1;
+    /// The file has been opened with O_DIRECT
+    bool direct_io = false;
+    /// Size of preallocation chunks (0 = disabled)
+    uint64_t prealloc;
+    /// Size of already preallocated space (accessed only by the writer thread)
+    uint64_t prealloc_size = 0;
+
+    /// Ring of buffers
+    std::vector<uint8_t *> ring;
+    /// Index of the buffer filled by the calling thread
+    size_t fill_idx = 0;
+    /// Used size of the buffer filled by the calling thread
+    size_t fill_used = 0;
+    /// Number of full buffers submitted to the writer thread
+    uint64_t submitted = 0;
+
+    /// Mutex protecting variables below
+    pthread_mutex_t mutex;
+    /// Condition variable signalling a submitted buffer (for the writer thread)
+    pthread_cond_t cond_full;
+    /// Condition variable signalling a written buffer (for the calling thread)
+    pthread_cond_t cond_free;
+    /// Number of full buffers waiting for writing (or being written)
+    size_t pending = 0;
+    /// Stop the writer thread after all pending buffers are written
+    bool stop = false;
+    /// A write failed (all following data are dropped)
+    bool failed = false;
+    /// Writer thread
+    pthread_t thread;
+    /// The writer thread is running
+    bool thread_running = false;
+
+    void
+    buffer_submit();
+    bool
+    write_at(const uint8_t *data, size_t size, uint64_t offset);
+    void
+    prealloc_extend(uint64_t size);
+    void
+    release();
+
+    static void *
+    thread_writer(void *arg);
+};
+
+#endif // FILEWRITER_HPP
@@ -132,13 +132,8 @@ IPFIXOutput::new_file(const std::time_t current_time)
     }
 
     // Open the file for writing
-    output_file = std::fopen(filename, "w");
-    if (!output_file) {
-        const char *err_str;
-        ipx_strerror(errno, err_str);
-        throw std::runtime_error("Failed to create file '" + std::string(filename)
-            + "': " + std::string(err_str));
-    }
+    output_file.reset(new FileWriter(filename, config->direct_io, config->prealloc_size,
+        plugin_context));
 
     // Consider all Templates as undefined
     for (auto &odid_pair : odid_contexts) {
@@ -158,18 +153,17 @@ IPFIXOutput::close_file()
         return;
     }
 
-    int return_code = std::fclose(output_file);
-    if (return_code != 0) {
+    if (!output_file->close()) {
         IPX_CTX_WARNING(plugin_context, "Error closing output file", '\0');
     }
 
-    output_file = nullptr;
+    output_file.reset();
     IPX_CTX_INFO(plugin_context, "Closed output file", '\0');
 }
 
 /// Auxiliary data structure for callback function
 struct write_templates_aux {
-    std::FILE *file;                   ///< Output file
+    FileWriter *file;                  ///< Output file
 
     uint32_t msg_odid;                 ///< IPFIX Message - ODID
     uint32_t msg_etime;                ///< IPFIX Message - Export Time
@@ -201,7 +195,7 @@ write_template_dump(struct write_templates_aux &ctx)
     ctx.set_ptr->length = htons(ctx.set_size);
 
     // Write the message to the file
-    std::fwrite(ctx.buffer, ctx.mem_used, 1, ctx.file);
+    ctx.file->write(ctx.buffer, ctx.mem_used);
 }
 
 /**
@@ -289,7 +283,7 @@ IPFIXOutput::write_templates(const fds_tsnapshot_t *snap, uint32_t odid, uint32_
     uint32_t seq_num)
 {
     struct write_templates_aux cb_data;
-    cb_data.file = output_file;
+    cb_data.file = output_file.get();
     cb_data.msg_odid = odid;
     cb_data.msg_etime = exp_time;
     cb_data.msg_seqnum = seq_num;
@@ -348,6 +342,25 @@ IPFIXOutput::get_odid(uint32_t odid, const ipx_session *session)
     return nullptr;
 }
 
+/**
+ * \brief Add a part of the original IPFIX Message to the list of parts to write
+ *
+ * If the part immediately follows the previous part, the previous part is just extended.
+ * \param[in] ptr  Pointer to the part
+ * \param[in] size Size of the part
+ */
+void
+IPFIXOutput::msg_part_add(const void *ptr, uint16_t size)
+{
+    struct iovec &last = msg_parts.back();
+    if (reinterpret_cast<const uint8_t *>(last.iov_base) + last.iov_len == ptr) {
+        last.iov_len += size;
+        return;
+    }
+
+    msg_parts.push_back({const_cast<void *>(ptr), size});
+}
+
 /**
  * \brief Processes an incoming IPFIX message from the collector
  * \param[in] message  The IPFIX message
@@ -399,17 +412,22 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
     // If we don't have to look for unknown Data Sets, just copy the whole message -> FAST PATH
     if (config->preserve_original) {
-        std::fwrite(msg_hdr, msg_size, 1, output_file);
+        output_file->write(msg_hdr, msg_size);
         return;
     }
 
     // SLOW PATH - check if the IPFIX Message is fully known and modify it, if necessary
+    // Instead of copying the Message, describe its new content as a list of parts that refer
+    // to the new IPFIX Message header and to ranges of Sets in the original Message.
 
-    // Copy the IPFIX Message header to the buffer
-    auto *new_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buffer.get());
-    std::memcpy(buffer.get(), msg_hdr, FDS_IPFIX_MSG_HDR_LEN);
+    // Prepare a new IPFIX Message header
+    struct fds_ipfix_msg_hdr new_hdr;
+    std::memcpy(&new_hdr, msg_hdr, FDS_IPFIX_MSG_HDR_LEN);
     uint16_t new_pos = FDS_IPFIX_MSG_HDR_LEN;
 
+    msg_parts.clear();
+    msg_parts.push_back({&new_hdr, FDS_IPFIX_MSG_HDR_LEN});
+
     // Iterate over all IPFIX Sets in the IPFIX Message
     struct ipx_ipfix_set *sets_data;
     size_t sets_count;
@@ -422,7 +440,7 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
         if (set_id < FDS_IPFIX_SET_MIN_DSET) {
             // Not a Data Sets -> just copy
-            std::memcpy(buffer.get() + new_pos, set, set_len);
+            msg_part_add(set, set_len);
             new_pos += set_len;
             continue;
         }
@@ -452,7 +470,7 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
         if (found) {
             // Copy the Data Set
-            std::memcpy(buffer.get() + new_pos, set, set_len);
+            msg_part_add(set, set_len);
             new_pos += set_len;
         } else {
             // Skip the Data Set
@@ -462,11 +480,11 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
     // Update IPFIX Message header
     assert(new_pos <= msg_size && "Modified IPFIX Message must be the same or smaller!");
-    new_hdr->length = htons(uint16_t(new_pos));
-    new_hdr->seq_num = htonl(odid_context->sequence_number);
+    new_hdr.length = htons(uint16_t(new_pos));
+    new_hdr.seq_num = htonl(odid_context->sequence_number);
     odid_context->sequence_number += drec_cnt;
 
-    std::fwrite(buffer.get(), new_pos, 1, output_file);
+    output_file->write(msg_parts.data(), int(msg_parts.size()));
 }
 
 /**
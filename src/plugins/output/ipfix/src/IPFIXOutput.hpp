@@ -42,13 +42,14 @@
 #define IPFIXOUTPUT_HPP
 
 #include "Config.hpp"
+#include "FileWriter.hpp"
 
 #include <set>
 #include <map>
 #include <memory>
 #include <vector>
-#include <cstdio>
 #include <ctime>
+#include <sys/uio.h>
 
 #include <ipfixcol2.h>
 #include <libfds.h>
@@ -73,12 +74,14 @@ private:
         uint32_t sequence_number = 0;
     };
 
-    /// Memory for editing IPFIX Messages
+    /// Memory for creating IPFIX Messages with (Options) Templates
     std::unique_ptr<uint8_t[]> buffer = nullptr;
+    /// Parts of the IPFIX Message to write (only if skipping unknown Data Sets is enabled)
+    std::vector<struct iovec> msg_parts;
     /// Map of known Observation Domain IDs (ODIDs)
     std::map<uint32_t, odid_context_s> odid_contexts;
     /// Current output file
-    std::FILE *output_file = nullptr;
+    std::unique_ptr<FileWriter> output_file = nullptr;
     /// Start time of the current file
     std::time_t file_start_time = 0;
 
@@ -93,6 +96,8 @@ private:
     void
     close_file();
     void
+    msg_part_add(const void *ptr, uint16_t size);
+    void
     write_templates(const fds_tsnapshot_t *snap, uint32_t odid, uint32_t exp_time, uint32_t seq_num);
 
 public:
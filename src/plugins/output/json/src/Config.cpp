@@ -68,6 +68,7 @@ enum params_xml_nodes {
     OUTPUT_SEND,       /**< Send over network               */
     OUTPUT_SERVER,     /**< Provide as server               */
     OUTPUT_FILE,       /**< Store to file                   */
+    OUTPUT_KAFKA,      /**< Send to Kafka                   */
     // Standard output
     PRINT_NAME,        /**< Printer name                    */
     // Send output
@@ -80,13 +81,29 @@ enum params_xml_nodes {
     SERVER_NAME,       /**< Server name                     */
     SERVER_PORT,       /**< Server port                     */
     SERVER_BLOCK,      /**< Blocking connection             */
+    SERVER_QUEUE,      /**< Size of client queues           */
+    SERVER_OVERFLOW,   /**< Overflow policy                 */
     // FIle output
     FILE_NAME,         /**< File storage name               */
     FILE_PATH,         /**< Path specification format       */
     FILE_PREFIX,       /**< File prefix                     */
     FILE_WINDOW,       /**< Window interval                 */
     FILE_ALIGN,        /**< Window alignment                */
-    FILE_COMPRESS      /**< Compression                     */
+    FILE_COMPRESS,     /**< Compression                     */
+    // Kafka output
+    KAFKA_NAME,        /**< Kafka output name               */
+    KAFKA_BROKERS,     /**< List of brokers                 */
+    KAFKA_TOPIC,       /**< Topic                           */
+    KAFKA_PARTITION,   /**< Fixed partition                 */
+    KAFKA_KEY,         /**< Partitioning key                */
+    KAFKA_BLOCK,       /**< Blocking on full queue          */
+    KAFKA_COMPRESS,    /**< Compression codec               */
+    KAFKA_ACKS,        /**< Required acknowledgements       */
+    KAFKA_LINGER,      /**< Batch delay                     */
+    KAFKA_BATCH,       /**< Batch size                      */
+    KAFKA_PROPERTY,    /**< Additional property             */
+    KAFKA_PROP_KEY,    /**< Property name                   */
+    KAFKA_PROP_VALUE   /**< Property value                  */
 };
 
 /** Definition of the \<print\> node  */
@@ -99,7 +116,9 @@ static const struct fds_xml_args args_print[] = {
 static const struct fds_xml_args args_server[] = {
     FDS_OPTS_ELEM(SERVER_NAME,  "name",     FDS_OPTS_T_STRING, 0),
     FDS_OPTS_ELEM(SERVER_PORT,  "port",     FDS_OPTS_T_UINT,   0),
-    FDS_OPTS_ELEM(SERVER_BLOCK, "blocking", FDS_OPTS_T_BOOL,   0),
+    FDS_OPTS_ELEM(SERVER_BLOCK, "blocking", FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(SERVER_QUEUE, "queueSize", FDS_OPTS_T_UINT,  FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(SERVER_OVERFLOW, "overflow", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -124,12 +143,36 @@ static const struct fds_xml_args args_file[] = {
     FDS_OPTS_END
 };
 
+/** Definition of the \<property\> node of the \<kafka\> output */
+static const struct fds_xml_args args_kafka_prop[] = {
+    FDS_OPTS_ELEM(KAFKA_PROP_KEY,   "key",   FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(KAFKA_PROP_VALUE, "value", FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<kafka\> node  */
+static const struct fds_xml_args args_kafka[] = {
+    FDS_OPTS_ELEM(KAFKA_NAME,      "name",         FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(KAFKA_BROKERS,   "brokers",      FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_TOPIC,     "topic",        FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(KAFKA_PARTITION, "partition",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_KEY,       "partitionKey", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_BLOCK,     "blocking",     FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_COMPRESS,  "compression",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_ACKS,      "acks",         FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_LINGER,    "lingerMs",     FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_BATCH,     "batchSize",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(KAFKA_PROPERTY, "property",    args_kafka_prop,   FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
 /** Definition of the \<outputs\> node  */
 static const struct fds_xml_args args_outputs[] = {
     FDS_OPTS_NESTED(OUTPUT_PRINT,  "print",  args_print,  FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_NESTED(OUTPUT_SERVER, "server", args_server, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_NESTED(OUTPUT_SEND,   "send",   args_send,   FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_NESTED(OUTPUT_FILE,   "file",   args_file,   FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(OUTPUT_KAFKA,  "kafka",  args_kafka,  FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_END
 };
 
@@ -236,7 +279,9 @@ Config::parse_server(fds_xml_ctx_t *server)
 {
     struct cfg_server output;
     output.port = 0;
-    output.blocking = false;
+    output.queue_size = 1024;
+    output.overflow = cfg_server::SERVER_OVERFLOW_DROP;
+    bool overflow_set = false;
 
     const struct fds_xml_cont *content;
     while (fds_xml_next(server, &content) != FDS_EOC) {
@@ -255,7 +300,34 @@ Config::parse_server(fds_xml_ctx_t *server)
             break;
         case SERVER_BLOCK:
             assert(content->type == FDS_OPTS_T_BOOL);
-            output.blocking = content->val_bool;
+            if (!overflow_set) {
+                // Backwards compatibility (explicit overflow policy has higher priority)
+                output.overflow = content->val_bool
+                    ? cfg_server::SERVER_OVERFLOW_BLOCK : cfg_server::SERVER_OVERFLOW_DROP;
+            }
+            break;
+        case SERVER_QUEUE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Invalid queue size of a <server> output!");
+            }
+
+            output.queue_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case SERVER_OVERFLOW:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "dropOldest") == 0) {
+                output.overflow = cfg_server::SERVER_OVERFLOW_DROP;
+            } else if (strcasecmp(content->ptr_string, "disconnect") == 0) {
+                output.overflow = cfg_server::SERVER_OVERFLOW_DISCONNECT;
+            } else if (strcasecmp(content->ptr_string, "block") == 0) {
+                output.overflow = cfg_server::SERVER_OVERFLOW_BLOCK;
+            } else {
+                throw std::invalid_argument("Unexpected parameter of the element <overflow> ("
+                    + std::string(content->ptr_string) + ")!");
+            }
+
+            overflow_set = true;
             break;
         default:
             throw std::invalid_argument("Unexpected element within <server>!");
@@ -402,6 +474,145 @@ Config::parse_file(fds_xml_ctx_t *file)
     outputs.files.push_back(output);
 }
 
+/**
+ * \brief Parse an additional property of a "kafka" output
+ *
+ * \param[in]  prop   Parsed XML context
+ * \param[out] output Output configuration where the property will be added
+ * \throw invalid_argument or runtime_error
+ */
+void
+Config::parse_kafka_prop(fds_xml_ctx_t *prop, struct cfg_kafka &output)
+{
+    std::string key;
+    std::string value;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(prop, &content) != FDS_EOC) {
+        switch (content->id) {
+        case KAFKA_PROP_KEY:
+            assert(content->type == FDS_OPTS_T_STRING);
+            key = content->ptr_string;
+            break;
+        case KAFKA_PROP_VALUE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            value = content->ptr_string;
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within <property>!");
+        }
+    }
+
+    if (key.empty()) {
+        throw std::runtime_error("Key of a <property> of the output <kafka> '" + output.name
+            + "' must be defined!");
+    }
+
+    output.properties.emplace_back(key, value);
+}
+
+/**
+ * \brief Parse "kafka" output parameters
+ *
+ * Successfully parsed output is added to the vector of outputs
+ * \param[in] kafka Parsed XML context
+ * \throw invalid_argument or runtime_error
+ */
+void
+Config::parse_kafka(fds_xml_ctx_t *kafka)
+{
+    struct cfg_kafka output;
+    output.brokers = "127.0.0.1:9092";
+    output.partition = -1; // Unassigned (i.e. RD_KAFKA_PARTITION_UA)
+    output.key = cfg_kafka::KAFKA_KEY_EXPORTER;
+    output.blocking = false;
+    output.compression = "none";
+    output.acks = "1";
+    output.linger_ms = 50;
+    output.batch_size = 10000;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(kafka, &content) != FDS_EOC) {
+        switch (content->id) {
+        case KAFKA_NAME:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.name = content->ptr_string;
+            break;
+        case KAFKA_BROKERS:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.brokers = content->ptr_string;
+            break;
+        case KAFKA_TOPIC:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.topic = content->ptr_string;
+            break;
+        case KAFKA_PARTITION:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > INT32_MAX) {
+                throw std::invalid_argument("Invalid partition of a <kafka> output!");
+            }
+            output.partition = static_cast<int32_t>(content->val_uint);
+            break;
+        case KAFKA_KEY:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "none") == 0) {
+                output.key = cfg_kafka::KAFKA_KEY_NONE;
+            } else if (strcasecmp(content->ptr_string, "odid") == 0) {
+                output.key = cfg_kafka::KAFKA_KEY_ODID;
+            } else if (strcasecmp(content->ptr_string, "exporter") == 0) {
+                output.key = cfg_kafka::KAFKA_KEY_EXPORTER;
+            } else {
+                throw std::invalid_argument("Unexpected parameter of the element <partitionKey> ("
+                    + std::string(content->ptr_string) + ")!");
+            }
+            break;
+        case KAFKA_BLOCK:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            output.blocking = content->val_bool;
+            break;
+        case KAFKA_COMPRESS:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.compression = content->ptr_string;
+            break;
+        case KAFKA_ACKS:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.acks = content->ptr_string;
+            break;
+        case KAFKA_LINGER:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Invalid linger time of a <kafka> output!");
+            }
+            output.linger_ms = static_cast<uint32_t>(content->val_uint);
+            break;
+        case KAFKA_BATCH:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Invalid batch size of a <kafka> output!");
+            }
+            output.batch_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case KAFKA_PROPERTY:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_kafka_prop(content->ptr_ctx, output);
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within <kafka>!");
+        }
+    }
+
+    if (output.name.empty()) {
+        throw std::runtime_error("Name of a <kafka> output must be defined!");
+    }
+
+    if (output.topic.empty()) {
+        throw std::runtime_error("Element <topic> of the output '" + output.name
+            + "' must be defined!");
+    }
+
+    outputs.kafkas.push_back(output);
+}
+
 /**
  * \brief Parse list of outputs
  * \param[in] outputs Parsed XML context
@@ -426,6 +637,9 @@ Config::parse_outputs(fds_xml_ctx_t *outputs)
         case OUTPUT_SERVER:
             parse_server(content->ptr_ctx);
             break;
+        case OUTPUT_KAFKA:
+            parse_kafka(content->ptr_ctx);
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <outputs>!");
         }
@@ -522,6 +736,7 @@ Config::default_set()
     outputs.files.clear();
     outputs.servers.clear();
     outputs.sends.clear();
+    outputs.kafkas.clear();
 }
 
 /**
@@ -536,6 +751,7 @@ Config::check_validity()
     output_cnt += outputs.servers.size();
     output_cnt += outputs.sends.size();
     output_cnt += outputs.files.size();
+    output_cnt += outputs.kafkas.size();
     if (output_cnt == 0) {
         throw std::invalid_argument("At least one output must be defined!");
     }
@@ -564,6 +780,9 @@ Config::check_validity()
     for (const auto &file : outputs.files) {
         check_and_add(file.name);
     }
+    for (const auto &kafka : outputs.kafkas) {
+        check_and_add(kafka.name);
+    }
 }
 
 Config::Config(const char *params)
@@ -102,8 +102,42 @@ struct cfg_send : cfg_output {
 struct cfg_server : cfg_output {
     /** Destination port                                                                         */
     uint16_t port;
-    /** Blocking communication                                                                   */
+    /** Maximum number of batches (i.e. converted IPFIX Messages) queued per client              */
+    uint32_t queue_size;
+    /** Overflow policy of client queues                                                         */
+    enum {
+        SERVER_OVERFLOW_DROP,       /**< Drop the oldest batch                                   */
+        SERVER_OVERFLOW_DISCONNECT, /**< Disconnect the client                                   */
+        SERVER_OVERFLOW_BLOCK       /**< Wait until the client receives queued batches           */
+    } overflow; /**< Behaviour when a client is not able to receive records fast enough          */
+};
+
+/** Configuration of Kafka producer                                                              */
+struct cfg_kafka : cfg_output {
+    /** List of brokers (comma separated "host:port" pairs)                                      */
+    std::string brokers;
+    /** Name of the topic                                                                        */
+    std::string topic;
+    /** Fixed partition (or -1 i.e. RD_KAFKA_PARTITION_UA for partitioning by the key)           */
+    int32_t partition;
+    /** Key of messages used for partitioning                                                    */
+    enum {
+        KAFKA_KEY_NONE,      /**< No key (records are distributed randomly)                      */
+        KAFKA_KEY_ODID,      /**< Observation Domain ID                                          */
+        KAFKA_KEY_EXPORTER   /**< IP address of the exporter and Observation Domain ID           */
+    } key; /**< Partitioning key                                                                 */
+    /** Blocking when the local producer queue is full                                           */
     bool blocking;
+    /** Compression codec of message batches ("none", "gzip", "snappy", "lz4" or "zstd")         */
+    std::string compression;
+    /** Required acknowledgements ("0", "1" or "all")                                            */
+    std::string acks;
+    /** Maximum delay before a batch of messages is transmitted (milliseconds)                   */
+    uint32_t linger_ms;
+    /** Maximum number of messages in a batch                                                    */
+    uint32_t batch_size;
+    /** Additional properties of the producer (name, value)                                      */
+    std::vector<std::pair<std::string, std::string>> properties;
 };
 
 enum class calg {
@@ -137,6 +171,8 @@ private:
     void parse_server(fds_xml_ctx_t *server);
     void parse_send(fds_xml_ctx_t *send);
     void parse_file(fds_xml_ctx_t *file);
+    void parse_kafka(fds_xml_ctx_t *kafka);
+    void parse_kafka_prop(fds_xml_ctx_t *prop, struct cfg_kafka &output);
     void parse_outputs(fds_xml_ctx_t *outputs);
     void parse_params(fds_xml_ctx_t *params);
 
@@ -153,6 +189,8 @@ public:
         std::vector<struct cfg_file> files;
         /** Servers                                                                              */
         std::vector<struct cfg_server> servers;
+        /** Kafka producers                                                                      */
+        std::vector<struct cfg_kafka> kafkas;
     } outputs; /**< Outputs                                                                      */
 
     /**
@@ -230,15 +230,15 @@ File::thread_window(void *context)
  * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
  */
 int
-File::process(const char *str, size_t len)
+File::process(const struct json_batch &batch)
 {
     pthread_rwlock_rdlock(&_thread->rwlock);
     if (_thread->file) {
-        // Store the record
+        // Store all records at once
         if (_thread->m_calg == calg::GZIP) {
-            gzwrite((gzFile)_thread->file, str, len);
+            gzwrite((gzFile)_thread->file, batch.buffer, batch.size);
         } else {
-            fwrite(str, len, 1, (FILE *)_thread->file);
+            fwrite(batch.buffer, batch.size, 1, (FILE *)_thread->file);
         }
     }
     pthread_rwlock_unlock(&_thread->rwlock);
@@ -59,8 +59,8 @@ public:
     File(const struct cfg_file &cfg, ipx_ctx_t *ctx);
     ~File();
 
-    // Store a record to the file
-    int process(const char *str, size_t len);
+    // Store records to the file
+    int process(const struct json_batch &batch);
 
     void flush();
 private:
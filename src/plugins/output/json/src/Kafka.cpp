@@ -0,0 +1,292 @@
+/**
+ * \file src/plugins/output/json/src/Kafka.cpp
+ * \brief Kafka output (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "Kafka.hpp"
+
+#include <stdexcept>
+#include <time.h>
+#include <inttypes.h>
+
+/** Size of the buffer for librdkafka error messages          */
+#define ERRSTR_SIZE (512)
+/** Timeout for delivery of remaining messages (milliseconds) */
+#define FLUSH_TIMEOUT (10000)
+/** Poll timeout if the local queue is full (milliseconds)    */
+#define POLL_TIMEOUT (100)
+/** Minimal delay between reports of failures (seconds)       */
+#define REPORT_DELAY (5)
+
+/**
+ * \brief Class constructor
+ *
+ * Configure and create a producer and a topic handle.
+ * \param[in] cfg Kafka configuration
+ * \param[in] ctx Instance context
+ * \throw runtime_error if the producer cannot be created
+ */
+Kafka::Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx), params(cfg)
+{
+    producer = nullptr;
+    topic = nullptr;
+    cnt_dropped = 0;
+    cnt_failed = 0;
+    last_err = RD_KAFKA_RESP_ERR_NO_ERROR;
+    clock_gettime(CLOCK_MONOTONIC, &report_time);
+
+    rd_kafka_conf_t *conf = rd_kafka_conf_new();
+    if (!conf) {
+        throw std::runtime_error("(Kafka output) Failed to create a producer configuration!");
+    }
+
+    try {
+        conf_set(conf, "bootstrap.servers", params.brokers);
+        conf_set(conf, "compression.codec", params.compression);
+        conf_set(conf, "acks", params.acks);
+        conf_set(conf, "linger.ms", std::to_string(params.linger_ms));
+        conf_set(conf, "batch.num.messages", std::to_string(params.batch_size));
+        // Additional properties (e.g. "test.mock.num.brokers" for a local broker stand-in)
+        for (const auto &prop : params.properties) {
+            conf_set(conf, prop.first, prop.second);
+        }
+    } catch (...) {
+        rd_kafka_conf_destroy(conf);
+        throw;
+    }
+
+    rd_kafka_conf_set_opaque(conf, this);
+    rd_kafka_conf_set_dr_msg_cb(conf, &Kafka::delivery_cb);
+
+    // On success, the configuration is owned by the producer
+    char errstr[ERRSTR_SIZE];
+    producer = rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr, sizeof(errstr));
+    if (!producer) {
+        rd_kafka_conf_destroy(conf);
+        throw std::runtime_error("(Kafka output) Failed to create a producer: "
+            + std::string(errstr));
+    }
+
+    topic = rd_kafka_topic_new(producer, params.topic.c_str(), nullptr);
+    if (!topic) {
+        const char *err_str = rd_kafka_err2str(rd_kafka_last_error());
+        rd_kafka_destroy(producer);
+        throw std::runtime_error("(Kafka output) Failed to create a topic '" + params.topic
+            + "': " + err_str);
+    }
+}
+
+/**
+ * \brief Destructor
+ *
+ * Wait for delivery of remaining messages (with a timeout) and destroy the producer.
+ */
+Kafka::~Kafka()
+{
+    if (rd_kafka_flush(producer, FLUSH_TIMEOUT) != RD_KAFKA_RESP_ERR_NO_ERROR) {
+        IPX_CTX_WARNING(_ctx, "(Kafka output) %d message(s) were not delivered before timeout.",
+            rd_kafka_outq_len(producer));
+    }
+
+    report();
+    rd_kafka_topic_destroy(topic);
+    rd_kafka_destroy(producer);
+}
+
+/**
+ * \brief Set a property of the producer
+ * \param[in] conf  Producer configuration
+ * \param[in] name  Name of the property
+ * \param[in] value Value of the property
+ * \throw runtime_error if the property is not valid
+ */
+void
+Kafka::conf_set(rd_kafka_conf_t *conf, const std::string &name, const std::string &value)
+{
+    char errstr[ERRSTR_SIZE];
+    if (rd_kafka_conf_set(conf, name.c_str(), value.c_str(), errstr, sizeof(errstr))
+            != RD_KAFKA_CONF_OK) {
+        throw std::runtime_error("(Kafka output) Invalid property '" + name + "': "
+            + std::string(errstr));
+    }
+}
+
+/**
+ * \brief Delivery report callback
+ *
+ * Called from rd_kafka_poll() (i.e. in the context of the output) for each produced message.
+ * \param[in] rk     Producer
+ * \param[in] msg    Message
+ * \param[in] opaque Instance of the output
+ */
+void
+Kafka::delivery_cb(rd_kafka_t *rk, const rd_kafka_message_t *msg, void *opaque)
+{
+    (void) rk;
+    if (msg->err == RD_KAFKA_RESP_ERR_NO_ERROR) {
+        return;
+    }
+
+    Kafka *inst = reinterpret_cast<Kafka *>(opaque);
+    inst->cnt_failed++;
+    inst->last_err = msg->err;
+}
+
+/**
+ * \brief Report the number of dropped and undelivered messages (if any)
+ */
+void
+Kafka::report()
+{
+    if (cnt_dropped > 0) {
+        IPX_CTX_WARNING(_ctx, "(Kafka output) %" PRIu64 " record(s) dropped due to full "
+            "producer queue.", cnt_dropped);
+        cnt_dropped = 0;
+    }
+
+    if (cnt_failed > 0) {
+        IPX_CTX_WARNING(_ctx, "(Kafka output) Delivery of %" PRIu64 " record(s) failed "
+            "(last error: %s).", cnt_failed, rd_kafka_err2str(last_err));
+        cnt_failed = 0;
+    }
+}
+
+/**
+ * \brief Prepare partitioning key for records of a new IPFIX Message
+ *
+ * Records with the same key are always stored into the same partition i.e. the order of
+ * records from the same exporter (or ODID) is preserved.
+ * \param[in] msg_ctx Message context
+ */
+void
+Kafka::msg_begin(const struct ipx_msg_ctx *msg_ctx)
+{
+    char src_addr[INET6_ADDRSTRLEN];
+    const char *addr;
+
+    switch (params.key) {
+    case cfg_kafka::KAFKA_KEY_NONE:
+        key.clear();
+        break;
+    case cfg_kafka::KAFKA_KEY_ODID:
+        key = std::to_string(msg_ctx->odid);
+        break;
+    case cfg_kafka::KAFKA_KEY_EXPORTER:
+        addr = Storage::session_src_addr(msg_ctx->session, src_addr, INET6_ADDRSTRLEN);
+        key = (addr != nullptr) ? addr : msg_ctx->session->ident;
+        key += "/" + std::to_string(msg_ctx->odid);
+        break;
+    }
+}
+
+/**
+ * \brief Produce a JSON record
+ *
+ * The record is copied to the local queue of the producer and sent asynchronously.
+ * \param[in] str JSON Record
+ * \param[in] len Size of the record
+ */
+void
+Kafka::produce(const char *str, size_t len)
+{
+    // Remove the trailing newline (each message contains exactly one record)
+    if (len > 0 && str[len - 1] == '\n') {
+        len--;
+    }
+
+    void *key_ptr = key.empty() ? nullptr : const_cast<char *>(key.data());
+    const size_t key_len = key.size();
+
+    while (rd_kafka_produce(topic, params.partition, RD_KAFKA_MSG_F_COPY,
+            const_cast<char *>(str), len, key_ptr, key_len, nullptr) == -1) {
+        const rd_kafka_resp_err_t err = rd_kafka_last_error();
+        if (err != RD_KAFKA_RESP_ERR__QUEUE_FULL) {
+            IPX_CTX_ERROR(_ctx, "(Kafka output) Failed to produce a record: %s",
+                rd_kafka_err2str(err));
+            return;
+        }
+
+        if (!params.blocking) {
+            cnt_dropped++;
+            return;
+        }
+
+        // Wait until some messages are delivered
+        rd_kafka_poll(producer, POLL_TIMEOUT);
+    }
+}
+
+/**
+ * \brief Produce JSON records
+ *
+ * Each record of the batch is produced as a separate message.
+ * \param[in] batch JSON Records
+ * \return Always #IPX_OK
+ */
+int
+Kafka::process(const struct json_batch &batch)
+{
+    for (size_t i = 0; i < batch.cnt; ++i) {
+        const size_t offset = batch.offsets[i];
+        produce(batch.buffer + offset, batch.offsets[i + 1] - offset);
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Serve delivery reports of already sent messages (non-blocking)
+ */
+void
+Kafka::flush()
+{
+    rd_kafka_poll(producer, 0);
+    if (cnt_dropped == 0 && cnt_failed == 0) {
+        return;
+    }
+
+    // Report failures at most once per REPORT_DELAY seconds
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (report_time.tv_sec + REPORT_DELAY > now.tv_sec) {
+        return;
+    }
+
+    report_time = now;
+    report();
+}
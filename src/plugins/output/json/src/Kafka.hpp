@@ -0,0 +1,96 @@
+/**
+ * \file src/plugins/output/json/src/Kafka.hpp
+ * \brief Kafka output (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_KAFKA_H
+#define JSON_KAFKA_H
+
+#include <string>
+#include <librdkafka/rdkafka.h>
+
+#include "Storage.hpp"
+
+/**
+ * \brief JSON producer for Apache Kafka
+ *
+ * Each JSON record is produced as a separate Kafka message. Messages are batched, compressed
+ * and sent asynchronously by the producer (librdkafka), therefore, the output doesn't block
+ * the pipeline thread unless the local producer queue is full and blocking mode is enabled.
+ */
+class Kafka : public Output {
+public:
+    // Constructor
+    Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx);
+    // Destructor
+    ~Kafka();
+
+    // Prepare partitioning key for records of a new IPFIX Message
+    void msg_begin(const struct ipx_msg_ctx *msg_ctx);
+    // Produce records
+    int process(const struct json_batch &batch);
+    // Serve delivery reports
+    void flush();
+
+private:
+    /** Configuration parameters of the output                                    */
+    struct cfg_kafka params;
+    /** Producer instance                                                          */
+    rd_kafka_t *producer;
+    /** Topic handle                                                               */
+    rd_kafka_topic_t *topic;
+    /** Key of the current IPFIX Message (empty, if not used)                      */
+    std::string key;
+    /** Number of messages dropped due to full local queue (since the last report) */
+    uint64_t cnt_dropped;
+    /** Number of failed deliveries (since the last report)                        */
+    uint64_t cnt_failed;
+    /** Error code of the last failed delivery                                     */
+    rd_kafka_resp_err_t last_err;
+    /** Time of the last report of failures                                        */
+    struct timespec report_time;
+
+    void conf_set(rd_kafka_conf_t *conf, const std::string &name, const std::string &value);
+    void produce(const char *str, size_t len);
+    void report();
+
+    // Delivery report callback
+    static void delivery_cb(rd_kafka_t *rk, const rd_kafka_message_t *msg, void *opaque);
+};
+
+#endif // JSON_KAFKA_H
@@ -48,9 +48,8 @@ Printer::Printer(const struct cfg_print &cfg, ipx_ctx_t *ctx) : Output(cfg.name,
 }
 
 int
-Printer::process(const char *str, size_t len)
+Printer::process(const struct json_batch &batch)
 {
-    (void) len;
-    std::cout << str;
+    std::cout.write(batch.buffer, batch.size);
     return IPX_OK;
 }
@@ -56,13 +56,12 @@ public:
     explicit Printer(const struct cfg_print &cfg, ipx_ctx_t *ctx);
 
     /**
-     * \brief Print a record on standard output
-     * \param[in] str JSON string to print
-     * \param[in] len Length of the string
+     * \brief Print records on standard output
+     * \param[in] batch JSON records to print
      * \return #IPX_OK on success
      * \return #IPX_ERR_DENIED in case of fatal failure
      */
-    int process(const char *str, size_t len);
+    int process(const struct json_batch &batch);
 };
 
 #endif // JSON_PRINTER_H
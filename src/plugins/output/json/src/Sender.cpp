@@ -78,13 +78,12 @@ Sender::~Sender()
 }
 
 /**
- * \brief Send a JSON record
- * \param[in] str JSON Record to send
- * \param[in] len Size of the record
+ * \brief Send JSON records
+ * \param[in] batch JSON Records to send
  * \return Always #IPX_OK
  */
 int
-Sender::process(const char *str, size_t len)
+Sender::process(const struct json_batch &batch)
 {
     if (sd == INVALID_FD) {
         // Not connected -> try to reconnect
@@ -126,7 +125,7 @@ Sender::process(const char *str, size_t len)
     }
 
     // Send new data
-    status = send(str, len);
+    status = send_batch(batch);
     switch (status) {
     case SEND_OK:
     case SEND_WOULDBLOCK:
@@ -197,6 +196,35 @@ Sender::connect()
     return IPX_OK;
 }
 
+/**
+ * \brief Send a batch of JSON records
+ *
+ * In case of TCP, all records are sent at once as a single stream of data. In case of UDP,
+ * each record must be sent as a separate datagram.
+ * \param[in] batch Records to send
+ * \return #SEND_OK on success
+ * \return #SEND_WOULDBLOCK if a part or nothing of the batch was sent
+ * \return #SEND_FAILED in case of broken connection
+ */
+enum Sender::Send_status
+Sender::send_batch(const struct json_batch &batch)
+{
+    if (params.proto == cfg_send::SEND_PROTO_TCP) {
+        return send(batch.buffer, batch.size);
+    }
+
+    enum Send_status status = SEND_OK;
+    for (size_t i = 0; i < batch.cnt; ++i) {
+        const size_t offset = batch.offsets[i];
+        status = send(batch.buffer + offset, batch.offsets[i + 1] - offset);
+        if (status == SEND_FAILED) {
+            break;
+        }
+    }
+
+    return status;
+}
+
 /**
  * \brief Send a JSON record
  *
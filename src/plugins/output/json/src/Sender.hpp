@@ -53,7 +53,7 @@ public:
     ~Sender();
 
     // Processing records
-    int process(const char *str, size_t len);
+    int process(const struct json_batch &batch);
 
 private:
     /** Transmission status */
@@ -74,6 +74,7 @@ private:
 
     int connect();
     enum Send_status send(const char *str, size_t len);
+    enum Send_status send_batch(const struct json_batch &batch);
 };
 
 #endif // JSON_SENDER_H
@@ -40,30 +40,39 @@
 #include "Server.hpp"
 #include <stdexcept>
 #include <cstring>
+#include <cinttypes>
 
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 
 /** How many pending connections queue will hold */
 #define BACKLOG (10)
+/** Maximum number of batches sent by a single system call */
+#define IOV_BATCH (64)
+/** Maximum number of events processed by a single epoll_wait() call */
+#define EPOLL_EVENTS (32)
+/** Timeout of epoll_wait() (in milliseconds) */
+#define EPOLL_TIMEOUT (100)
 
 /**
  * \brief Class constructor
  *
  * \param[in] cfg Configuration
  * \param[in] ctx Instance context
- * Parse configuration, create and bind server's socket and create acceptor's
- * thread
+ * Parse configuration, create and bind server's socket and create sender's thread
  */
-Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
+Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx), _cfg(cfg)
 {
     std::string port = std::to_string(cfg.port);
-    _non_blocking = !cfg.blocking;
-    _acceptor = NULL;
+    _stop = false;
+    _clients_cnt = 0;
+    _batch_seq = 0;
 
     int serv_fd;
     int ret_val;
@@ -84,7 +93,8 @@ Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name,
     }
 
     for (iter = servinfo; iter != NULL; iter = iter->ai_next) {
-        serv_fd = socket(iter->ai_family, iter->ai_socktype, iter->ai_protocol);
+        serv_fd = socket(iter->ai_family, iter->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            iter->ai_protocol);
         if ((serv_fd) == -1) {
             continue;
         }
@@ -118,84 +128,120 @@ Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name,
         throw std::runtime_error("(Server output) Failed to initialize server (listen() failed).");
     }
 
+    _socket_fd = serv_fd;
+    _epoll_fd = -1;
+    _event_fd = -1;
+
+    // Prepare the epoll instance with the server socket and the notification event
+    auto cleanup = [&](const std::string &msg) {
+        if (_event_fd != -1) {
+            close(_event_fd);
+        }
+        if (_epoll_fd != -1) {
+            close(_epoll_fd);
+        }
+        close(_socket_fd);
+        throw std::runtime_error("(Server output) " + msg);
+    };
+
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        cleanup("Failed to create an epoll instance (epoll_create1() failed).");
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        cleanup("Failed to create a notification event (eventfd() failed).");
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = _socket_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _socket_fd, &ev) == -1) {
+        cleanup("Failed to register the server socket (epoll_ctl() failed).");
+    }
+
+    ev.data.fd = _event_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &ev) == -1) {
+        cleanup("Failed to register the notification event (epoll_ctl() failed).");
+    }
+
     // Create thread
-    _acceptor = new acceptor_t;
-    _acceptor->ctx = ctx; // Only for log
-    _acceptor->socket_fd = serv_fd;
-    _acceptor->new_clients_ready = false;
-    _acceptor->stop = false;
-
-    if (pthread_mutex_init(&_acceptor->mutex, NULL) != 0) {
-        delete _acceptor;
-        close(serv_fd);
-        throw std::runtime_error("(Server output) Mutex initialization failed!");
+    if (pthread_mutex_init(&_mutex, NULL) != 0) {
+        cleanup("Mutex initialization failed!");
     }
 
-    if (pthread_create(&_acceptor->thread, NULL, &Server::thread_accept,_acceptor) != 0) {
-        pthread_mutex_destroy(&_acceptor->mutex);
-        delete _acceptor;
-        close(serv_fd);
-        throw std::runtime_error("(Server output) Acceptor thread failed");
+    if (pthread_cond_init(&_cond, NULL) != 0) {
+        pthread_mutex_destroy(&_mutex);
+        cleanup("Condition variable initialization failed!");
+    }
+
+    if (pthread_create(&_thread, NULL, &Server::thread_sender, this) != 0) {
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_mutex);
+        cleanup("Sender thread failed");
     }
 }
 
 /**
  * \brief Class destructor
  *
- * Close all sockets and stop and destroy the acceptor.
+ * Stop and destroy the sender and close all sockets.
  */
 Server::~Server()
 {
+    // Stop and destroy sender's thread
+    _stop = true;
+    sender_notify();
+    pthread_join(_thread, NULL);
+
     // Disconnect connected clients
-    for (auto &client : _clients) {
-        close(client.socket);
+    for (auto &it : _clients) {
+        close(it.second->socket);
+        delete it.second;
     }
 
-    // Stop and destroy acceptor's thread
-    if (_acceptor) {
-        _acceptor->stop = true;
-        pthread_join(_acceptor->thread, NULL);
-        pthread_mutex_destroy(&_acceptor->mutex);
-
-        close(_acceptor->socket_fd);
-
-        for (auto &client : _acceptor->new_clients) {
-            close(client.socket);
-        }
+    pthread_cond_destroy(&_cond);
+    pthread_mutex_destroy(&_mutex);
+    close(_event_fd);
+    close(_epoll_fd);
+    close(_socket_fd);
+}
 
-        delete _acceptor;
+/**
+ * \brief Wake up the sender thread
+ *
+ * The thread will try to send pending batches of all clients that are ready to receive data.
+ */
+void
+Server::sender_notify()
+{
+    const uint64_t value = 1;
+    if (write(_event_fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+        char buffer[128];
+        const char *err_str = strerror_r(errno, buffer, 128);
+        IPX_CTX_ERROR(_ctx, "(Server output) Failed to notify the sender thread (%s)", err_str);
     }
 }
 
 /**
- * \brief Acceptor's thread function
+ * \brief Sender's thread function
  *
- * Wait for new clients and accept them.
- * \param[in,out] context Acceptor's structure with configured server socket
+ * Accept new clients and send queued batches to clients that are ready to receive them.
+ * \param[in,out] context Server instance
  * \return Nothing
  */
 void *
-Server::thread_accept(void *context)
+Server::thread_sender(void *context)
 {
-    acceptor_t *acc = (acceptor_t *) context;
-    int ret_val;
-    struct timeval tv;
-    fd_set rfds;
-
-    IPX_CTX_INFO(acc->ctx, "(Server output) Waiting for connections...", '\0');
+    Server *server = (Server *) context;
+    struct epoll_event events[EPOLL_EVENTS];
 
-    while(!acc->stop) {
-        struct sockaddr_storage client_addr;
-        socklen_t sin_size = sizeof(client_addr);
-        int new_fd;
+    IPX_CTX_INFO(server->_ctx, "(Server output) Waiting for connections...", '\0');
 
-        // "select()" configuration
-        FD_ZERO(&rfds);
-        FD_SET(acc->socket_fd, &rfds);
-        tv.tv_sec = 0;
-        tv.tv_usec = 100000;
-
-        ret_val = select(acc->socket_fd + 1, &rfds, NULL, NULL, &tv);
+    while (!server->_stop) {
+        int ret_val = epoll_wait(server->_epoll_fd, events, EPOLL_EVENTS, EPOLL_TIMEOUT);
         if (ret_val == -1) {
             if (errno == EINTR) { // Just interrupted
                 continue;
@@ -203,69 +249,264 @@ Server::thread_accept(void *context)
 
             char buffer[128];
             const char *err_str = strerror_r(errno, buffer, 128);
-            IPX_CTX_ERROR(acc->ctx, "(Server output) select() - failed (%s)", err_str);
+            IPX_CTX_ERROR(server->_ctx, "(Server output) epoll_wait() - failed (%s)", err_str);
             break;
         }
 
-        if (!FD_ISSET(acc->socket_fd, &rfds)) {
-            // Timeout
-            continue;
+        bool check_all = false;
+        for (int i = 0; i < ret_val; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == server->_socket_fd) {
+                server->clients_accept();
+                continue;
+            }
+
+            if (fd == server->_event_fd) {
+                // New batches are ready (reset the counter)
+                uint64_t value;
+                if (read(server->_event_fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+                    IPX_CTX_WARNING(server->_ctx, "(Server output) Failed to read a notification "
+                        "event.", '\0');
+                }
+                check_all = true;
+                continue;
+            }
+
+            // The structure of the map is modified only by this thread, i.e. no locking required
+            auto it = server->_clients.find(fd);
+            if (it == server->_clients.end()) {
+                continue;
+            }
+
+            client_t *client = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                IPX_CTX_INFO(server->_ctx, "(Server output) Client disconnected: %s",
+                    get_client_desc(client->info).c_str());
+                server->client_remove(client);
+                continue;
+            }
+
+            // The socket is writable again
+            client->wait_out = false;
+            if (!server->client_process(*client)) {
+                server->client_remove(client);
+            }
         }
 
-        new_fd = accept(acc->socket_fd, (struct sockaddr *) &client_addr, &sin_size);
-        if (new_fd == -1) {
-            char buffer[128];
-            const char *err_str = strerror_r(errno, buffer, 128);
-            IPX_CTX_ERROR(acc->ctx, "(Server output) accept() - failed (%s)", err_str);
+        if (!check_all) {
             continue;
         }
 
-        IPX_CTX_INFO(acc->ctx, "(Server output) Client connected: %s",
-            get_client_desc(client_addr).c_str());
-
-        // Further receptions from the socket will be disallowed
-        shutdown(new_fd, SHUT_RD);
-        // Add new client to the array of new clients
-        pthread_mutex_lock(&acc->mutex);
-        client_t new_client {client_addr, new_fd, ""};
-        acc->new_clients.push_back(new_client);
-        acc->new_clients_ready = true;
-        pthread_mutex_unlock(&acc->mutex);
+        // Send new batches to all clients which are not waiting for the socket
+        auto iter = server->_clients.begin();
+        while (iter != server->_clients.end()) {
+            client_t *client = iter->second;
+            ++iter; // The client might be removed
+
+            if (client->wait_out && !client->disconnect) {
+                continue;
+            }
+
+            if (!server->client_process(*client)) {
+                server->client_remove(client);
+            }
+        }
     }
 
-    IPX_CTX_INFO(acc->ctx, "(Server output) Connection acceptor terminated.", '\0');
+    // Make sure that nobody waits for free space in a queue
+    pthread_mutex_lock(&server->_mutex);
+    server->_stop = true;
+    pthread_cond_broadcast(&server->_cond);
+    pthread_mutex_unlock(&server->_mutex);
+
+    IPX_CTX_INFO(server->_ctx, "(Server output) Sender terminated.", '\0');
     return NULL;
 }
 
 /**
- * \brief Send a message to a client
+ * \brief Accept a new client
  *
- * Sends the message to the client using prepared socket. When non-blocking mode
- * is enabled and only part of the message was sent, the rest of the message is
- * stored in the client's profile.
- * \param[in] data   The message
- * \param[in] len    The length of the message
+ * The client is registered to the epoll instance and added to the map of connected clients.
+ * Its queue is empty, i.e. it will receive only batches of records flushed after the connection.
+ */
+void
+Server::clients_accept()
+{
+    struct sockaddr_storage client_addr;
+    socklen_t sin_size = sizeof(client_addr);
+
+    int new_fd = accept4(_socket_fd, (struct sockaddr *) &client_addr, &sin_size,
+        SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (new_fd == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return;
+        }
+
+        char buffer[128];
+        const char *err_str = strerror_r(errno, buffer, 128);
+        IPX_CTX_ERROR(_ctx, "(Server output) accept() - failed (%s)", err_str);
+        return;
+    }
+
+    // Further receptions from the socket will be disallowed
+    shutdown(new_fd, SHUT_RD);
+
+    // Edge-triggered notifications, i.e. only when the socket becomes writable again
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLOUT | EPOLLET;
+    ev.data.fd = new_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, new_fd, &ev) == -1) {
+        char buffer[128];
+        const char *err_str = strerror_r(errno, buffer, 128);
+        IPX_CTX_ERROR(_ctx, "(Server output) Failed to register a client %s (%s)",
+            get_client_desc(client_addr).c_str(), err_str);
+        close(new_fd);
+        return;
+    }
+
+    client_t *client = new client_t;
+    client->info = client_addr;
+    client->socket = new_fd;
+    client->offset = 0;
+    client->wait_out = false;
+    client->disconnect = false;
+    client->dropped = 0;
+    client->last_seq = 0;
+
+    pthread_mutex_lock(&_mutex);
+    _clients[new_fd] = client;
+    _clients_cnt = _clients.size();
+    pthread_mutex_unlock(&_mutex);
+
+    IPX_CTX_INFO(_ctx, "(Server output) Client connected: %s",
+        get_client_desc(client_addr).c_str());
+}
+
+/**
+ * \brief Close the connection and remove a client
+ * \warning Only the sender thread is allowed to call this function!
+ * \param[in] client Client to remove
+ */
+void
+Server::client_remove(client_t *client)
+{
+    // Closing of the socket also removes it from the epoll instance
+    close(client->socket);
+
+    pthread_mutex_lock(&_mutex);
+    _clients.erase(client->socket);
+    _clients_cnt = _clients.size();
+    pthread_cond_broadcast(&_cond);
+    pthread_mutex_unlock(&_mutex);
+
+    delete client;
+}
+
+/**
+ * \brief Send pending batches of a client
+ *
+ * Batches are moved from the client's (shared) queue to the list of in-flight batches and sent
+ * until the queue is empty or the socket is not able to accept more data.
+ * \warning Only the sender thread is allowed to call this function!
  * \param[in] client Client
- * \return Transmission status
+ * \return False if the client should be disconnected. Otherwise true.
  */
-enum Server::Send_status
-Server::msg_send(const char *data, ssize_t len, client_t &client)
+bool
+Server::client_process(client_t &client)
 {
-    ssize_t now;
-    ssize_t todo = len;
-    const char *ptr = data;
+    while (true) {
+        if (client.disconnect) {
+            IPX_CTX_WARNING(_ctx, "(Server output) Client %s is not able to receive records "
+                "fast enough and will be disconnected.", get_client_desc(client.info).c_str());
+            return false;
+        }
+
+        if (client.inflight.empty()) {
+            uint64_t dropped;
+
+            pthread_mutex_lock(&_mutex);
+            dropped = client.dropped;
+            client.dropped = 0;
+
+            while (!client.queue.empty() && client.inflight.size() < IOV_BATCH) {
+                client.inflight.push_back(std::move(client.queue.front()));
+                client.queue.pop_front();
+            }
+
+            if (!client.inflight.empty() && _cfg.overflow == cfg_server::SERVER_OVERFLOW_BLOCK) {
+                pthread_cond_broadcast(&_cond);
+            }
+            pthread_mutex_unlock(&_mutex);
+
+            if (dropped > 0) {
+                IPX_CTX_WARNING(_ctx, "(Server output) Client %s is not able to receive records "
+                    "fast enough. %" PRIu64 " batch(es) of records dropped.",
+                    get_client_desc(client.info).c_str(), dropped);
+            }
+
+            if (client.inflight.empty()) {
+                // Nothing to send
+                return true;
+            }
 
-    int flags = MSG_NOSIGNAL;
-    if (_non_blocking) {
-        flags |= MSG_DONTWAIT;
+            client.offset = 0;
+        }
+
+        switch (msg_send(client)) {
+        case SEND_OK:
+            // Try to get next batches
+            continue;
+        case SEND_WOULDBLOCK:
+            // Wait until the socket is writable again
+            client.wait_out = true;
+            return true;
+        case SEND_FAILED:
+            return false;
+        }
     }
+}
 
-    while (todo > 0) {
-        now = send(client.socket, ptr, todo, flags);
+/**
+ * \brief Send in-flight batches to a client
+ *
+ * Sends as many in-flight batches as possible by a vectored I/O. Successfully sent batches are
+ * removed from the list of in-flight batches. If only a part of a batch has been sent, the offset
+ * of the rest is remembered for the next transmission to avoid invalid JSON format.
+ * \param[in] client Client
+ * \return Transmission status
+ */
+enum Server::Send_status
+Server::msg_send(client_t &client)
+{
+    std::vector<batch_t> &inflight = client.inflight;
+    struct iovec iov[IOV_BATCH];
+    size_t idx = 0; // Index of the first (partly) unsent batch
+    enum Send_status status = SEND_OK;
+
+    while (idx < inflight.size()) {
+        size_t iov_cnt = 0;
+        for (size_t i = idx; i < inflight.size() && iov_cnt < IOV_BATCH; ++i, ++iov_cnt) {
+            const std::string &batch = *inflight[i];
+            const size_t skip = (i == idx) ? client.offset : 0;
+            iov[iov_cnt].iov_base = const_cast<char *>(batch.data() + skip);
+            iov[iov_cnt].iov_len = batch.size() - skip;
+        }
 
+        // Equivalent of writev() that doesn't generate SIGPIPE
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_cnt;
+
+        ssize_t now = sendmsg(client.socket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
         if (now == -1) {
-            if (_non_blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-                // Non-blocking mode
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                status = SEND_WOULDBLOCK;
                 break;
             }
 
@@ -277,99 +518,111 @@ Server::msg_send(const char *data, ssize_t len, client_t &client)
             return SEND_FAILED;
         }
 
-        ptr  += now;
-        todo -= now;
-    }
-
-    if (todo <= 0) {
-        return SEND_OK;
-    }
+        // Skip successfully sent batches
+        size_t sent = static_cast<size_t>(now);
+        while (sent > 0) {
+            const size_t remain = inflight[idx]->size() - client.offset;
+            if (sent < remain) {
+                client.offset += sent;
+                break;
+            }
 
-    // Non-blocking mode - (partly) failed to sent the message
-    if (todo == len) {
-        // No part of the message was sent
-        return SEND_WOULDBLOCK;
+            sent -= remain;
+            client.offset = 0;
+            ++idx;
+        }
     }
 
-    /*
-     * Partly sent. Store the rest of the message for the next transmission to
-     * avoid invalid JSON format. Temporary string should be here, because it is
-     * possible to "data == rest.c_str()".
-     */
-    std::string tmp(ptr, todo);
-    client.msg_rest.assign(tmp);
-    return SEND_WOULDBLOCK;
+    // Release sent batches
+    inflight.erase(inflight.begin(), inflight.begin() + idx);
+    return status;
 }
 
 /**
- * \brief Send record to all connected clients
+ * \brief Add records to the current batch
  *
- * \param[in] str JSON Record
- * \param[in] len Length of the record
+ * The batch is passed to connected clients when flushed, i.e. after processing of the whole
+ * IPFIX Message.
+ * \param[in] batch JSON Records
  * \return Always #IPX_OK
  */
-int Server::process(const char *str, size_t len)
+int Server::process(const struct json_batch &batch)
 {
-    const char *data = str;
-    ssize_t length = len;
-
-    // Are there new clients?
-    if (_acceptor->new_clients_ready) {
-        pthread_mutex_lock(&_acceptor->mutex);
+    if (_clients_cnt == 0) {
+        // Nobody is listening...
+        return IPX_OK;
+    }
 
-        _clients.insert(_clients.end(), _acceptor->new_clients.begin(),
-            _acceptor->new_clients.end());
-        _acceptor->new_clients.clear();
+    _batch.append(batch.buffer, batch.size);
+    return IPX_OK;
+}
 
-        _acceptor->new_clients_ready = false;
-        pthread_mutex_unlock(&_acceptor->mutex);
+/**
+ * \brief Pass the current batch to all connected clients
+ *
+ * The batch is shared by queues of all clients, i.e. it is not copied. If a queue is full,
+ * the configured overflow policy is applied.
+ */
+void
+Server::flush()
+{
+    if (_batch.empty()) {
+        return;
     }
 
-    // Send the message to all clients
-    std::vector<client_t>::iterator iter = _clients.begin();
+    batch_t batch = std::make_shared<const std::string>(std::move(_batch));
+    _batch.clear();
+    const uint64_t seq = ++_batch_seq;
+    bool notify = false;
+
+    pthread_mutex_lock(&_mutex);
+    auto iter = _clients.begin();
     while (iter != _clients.end()) {
-        client_t &client = *iter;
-        enum Send_status ret_val;
-
-        // Send the rest part of the last partly sent message
-        if (_non_blocking && !client.msg_rest.empty()) {
-            std::string &rest = client.msg_rest;
-
-            ret_val = msg_send(rest.c_str(), rest.size(), client);
-            switch (ret_val) {
-            case SEND_OK:
-                // The rest of the message successfully sent
-                rest.clear();
+        client_t *client = iter->second;
+        if (client->last_seq == seq || client->disconnect) {
+            // Already processed or going to be disconnected
+            ++iter;
+            continue;
+        }
+
+        if (client->queue.size() >= _cfg.queue_size) {
+            switch (_cfg.overflow) {
+            case cfg_server::SERVER_OVERFLOW_DROP:
+                // Make space for the new batch
+                client->queue.pop_front();
+                client->dropped++;
                 break;
-            case SEND_WOULDBLOCK:
-                // Skip, next client...
+            case cfg_server::SERVER_OVERFLOW_DISCONNECT:
+                client->disconnect = true;
+                client->queue.clear();
+                notify = true;
                 ++iter;
                 continue;
-            case SEND_FAILED:
-                // Close socket and remove client
-                close(client.socket);
-                iter = _clients.erase(iter); // The iterator has new location...
+            case cfg_server::SERVER_OVERFLOW_BLOCK:
+                if (_stop) {
+                    // The sender is not running anymore
+                    ++iter;
+                    continue;
+                }
+
+                // Wait for free space and start over (the map might be modified in the meantime)
+                sender_notify();
+                pthread_cond_wait(&_cond, &_mutex);
+                iter = _clients.begin();
                 continue;
             }
         }
 
-        // Send new message
-        ret_val = msg_send(data, length, client);
-        switch (ret_val) {
-        case SEND_OK:
-        case SEND_WOULDBLOCK:
-            // Next client
-            ++iter;
-            break;
-        case SEND_FAILED:
-            // Close socket and remove client's info
-            close(client.socket);
-            iter = _clients.erase(iter); // The iterator has new location...
-            break;
-        }
+        client->queue.push_back(batch);
+        client->last_seq = seq;
+        notify = true;
+        ++iter;
     }
+    pthread_mutex_unlock(&_mutex);
 
-    return IPX_OK;
+    if (notify) {
+        sender_notify();
+    }
 }
 
 /**
@@ -41,6 +41,9 @@
 #define JSON_SERVER_H
 
 #include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <pthread.h>
@@ -50,6 +53,13 @@
 
 /**
  * \brief The class for server output interface
+ *
+ * Records are not sent by the calling (pipeline) thread. Instead, all records converted from
+ * a single IPFIX Message are collected into a batch, which is shared (by reference counting)
+ * among queues of all connected clients. A dedicated sender thread waits (epoll) for clients
+ * that are ready to receive data and sends queued batches using a vectored I/O. Therefore,
+ * a slow client doesn't affect other clients and the cost of the pipeline thread doesn't depend
+ * on the number of connected clients.
  */
 class Server : public Output
 {
@@ -57,49 +67,76 @@ public:
     Server(const struct cfg_server &cfg, ipx_ctx_t *ctx);
     ~Server();
 
-    // Send a record to connected clients
-    int process(const char *str, size_t len);
+    // Add records to the current batch
+    int process(const struct json_batch &batch);
+    // Pass the current batch to connected clients
+    void flush();
 private:
-    /** Transmission status */
-    enum Send_status {
-        SEND_OK,               /**< Successfully sent                             */
-        SEND_WOULDBLOCK,       /**< Message skipped or partly sent                */
-        SEND_FAILED            /**< Failed                                        */
-    };
+    /** Shared batch of JSON records                                                             */
+    typedef std::shared_ptr<const std::string> batch_t;
 
     /** Structure for connected client */
     typedef struct client_s {
-        struct sockaddr_storage info; /**< Info about client (IP, port)           */
-        int socket;                   /**< Client's socket                        */
-        std::string msg_rest;         /**< Rest of a message in non-blocking mode */
+        struct sockaddr_storage info; /**< Info about client (IP, port)                          */
+        int socket;                   /**< Client's socket                                       */
+        std::deque<batch_t> queue;    /**< Batches waiting for transmission (protected by mutex) */
+        std::vector<batch_t> inflight;/**< Batches being sent (accessed by sender thread only)   */
+        size_t offset;                /**< Already sent bytes of the first in-flight batch       */
+        bool wait_out;                /**< Waiting for EPOLLOUT event                            */
+        std::atomic<bool> disconnect; /**< Client should be disconnected (queue overflow)        */
+        uint64_t dropped;             /**< Number of dropped batches (since the last report)     */
+        uint64_t last_seq;            /**< Sequence number of the last queued batch              */
     } client_t;
 
-    /** Configuration of acceptor thread */
-    typedef struct acceptor_s {
-        ipx_ctx_t *ctx;                     /**< Instance context (for log only ) */
-        pthread_t thread;					/**< Thread                           */
-        pthread_mutex_t mutex;              /**< Mutex for the array              */
-        std::atomic<bool> stop;             /**< Stop flag for terminating        */
+    /** Transmission status */
+    enum Send_status {
+        SEND_OK,               /**< All in-flight batches successfully sent                      */
+        SEND_WOULDBLOCK,       /**< Batches partly sent (the socket is not ready)                */
+        SEND_FAILED            /**< Failed                                                       */
+    };
+
+    /** Instance configuration                                                                   */
+    struct cfg_server _cfg;
+    /** Records of the current IPFIX Message (accessed only by the pipeline thread)              */
+    std::string _batch;
+    /** Sequence number of the last flushed batch (accessed only by the pipeline thread)         */
+    uint64_t _batch_seq;
 
-        int socket_fd;                      /**< Server socket                    */
-        std::atomic<bool> new_clients_ready; /**< New clients flag                 */
-        std::vector<client_t> new_clients;  /**< Array of new clients             */
-    } acceptor_t;
+    /** Sender thread                                                                            */
+    pthread_t _thread;
+    /** Mutex for client queues and the map of clients                                           */
+    pthread_mutex_t _mutex;
+    /** Condition variable signalling released space in client queues (blocking policy only)    */
+    pthread_cond_t _cond;
+    /** Stop flag for terminating                                                                */
+    std::atomic<bool> _stop;
+    /** Number of connected clients (for a quick check without locking)                          */
+    std::atomic<size_t> _clients_cnt;
+    /** Connected clients (socket -> client) (structure modified by the sender thread only)      */
+    std::map<int, client_t *> _clients;
 
-    /** Connected client */
-    std::vector<client_t> _clients;
-    /** Socket state */
-    bool _non_blocking;
-    /** Acceptor of new clients */
-    acceptor_t *_acceptor;
+    /** Server (listening) socket                                                                */
+    int _socket_fd;
+    /** Epoll instance of the sender thread                                                      */
+    int _epoll_fd;
+    /** Event file descriptor for waking up the sender thread                                    */
+    int _event_fd;
 
     // Brief description of a client
     static std::string get_client_desc(const struct sockaddr_storage &client);
-    // Send data to the client
-    enum Send_status msg_send(const char *data, ssize_t len, client_t &client);
+    // Send in-flight batches to the client
+    enum Send_status msg_send(client_t &client);
+    // Process all pending batches of a client
+    bool client_process(client_t &client);
+    // Accept new clients
+    void clients_accept();
+    // Remove a client
+    void client_remove(client_t *client);
+    // Wake up the sender thread
+    void sender_notify();
 
-    // Acceptor's thread function
-    static void *thread_accept(void *context);
+    // Sender's thread function
+    static void *thread_sender(void *context);
 };
 
 #endif // JSON_SERVER_H
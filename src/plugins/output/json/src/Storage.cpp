@@ -60,8 +60,9 @@ Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
     m_record.size_used = 0;
     m_record.size_alloc = 0;
 
-    // Prepare conversion flags
-    m_flags = FDS_CD2J_ALLOW_REALLOC; // Allow automatic reallocation of the buffer
+    // Prepare conversion flags (records are converted directly into the batch buffer, therefore,
+    // automatic reallocation of the buffer by the converter is not allowed)
+    m_flags = 0;
     if (m_format.tcp_flags) {
         m_flags |= FDS_CD2J_FORMAT_TCPFLAGS;
     }
@@ -259,12 +260,11 @@ Storage::convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id, con
  * \brief Convert Template sets and Options Template sets
  *
  * From all sets in the Message, try to convert just Template and Options template sets.
+ * Converted records are appended to the batch.
  * \param[in] set   All sets in the Message
  * \param[in] hdr   Message header of IPFIX record
- * \return #IPX_OK on success
- * \return #IPX_ERR_DENIED if an output fails to store any record
  */
-int
+void
 Storage::convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr *hdr)
 {
     uint16_t set_id = ntohs(set->ptr->flowset_id);
@@ -277,20 +277,9 @@ Storage::convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr
     // Iteration through all (Options) Templates in the Set
     while (fds_tset_iter_next(&tset_iter) == FDS_OK) {
         // Read and print single template
+        m_offsets.push_back(m_record.size_used);
         convert_tmplt_rec(&tset_iter, set_id, hdr);
-
-        // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                return IPX_ERR_DENIED;
-            }
-        }
-
-        // Buffer is empty
-        m_record.size_used = 0;
     }
-
-    return IPX_OK;
 }
 
 int
@@ -298,14 +287,21 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
 {
     const auto hdr = (fds_ipfix_msg_hdr*) ipx_msg_ipfix_get_packet(msg);
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
-    bool flush = false;
     int ret = IPX_OK;
 
+    // Start a new batch
+    m_record.size_used = 0;
+    m_offsets.clear();
+
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    for (Output *output : m_outputs) {
+        output->msg_begin(msg_ctx);
+    }
+
     // Extract IPv4/IPv6 address of the exporter, if required
     m_src_addr = nullptr;
     char src_addr[INET6_ADDRSTRLEN];
     if (m_format.detailed_info) {
-        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
         m_src_addr = session_src_addr(msg_ctx->session, src_addr, INET6_ADDRSTRLEN);
     }
 
@@ -323,11 +319,7 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
                 continue;
             }
 
-            flush = true;
-            if (convert_tset(&sets[i], hdr) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+            convert_tset(&sets[i], hdr);
         }
     }
 
@@ -341,43 +333,44 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
             continue;
         }
 
-        flush = true;
-
         // Convert the record
+        m_offsets.push_back(m_record.size_used);
         convert(ipfix_rec->rec, iemgr, hdr, false);
 
-        // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
-        }
-
         if (!m_format.split_biflow || (ipfix_rec->rec.tmplt->flags & FDS_TEMPLATE_BIFLOW) == 0) {
             // Record splitting is disabled or it is not a biflow record -> continue
             continue;
         }
 
         // Convert the record from reverse point of view
+        m_offsets.push_back(m_record.size_used);
         convert(ipfix_rec->rec, iemgr, hdr, true);
+    }
 
-        // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
-        }
+    if (m_offsets.empty()) {
+        // Nothing to store
+        return IPX_OK;
     }
 
-endloop:
-    if (flush) {
-        for (Output *output : m_outputs) {
-            output->flush();
+    // Pass the whole batch to all outputs
+    struct json_batch batch;
+    batch.buffer = m_record.buffer;
+    batch.size = m_record.size_used;
+    batch.cnt = m_offsets.size();
+    m_offsets.push_back(m_record.size_used);
+    batch.offsets = m_offsets.data();
+
+    for (Output *output : m_outputs) {
+        if (output->process(batch) != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            break;
         }
     }
 
+    for (Output *output : m_outputs) {
+        output->flush();
+    }
+
     return ret;
 }
 
@@ -414,8 +407,8 @@ Storage::addDetailedInfo(const struct fds_ipfix_msg_hdr *hdr)
 /**
  * \brief Convert an IPFIX record to JSON string
  *
- * For each field in the record, try to convert it into JSON format. The record is stored
- * into the local buffer.
+ * For each field in the record, try to convert it into JSON format. The record is converted
+ * directly to the end of the batch buffer, which is enlarged if the converter runs out of space.
  * \param[in] rec     IPFIX record to convert
  * \param[in] iemgr   Manager of Information Elements
  * \param[in] reverse Convert from reverse point of view (affects only biflow records)
@@ -428,12 +421,25 @@ Storage::convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, fds_ipfix_msg_h
     uint32_t flags = m_flags;
     flags |= reverse ? FDS_CD2J_BIFLOW_REVERSE : 0;
 
-    int rc = fds_drec2json(&rec, flags, iemgr, &m_record.buffer, &m_record.size_alloc);
+    int rc;
+    buffer_reserve(buffer_used() + BUFFER_BASE);
+    while (true) {
+        char *rec_buffer = m_record.buffer + buffer_used();
+        size_t rec_size = buffer_remain();
+        rc = fds_drec2json(&rec, flags, iemgr, &rec_buffer, &rec_size);
+        if (rc != FDS_ERR_BUFFER) {
+            break;
+        }
+
+        // The buffer is too small
+        buffer_reserve(2 * buffer_alloc());
+    }
+
     if (rc < 0) {
         throw std::runtime_error("Conversion to JSON failed (probably a memory allocation error)!");
     }
 
-    m_record.size_used = size_t(rc);
+    m_record.size_used += size_t(rc);
 
     if (m_format.detailed_info) {
         // Remove '}' parenthesis at the end of the record
@@ -48,6 +48,24 @@
 #include <ipfixcol2.h>
 #include "Config.hpp"
 
+/**
+ * \brief Batch of converted JSON records
+ *
+ * All records converted from a single IPFIX Message (including both directions of split
+ * biflow records) are stored one after another in a contiguous buffer. Each record is
+ * terminated by '\n' and the whole buffer is terminated by '\0'.
+ */
+struct json_batch {
+    /** Converted records                                                                        */
+    const char *buffer;
+    /** Total length of all records (excluding the terminating null byte '\0')                   */
+    size_t size;
+    /** Offsets of the records in the buffer (has cnt + 1 items, the last one is equal to size)  */
+    const size_t *offsets;
+    /** Number of records in the batch                                                           */
+    size_t cnt;
+};
+
 /** Base class                                                                                   */
 class Output {
 protected:
@@ -67,14 +85,23 @@ public:
     ~Output() {};
 
     /**
-     * \brief Process a converted JSON
-     * \param[in] str JSON Record
-     * \param[in] len Length of the record (excluding the terminating null byte '\0')
+     * \brief Start processing of records of a new IPFIX Message
+     *
+     * All following records (until the next call) belong to the Message.
+     * \param[in] msg_ctx Message context (Transport Session, ODID, etc.)
+     */
+    virtual void
+    msg_begin(const struct ipx_msg_ctx *msg_ctx) {(void) msg_ctx;};
+
+    /**
+     * \brief Process converted JSON records of an IPFIX Message
+     * \note The batch is valid only during the call, i.e. it must be copied if required later.
+     * \param[in] batch Batch of JSON records (never empty)
      * \return #IPX_OK on success
      * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
      */
     virtual int
-    process(const char *str, size_t len) = 0;
+    process(const struct json_batch &batch) = 0;
 
     /**
      * \brief Flush buffered records
@@ -101,7 +128,9 @@ private:
         char *buffer;
         size_t size_alloc;
         size_t size_used;
-    } m_record; /**< Converted JSON record                                                       */
+    } m_record; /**< Converted JSON records of the current IPFIX Message                         */
+    /** Offsets of the converted records in the buffer                                           */
+    std::vector<size_t> m_offsets;
 
     // Convert an IPFIX record to a JSON string
     void convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, struct fds_ipfix_msg_hdr *hdr, bool reverse = false);
@@ -117,14 +146,15 @@ private:
     // Reserve memory for a JSON string
     void buffer_reserve(size_t n);
     // Convert set to JSON string
-    int convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr *hdr);
+    void convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr *hdr);
     // Convert template record to a JSON string
     void convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id, const struct fds_ipfix_msg_hdr *hdr);
     // Add detailed info (templateId, ODID, seqNum, exportTime) to JSON string
     void addDetailedInfo(const struct fds_ipfix_msg_hdr *hdr);
+public:
     // Get src_addr from IPFIX session
     static const char *session_src_addr(const struct ipx_session *ipx_desc, char *src_addr, socklen_t size);
-public:
+
     /**
      * \brief Constructor
      * \param[in] ctx Plugin context (only for log!)
@@ -137,8 +167,8 @@ public:
     /**
      * \brief Add a new output instance
      *
-     * Every time a new record is converted, the output instance will receive a reference
-     * to the record and store it.
+     * Every time records of an IPFIX Message are converted, the output instance will receive
+     * a reference to the batch of the records and store it.
      * \note The storage will destroy the output instance when during destruction of this storage
      * \param[in] output Instance to add
      */
@@ -148,7 +178,8 @@ public:
     /**
      * \brief Process IPFIX Message records
      *
-     * For each record perform conversion to JSON and pass it to all output instances.
+     * All records are converted to JSON into a single batch, which is then passed to all
+     * output instances at once.
      * \param[in] msg   IPFIX Message to convert
      * \param[in] iemgr Information Element manager (can be NULL)
      * \return #IPX_OK on success
@@ -42,6 +42,7 @@
 #include <libfds.h>
 #include <ipfixcol2.h>
 #include <memory>
+#include <stdexcept>
 
 #include "Config.hpp"
 #include "Storage.hpp"
@@ -49,6 +50,9 @@
 #include "File.hpp"
 #include "Server.hpp"
 #include "Sender.hpp"
+#ifdef JSON_WITH_KAFKA
+#include "Kafka.hpp"
+#endif
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -101,6 +105,15 @@ outputs_initialize(ipx_ctx_t *ctx, Storage *storage, Config *cfg)
     for (const auto &send : cfg->outputs.sends) {
         storage->output_add(new Sender(send, ctx));
     }
+
+    for (const auto &kafka : cfg->outputs.kafkas) {
+#ifdef JSON_WITH_KAFKA
+        storage->output_add(new Kafka(kafka, ctx));
+#else
+        throw std::runtime_error("Unable to create output '" + kafka.name + "'. The plugin "
+            "has been built without support of Kafka output (librdkafka is required).");
+#endif
+    }
 }
 
 int
@@ -75,6 +75,8 @@ struct instance_data {
     struct instance_config *config;
     /** Current time (seconds since the Epoch) */
     uint64_t ts_now;
+    /** Selector of timestamp fields           */
+    ipx_fsel_t *fsel;
 
     /** Context reference (only for log!)      */
     ipx_ctx_t *ctx;
@@ -85,6 +87,25 @@ static void
 timestamp_check(const struct instance_data *inst, ipx_msg_ipfix_t *msg,
     const struct fds_drec_field *field);
 
+/**
+ * \brief Select timestamp fields
+ * \param[in] field Template field
+ * \param[in] data  Unused
+ * \return True if the field is an IANA (or reverse IANA) element within the range 150 - 157
+ */
+static bool
+select_timestamp(const struct fds_tfield *field, void *data)
+{
+    (void) data;
+    if (field->en != PEN_IANA && field->en != PEN_IANA_REV) {
+        // We don't check non-standard fields
+        return false;
+    }
+
+    // We want to check only IE elements within the range 150 - 157
+    return (field->id >= 150U && field->id <= 157U);
+}
+
 int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 {
@@ -99,6 +120,12 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    if ((data->fsel = ipx_fsel_create(&select_timestamp, NULL)) == NULL) {
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
     data->ctx = ctx;
     ipx_ctx_private_set(ctx, data);
     return IPX_OK;
@@ -110,6 +137,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) ctx; // Suppress warnings
 
     struct instance_data *data = (struct instance_data *) cfg;
+    ipx_fsel_destroy(data->fsel);
     config_destroy(data->config);
     free(data);
 }
@@ -117,7 +145,6 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
-    (void) ctx; // Suppress warnings
     struct instance_data *data = (struct instance_data *) cfg;
     ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
 
@@ -126,27 +153,26 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
     // For each Data Record in the message
     uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+    const struct fds_template *last_tmplt = NULL;
+    const struct ipx_fsel_result *fields = NULL;
+
     for (uint32_t i = 0; i < rec_cnt; ++i) {
-        // For each field in the Data Record
         struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
-        struct fds_drec_iter it;
 
-        fds_drec_iter_init(&it, &rec->rec, 0);
-        while (fds_drec_iter_next(&it) != FDS_EOC) {
-            // Is it a timestamp?
-            const uint16_t field_id = it.field.info->id;
-            const uint32_t field_en = it.field.info->en;
-
-            if (field_en != PEN_IANA && field_en != PEN_IANA_REV) {
-                // We don't check non-standard fields
-                continue;
-            }
-
-            if (field_id < 150U || field_id > 157U) {
-                // We want to check only IE elements within the range 150 - 157
-                continue;
+        // Get positions of timestamps in the record (records of the same template follow)
+        if (rec->rec.tmplt != last_tmplt) {
+            fields = ipx_fsel_get(data->fsel, rec->rec.tmplt);
+            last_tmplt = rec->rec.tmplt;
+            if (!fields) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_DENIED;
             }
+        }
 
+        // For each timestamp in the Data Record
+        struct ipx_fsel_iter it;
+        ipx_fsel_iter_init(&it, fields, &rec->rec);
+        while (ipx_fsel_iter_next(&it) == IPX_OK) {
             // Check if the value doesn't violate rules
             timestamp_check(data, ipfix_msg, &it.field);
         }
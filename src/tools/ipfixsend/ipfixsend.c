@@ -42,6 +42,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <errno.h>
@@ -52,6 +53,7 @@
 #include "siso.h"
 #include "reader.h"
 #include "sender.h"
+#include "vexp.h"
 
 /** Default destination IP                 */
 #define DEFAULT_IP "127.0.0.1"
@@ -80,7 +82,7 @@ void usage()
     printf("  -d ip      Destination IP address (default: %s)\n", DEFAULT_IP);
     printf("  -p port    Destination port number (default: %s)\n", DEFAULT_PORT);
     printf("  -t type    Connection type (UDP or TCP) (default: UDP)\n");
-    printf("  -c         Precache input file (for performance tests)\n");
+    printf("  -c         Load the whole input file into memory in advance\n");
     printf("  -n num     How many times the file should be sent (default: infinity)\n");
     printf("  -s speed   Maximum data sending speed/s\n");
     printf("             Supported suffixes: B (default), K, M, G\n");
@@ -89,6 +91,15 @@ void usage()
     printf("             Allow speed-up sending 'num' times (realtime: 1.0)\n");
     printf("  -O num     Rewrite Observation Domain ID (ODID)\n");
     printf("\n");
+    printf("Virtual exporters (UDP only, incompatible with -s and -R):\n");
+    printf("  -E num     Number of virtual exporters, each exporter has its own socket\n");
+    printf("             and sends the whole file (default: 1)\n");
+    printf("  -T num     Number of sending threads (default: 1, the input must be a file)\n");
+    printf("  -a ip      Source IP address of the first exporter, the next exporters use\n");
+    printf("             subsequent addresses (default: ephemeral source ports only)\n");
+    printf("  -B num     Maximum number of messages sent by one system call (default: %d)\n",
+        VEXP_BATCH_DEF);
+    printf("\n");
 }
 
 /**
@@ -99,6 +110,7 @@ void handler(int signal)
 {
     (void) signal; // skip compiler warning
     sender_stop();
+    vexp_stop();
     stop = 1;
 }
 
@@ -123,6 +135,11 @@ int main(int argc, char** argv)
     bool    odid_rewrite = false;
     long    odid_new;
 
+    int     exporters = 1;
+    int     threads = 1;
+    int     batch = 0;
+    char   *src_ip = NULL;
+
     if (argc == 1) {
         usage();
         return 0;
@@ -130,7 +147,7 @@ int main(int argc, char** argv)
 
     // Parse parameters
     int c;
-    while ((c = getopt(argc, argv, "hci:d:p:t:n:s:S:R:O:")) != -1) {
+    while ((c = getopt(argc, argv, "hci:d:p:t:n:s:S:R:O:E:T:a:B:")) != -1) {
         switch (c) {
         case 'h':
             usage();
@@ -166,6 +183,18 @@ int main(int argc, char** argv)
             odid_rewrite = true;
             odid_new = atol(optarg);
             break;
+        case 'E':
+            exporters = atoi(optarg);
+            break;
+        case 'T':
+            threads = atoi(optarg);
+            break;
+        case 'a':
+            src_ip = optarg;
+            break;
+        case 'B':
+            batch = atoi(optarg);
+            break;
         default:
             fprintf(stderr, "Unknown option.\n");
             return 1;
@@ -206,8 +235,49 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (exporters < 1 || threads < 1 || threads > exporters) {
+        fprintf(stderr, "Invalid number of exporters or threads (each thread must have at "
+            "least one exporter).\n");
+        return 1;
+    }
+
+    if (batch < 0 || batch > VEXP_BATCH_MAX) {
+        fprintf(stderr, "Invalid batch size. Must be in range (1 .. %d)\n", VEXP_BATCH_MAX);
+        return 1;
+    }
+
     signal(SIGINT, handler);
 
+    if (exporters > 1 || threads > 1 || src_ip != NULL || batch > 0) {
+        // Virtual exporters
+        if (strcasecmp(type, "UDP") != 0) {
+            fprintf(stderr, "Virtual exporters are supported only over UDP.\n");
+            return 1;
+        }
+
+        if (speed != NULL || realtime_s > 0.0) {
+            fprintf(stderr, "Virtual exporters cannot be combined with the real-time sending "
+                "or the data speed limitation.\n");
+            return 1;
+        }
+
+        struct vexp_cfg cfg = {
+            .input = input,
+            .precache = precache,
+            .dst_ip = ip,
+            .dst_port = port,
+            .src_ip = src_ip,
+            .threads = (unsigned int) threads,
+            .exporters = (unsigned int) exporters,
+            .batch = (batch > 0) ? (unsigned int) batch : VEXP_BATCH_DEF,
+            .loops = loops,
+            .packets_s = (uint64_t) packets_s,
+            .odid_rewrite = odid_rewrite,
+            .odid_new = odid_rewrite ? (uint32_t) odid_new : 0
+        };
+        return (vexp_send(&cfg) == 0) ? 0 : 1;
+    }
+
     // Get collector's address
     sisoconf *sender = siso_create();
     if (!sender) {
@@ -43,6 +43,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
@@ -53,6 +54,8 @@
 #define MAX_PACKET_SIZE 65536
 /** Increase the auto-updated sequence number after finishing the file       */
 #define SEQ_NUM_INC     256
+/** Default size of the index of packets (number of packets)                  */
+#define INDEX_DEF_SIZE  2048
 
 /** Auto update configuration */
 struct reader_autoupdate {
@@ -69,11 +72,17 @@ struct reader_autoupdate {
 
 /** Internal representation of the packet reader                             */
 struct reader_internal {
-    FILE *file;          /**< Input file                                     */
-    size_t next_id;      /**< Index of next packet                           */
-    bool is_preloaded;   /**< Is the whole file preloaded                    */
+    FILE *file;          /**< Input file (only if not mapped)                */
+    size_t next_id;      /**< Index of next packet (only if mapped)          */
+    bool is_mapped;      /**< Is the whole file mapped into memory           */
+
+    struct {
+        const uint8_t *data; /**< Mapped file (NULL if the file is empty)    */
+        size_t size;         /**< Size of the mapped file                    */
+        size_t *offsets;     /**< Offsets of packets in the file             */
+        size_t cnt;          /**< Number of packets in the file              */
+    } map;                   /**< Memory mapped file                         */
 
-    struct fds_ipfix_msg_hdr **packets_preload;  /**< Preloaded packets      */
     uint8_t packet_single[MAX_PACKET_SIZE];      /**< Internal buffer        */
 
     struct {
@@ -88,16 +97,16 @@ struct reader_internal {
 
     struct {
         bool   valid;      /**< Position validity flag                       */
-        fpos_t pos_offset; /**< Position (only for non-preloaded)            */
-        size_t pos_idx;    /**< Position (only for preloaded)                */
+        fpos_t pos_offset; /**< Position (only for not mapped)               */
+        size_t pos_idx;    /**< Position (only for mapped)                   */
     } pos;  /**< Pushed position in the file */
 };
 
 // Function prototypes
-static struct fds_ipfix_msg_hdr **
-reader_preload_packets(reader_t *reader);
+static enum READER_STATUS
+reader_map(reader_t *reader, bool preload);
 static void
-reader_free_preloaded_packets(struct fds_ipfix_msg_hdr **packets);
+reader_unmap(reader_t *reader);
 
 
 // Create a new packet reader
@@ -118,15 +127,15 @@ reader_create(const char *file, bool preload)
         return NULL;
     }
 
-    new_reader->is_preloaded = preload;
-    if (preload) {
-        new_reader->packets_preload = reader_preload_packets(new_reader);
-        if (new_reader->packets_preload == NULL) {
-            fclose(new_reader->file);
-            free(new_reader);
-            return NULL;
-        }
+    // Try to map the file into memory (not possible for pipes, etc.)
+    enum READER_STATUS status = reader_map(new_reader, preload);
+    if (status == READER_ERROR) {
+        fclose(new_reader->file);
+        free(new_reader);
+        return NULL;
+    }
 
+    if (status == READER_OK) {
         // We don't need file anymore...
         fclose(new_reader->file);
         new_reader->file = NULL;
@@ -144,8 +153,8 @@ reader_destroy(reader_t *reader)
         return;
     }
 
-    if (reader->is_preloaded) {
-        reader_free_preloaded_packets(reader->packets_preload);
+    if (reader->is_mapped) {
+        reader_unmap(reader);
     }
 
     if (reader->file) {
@@ -266,140 +275,173 @@ reader_load_packet_buffer(reader_t *reader, uint8_t *out_buffer,
 }
 
 /**
- * \brief Allocate a memory large enough and load the next packet from a file
- *   into it.
- *
- * User MUST manually free the packet later.
- * \note You should check EOF before calling this function.
- * \param[in] reader        Pointer to the packet reader
- * \param[out] packet_data  Pointer to newly allocated packet
- * \param[out] packet_size  Size of the new packet (can be NULL)
- * \return On success returns #READER_OK and fills the \p packet_data and
- *   \p packet_size. When end-of-file occurs, returns #READER_EOF. Otherwise
- *   (i.e. malformed packet, memory allocation error) returns #READER_ERROR.
+ * \brief Check the IPFIX header of a mapped packet
+ * \param[in] reader Pointer to the packet reader
+ * \param[in] offset Offset of the packet in the file
+ * \return On success returns the size of the packet. Otherwise (malformed packet) returns 0.
  */
-static enum READER_STATUS
-reader_load_packet_alloc(reader_t *reader, struct fds_ipfix_msg_hdr **packet_data,
-    uint16_t *packet_size)
+static uint16_t
+reader_map_check(const reader_t *reader, size_t offset)
 {
-    // Load the packet header
-    struct fds_ipfix_msg_hdr header;
-    uint8_t *result;
-
-    enum READER_STATUS status = reader_load_packet_header(reader, &header);
-    if (status != READER_OK) {
-        return status;
+    if (reader->map.size - offset < FDS_IPFIX_MSG_HDR_LEN) {
+        fprintf(stderr, "Unable to read a packet header (probably malformed packet).\n");
+        return 0;
     }
 
-    uint16_t new_size = ntohs(header.length);
-    result = (uint8_t *) malloc(new_size);
-    if (!result) {
-        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
-        return READER_ERROR;
+    const struct fds_ipfix_msg_hdr *header;
+    header = (const struct fds_ipfix_msg_hdr *) (reader->map.data + offset);
+    if (ntohs(header->version) != FDS_IPFIX_VERSION) {
+        fprintf(stderr, "Invalid version of a packet header.\n");
+        return 0;
     }
 
-    memcpy(result, (const uint8_t *) &header, FDS_IPFIX_MSG_HDR_LEN);
-    uint8_t *body_ptr = result + FDS_IPFIX_MSG_HDR_LEN;
-    uint16_t body_size = new_size - FDS_IPFIX_MSG_HDR_LEN;
-
-    if (body_size > 0 && fread(body_ptr, body_size, 1, reader->file) != 1) {
-        fprintf(stderr, "Unable to read a packet!\n");
-        free(result);
-        return READER_ERROR;
+    uint16_t size = ntohs(header->length);
+    if (size < FDS_IPFIX_MSG_HDR_LEN) {
+        fprintf(stderr, "Invalid size a packet in the packet header.\n");
+        return 0;
     }
 
-    if (packet_size) {
-        *packet_size = new_size;
+    if (reader->map.size - offset < size) {
+        fprintf(stderr, "Unable to read a packet!\n");
+        return 0;
     }
 
-    *packet_data = (struct fds_ipfix_msg_hdr *) result;
-    return READER_OK;
+    return size;
 }
 
 /**
- * \brief Read packets from IPFIX file and store them into memory
+ * \brief Create an index of packets in the mapped file
  *
- * Result represents a NULL-terminated array of pointers to the packets.
- * \param[in] reader  Pointer to the packet reader
- * \return On success returns a pointer to the array. Otherwise returns NULL.
+ * Offsets of all packets are stored, so packets can be accessed directly by their index.
+ * \param[in] reader Pointer to the packet reader
+ * \return On success returns #READER_OK. Otherwise (i.e. malformed packet, memory allocation
+ *   error) returns #READER_ERROR.
  */
-static struct fds_ipfix_msg_hdr **
-reader_preload_packets(reader_t *reader)
+static enum READER_STATUS
+reader_map_index(reader_t *reader)
 {
-    enum READER_STATUS status;
-    size_t pkt_cnt = 0;
-    size_t pkt_max = 2048;
-
-    struct fds_ipfix_msg_hdr **packets = calloc(pkt_max, sizeof(*packets));
-    if (!packets) {
+    size_t idx_max = INDEX_DEF_SIZE;
+    size_t idx_cnt = 0;
+    size_t *offsets = malloc(idx_max * sizeof(*offsets));
+    if (!offsets) {
         fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
-        return NULL;
+        return READER_ERROR;
     }
 
-    while (1) {
-        // Read packet
-        status = reader_load_packet_alloc(reader, &packets[pkt_cnt], NULL);
-        if (status == READER_EOF) {
-            break;
+    size_t offset = 0;
+    while (offset < reader->map.size) {
+        uint16_t size = reader_map_check(reader, offset);
+        if (size == 0) {
+            free(offsets);
+            return READER_ERROR;
         }
 
-        if (status != READER_OK) {
-            // Failed -> Delete all loaded packets
-            for (size_t i = 0; i < pkt_cnt; ++i) {
-                free(packets[i]);
+        if (idx_cnt == idx_max) {
+            // Resize the index
+            size_t new_max = 2 * idx_max;
+            size_t *new_offsets = realloc(offsets, new_max * sizeof(*offsets));
+            if (!new_offsets) {
+                fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+                free(offsets);
+                return READER_ERROR;
             }
 
-            free(packets);
-            return NULL;
-        }
-
-        // Move array index to next packet - resize array if needed
-        pkt_cnt++;
-        if (pkt_cnt < pkt_max) {
-            continue;
+            offsets = new_offsets;
+            idx_max = new_max;
         }
 
-        size_t new_max = 2 * pkt_max;
-        struct fds_ipfix_msg_hdr** new_packets;
+        offsets[idx_cnt++] = offset;
+        offset += size;
+    }
 
-        new_packets = realloc(packets, new_max * sizeof(*packets));
-        if (!new_packets) {
-            fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
-            // Failed -> Delete all loaded packets
-            for (size_t i = 0; i < pkt_cnt; ++i) {
-                free(packets[i]);
-            }
+    reader->map.offsets = offsets;
+    reader->map.cnt = idx_cnt;
+    return READER_OK;
+}
 
-            free(packets);
-            return NULL;
+/**
+ * \brief Map the file into memory and create an index of packets
+ *
+ * Packets are later sent directly from the mapping, so even large files don't have to fit
+ * into the memory.
+ * \param[in] reader  Pointer to the packet reader
+ * \param[in] preload Load the whole file into memory in advance
+ * \return On success returns #READER_OK. If the file cannot be mapped (e.g. it is not a regular
+ *   file), returns #READER_EOF and the file should be read sequentially. Otherwise (malformed
+ *   packet, memory allocation error) returns #READER_ERROR.
+ */
+static enum READER_STATUS
+reader_map(reader_t *reader, bool preload)
+{
+    int fd = fileno(reader->file);
+    struct stat file_info;
+    if (fstat(fd, &file_info) == -1 || !S_ISREG(file_info.st_mode)) {
+        return READER_EOF;
+    }
+
+    reader->map.size = (size_t) file_info.st_size;
+    reader->map.data = NULL;
+    if (reader->map.size > 0) {
+        int flags = MAP_PRIVATE | (preload ? MAP_POPULATE : 0);
+        void *data = mmap(NULL, reader->map.size, PROT_READ, flags, fd, 0);
+        if (data == MAP_FAILED) {
+            return READER_EOF;
         }
 
-        packets = new_packets;
-        pkt_max = new_max;
+        // Packets are usually read sequentially
+        madvise(data, reader->map.size, preload ? MADV_WILLNEED : MADV_SEQUENTIAL);
+        reader->map.data = data;
+    }
+
+    if (reader_map_index(reader) != READER_OK) {
+        if (reader->map.data != NULL) {
+            munmap((void *) reader->map.data, reader->map.size);
+        }
+        return READER_ERROR;
     }
 
-    packets[pkt_cnt] = NULL;
-    return packets;
+    reader->is_mapped = true;
+    return READER_OK;
 }
 
 /**
- * \brief Free allocated memory for packets
- * \param[in] packets Array of packets
+ * \brief Unmap the file and free the index of packets
+ * \param[in] reader Pointer to the packet reader
  */
 static void
-reader_free_preloaded_packets(struct fds_ipfix_msg_hdr **packets)
+reader_unmap(reader_t *reader)
 {
-
-    for (size_t i = 0; packets[i] != NULL; ++i) {
-        free(packets[i]);
+    if (reader->map.data != NULL) {
+        munmap((void *) reader->map.data, reader->map.size);
     }
 
-    free(packets);
+    free(reader->map.offsets);
+    reader->map.data = NULL;
+    reader->map.offsets = NULL;
+    reader->is_mapped = false;
 }
 
+/**
+ * \brief Get a mapped packet
+ * \param[in] reader Pointer to the packet reader
+ * \param[in] idx    Index of the packet
+ * \return Pointer to the packet or NULL (end of file)
+ */
+static inline const struct fds_ipfix_msg_hdr *
+reader_map_packet(const reader_t *reader, size_t idx)
+{
+    if (idx >= reader->map.cnt) {
+        return NULL;
+    }
 
-#include <inttypes.h>
+    return (const struct fds_ipfix_msg_hdr *) (reader->map.data + reader->map.offsets[idx]);
+}
 
+/**
+ * \brief Update the IPFIX header (ODID, Sequence number and Export Time)
+ * \param[in]     reader Pointer to the packet reader
+ * \param[in,out] hdr    Header to update
+ */
 static void
 reader_header_update(reader_t *reader, struct fds_ipfix_msg_hdr *hdr)
 {
@@ -453,7 +495,7 @@ reader_header_update(reader_t *reader, struct fds_ipfix_msg_hdr *hdr)
 void
 reader_rewind(reader_t *reader)
 {
-    if (reader->is_preloaded) {
+    if (reader->is_mapped) {
         reader->next_id = 0;
     } else {
         rewind(reader->file);
@@ -467,7 +509,7 @@ enum READER_STATUS
 reader_position_push(reader_t *reader)
 {
     reader->pos.valid = false;
-    if (reader->is_preloaded) {
+    if (reader->is_mapped) {
         reader->pos.pos_idx = reader->next_id;
     } else {
         if (fgetpos(reader->file, &reader->pos.pos_offset)) {
@@ -490,7 +532,7 @@ reader_position_pop(reader_t *reader)
     }
 
     reader->pos.valid = false;
-    if (reader->is_preloaded) {
+    if (reader->is_mapped) {
         reader->next_id = reader->pos.pos_idx;
     } else {
         if (fsetpos(reader->file, &reader->pos.pos_offset)) {
@@ -510,9 +552,9 @@ reader_get_next_packet(reader_t *reader, struct fds_ipfix_msg_hdr **output, uint
     struct fds_ipfix_msg_hdr *buffer;
     buffer = (struct fds_ipfix_msg_hdr *) reader->packet_single;
 
-    if (reader->is_preloaded) {
+    if (reader->is_mapped) {
         // Read from memory
-        const struct fds_ipfix_msg_hdr *packet = reader->packets_preload[reader->next_id];
+        const struct fds_ipfix_msg_hdr *packet = reader_map_packet(reader, reader->next_id);
         if (packet == NULL) {
             return READER_EOF;
         }
@@ -552,9 +594,9 @@ reader_get_next_header(reader_t *reader, struct fds_ipfix_msg_hdr **header)
     struct fds_ipfix_msg_hdr *header_buffer;
     header_buffer = (struct fds_ipfix_msg_hdr *) reader->packet_single;
 
-    if (reader->is_preloaded) {
+    if (reader->is_mapped) {
         // Read from memory
-        const struct fds_ipfix_msg_hdr *packet = reader->packets_preload[reader->next_id];
+        const struct fds_ipfix_msg_hdr *packet = reader_map_packet(reader, reader->next_id);
         if (packet == NULL) {
             return READER_EOF;
         }
@@ -585,6 +627,54 @@ reader_get_next_header(reader_t *reader, struct fds_ipfix_msg_hdr **header)
     return READER_OK;
 }
 
+// Get the next packet as I/O vectors
+enum READER_STATUS
+reader_get_next_iovec(reader_t *reader, struct fds_ipfix_msg_hdr *header, struct iovec iov[2])
+{
+    const uint8_t *packet;
+    if (reader->is_mapped) {
+        // Send directly from the mapped file
+        packet = (const uint8_t *) reader_map_packet(reader, reader->next_id);
+        if (packet == NULL) {
+            return READER_EOF;
+        }
+
+        ++reader->next_id;
+    } else {
+        // Read from the file into the internal buffer
+        size_t b_size = MAX_PACKET_SIZE;
+        enum READER_STATUS ret;
+
+        ret = reader_load_packet_buffer(reader, reader->packet_single, &b_size);
+        if (ret == READER_EOF) {
+            return READER_EOF;
+        }
+
+        if (ret != READER_OK) {
+            // Buffer should be big enough, so only an error can occur
+            return READER_ERROR;
+        }
+
+        packet = reader->packet_single;
+    }
+
+    // Only the header is copied and updated
+    memcpy(header, packet, FDS_IPFIX_MSG_HDR_LEN);
+    reader_header_update(reader, header);
+
+    iov[0].iov_base = header;
+    iov[0].iov_len = FDS_IPFIX_MSG_HDR_LEN;
+    iov[1].iov_base = (void *) (packet + FDS_IPFIX_MSG_HDR_LEN);
+    iov[1].iov_len = ntohs(header->length) - FDS_IPFIX_MSG_HDR_LEN;
+    return READER_OK;
+}
+
+bool
+reader_is_mapped(const reader_t *reader)
+{
+    return reader->is_mapped;
+}
+
 void
 reader_odid_rewrite(reader_t *reader, uint32_t odid)
 {
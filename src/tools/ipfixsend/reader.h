@@ -39,6 +39,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <sys/uio.h>
 #include <libfds.h>
 
 #ifndef READER_H
@@ -59,8 +60,12 @@ typedef struct reader_internal reader_t;
 
 /**
  * \brief Create a new packet reader
+ *
+ * If possible (i.e. the file is a regular file), the file is mapped into memory and offsets of
+ * all IPFIX Messages are indexed. Messages are then accessed directly in the mapping without
+ * reading the file again. Otherwise, the file is read sequentially.
  * \param[in] file     Path to the IPFIX file
- * \param[in] preload  Preload all IPFIX record to an internal buffer
+ * \param[in] preload  Load the whole file into memory in advance (if the file can be mapped)
  * \return On success returns a new pointer to instance of the reader. Otherwise
  *   returns NULL.
  */
@@ -140,6 +145,34 @@ reader_get_next_packet(reader_t *reader, struct fds_ipfix_msg_hdr **output,
 enum READER_STATUS
 reader_get_next_header(reader_t *reader, struct fds_ipfix_msg_hdr **header);
 
+/**
+ * \brief Get the next packet as I/O vectors (without copying the whole packet)
+ *
+ * Only the header of the packet is copied to the user defined \p header and updated
+ * (ODID rewrite and automatic update, see reader_odid_rewrite() and reader_header_autoupdate()).
+ * The first vector refers to the \p header and the second one to the rest of the packet.
+ * If the file is mapped (see reader_is_mapped()), the rest of the packet refers directly to
+ * the mapped file and it is valid until the reader is destroyed. Otherwise, it is stored in
+ * an internal buffer and it is overwritten by the next call of any reader_get_next_*()
+ * function.
+ * \warning The rest of the packet MUST NOT be modified.
+ * \param[in]  reader Pointer to the packet reader
+ * \param[out] header Buffer for the header of the packet
+ * \param[out] iov    I/O vectors of the packet (header and the rest of the packet)
+ * \return On success returns #READER_OK and fills the \p header and \p iov. Otherwise returns
+ *   #READER_EOF (end of file) or #READER_ERROR (malformed input file).
+ */
+enum READER_STATUS
+reader_get_next_iovec(reader_t *reader, struct fds_ipfix_msg_hdr *header, struct iovec iov[2]);
+
+/**
+ * \brief Check whether the file is mapped into memory
+ * \param[in] reader Pointer to the packet reader
+ * \return True or false
+ */
+bool
+reader_is_mapped(const reader_t *reader);
+
 /**
  * \brief Rewrite ODID of all IPFIX Messages
  * \param[in] reader Pointer to the packet reader
@@ -0,0 +1,538 @@
+/**
+ * \file ipfixsend/vexp.c
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Multi-threaded sending from many virtual exporters over UDP
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "vexp.h"
+#include "reader.h"
+
+/** Maximum IPFIX packet size (2^16) */
+#define VEXP_PKT_MAX 65536
+/** 1 second in nanoseconds          */
+#define VEXP_NANO_SEC 1000000000LL
+
+/** Global termination flag          */
+static volatile sig_atomic_t vexp_stop_flag = 0;
+
+/** Sending thread */
+struct vexp_thread {
+    /** Thread identification                                  */
+    pthread_t id;
+    /** Index of the thread                                    */
+    unsigned int idx;
+    /** Configuration of the sender                            */
+    const struct vexp_cfg *cfg;
+    /** File reader (each thread has its own)                  */
+    reader_t *reader;
+
+    /** Sockets of virtual exporters of the thread             */
+    int *sockets;
+    /** Number of sockets                                      */
+    unsigned int sock_cnt;
+    /** Speed limit of the thread in packets/s (0 = unlimited) */
+    double packets_s;
+
+    /** Buffer for a batch of messages (only if the file is not mapped) */
+    uint8_t *buffer;
+    /** Updated headers of messages of the batch               */
+    struct fds_ipfix_msg_hdr *hdrs;
+    /** Descriptions of messages of the batch                  */
+    struct mmsghdr *msgs;
+    /** I/O vectors of messages of the batch (2 per message)   */
+    struct iovec *iovs;
+
+    /** Number of sent messages                                */
+    uint64_t sent_pkts;
+    /** Number of sent bytes                                   */
+    uint64_t sent_bytes;
+    /** Result of the thread (0 = success)                     */
+    int status;
+};
+
+void vexp_stop()
+{
+    vexp_stop_flag = 1;
+}
+
+/**
+ * \brief Get the source address of a virtual exporter
+ *
+ * The address is the first source address increased by the index of the exporter.
+ * \param[in]  base   First source address
+ * \param[in]  family Address family of the first address
+ * \param[in]  idx    Index of the exporter
+ * \param[out] addr   Source address (with an ephemeral port)
+ * \return Size of the address
+ */
+static socklen_t
+vexp_src_addr(const struct in6_addr *base, int family, unsigned int idx,
+    struct sockaddr_storage *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    if (family == AF_INET) {
+        struct sockaddr_in *addr4 = (struct sockaddr_in *) addr;
+        uint32_t ip4;
+        memcpy(&ip4, base, sizeof(ip4));
+        addr4->sin_family = AF_INET;
+        addr4->sin_addr.s_addr = htonl(ntohl(ip4) + idx);
+        return sizeof(*addr4);
+    }
+
+    struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *) addr;
+    uint32_t ip6_low;
+    addr6->sin6_family = AF_INET6;
+    addr6->sin6_addr = *base;
+    memcpy(&ip6_low, &addr6->sin6_addr.s6_addr[12], sizeof(ip6_low));
+    ip6_low = htonl(ntohl(ip6_low) + idx);
+    memcpy(&addr6->sin6_addr.s6_addr[12], &ip6_low, sizeof(ip6_low));
+    return sizeof(*addr6);
+}
+
+/**
+ * \brief Create sockets of all virtual exporters
+ *
+ * Each socket is bound to its own source address (if defined) or an ephemeral port and
+ * connected to the destination.
+ * \param[in]  cfg     Configuration
+ * \param[out] sockets Array of sockets (size = number of exporters)
+ * \return On success returns 0. Otherwise returns nonzero value and no sockets are opened.
+ */
+static int
+vexp_sockets_open(const struct vexp_cfg *cfg, int *sockets)
+{
+    struct in6_addr src_base;
+    int src_family = AF_UNSPEC;
+    if (cfg->src_ip != NULL) {
+        if (inet_pton(AF_INET, cfg->src_ip, &src_base) == 1) {
+            src_family = AF_INET;
+        } else if (inet_pton(AF_INET6, cfg->src_ip, &src_base) == 1) {
+            src_family = AF_INET6;
+        } else {
+            fprintf(stderr, "Invalid source IP address '%s'.\n", cfg->src_ip);
+            return 1;
+        }
+    }
+
+    struct addrinfo hints;
+    struct addrinfo *dst_info;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = src_family;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+
+    int ret = getaddrinfo(cfg->dst_ip, cfg->dst_port, &hints, &dst_info);
+    if (ret != 0) {
+        fprintf(stderr, "Unable to get the destination address: %s\n", gai_strerror(ret));
+        return 1;
+    }
+
+    unsigned int idx;
+    for (idx = 0; idx < cfg->exporters; ++idx) {
+        int fd = socket(dst_info->ai_family, SOCK_DGRAM, IPPROTO_UDP);
+        if (fd == -1) {
+            fprintf(stderr, "Unable to create a socket: %s\n", strerror(errno));
+            break;
+        }
+
+        if (src_family != AF_UNSPEC) {
+            struct sockaddr_storage src_addr;
+            socklen_t src_len = vexp_src_addr(&src_base, src_family, idx, &src_addr);
+            if (bind(fd, (struct sockaddr *) &src_addr, src_len) == -1) {
+                char ip_str[INET6_ADDRSTRLEN];
+                const void *ip_ptr = (src_family == AF_INET)
+                    ? (const void *) &((struct sockaddr_in *) &src_addr)->sin_addr
+                    : (const void *) &((struct sockaddr_in6 *) &src_addr)->sin6_addr;
+                inet_ntop(src_family, ip_ptr, ip_str, sizeof(ip_str));
+                fprintf(stderr, "Unable to bind the source address '%s' (is it configured on "
+                    "a local interface?): %s\n", ip_str, strerror(errno));
+                close(fd);
+                break;
+            }
+        }
+
+        if (connect(fd, dst_info->ai_addr, dst_info->ai_addrlen) == -1) {
+            fprintf(stderr, "Unable to connect to the destination: %s\n", strerror(errno));
+            close(fd);
+            break;
+        }
+
+        sockets[idx] = fd;
+    }
+
+    freeaddrinfo(dst_info);
+    if (idx == cfg->exporters) {
+        return 0;
+    }
+
+    // Failed -> close already opened sockets
+    for (unsigned int i = 0; i < idx; ++i) {
+        close(sockets[i]);
+    }
+    return 1;
+}
+
+/**
+ * \brief Read the next batch of messages from the file
+ * \param[in] thread Thread data
+ * \return Number of messages in the batch (0 = end of file) or a negative number on error
+ */
+static int
+vexp_batch_read(struct vexp_thread *thread)
+{
+    unsigned int cnt;
+    for (cnt = 0; cnt < thread->cfg->batch; ++cnt) {
+        struct iovec *iov = &thread->iovs[2 * cnt];
+        enum READER_STATUS status;
+
+        // Only headers are copied, the rest of messages is sent directly from the mapped file
+        status = reader_get_next_iovec(thread->reader, &thread->hdrs[cnt], iov);
+        if (status == READER_EOF) {
+            break;
+        }
+
+        if (status != READER_OK) {
+            return -1;
+        }
+
+        if (thread->buffer != NULL) {
+            // The reader overwrites its internal buffer, therefore, the message must be copied
+            uint8_t *dst = thread->buffer + ((size_t) cnt * VEXP_PKT_MAX);
+            memcpy(dst, iov[1].iov_base, iov[1].iov_len);
+            iov[1].iov_base = dst;
+        }
+    }
+
+    return (int) cnt;
+}
+
+/**
+ * \brief Send a batch of messages by a socket
+ * \param[in] thread Thread data
+ * \param[in] fd     Socket
+ * \param[in] cnt    Number of messages in the batch
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+static int
+vexp_batch_send(struct vexp_thread *thread, int fd, unsigned int cnt)
+{
+    unsigned int done = 0;
+    while (done < cnt && vexp_stop_flag == 0) {
+        int ret = sendmmsg(fd, &thread->msgs[done], cnt - done, MSG_NOSIGNAL);
+        if (ret == -1) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Probably a signal occurred. Try again.
+                continue;
+            }
+
+            fprintf(stderr, "Network error: %s\n", strerror(errno));
+            return 1;
+        }
+
+        for (unsigned int i = done; i < done + (unsigned int) ret; ++i) {
+            thread->sent_bytes += ntohs(thread->hdrs[i].length);
+        }
+        thread->sent_pkts += (uint64_t) ret;
+        done += (unsigned int) ret;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Wait until a number of messages can be sent (only if the speed is limited)
+ * \param[in]     thread Thread data
+ * \param[in,out] next   Time when the messages can be sent (updated for the next messages)
+ * \param[in]     cnt    Number of messages to send
+ */
+static void
+vexp_rate_wait(const struct vexp_thread *thread, struct timespec *next, unsigned int cnt)
+{
+    if (thread->packets_s <= 0.0) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > next->tv_sec + 1) {
+        // Too late (e.g. blocked by the network stack), don't try to catch up
+        *next = now;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, next, NULL) == EINTR
+            && vexp_stop_flag == 0);
+
+    long long step = (long long) (cnt * (VEXP_NANO_SEC / thread->packets_s));
+    step += next->tv_nsec;
+    next->tv_sec += (time_t) (step / VEXP_NANO_SEC);
+    next->tv_nsec = (long) (step % VEXP_NANO_SEC);
+}
+
+/**
+ * \brief Main function of a sending thread
+ * \param[in] arg Thread data
+ * \return NULL
+ */
+static void *
+vexp_thread_main(void *arg)
+{
+    struct vexp_thread *thread = (struct vexp_thread *) arg;
+    const struct vexp_cfg *cfg = thread->cfg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (int i = 0; vexp_stop_flag == 0 && (cfg->loops < 0 || i < cfg->loops); ++i) {
+        reader_rewind(thread->reader);
+
+        while (vexp_stop_flag == 0) {
+            int cnt = vexp_batch_read(thread);
+            if (cnt < 0) {
+                thread->status = 1;
+                return NULL;
+            }
+
+            if (cnt == 0) {
+                // End of file
+                break;
+            }
+
+            // The same batch is sent by all exporters of the thread
+            for (unsigned int s = 0; s < thread->sock_cnt && vexp_stop_flag == 0; ++s) {
+                vexp_rate_wait(thread, &next, (unsigned int) cnt);
+                if (vexp_batch_send(thread, thread->sockets[s], (unsigned int) cnt) != 0) {
+                    thread->status = 1;
+                    return NULL;
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Initialize a sending thread (without starting)
+ * \param[in] thread  Thread data (zeroed)
+ * \param[in] cfg     Configuration
+ * \param[in] idx     Index of the thread
+ * \param[in] sockets Sockets of all virtual exporters
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+static int
+vexp_thread_init(struct vexp_thread *thread, const struct vexp_cfg *cfg, unsigned int idx,
+    int *sockets)
+{
+    // Exporters are evenly distributed among threads
+    const unsigned int exp_per_thread = cfg->exporters / cfg->threads;
+    const unsigned int exp_rest = cfg->exporters % cfg->threads;
+    const unsigned int exp_first = idx * exp_per_thread + ((idx < exp_rest) ? idx : exp_rest);
+
+    thread->idx = idx;
+    thread->cfg = cfg;
+    thread->sockets = &sockets[exp_first];
+    thread->sock_cnt = exp_per_thread + ((idx < exp_rest) ? 1 : 0);
+    thread->packets_s = ((double) cfg->packets_s * thread->sock_cnt) / cfg->exporters;
+
+    thread->reader = reader_create(cfg->input, cfg->precache);
+    if (!thread->reader) {
+        return 1;
+    }
+
+    if (cfg->odid_rewrite) {
+        reader_odid_rewrite(thread->reader, cfg->odid_new);
+    }
+
+    if (cfg->loops != 1) {
+        reader_header_autoupdate(thread->reader, true);
+    }
+
+    if (!reader_is_mapped(thread->reader)) {
+        /* The input is a stream (e.g. a pipe), so each message can be read only once and only by
+         * one reader. Multiple threads would split messages between them.
+         */
+        if (cfg->threads > 1 || cfg->loops != 1) {
+            fprintf(stderr, "The input cannot be memory-mapped (e.g. a pipe), so it can be sent "
+                "only by one thread (-T 1) and only once (-n 1).\n");
+            return 1;
+        }
+
+        thread->buffer = malloc((size_t) cfg->batch * VEXP_PKT_MAX);
+        if (!thread->buffer) {
+            fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+            return 1;
+        }
+    }
+
+    thread->hdrs = calloc(cfg->batch, sizeof(*thread->hdrs));
+    thread->msgs = calloc(cfg->batch, sizeof(*thread->msgs));
+    thread->iovs = calloc(2 * cfg->batch, sizeof(*thread->iovs));
+    if (!thread->hdrs || !thread->msgs || !thread->iovs) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        return 1;
+    }
+
+    for (unsigned int i = 0; i < cfg->batch; ++i) {
+        thread->msgs[i].msg_hdr.msg_iov = &thread->iovs[2 * i];
+        thread->msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Free resources of a sending thread
+ * \param[in] thread Thread data
+ */
+static void
+vexp_thread_destroy(struct vexp_thread *thread)
+{
+    reader_destroy(thread->reader);
+    free(thread->buffer);
+    free(thread->hdrs);
+    free(thread->msgs);
+    free(thread->iovs);
+}
+
+int vexp_send(const struct vexp_cfg *cfg)
+{
+    if (cfg->threads == 0 || cfg->exporters < cfg->threads) {
+        fprintf(stderr, "The number of exporters must be at least the number of threads.\n");
+        return 1;
+    }
+
+    if (cfg->batch == 0 || cfg->batch > VEXP_BATCH_MAX) {
+        fprintf(stderr, "The batch size must be in range (1 .. %d).\n", VEXP_BATCH_MAX);
+        return 1;
+    }
+
+    int *sockets = calloc(cfg->exporters, sizeof(*sockets));
+    struct vexp_thread *threads = calloc(cfg->threads, sizeof(*threads));
+    if (!sockets || !threads) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        free(sockets);
+        free(threads);
+        return 1;
+    }
+
+    if (vexp_sockets_open(cfg, sockets) != 0) {
+        free(sockets);
+        free(threads);
+        return 1;
+    }
+
+    int ret = 0;
+    unsigned int running = 0;
+    for (unsigned int i = 0; i < cfg->threads; ++i) {
+        if (vexp_thread_init(&threads[i], cfg, i, sockets) != 0) {
+            ret = 1;
+            break;
+        }
+    }
+
+    struct timespec ts_start, ts_end;
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+    // Start threads (signals are handled only by the main thread)
+    sigset_t set_new, set_old;
+    sigfillset(&set_new);
+    pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
+    for (; ret == 0 && running < cfg->threads; ++running) {
+        int rc = pthread_create(&threads[running].id, NULL, &vexp_thread_main, &threads[running]);
+        if (rc != 0) {
+            fprintf(stderr, "Unable to start a sending thread: %s\n", strerror(rc));
+            vexp_stop();
+            ret = 1;
+            break;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &set_old, NULL);
+
+    uint64_t sent_pkts = 0;
+    uint64_t sent_bytes = 0;
+    for (unsigned int i = 0; i < running; ++i) {
+        pthread_join(threads[i].id, NULL);
+        sent_pkts += threads[i].sent_pkts;
+        sent_bytes += threads[i].sent_bytes;
+        if (threads[i].status != 0) {
+            ret = 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+
+    for (unsigned int i = 0; i < cfg->threads; ++i) {
+        vexp_thread_destroy(&threads[i]);
+    }
+
+    for (unsigned int i = 0; i < cfg->exporters; ++i) {
+        close(sockets[i]);
+    }
+
+    free(threads);
+    free(sockets);
+
+    if (running > 0) {
+        double duration = (double) (ts_end.tv_sec - ts_start.tv_sec)
+            + (double) (ts_end.tv_nsec - ts_start.tv_nsec) / VEXP_NANO_SEC;
+        if (duration <= 0.0) {
+            duration = 1e-9;
+        }
+
+        printf("Sent %" PRIu64 " messages (%" PRIu64 " bytes) from %u exporter(s) by %u "
+            "thread(s) in %.3f s (%.0f msg/s, %.2f Mbps)\n", sent_pkts, sent_bytes,
+            cfg->exporters, running, duration, sent_pkts / duration,
+            (sent_bytes * 8.0) / duration / 1e6);
+    }
+
+    return ret;
+}
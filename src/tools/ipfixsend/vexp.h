@@ -0,0 +1,108 @@
+/**
+ * \file ipfixsend/vexp.h
+ * \author Lukas Hutak <lukas.hutak@cesnet.cz>
+ * \brief Multi-threaded sending from many virtual exporters over UDP
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef VEXP_H
+#define VEXP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Default number of messages sent by one system call */
+#define VEXP_BATCH_DEF 32
+/** Maximum number of messages sent by one system call */
+#define VEXP_BATCH_MAX 1024
+
+/**
+ * \brief Configuration of virtual exporters
+ *
+ * Each virtual exporter has its own UDP socket, so the collector sees it as an independent
+ * Transport Session. Every exporter replays the whole input file, therefore, it sends all
+ * (Options) Templates of the file and has its own sequence numbers.
+ */
+struct vexp_cfg {
+    /** Path to the IPFIX file                                                      */
+    const char *input;
+    /** Load the whole file into memory in advance                                  */
+    bool precache;
+    /** Destination IP address                                                      */
+    const char *dst_ip;
+    /** Destination port                                                            */
+    const char *dst_port;
+    /**
+     * First source IP address (NULL = use the default address).
+     * The exporter N uses the address increased by N (e.g. 127.0.1.1, 127.0.1.2, ...).
+     * If not defined, exporters are distinguished only by (ephemeral) source ports.
+     */
+    const char *src_ip;
+
+    /** Number of sending threads                                                   */
+    unsigned int threads;
+    /** Number of virtual exporters (at least the number of threads)                */
+    unsigned int exporters;
+    /** Maximum number of messages sent by one sendmmsg() call                      */
+    unsigned int batch;
+
+    /** How many times the file should be sent by each exporter (-1 = infinity)     */
+    int loops;
+    /** Speed limit of all exporters together in packets/s (0 = unlimited)          */
+    uint64_t packets_s;
+    /** Rewrite Observation Domain ID                                               */
+    bool odid_rewrite;
+    /** New Observation Domain ID                                                   */
+    uint32_t odid_new;
+};
+
+/**
+ * \brief Send the file from all virtual exporters
+ *
+ * The function returns after all exporters have sent the file the configured number of times,
+ * the sending has been interrupted (see vexp_stop()) or a fatal error has occurred. Statistics
+ * of the transfer are printed on the standard output.
+ * \param[in] cfg Configuration
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+int vexp_send(const struct vexp_cfg *cfg);
+
+/**
+ * \brief Stop sending data (async-signal-safe)
+ */
+void vexp_stop();
+
+#endif /* VEXP_H */
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <core/epoch.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/// Destruction callback that increments a counter
+static void
+counter_inc(void *object)
+{
+    __atomic_add_fetch(static_cast<int *>(object), 1, __ATOMIC_SEQ_CST);
+}
+
+// Without references, retired objects are destroyed immediately
+TEST(Epoch, retireUnreferenced)
+{
+    int cnt = 0;
+    ASSERT_EQ(ipx_epoch_retire(&cnt, &counter_inc), IPX_OK);
+    EXPECT_EQ(cnt, 1);
+    ASSERT_EQ(ipx_epoch_retire(&cnt, &counter_inc), IPX_OK);
+    EXPECT_EQ(cnt, 2);
+}
+
+// Objects are destroyed after the last reference of the epoch is removed
+TEST(Epoch, retireReferenced)
+{
+    int cnt = 0;
+    uint64_t e1 = ipx_epoch_enter();
+    uint64_t e2 = ipx_epoch_enter();
+    EXPECT_EQ(e1, e2);
+
+    ASSERT_EQ(ipx_epoch_retire(&cnt, &counter_inc), IPX_OK);
+    EXPECT_EQ(cnt, 0);
+    ipx_epoch_leave(e1);
+    EXPECT_EQ(cnt, 0);
+    ipx_epoch_leave(e2);
+    EXPECT_EQ(cnt, 1);
+}
+
+// References of newer epochs don't block objects retired before
+TEST(Epoch, newerEpoch)
+{
+    int cnt_old = 0;
+    int cnt_new = 0;
+    uint64_t e_old = ipx_epoch_enter();
+    ASSERT_EQ(ipx_epoch_retire(&cnt_old, &counter_inc), IPX_OK);
+
+    uint64_t e_new = ipx_epoch_enter();
+    EXPECT_GT(e_new, e_old);
+    ASSERT_EQ(ipx_epoch_retire(&cnt_new, &counter_inc), IPX_OK);
+
+    ipx_epoch_leave(e_old);
+    EXPECT_EQ(cnt_old, 1);
+    EXPECT_EQ(cnt_new, 0);
+    ipx_epoch_leave(e_new);
+    EXPECT_EQ(cnt_new, 1);
+}
+
+// Younger epochs are reclaimed only after older ones
+TEST(Epoch, order)
+{
+    int cnt_old = 0;
+    int cnt_new = 0;
+    uint64_t e_old = ipx_epoch_enter();
+    ASSERT_EQ(ipx_epoch_retire(&cnt_old, &counter_inc), IPX_OK);
+    uint64_t e_new = ipx_epoch_enter();
+    ASSERT_EQ(ipx_epoch_retire(&cnt_new, &counter_inc), IPX_OK);
+
+    ipx_epoch_leave(e_new);
+    EXPECT_EQ(cnt_old, 0);
+    EXPECT_EQ(cnt_new, 0);
+    ipx_epoch_leave(e_old);
+    EXPECT_EQ(cnt_old, 1);
+    EXPECT_EQ(cnt_new, 1);
+}
+
+// A pinned epoch is inherited by new references
+TEST(Epoch, pin)
+{
+    int cnt = 0;
+    uint64_t e_old = ipx_epoch_enter();
+    ASSERT_EQ(ipx_epoch_retire(&cnt, &counter_inc), IPX_OK);
+
+    ipx_epoch_pin(e_old);
+    uint64_t e_derived = ipx_epoch_enter();
+    ipx_epoch_unpin();
+    EXPECT_EQ(e_derived, e_old);
+    uint64_t e_new = ipx_epoch_enter();
+    EXPECT_NE(e_new, e_old);
+    ipx_epoch_leave(e_new);
+
+    ipx_epoch_leave(e_old);
+    EXPECT_EQ(cnt, 0);
+    ipx_epoch_leave(e_derived);
+    EXPECT_EQ(cnt, 1);
+}
+
+// More epochs than available slots
+TEST(Epoch, manyEpochs)
+{
+    const size_t epoch_cnt = 1000;
+    int cnt = 0;
+    std::vector<uint64_t> epochs;
+
+    for (size_t i = 0; i < epoch_cnt; ++i) {
+        epochs.push_back(ipx_epoch_enter());
+        ASSERT_EQ(ipx_epoch_retire(&cnt, &counter_inc), IPX_OK);
+    }
+
+    EXPECT_EQ(cnt, 0);
+    for (uint64_t epoch : epochs) {
+        ipx_epoch_leave(epoch);
+    }
+    EXPECT_EQ(cnt, (int) epoch_cnt);
+}
+
+// Flush destroys objects regardless of references
+TEST(Epoch, flush)
+{
+    int cnt = 0;
+    uint64_t epoch = ipx_epoch_enter();
+    ASSERT_EQ(ipx_epoch_retire(&cnt, &counter_inc), IPX_OK);
+    ipx_epoch_flush();
+    EXPECT_EQ(cnt, 1);
+    ipx_epoch_leave(epoch);
+    EXPECT_EQ(cnt, 1);
+}
+
+// Concurrent references and retirement
+TEST(Epoch, threads)
+{
+    const int thread_cnt = 4;
+    const int iter_cnt = 10000;
+    int cnt = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_cnt; ++i) {
+        threads.emplace_back([&cnt, iter_cnt]() {
+            for (int j = 0; j < iter_cnt; ++j) {
+                uint64_t epoch = ipx_epoch_enter();
+                if (j % 16 == 0) {
+                    ipx_epoch_retire(&cnt, &counter_inc);
+                }
+                ipx_epoch_leave(epoch);
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Nothing is referenced, so everything must be destroyed
+    EXPECT_EQ(__atomic_load_n(&cnt, __ATOMIC_SEQ_CST), thread_cnt * ((iter_cnt + 15) / 16));
+}
@@ -0,0 +1,366 @@
+#include <gtest/gtest.h>
+#include <ipfixcol2.h>
+
+#include <set>
+#include <map>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <cstdint>
+#include <arpa/inet.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/// Selection of fields by IANA Information Element ID
+struct select_ids {
+    std::set<uint16_t> ids;
+    unsigned int calls = 0;
+};
+
+static bool
+select_cb(const struct fds_tfield *field, void *data)
+{
+    auto *sel = reinterpret_cast<select_ids *>(data);
+    sel->calls++;
+    return field->en == 0 && sel->ids.count(field->id) != 0;
+}
+
+/// Mapping of IANA Information Element IDs to private data
+struct map_ids {
+    std::map<uint16_t, std::string> ids;
+    unsigned int calls = 0;
+};
+
+static const void *
+map_cb(const struct fds_template *tmplt, uint16_t idx, void *data)
+{
+    auto *map = reinterpret_cast<map_ids *>(data);
+    map->calls++;
+    const struct fds_tfield *field = &tmplt->fields[idx];
+    if (field->en != 0) {
+        return nullptr;
+    }
+
+    auto it = map->ids.find(field->id);
+    return (it != map->ids.end()) ? &it->second : nullptr;
+}
+
+/// Simple wrapper around a parsed template
+class Tmplt {
+private:
+    std::vector<uint8_t> raw;
+    struct fds_template *tmplt = nullptr;
+public:
+    /// Create a template from pairs (IE ID, length)
+    Tmplt(uint16_t id, const std::vector<std::pair<uint16_t, uint16_t>> &fields) {
+        auto add_u16 = [this](uint16_t val) {
+            raw.push_back(uint8_t(val >> 8));
+            raw.push_back(uint8_t(val & 0xFF));
+        };
+
+        add_u16(id);
+        add_u16(uint16_t(fields.size()));
+        for (const auto &field : fields) {
+            add_u16(field.first);
+            add_u16(field.second);
+        }
+
+        uint16_t size = uint16_t(raw.size());
+        if (fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &size, &tmplt) != FDS_OK) {
+            throw std::runtime_error("Failed to parse a template");
+        }
+    };
+    ~Tmplt() {fds_template_destroy(tmplt);};
+    const struct fds_template *get() const {return tmplt;};
+};
+
+/// Template with fixed offsets of all fields
+class Static : public ::testing::Test {
+protected:
+    // sourceIPv4Address, destinationIPv4Address, sourceTransportPort, destinationTransportPort,
+    // flowStartSeconds, flowEndMilliseconds
+    Tmplt tmplt {256, {{8, 4}, {12, 4}, {7, 2}, {11, 2}, {150, 4}, {153, 8}}};
+    uint8_t data[24];
+    struct fds_drec rec;
+
+    void SetUp() override {
+        for (size_t i = 0; i < sizeof(data); ++i) {
+            data[i] = uint8_t(i);
+        }
+
+        rec.data = data;
+        rec.size = sizeof(data);
+        rec.tmplt = tmplt.get();
+        rec.snap = nullptr;
+    }
+};
+
+/// Template with variable-length fields
+class Dynamic : public ::testing::Test {
+protected:
+    // sourceIPv4Address, interfaceName, destinationIPv4Address, interfaceDescription,
+    // flowStartSeconds
+    Tmplt tmplt {257, {{8, 4}, {82, 65535}, {12, 4}, {83, 65535}, {150, 4}}};
+    uint8_t data[24] = {
+        1, 2, 3, 4,               // sourceIPv4Address
+        3, 'a', 'b', 'c',         // interfaceName (short length format)
+        5, 6, 7, 8,               // destinationIPv4Address
+        255, 0, 5, 'd', 'e', 'f', 'g', 'h', // interfaceDescription (long length format)
+        9, 10, 11, 12             // flowStartSeconds
+    };
+    struct fds_drec rec;
+
+    void SetUp() override {
+        rec.data = data;
+        rec.size = sizeof(data);
+        rec.tmplt = tmplt.get();
+        rec.snap = nullptr;
+    }
+};
+
+TEST_F(Static, selectTimestamps)
+{
+    select_ids ids;
+    ids.ids = {150, 151, 152, 153, 154, 155, 156, 157};
+    ipx_fsel_t *sel = ipx_fsel_create(&select_cb, &ids);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res, nullptr);
+    ASSERT_EQ(res->cnt, 2U);
+    EXPECT_FALSE(res->dynamic);
+    EXPECT_EQ(res->idx[0], 4U);
+    EXPECT_EQ(res->idx[1], 5U);
+
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, res, &rec);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[12]);
+    EXPECT_EQ(it.field.size, 4U);
+    EXPECT_EQ(it.field.info->id, 150U);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[16]);
+    EXPECT_EQ(it.field.size, 8U);
+    EXPECT_EQ(it.field.info->id, 153U);
+    EXPECT_EQ(ipx_fsel_iter_next(&it), IPX_EOC);
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Static, noMatch)
+{
+    select_ids ids;
+    ids.ids = {1, 2};
+    ipx_fsel_t *sel = ipx_fsel_create(&select_cb, &ids);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->cnt, 0U);
+
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, res, &rec);
+    EXPECT_EQ(ipx_fsel_iter_next(&it), IPX_EOC);
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Static, cached)
+{
+    select_ids ids;
+    ids.ids = {8, 12};
+    ipx_fsel_t *sel = ipx_fsel_create(&select_cb, &ids);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res1 = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res1, nullptr);
+    const unsigned int calls = ids.calls;
+    EXPECT_EQ(calls, tmplt.get()->fields_cnt_total);
+
+    // The matching function must not be called again
+    const struct ipx_fsel_result *res2 = ipx_fsel_get(sel, tmplt.get());
+    EXPECT_EQ(res1, res2);
+    EXPECT_EQ(ids.calls, calls);
+
+    // Other templates are processed separately
+    Tmplt other {300, {{12, 4}, {8, 4}, {4, 1}}};
+    const struct ipx_fsel_result *res3 = ipx_fsel_get(sel, other.get());
+    ASSERT_NE(res3, nullptr);
+    EXPECT_EQ(res3->cnt, 2U);
+    EXPECT_EQ(res3->idx[0], 0U);
+    EXPECT_EQ(res3->idx[1], 1U);
+    EXPECT_EQ(ids.calls, calls + 3);
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Static, manyTemplates)
+{
+    select_ids ids;
+    ids.ids = {12};
+    ipx_fsel_t *sel = ipx_fsel_create(&select_cb, &ids);
+    ASSERT_NE(sel, nullptr);
+
+    // Enforce resizing of the internal table
+    std::vector<std::unique_ptr<Tmplt>> tmplts;
+    for (uint16_t i = 0; i < 500; ++i) {
+        tmplts.emplace_back(new Tmplt(uint16_t(256 + i), {{8, 4}, {12, 4}}));
+        const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplts.back()->get());
+        ASSERT_NE(res, nullptr);
+        ASSERT_EQ(res->cnt, 1U);
+    }
+
+    const unsigned int calls = ids.calls;
+    for (const auto &ptr : tmplts) {
+        const struct ipx_fsel_result *res = ipx_fsel_get(sel, ptr->get());
+        ASSERT_NE(res, nullptr);
+        ASSERT_EQ(res->cnt, 1U);
+        EXPECT_EQ(res->idx[0], 1U);
+    }
+    EXPECT_EQ(ids.calls, calls);
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Dynamic, selectAfterVariableFields)
+{
+    select_ids ids;
+    ids.ids = {12, 83, 150};
+    ipx_fsel_t *sel = ipx_fsel_create(&select_cb, &ids);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res, nullptr);
+    ASSERT_EQ(res->cnt, 3U);
+    EXPECT_TRUE(res->dynamic);
+
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, res, &rec);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[8]);
+    EXPECT_EQ(it.field.size, 4U);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[15]);
+    EXPECT_EQ(it.field.size, 5U);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[20]);
+    EXPECT_EQ(it.field.size, 4U);
+    EXPECT_EQ(ipx_fsel_iter_next(&it), IPX_EOC);
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Dynamic, selectOnlyLast)
+{
+    select_ids ids;
+    ids.ids = {150, 82};
+    ipx_fsel_t *sel = ipx_fsel_create(&select_cb, &ids);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res, nullptr);
+    ASSERT_EQ(res->cnt, 2U);
+
+    // The same selection can be used for multiple records
+    for (int i = 0; i < 2; ++i) {
+        struct ipx_fsel_iter it;
+        ipx_fsel_iter_init(&it, res, &rec);
+        ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+        EXPECT_EQ(it.field.data, &data[5]);
+        EXPECT_EQ(it.field.size, 3U);
+        EXPECT_EQ(it.field.info->id, 82U);
+        ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+        EXPECT_EQ(it.field.data, &data[20]);
+        EXPECT_EQ(it.field.size, 4U);
+        EXPECT_EQ(it.field.info->id, 150U);
+        EXPECT_EQ(ipx_fsel_iter_next(&it), IPX_EOC);
+    }
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Static, plainHasNoPrivateData)
+{
+    select_ids ids;
+    ids.ids = {8};
+    ipx_fsel_t *sel = ipx_fsel_create(&select_cb, &ids);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->priv, nullptr);
+
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, res, &rec);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.priv, nullptr);
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Static, mapPrivateData)
+{
+    map_ids map;
+    map.ids = {{12, "dst"}, {7, "sport"}, {1, "octets"}};
+    ipx_fsel_t *sel = ipx_fsel_create_map(&map_cb, &map);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res, nullptr);
+    ASSERT_EQ(res->cnt, 2U);
+    ASSERT_NE(res->priv, nullptr);
+    EXPECT_EQ(res->idx[0], 1U);
+    EXPECT_EQ(res->idx[1], 2U);
+    EXPECT_EQ(res->priv[0], &map.ids[12]);
+    EXPECT_EQ(res->priv[1], &map.ids[7]);
+
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, res, &rec);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[4]);
+    EXPECT_EQ(it.field.info->id, 12U);
+    EXPECT_EQ(*reinterpret_cast<const std::string *>(it.priv), "dst");
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[8]);
+    EXPECT_EQ(it.field.info->id, 7U);
+    EXPECT_EQ(*reinterpret_cast<const std::string *>(it.priv), "sport");
+    EXPECT_EQ(ipx_fsel_iter_next(&it), IPX_EOC);
+
+    // The mapping function must not be called again
+    const unsigned int calls = map.calls;
+    EXPECT_EQ(ipx_fsel_get(sel, tmplt.get()), res);
+    EXPECT_EQ(map.calls, calls);
+
+    ipx_fsel_destroy(sel);
+}
+
+TEST_F(Dynamic, mapAfterVariableFields)
+{
+    map_ids map;
+    map.ids = {{83, "descr"}, {150, "start"}};
+    ipx_fsel_t *sel = ipx_fsel_create_map(&map_cb, &map);
+    ASSERT_NE(sel, nullptr);
+
+    const struct ipx_fsel_result *res = ipx_fsel_get(sel, tmplt.get());
+    ASSERT_NE(res, nullptr);
+    ASSERT_EQ(res->cnt, 2U);
+    EXPECT_TRUE(res->dynamic);
+
+    struct ipx_fsel_iter it;
+    ipx_fsel_iter_init(&it, res, &rec);
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[15]);
+    EXPECT_EQ(it.field.size, 5U);
+    EXPECT_EQ(*reinterpret_cast<const std::string *>(it.priv), "descr");
+    ASSERT_EQ(ipx_fsel_iter_next(&it), IPX_OK);
+    EXPECT_EQ(it.field.data, &data[20]);
+    EXPECT_EQ(*reinterpret_cast<const std::string *>(it.priv), "start");
+    EXPECT_EQ(ipx_fsel_iter_next(&it), IPX_EOC);
+
+    ipx_fsel_destroy(sel);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <ipfixcol2/session.h>
+#include <cstring>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/parser.h>
+    #include <core/message_base.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/// Copy-on-write modification of IPFIX Messages
+class Cow : public ::testing::Test {
+protected:
+    static const ipx_verb_level DEF_VERB = IPX_VERB_DEBUG;
+    static const uint16_t TMPLT_ID = 256;
+    static const uint32_t ODID = 1;
+
+    ipx_ctx_t *ctx;
+    ipx_parser_t *parser;
+    ipx_session *session;
+
+    void SetUp() override {
+        ipx_session_net net_cfg;
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = 60000;
+        net_cfg.port_dst = 4739;
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4), 1);
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4), 1);
+
+        ctx = ipx_ctx_create("Testing context", nullptr);
+        ASSERT_NE(ctx, nullptr);
+        parser = ipx_parser_create("Parser", DEF_VERB);
+        ASSERT_NE(parser, nullptr);
+        session = ipx_session_new_udp(&net_cfg, 0, 0);
+        ASSERT_NE(session, nullptr);
+    }
+
+    void TearDown() override {
+        ipx_parser_destroy(parser);
+        ipx_session_destroy(session);
+        ipx_ctx_destroy(ctx);
+    }
+
+    /// Create a parsed message with a template and two data records
+    ipx_msg_ipfix_t *create() {
+        ipfix_msg msg;
+        msg.set_odid(ODID);
+
+        ipfix_trec trec(TMPLT_ID);
+        trec.add_field(8, 4);  // SRC IPv4 address
+        trec.add_field(1, 4);  // bytes
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+        msg.add_set(set_tmplts);
+
+        ipfix_set set_data(TMPLT_ID);
+        for (int i = 0; i < 2; ++i) {
+            ipfix_drec drec;
+            drec.append_ip("127.0.0.1");
+            drec.append_uint(12345, 4);
+            set_data.add_rec(drec);
+        }
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {session, ODID, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        EXPECT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage_t *garbage;
+        EXPECT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        if (garbage != nullptr) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+
+        EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 2U);
+        return ipfix_msg;
+    }
+};
+
+// A message that is not shared is modified in place
+TEST_F(Cow, notShared)
+{
+    ipx_msg_ipfix_t *msg = create();
+    uint8_t *data = ipx_msg_ipfix_get_drec(msg, 0)->rec.data;
+
+    ASSERT_EQ(ipx_msg_ipfix_cow(msg), msg);
+    struct ipx_ipfix_record *rec = ipx_msg_ipfix_drec_modify(msg, 0);
+    ASSERT_NE(rec, nullptr);
+    EXPECT_EQ(rec->rec.data, data);
+    EXPECT_EQ(ipx_msg_ipfix_drec_modify(msg, 2), nullptr);
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// Modifications of a shared message are visible only in the private copy
+TEST_F(Cow, shared)
+{
+    ipx_msg_ipfix_t *orig = create();
+    ipx_msg_header_cnt_set(ipx_msg_ipfix2base(orig), 2); // e.g. two output instances
+    uint8_t *orig_pkt = ipx_msg_ipfix_get_packet(orig);
+    uint8_t *orig_rec0 = ipx_msg_ipfix_get_drec(orig, 0)->rec.data;
+    uint8_t *orig_rec1 = ipx_msg_ipfix_get_drec(orig, 1)->rec.data;
+    const size_t offset = orig_rec0 - orig_pkt;
+
+    ipx_msg_ipfix_t *copy = ipx_msg_ipfix_cow(orig);
+    ASSERT_NE(copy, nullptr);
+    ASSERT_NE(copy, orig);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(copy), 2U);
+    EXPECT_EQ(ipx_msg_ipfix_get_ctx(copy)->odid, ODID);
+
+    // Only the modified record is copied
+    struct ipx_ipfix_record *rec = ipx_msg_ipfix_drec_modify(copy, 0);
+    ASSERT_NE(rec, nullptr);
+    EXPECT_NE(rec->rec.data, orig_rec0);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(copy, 1)->rec.data, orig_rec1);
+    EXPECT_EQ(ipx_msg_ipfix_drec_modify(copy, 0), rec);
+    const uint8_t addr_anon[4] = {10, 0, 0, 1};
+    memcpy(rec->rec.data, addr_anon, sizeof(addr_anon));
+    EXPECT_NE(memcmp(orig_rec0, addr_anon, sizeof(addr_anon)), 0);
+
+    // The raw packet is serialized on demand
+    uint8_t *copy_pkt = ipx_msg_ipfix_get_packet(copy);
+    ASSERT_NE(copy_pkt, orig_pkt);
+    const uint16_t pkt_size = ntohs(reinterpret_cast<fds_ipfix_msg_hdr *>(orig_pkt)->length);
+    EXPECT_EQ(memcmp(copy_pkt, orig_pkt, offset), 0);
+    EXPECT_EQ(memcmp(&copy_pkt[offset], addr_anon, sizeof(addr_anon)), 0);
+    const size_t rest = offset + sizeof(addr_anon);
+    EXPECT_EQ(memcmp(&copy_pkt[rest], &orig_pkt[rest], pkt_size - rest), 0);
+
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(copy, &sets, &sets_cnt);
+    ASSERT_EQ(sets_cnt, 2U);
+    EXPECT_EQ(reinterpret_cast<uint8_t *>(sets[0].ptr), &copy_pkt[FDS_IPFIX_MSG_HDR_LEN]);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(copy, 0)->rec.data, &copy_pkt[offset]);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(copy, 1)->rec.data, &copy_pkt[orig_rec1 - orig_pkt]);
+
+    // The copy holds a reference to the original message
+    ipx_msg_ipfix_destroy(orig);
+    EXPECT_EQ(memcmp(orig_rec1, copy_pkt + (orig_rec1 - orig_pkt), 4), 0);
+    ipx_msg_ipfix_destroy(copy);
+}
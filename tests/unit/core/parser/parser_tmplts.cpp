@@ -0,0 +1,275 @@
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <ipfixcol2/session.h>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/parser.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/// Preserving (Options) Templates of UDP Transport Sessions in a file
+class Tmplts : public ::testing::Test {
+protected:
+    static const ipx_verb_level DEF_VERB = IPX_VERB_DEBUG;
+    static constexpr const char *FILE_NAME = "parser_tmplts.data";
+    static const uint16_t TMPLT_ID = 256;
+    static const uint32_t ODID = 1;
+
+    ipx_ctx_t *ctx;
+    ipx_session_net net_cfg;
+
+    void SetUp() override {
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = 60000;
+        net_cfg.port_dst = 4739;
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4), 1);
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4), 1);
+
+        ctx = ipx_ctx_create("Testing context", nullptr);
+        ASSERT_NE(ctx, nullptr);
+        std::remove(FILE_NAME);
+    }
+
+    void TearDown() override {
+        ipx_ctx_destroy(ctx);
+        std::remove(FILE_NAME);
+    }
+
+    /**
+     * \brief Process a message with an optional template and one data record
+     * \return Number of data records in the parsed message
+     */
+    int process(ipx_parser_t *parser, ipx_session *session, uint32_t exp_time, bool with_tmplt) {
+        ipfix_msg msg;
+        msg.set_exp(exp_time);
+        msg.set_odid(ODID);
+
+        if (with_tmplt) {
+            ipfix_trec trec(TMPLT_ID);
+            trec.add_field(8, 4);  // SRC IPv4 address
+            trec.add_field(1, 4);  // bytes
+            ipfix_set set_tmplts(2);
+            set_tmplts.add_rec(trec);
+            msg.add_set(set_tmplts);
+        }
+
+        ipfix_drec drec;
+        drec.append_ip("127.0.0.1");
+        drec.append_uint(12345, 4);
+        ipfix_set set_data(TMPLT_ID);
+        set_data.add_rec(drec);
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {session, ODID, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        EXPECT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage_t *garbage;
+        EXPECT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        if (garbage != nullptr) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+
+        int cnt = static_cast<int>(ipx_msg_ipfix_get_drec_cnt(ipfix_msg));
+        if (cnt > 0) {
+            EXPECT_NE(ipx_msg_ipfix_get_drec(ipfix_msg, 0)->rec.tmplt, nullptr);
+        }
+        ipx_msg_ipfix_destroy(ipfix_msg);
+        return cnt;
+    }
+
+    /// Remove a Transport Session from a parser
+    void remove(ipx_parser_t *parser, ipx_session *session) {
+        ipx_msg_garbage_t *garbage = nullptr;
+        ASSERT_EQ(ipx_parser_session_remove(parser, session, &garbage), IPX_OK);
+        if (garbage != nullptr) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+    }
+};
+
+// Templates of an active session are restored by a new parser
+TEST_F(Tmplts, saveAndLoad)
+{
+    ipx_parser_t *p_old = ipx_parser_create("Old parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_old, true);
+    ipx_session *s_old = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(process(p_old, s_old, 1000, true), 1);
+    ASSERT_EQ(ipx_parser_tmplts_save(p_old, FILE_NAME), IPX_OK);
+    ipx_parser_destroy(p_old);
+    ipx_session_destroy(s_old);
+
+    ipx_parser_t *p_new = ipx_parser_create("New parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_new, true);
+    ipx_session *s_new = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(ipx_parser_tmplts_load(p_new, FILE_NAME), IPX_OK);
+    EXPECT_EQ(process(p_new, s_new, 1100, false), 1);
+    EXPECT_EQ(process(p_new, s_new, 1200, false), 1);
+    ipx_parser_destroy(p_new);
+    ipx_session_destroy(s_new);
+}
+
+// Templates of a closed session are kept and saved
+TEST_F(Tmplts, closedSession)
+{
+    ipx_parser_t *p_old = ipx_parser_create("Old parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_old, true);
+    ipx_session *s_old = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(process(p_old, s_old, 1000, true), 1);
+    remove(p_old, s_old);
+    ipx_session_destroy(s_old);
+    ASSERT_EQ(ipx_parser_tmplts_save(p_old, FILE_NAME), IPX_OK);
+
+    // The same parser restores templates of the reconnected exporter
+    ipx_session *s_same = ipx_session_new_udp(&net_cfg, 0, 0);
+    EXPECT_EQ(process(p_old, s_same, 1100, false), 1);
+    ipx_parser_destroy(p_old);
+    ipx_session_destroy(s_same);
+
+    ipx_parser_t *p_new = ipx_parser_create("New parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_new, true);
+    ipx_session *s_new = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(ipx_parser_tmplts_load(p_new, FILE_NAME), IPX_OK);
+    EXPECT_EQ(process(p_new, s_new, 1100, false), 1);
+    ipx_parser_destroy(p_new);
+    ipx_session_destroy(s_new);
+}
+
+// Templates that would already expire are not restored
+TEST_F(Tmplts, expired)
+{
+    ipx_parser_t *p_old = ipx_parser_create("Old parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_old, true);
+    ipx_session *s_old = ipx_session_new_udp(&net_cfg, 60, 60);
+    ASSERT_EQ(process(p_old, s_old, 1000, true), 1);
+    ASSERT_EQ(ipx_parser_tmplts_save(p_old, FILE_NAME), IPX_OK);
+    ipx_parser_destroy(p_old);
+    ipx_session_destroy(s_old);
+
+    ipx_parser_t *p_new = ipx_parser_create("New parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_new, true);
+    ipx_session *s_new = ipx_session_new_udp(&net_cfg, 60, 60);
+    ASSERT_EQ(ipx_parser_tmplts_load(p_new, FILE_NAME), IPX_OK);
+    EXPECT_EQ(process(p_new, s_new, 1000 + 600, false), 0);
+    ipx_parser_destroy(p_new);
+    ipx_session_destroy(s_new);
+}
+
+// Templates are restored only for the same exporter and port
+TEST_F(Tmplts, differentExporter)
+{
+    ipx_parser_t *p_old = ipx_parser_create("Old parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_old, true);
+    ipx_session *s_old = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(process(p_old, s_old, 1000, true), 1);
+    ASSERT_EQ(ipx_parser_tmplts_save(p_old, FILE_NAME), IPX_OK);
+    ipx_parser_destroy(p_old);
+    ipx_session_destroy(s_old);
+
+    net_cfg.port_src = 60001;
+    ipx_parser_t *p_new = ipx_parser_create("New parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_new, true);
+    ipx_session *s_new = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(ipx_parser_tmplts_load(p_new, FILE_NAME), IPX_OK);
+    EXPECT_EQ(process(p_new, s_new, 1100, false), 0);
+    ipx_parser_destroy(p_new);
+    ipx_session_destroy(s_new);
+}
+
+// Templates of TCP sessions are never preserved
+TEST_F(Tmplts, tcpSession)
+{
+    ipx_parser_t *p_old = ipx_parser_create("Old parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_old, true);
+    ipx_session *s_old = ipx_session_new_tcp(&net_cfg);
+    ASSERT_EQ(process(p_old, s_old, 1000, true), 1);
+    ASSERT_EQ(ipx_parser_tmplts_save(p_old, FILE_NAME), IPX_OK);
+    ipx_parser_destroy(p_old);
+    ipx_session_destroy(s_old);
+
+    ipx_parser_t *p_new = ipx_parser_create("New parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_new, true);
+    ipx_session *s_new = ipx_session_new_tcp(&net_cfg);
+    ASSERT_EQ(ipx_parser_tmplts_load(p_new, FILE_NAME), IPX_OK);
+    EXPECT_EQ(process(p_new, s_new, 1100, false), 0);
+    ipx_parser_destroy(p_new);
+    ipx_session_destroy(s_new);
+}
+
+// Templates are neither kept nor restored unless enabled
+TEST_F(Tmplts, disabled)
+{
+    ipx_parser_t *p_old = ipx_parser_create("Old parser", DEF_VERB);
+    ipx_session *s_old = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(process(p_old, s_old, 1000, true), 1);
+    ASSERT_EQ(ipx_parser_tmplts_save(p_old, FILE_NAME), IPX_OK);
+    remove(p_old, s_old);
+    ipx_session_destroy(s_old);
+
+    // The reconnected exporter is a new one
+    ipx_session *s_same = ipx_session_new_udp(&net_cfg, 0, 0);
+    EXPECT_EQ(process(p_old, s_same, 1100, false), 0);
+    ipx_parser_destroy(p_old);
+    ipx_session_destroy(s_same);
+
+    // Loaded templates are not restored
+    ipx_parser_t *p_new = ipx_parser_create("New parser", DEF_VERB);
+    ipx_session *s_new = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(ipx_parser_tmplts_load(p_new, FILE_NAME), IPX_OK);
+    EXPECT_EQ(process(p_new, s_new, 1200, false), 0);
+    ipx_parser_destroy(p_new);
+    ipx_session_destroy(s_new);
+}
+
+// Serialized templates written by another thread are the same as a saved file
+TEST_F(Tmplts, dumpAndWrite)
+{
+    ipx_parser_t *p_old = ipx_parser_create("Old parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_old, true);
+    ipx_session *s_old = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(process(p_old, s_old, 1000, true), 1);
+
+    uint8_t *data = nullptr;
+    size_t size = 0;
+    ASSERT_EQ(ipx_parser_tmplts_dump(p_old, &data, &size), IPX_OK);
+    ipx_parser_destroy(p_old);
+    ipx_session_destroy(s_old);
+
+    int rc = IPX_ERR_DENIED;
+    std::thread writer([&]() {
+        rc = ipx_parser_tmplts_write("Writer", FILE_NAME, data, size);
+    });
+    writer.join();
+    free(data);
+    ASSERT_EQ(rc, IPX_OK);
+
+    ipx_parser_t *p_new = ipx_parser_create("New parser", DEF_VERB);
+    ipx_parser_tmplts_keep(p_new, true);
+    ipx_session *s_new = ipx_session_new_udp(&net_cfg, 0, 0);
+    ASSERT_EQ(ipx_parser_tmplts_load(p_new, FILE_NAME), IPX_OK);
+    EXPECT_EQ(process(p_new, s_new, 1100, false), 1);
+    ipx_parser_destroy(p_new);
+    ipx_session_destroy(s_new);
+}
+
+// Missing and malformed files
+TEST_F(Tmplts, invalidFile)
+{
+    ipx_parser_t *parser = ipx_parser_create("Parser", DEF_VERB);
+    EXPECT_EQ(ipx_parser_tmplts_load(parser, FILE_NAME), IPX_ERR_NOTFOUND);
+
+    std::ofstream(FILE_NAME) << "definitely not a file with templates";
+    EXPECT_EQ(ipx_parser_tmplts_load(parser, FILE_NAME), IPX_ERR_FORMAT);
+    ipx_parser_destroy(parser);
+}
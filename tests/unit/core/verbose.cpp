@@ -1,6 +1,15 @@
 #include <gtest/gtest.h>
 #include <core/verbose.h>
 
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <regex>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <unistd.h>
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -13,3 +22,152 @@ TEST(Verbosity, global_set_and_get)
     enum ipx_verb_level level = ipx_verb_level_get();
     EXPECT_EQ(level, IPX_VERB_INFO);
 }
+
+/// Redirection of the standard output into a temporary file
+class Output {
+private:
+    FILE *file = nullptr;
+    int fd_orig = -1;
+public:
+    Output() {
+        fflush(stdout);
+        file = tmpfile();
+        if (!file) {
+            throw std::runtime_error("Failed to create a temporary file");
+        }
+        fd_orig = dup(STDOUT_FILENO);
+        dup2(fileno(file), STDOUT_FILENO);
+    };
+    ~Output() {
+        fflush(stdout);
+        dup2(fd_orig, STDOUT_FILENO);
+        close(fd_orig);
+        fclose(file);
+    };
+
+    /// Get everything printed so far
+    std::string text() {
+        fflush(stdout);
+        std::string str;
+        char buffer[4096];
+        ssize_t len;
+        off_t offset = 0;
+        while ((len = pread(fileno(file), buffer, sizeof(buffer), offset)) > 0) {
+            str.append(buffer, size_t(len));
+            offset += len;
+        }
+        return str;
+    };
+};
+
+/// Count lines that start with a prefix
+static unsigned int
+lines_cnt(const std::string &text, const std::string &prefix)
+{
+    unsigned int cnt = 0;
+    size_t pos = 0;
+    while ((pos = text.find(prefix, pos)) != std::string::npos) {
+        if (pos == 0 || text[pos - 1] == '\n') {
+            cnt++;
+        }
+        pos += prefix.size();
+    }
+    return cnt;
+}
+
+/// Sum numbers of messages in reports that match a regular expression with one number
+static unsigned int
+reports_sum(const std::string &text, const std::string &expr)
+{
+    const std::regex regex(expr);
+    unsigned int sum = 0;
+    for (auto it = std::sregex_iterator(text.begin(), text.end(), regex);
+            it != std::sregex_iterator(); ++it) {
+        sum += unsigned(std::stoul((*it)[1].str()));
+    }
+    return sum;
+}
+
+/// Number of suppressed messages reported by sites and by the logger
+static unsigned int
+suppressed_cnt(const std::string &text)
+{
+    return reports_sum(text, "Suppressed ([0-9]+) similar message")
+        + reports_sum(text, "([0-9]+) message\\(s\\) suppressed by rate limiting");
+}
+
+TEST(VerbosityAsync, rateLimiting)
+{
+    const unsigned int total = 25;
+    const std::string msg = "WARNING: Test: Flood";
+
+    Output out;
+    ASSERT_EQ(ipx_verb_async_start(), IPX_OK);
+    for (unsigned int i = 0; i < total; ++i) {
+        ipx_verb_print(IPX_VERB_WARNING, "WARNING: Test: Flood\n");
+    }
+
+    // The site doesn't print anymore, so the logger must report the suppressed messages itself
+    std::string text;
+    for (int i = 0; i < 50; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        text = out.text();
+        if (lines_cnt(text, msg) + suppressed_cnt(text) >= total) {
+            break;
+        }
+    }
+    ipx_verb_async_stop();
+
+    // At most 2 intervals (if the flood crossed a boundary of an interval)
+    const unsigned int printed = lines_cnt(text, msg);
+    EXPECT_GE(printed, 10U);
+    EXPECT_LE(printed, 20U);
+    EXPECT_EQ(printed + suppressed_cnt(text), total);
+}
+
+TEST(VerbosityAsync, suppressedReportedOnce)
+{
+    const unsigned int total = 15;
+    const std::string msg = "WARNING: Test: Repeated";
+
+    Output out;
+    ASSERT_EQ(ipx_verb_async_start(), IPX_OK);
+    for (unsigned int i = 0; i < total; ++i) {
+        ipx_verb_print(IPX_VERB_WARNING, "WARNING: Test: Repeated\n");
+    }
+
+    // Wait for the next interval and print the message again
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    ipx_verb_print(IPX_VERB_WARNING, "WARNING: Test: Repeated\n");
+    ipx_verb_async_stop();
+
+    // The suppressed messages are reported either by the site or by the logger (not twice)
+    const std::string text = out.text();
+    const unsigned int printed = lines_cnt(text, msg);
+    EXPECT_GE(printed, 11U);
+    EXPECT_EQ(printed + suppressed_cnt(text), total + 1);
+}
+
+TEST(VerbosityAsync, dropWhenFull)
+{
+    // Each message has its own site, so it is not rate limited
+    const unsigned int total = 5000;
+    std::vector<std::string> fmts;
+    for (unsigned int i = 0; i < total; ++i) {
+        fmts.push_back("WARNING: Test: Message " + std::to_string(i) + "\n");
+    }
+
+    Output out;
+    ASSERT_EQ(ipx_verb_async_start(), IPX_OK);
+    for (const auto &fmt : fmts) {
+        ipx_verb_print(IPX_VERB_WARNING, fmt.c_str());
+    }
+    ipx_verb_async_stop();
+
+    const std::string text = out.text();
+    const unsigned int printed = lines_cnt(text, "WARNING: Test: Message ");
+    const unsigned int dropped = reports_sum(text,
+        "([0-9]+) message\\(s\\) dropped due to a full log buffer");
+    EXPECT_GT(dropped, 0U);
+    EXPECT_EQ(printed + dropped, total);
+}